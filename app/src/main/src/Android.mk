@@ -37,7 +37,12 @@ include $(CLEAR_VARS)
 
 LOCAL_MODULE := CloudXRClientPXR
 
-LOCAL_CFLAGS += -DXR_USE_PLATFORM_ANDROID=1 -DXR_USE_GRAPHICS_API_OPENGL_ES=1
+LOCAL_CFLAGS += -DXR_USE_PLATFORM_ANDROID=1 -DXR_USE_GRAPHICS_API_OPENGL_ES=1 -DXR_USE_TIMESPEC=1
+
+# NEON is always there on arm64, use the SIMD backend of xr_linear.h.
+ifeq ($(TARGET_ARCH_ABI),arm64-v8a)
+LOCAL_CFLAGS += -DXR_LINEAR_USE_SIMD=1
+endif
 
 LOCAL_C_INCLUDES := $(PXR_SDK_ROOT)/include \
                     $(OBOE_SDK_ROOT)/prefab/modules/oboe/include \
@@ -53,12 +58,57 @@ LOCAL_SRC_FILES := main.cpp \
                    graphicsplugin_opengles.cpp \
                    openxr_loader/include/common/gfxwrapper_opengl.c \
                    cloudXRClient.cpp \
-                   openxr_program.cpp
+                   openxr_program.cpp \
+                   thread_pool.cpp \
+                   startup.cpp \
+                   runtime_options.cpp \
+                   file_watcher.cpp \
+                   lifecycle_worker.cpp \
+                   frame_pacing.cpp \
+                   thread_policy.cpp \
+                   clock.cpp \
+                   haptics.cpp \
+                   latch_scheduler.cpp \
+                   frame_drops.cpp \
+                   latency_tracker.cpp \
+                   loop_waker.cpp \
+                   performance_settings.cpp \
+                   thermal_governor.cpp \
+                   half_rate.cpp \
+                   gaze_foveation.cpp \
+                   input_thread.cpp \
+                   reconnect_scheduler.cpp \
+                   controller_pose.cpp
 
 LOCAL_LDLIBS := -llog -landroid -lGLESv3 -lEGL
 LOCAL_STATIC_LIBRARIES	:= android_native_app_glue
 LOCAL_SHARED_LIBRARIES := Oboe CloudXRClient Grid Poco GsAudioWebRTC openxr_loader
 
+# The Vulkan graphics plugin is opt-in: ndk-build CLOUDXR_VULKAN=1, or gradlew -Pvulkan. It is then picked at runtime
+# with adb shell setprop debug.xr.graphicsPlugin Vulkan.
+ifeq ($(CLOUDXR_VULKAN),1)
+LOCAL_CFLAGS += -DXR_USE_GRAPHICS_API_VULKAN=1
+LOCAL_SRC_FILES += graphicsplugin_vulkan.cpp
+LOCAL_LDLIBS += -lvulkan
+
+# Precompile the plugin shaders to SPIR-V with the NDK glslc, emitted as the C initializer lists that
+# graphicsplugin_vulkan.cpp includes as vulkan_shaders/*.spv from the object directory.
+GLSLC := $(NDK_ROOT)/shader-tools/$(HOST_TAG64)/glslc
+VULKAN_SHADER_SRC := $(LOCAL_PATH)/vulkan_shaders
+VULKAN_SHADER_OUT := $(TARGET_OBJS)/$(LOCAL_MODULE)/vulkan_shaders
+LOCAL_C_INCLUDES += $(TARGET_OBJS)/$(LOCAL_MODULE)
+
+$(VULKAN_SHADER_OUT)/vert.spv: $(VULKAN_SHADER_SRC)/cube.vert
+	$(call host-mkdir,$(dir $@))
+	$(GLSLC) -Os -mfmt=c -o $@ $<
+
+$(VULKAN_SHADER_OUT)/frag.spv: $(VULKAN_SHADER_SRC)/cube.frag
+	$(call host-mkdir,$(dir $@))
+	$(GLSLC) -Os -mfmt=c -o $@ $<
+
+$(TARGET_OBJS)/$(LOCAL_MODULE)/graphicsplugin_vulkan.o: $(VULKAN_SHADER_OUT)/vert.spv $(VULKAN_SHADER_OUT)/frag.spv
+endif
+
 include $(BUILD_SHARED_LIBRARY)
 
 $(call import-module, android/native_app_glue)
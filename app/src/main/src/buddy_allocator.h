@@ -0,0 +1,99 @@
+/*
+    buddy allocator for sub-allocating device memory blocks
+*/
+
+#pragma once
+#include "pch.h"
+#include "common.h"
+
+// Buddy allocator over a power-of-two range. It only does the offset bookkeeping and never calls into the graphics API,
+// so the Vulkan plugin sub-allocates a VkDeviceMemory block without driver calls.
+struct BuddyAllocator {
+    void Init(uint64_t size, uint64_t minSize) {
+        CHECK_MSG(IsPowerOfTwo(size) && IsPowerOfTwo(minSize) && minSize <= size, "Buddy allocator sizes must be powers of two");
+
+        // Level 0 is the whole range, every following level halves the range size down to minSize.
+        m_size = size;
+        m_minSize = minSize;
+        m_levelCount = 1;
+        for (uint64_t levelSize = size; levelSize > minSize; levelSize >>= 1) {
+            m_levelCount++;
+        }
+        m_freeLists.assign(m_levelCount, {});
+        m_freeLists[0].insert(0);
+        m_allocated.clear();
+        m_usedSize = 0;
+    }
+
+    // Ranges are aligned to their own size, so any power-of-two alignment up to the range size is satisfied.
+    bool Allocate(uint64_t size, uint64_t alignment, uint64_t* offset) {
+        const uint64_t needed = std::max(std::max(size, alignment), m_minSize);
+        if (needed > m_size) {
+            return false;
+        }
+
+        uint32_t level = m_levelCount - 1;
+        while (LevelSize(level) < needed) {
+            level--;
+        }
+
+        // Take the smallest free range that fits and split it down to the requested level.
+        int from = (int)level;
+        while (from >= 0 && m_freeLists[from].empty()) {
+            from--;
+        }
+        if (from < 0) {
+            return false;
+        }
+
+        const uint64_t rangeOffset = *m_freeLists[from].begin();
+        m_freeLists[from].erase(m_freeLists[from].begin());
+        for (uint32_t split = (uint32_t)from + 1; split <= level; ++split) {
+            // Keep the lower half, the upper half becomes free.
+            m_freeLists[split].insert(rangeOffset + LevelSize(split));
+        }
+
+        m_allocated[rangeOffset] = level;
+        m_usedSize += LevelSize(level);
+        *offset = rangeOffset;
+        return true;
+    }
+
+    void Free(uint64_t offset) {
+        auto it = m_allocated.find(offset);
+        CHECK_MSG(it != m_allocated.end(), Fmt("Freeing unallocated offset %llu", (unsigned long long)offset));
+
+        uint32_t level = it->second;
+        m_allocated.erase(it);
+        m_usedSize -= LevelSize(level);
+
+        // Merge with the buddy range for as long as it is free too.
+        while (level > 0) {
+            const uint64_t buddy = offset ^ LevelSize(level);
+            auto buddyIt = m_freeLists[level].find(buddy);
+            if (buddyIt == m_freeLists[level].end()) {
+                break;
+            }
+            m_freeLists[level].erase(buddyIt);
+            offset = std::min(offset, buddy);
+            level--;
+        }
+        m_freeLists[level].insert(offset);
+    }
+
+    bool Empty() const { return m_allocated.empty(); }
+    uint64_t Size() const { return m_size; }
+    uint64_t UsedSize() const { return m_usedSize; }
+
+    static bool IsPowerOfTwo(uint64_t value) { return value != 0 && (value & (value - 1)) == 0; }
+
+   private:
+    uint64_t LevelSize(uint32_t level) const { return m_size >> level; }
+
+    uint64_t m_size{0};
+    uint64_t m_minSize{0};
+    uint64_t m_usedSize{0};
+    uint32_t m_levelCount{0};
+    std::vector<std::set<uint64_t>> m_freeLists;
+    std::map<uint64_t, uint32_t> m_allocated;
+};
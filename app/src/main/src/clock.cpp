@@ -0,0 +1,84 @@
+/*
+    monotonic clock shared by every latency measurement and XrTime conversion
+*/
+#include "clock.h"
+#include "logger.h"
+#include "common.h"
+#include <atomic>
+
+namespace {
+constexpr int64_t NsPerSecond = 1000000000;
+
+std::atomic<XrInstance> s_instance{XR_NULL_HANDLE};
+std::atomic<PFN_xrConvertTimespecTimeToTimeKHR> s_timespecToTime{nullptr};
+std::atomic<PFN_xrConvertTimeToTimespecTimeKHR> s_timeToTimespec{nullptr};
+}  // namespace
+
+namespace Clock {
+int64_t NowNs() {
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return FromTimespec(now);
+}
+
+// Integer math throughout, a double only holds 53 bits and loses nanoseconds after about 104 days of uptime.
+int64_t FromTimespec(const timespec& time) {
+    return (int64_t)time.tv_sec * NsPerSecond + time.tv_nsec;
+}
+
+timespec ToTimespec(int64_t ns) {
+    timespec time;
+    time.tv_sec = (time_t)(ns / NsPerSecond);
+    time.tv_nsec = (long)(ns % NsPerSecond);
+    if (time.tv_nsec < 0) {
+        time.tv_sec -= 1;
+        time.tv_nsec += NsPerSecond;
+    }
+    return time;
+}
+
+void InitializeXrTime(XrInstance instance, bool convertTimespecEnabled) {
+    PFN_xrConvertTimespecTimeToTimeKHR timespecToTime = nullptr;
+    PFN_xrConvertTimeToTimespecTimeKHR timeToTimespec = nullptr;
+    if (instance != XR_NULL_HANDLE && convertTimespecEnabled) {
+        if (XR_FAILED(xrGetInstanceProcAddr(instance, "xrConvertTimespecTimeToTimeKHR", (PFN_xrVoidFunction*)&timespecToTime)) ||
+            XR_FAILED(xrGetInstanceProcAddr(instance, "xrConvertTimeToTimespecTimeKHR", (PFN_xrVoidFunction*)&timeToTimespec))) {
+            timespecToTime = nullptr;
+            timeToTimespec = nullptr;
+        }
+    }
+    // Cleared first so a concurrent conversion never pairs a function with a destroyed instance.
+    s_timespecToTime = nullptr;
+    s_timeToTimespec = nullptr;
+    s_instance = instance;
+    s_timespecToTime = timespecToTime;
+    s_timeToTimespec = timeToTimespec;
+
+    if (instance != XR_NULL_HANDLE) {
+        Log::Write(Log::Level::Info, Fmt("XrTime conversion: %s", timespecToTime != nullptr ? "XR_KHR_convert_timespec_time" : "identity"));
+    }
+}
+
+XrTime ToXrTime(int64_t monotonicNs) {
+    const PFN_xrConvertTimespecTimeToTimeKHR timespecToTime = s_timespecToTime;
+    if (timespecToTime != nullptr) {
+        const timespec time = ToTimespec(monotonicNs);
+        XrTime xrTime = 0;
+        if (XR_SUCCEEDED(timespecToTime(s_instance, &time, &xrTime))) {
+            return xrTime;
+        }
+    }
+    return (XrTime)monotonicNs;
+}
+
+int64_t FromXrTime(XrTime xrTime) {
+    const PFN_xrConvertTimeToTimespecTimeKHR timeToTimespec = s_timeToTimespec;
+    if (timeToTimespec != nullptr) {
+        timespec time;
+        if (XR_SUCCEEDED(timeToTimespec(s_instance, xrTime, &time))) {
+            return FromTimespec(time);
+        }
+    }
+    return (int64_t)xrTime;
+}
+}  // namespace Clock
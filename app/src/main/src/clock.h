@@ -0,0 +1,26 @@
+/*
+    monotonic clock shared by every latency measurement and XrTime conversion
+*/
+
+#pragma once
+#include "pch.h"
+
+namespace Clock {
+// CLOCK_MONOTONIC in integer nanoseconds. std::chrono::steady_clock reads the same clock, so time points from either
+// are on one timeline.
+int64_t NowNs();
+
+inline double NsToMs(int64_t ns) { return ns / 1e6; }
+
+int64_t FromTimespec(const timespec& time);
+
+timespec ToTimespec(int64_t ns);
+
+// Resolves the XR_KHR_convert_timespec_time entry points of the instance, pass XR_NULL_HANDLE when it is destroyed.
+// Without them XrTime is taken to be CLOCK_MONOTONIC nanoseconds, which is what Android runtimes use.
+void InitializeXrTime(XrInstance instance, bool convertTimespecEnabled);
+
+XrTime ToXrTime(int64_t monotonicNs);
+
+int64_t FromXrTime(XrTime time);
+}  // namespace Clock
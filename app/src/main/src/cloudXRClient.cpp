@@ -3,32 +3,123 @@
 */
 #include <thread>
 #include <chrono>
+#include <fstream>
+#include <sstream>
+#include <netdb.h>
 #include "CloudXRClientOptions.h"
 #include <CloudXRMatrixHelpers.h>
 #include "cloudXRClient.h"
 #include <EGL/egl.h>
 #include <GLES3/gl3.h>
 #include "logger.h"
+#include "thread_policy.h"
+#include "clock.h"
 #include "common/gfxwrapper_opengl.h"
 
 static CloudXR::ClientOptions s_options;
 
+static const char* s_optionsDirectory = "/sdcard";
+static const char* s_launchOptionsFile = "CloudXRLaunchOptions.txt";
+static const char* s_runtimeOptionsFile = "CloudXRRuntimeOptions.txt";
+
+// The launch file supplies the defaults, the runtime file overrides them.
+static RuntimeOptions LoadRuntimeOptions(const CloudXR::ClientOptions& launchOptions) {
+    RuntimeOptions base;
+    base.serverIP = launchOptions.mServerIP;
+    base.maxVideoBitrateKbps = launchOptions.mMaxVideoBitrate;
+    base.foveation = (launchOptions.mFoveation > 0 && launchOptions.mFoveation < 100) ? launchOptions.mFoveation : 0;
+
+    const std::string path = Fmt("%s/%s", s_optionsDirectory, s_runtimeOptionsFile);
+    std::ifstream file(path);
+    if (!file) {
+        return base;
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+
+    std::vector<std::string> errors;
+    RuntimeOptions options = ParseRuntimeOptions(text.str(), base, &errors);
+    for (const std::string& error : errors) {
+        Log::Write(Log::Level::Warning, Fmt("%s: %s", path.c_str(), error.c_str()));
+    }
+    return options;
+}
+
 CloudXRClient::CloudXRClient(): mReceiver(nullptr), mClientState(cxrClientState_ReadyToConnect), mInstance(nullptr), mSystemId(0), mSession(nullptr) {
     memset(&mDeviceDesc, 0x00, sizeof(mDeviceDesc));
+    mDeviceDescValid = false;
+    mReconnectRequested = false;
+    mStatsIntervalMs = 1000;
+    mChangedDisplayRate = 0.0f;
+    mPfnRequestDisplayRefreshRate = nullptr;
+    mWasStreaming = false;
+    mLastPoseToPhotonMs = 0;
+    mUseAimPose = false;
+    mInputRateHz = 0;
+    mHalfRate = false;
+    mGazeFoveation = false;
+    mEyeGazeSupported = false;
+    mGazeSequence = 0;
+    mGazeSendErrors = 0;
+    mPerfPressure = PerfPressure::Normal;
+    mAppliedPerfPressure = PerfPressure::Normal;
+    mAppliedThermalLevel = 0;
+    mResolutionFactor = 1.0f;
+    mPoseSequence = 0;
+#ifndef CLOUDXR3_5
+    std::fill(std::begin(mControllers), std::end(mControllers), nullptr);
+#endif
+    mIsPrepared = false;
     mIsPaused = true;
-    mWasPaused = true;
     mIPD = 0.060f;
     mFps = 72.0f;
     memset(mFramebuffers, 0x00, sizeof(mFramebuffers));
     m_callbackArg = nullptr;
     m_traggerHapticCallback = nullptr;
     m_isSupport_epic_view_configuration_fov_extention = false;
+
+    // Created here so a pause or resume posted before Initialize is handled once the thread starts.
+    LifecycleWorker::Handlers handlers;
+    handlers.setPaused = [this](bool pause) { SetReceiverPaused(pause); };
+    handlers.poll = [this]() { PollControl(); };
+    handlers.pollInterval = [this]() { return GetControlPollInterval(); };
+    handlers.shutdown = [this]() {
+        Stop();
+        Log::Write(Log::Level::Info, Fmt("exit cloudxr thread ......"));
+    };
+    mLifecycle.reset(new LifecycleWorker(std::move(handlers)));
+
+    ReconnectScheduler::Handlers reconnectHandlers;
+    reconnectHandlers.start = [this]() { return Start(); };
+    reconnectHandlers.stop = [this]() { Stop(); };
+    reconnectHandlers.server = [this]() { return GetOptions().serverIP; };
+    mReconnect.reset(new ReconnectScheduler(std::move(reconnectHandlers)));
 }
 
 CloudXRClient::~CloudXRClient() {
+    if (mOptionsWatcher) {
+        mOptionsWatcher->Stop();
+    }
+    mLifecycle->Stop();
 }
 
-void CloudXRClient::Initialize(XrInstance instance, XrSystemId systemId, XrSession session, float fps, bool isSupportFov, void* arg, traggerHapticCallback traggerHaptic) {
+void CloudXRClient::Prepare() {
+    Log::Write(Log::Level::Info, Fmt("CloudXRClient::Prepare......"));
+
+    s_options.ParseFile(Fmt("%s/%s", s_optionsDirectory, s_launchOptionsFile).c_str());
+    {
+        std::lock_guard<std::mutex> guard(mOptionsMutex);
+        mOptions = LoadRuntimeOptions(s_options);
+        ApplyLiveOptions(mOptions);
+    }
+    // Opening a low latency stream takes tens of ms on some devices, do it now instead of at connect time.
+    OpenAudioStream();
+    WarmUpServerAddress();
+    mIsPrepared = true;
+}
+
+void CloudXRClient::Initialize(XrInstance instance, XrSystemId systemId, XrSession session, float fps, bool isSupportFov, const DeviceProfile& deviceProfile, void* arg, traggerHapticCallback traggerHaptic) {
+    mDeviceProfile = &deviceProfile;
     mInstance = instance;
     mSystemId = systemId;
     mSession = session;
@@ -41,7 +132,13 @@ void CloudXRClient::Initialize(XrInstance instance, XrSystemId systemId, XrSessi
 
     Log::Write(Log::Level::Info, Fmt("ipd:%f", mIPD));
 
-    s_options.ParseFile("/sdcard/CloudXRLaunchOptions.txt");
+    if (!mIsPrepared) {
+        Prepare();
+    }
+
+    mOptionsWatcher.reset(new FileWatcher(s_optionsDirectory, {s_launchOptionsFile, s_runtimeOptionsFile},
+                                          [this](const std::string&) { ReloadOptions(); }));
+    mOptionsWatcher->Start();
 
     mContext.type = cxrGraphicsContext_GLES;
     mContext.egl.display = eglGetCurrentDisplay();
@@ -55,64 +152,277 @@ void CloudXRClient::Initialize(XrInstance instance, XrSystemId systemId, XrSessi
         return;
     }
 
-    std::thread([=](){
-        static uint64_t lastTimeMs = 0;
-        while (true) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    InitializeFramePacing();
+    if (!mThermalSource) {
+        mThermalSource.reset(new SysfsThermalSource());
+    }
 
-            if (mWasPaused != mIsPaused) {
-                mWasPaused = mIsPaused;
-                if (mIsPaused == false && mClientState == cxrClientState_ReadyToConnect) {
-                    Start();
-                } else if (mIsPaused == true) {
-                    Stop();
-                }
-            }
+    mLifecycle->Start();
+}
 
-            if (mReceiver && mClientState == cxrClientState_StreamingSessionInProgress) {
-                uint64_t nowTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();  //milliseconds
-                // display network quality information pre second
-                if (nowTimeMs - lastTimeMs >= 1000) {
-                    lastTimeMs = nowTimeMs;
-                    cxrConnectionStats stats = {0};
-                    cxrError ret = cxrGetConnectionStats(mReceiver, &stats);
-                    if (ret == cxrError_Success) {
-                        Log::Write(Log::Level::Info, Fmt("clientstats framesPerSecond:%f, frameDeliveryTime:%f, frameQueueTime:%f, frameLatchTime:%f", 
-                            stats.framesPerSecond, stats.frameDeliveryTimeMs, stats.frameQueueTimeMs, stats.frameLatchTimeMs));
-                        Log::Write(Log::Level::Info, Fmt("bandKbps:%6d, bandwidthUtilizationKbps:%5d, bandUtilizationPercent:%d%%, roundTripDelayMs:%d, "
-                            "jitterUs:%d, totalPacketsReceived:%d, totalPacketsLost:%d, totalPacketsDropped:%d, quality:%d, qualityReasons:%d",
-                            stats.bandwidthAvailableKbps, stats.bandwidthUtilizationKbps, stats.bandwidthUtilizationPercent, stats.roundTripDelayMs,
-                            stats.jitterUs, stats.totalPacketsReceived, stats.totalPacketsLost, stats.totalPacketsDropped, stats.quality, stats.qualityReasons));    
-                    } else {
-                        Log::Write(Log::Level::Error, Fmt("cxrGetConnectionStats error %d", ret));
-                    }
-                }
+// The rest of the control thread's work runs every 100 ms or at the next reconnect attempt, whichever is sooner.
+std::chrono::milliseconds CloudXRClient::GetControlPollInterval() const {
+    return mReconnect->GetPollInterval(std::chrono::milliseconds(100));
+}
+
+void CloudXRClient::PollControl() {
+    UpdateReconnect();
+
+    UpdateDisplayRate();
+    UpdateThermal();
+    PollStats();
+}
+
+void CloudXRClient::SetReceiverPaused(bool pause) {
+    mReconnect->Reset();
+    if (!pause && mClientState == cxrClientState_ReadyToConnect) {
+        if (!Start()) {
+            mReconnect->ScheduleRetry();
+        }
+    } else if (pause) {
+        Stop();
+    }
+    WakeMainLoop();
+}
+
+void CloudXRClient::InitializeFramePacing() {
+    std::vector<float> rates;
+    PFN_xrEnumerateDisplayRefreshRatesFB pfnEnumerateRates = nullptr;
+    if (XR_SUCCEEDED(xrGetInstanceProcAddr(mInstance, "xrEnumerateDisplayRefreshRatesFB", (PFN_xrVoidFunction*)&pfnEnumerateRates)) &&
+        XR_SUCCEEDED(xrGetInstanceProcAddr(mInstance, "xrRequestDisplayRefreshRateFB", (PFN_xrVoidFunction*)&mPfnRequestDisplayRefreshRate))) {
+        uint32_t count = 0;
+        if (XR_SUCCEEDED(pfnEnumerateRates(mSession, 0, &count, nullptr)) && count > 0) {
+            rates.resize(count);
+            if (XR_FAILED(pfnEnumerateRates(mSession, count, &count, rates.data()))) {
+                rates.clear();
             }
         }
+    }
+
+    std::string rateList;
+    for (float rate : rates) {
+        rateList += Fmt(" %.0f", rate);
+    }
+    Log::Write(Log::Level::Info, Fmt("display refresh rates:%s, current %.0f", rateList.empty() ? " unknown" : rateList.c_str(), mFps));
+    mFramePacing.Reset(rates, mFps);
+}
+
+void CloudXRClient::OnDisplayRefreshRateChanged(float rate) {
+    mChangedDisplayRate = rate;
+}
+
+// Runs on the polling thread. The stream fps is part of the device description, so following the display means
+// a reconnect; the pacing hysteresis keeps those rare.
+void CloudXRClient::UpdateDisplayRate() {
+    const float rate = mChangedDisplayRate.exchange(0.0f);
+    if (rate <= 0.0f || rate == mFps) {
+        return;
+    }
+    Log::Write(Log::Level::Info, Fmt("display refresh rate %.0f -> %.0f Hz", mFps, rate));
+    mFps = rate;
+    mFramePacing.OnRateChanged(rate);
+    if (mReceiver != nullptr) {
+        mReconnectRequested = true;
+    }
+}
+
+// Samples connection stats once a second for frame pacing and logs them at the configured stats interval.
+void CloudXRClient::PollStats() {
+    if (!mReceiver || mClientState != cxrClientState_StreamingSessionInProgress) {
+        mWasStreaming = false;
+        return;
+    }
+    if (!mWasStreaming) {
+        mWasStreaming = true;
+        mFramePacing.OnStreamStarted();
+        mFrameDrops.OnStreamStarted();
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const uint32_t statsIntervalMs = mStatsIntervalMs;
+    const auto sampleInterval = std::chrono::milliseconds(statsIntervalMs != 0 ? std::min(statsIntervalMs, 1000u) : 1000u);
+    if (now - mLastStatsTime < sampleInterval) {
+        return;
+    }
+    const float elapsedSeconds = std::chrono::duration<float>(now - mLastStatsTime).count();
+    mLastStatsTime = now;
+
+    cxrConnectionStats stats = {0};
+    cxrError ret = cxrGetConnectionStats(mReceiver, &stats);
+    if (ret != cxrError_Success) {
+        Log::Write(Log::Level::Error, Fmt("cxrGetConnectionStats error %d", ret));
+        return;
+    }
+
+    // elapsedSeconds is huge on the first sample after a pause, the pacing warmup skips it anyway. A half-rate stream is
+    // judged per display frame, it has twice the frame period to decode in.
+    PacingSample pacingSample{stats.framesPerSecond, stats.frameQueueTimeMs};
+    if (mHalfRate) {
+        pacingSample.serverFps *= 2.0f;
+        pacingSample.decodeLatencyMs /= 2.0f;
+    }
+    const float requestRate = mFramePacing.Update(pacingSample, std::min(elapsedSeconds, 5.0f));
+    if (requestRate > 0.0f && mPfnRequestDisplayRefreshRate != nullptr) {
+        XrResult result = mPfnRequestDisplayRefreshRate(mSession, requestRate);
+        if (XR_FAILED(result)) {
+            Log::Write(Log::Level::Warning, Fmt("xrRequestDisplayRefreshRateFB(%.0f) failed: %d", requestRate, result));
+        }
+    }
 
-        Log::Write(Log::Level::Warning, Fmt("exit cloudxr thread ......"));
-    }).detach(); 
+    // display network quality information
+    if (statsIntervalMs != 0 && now - mLastStatsLogTime >= std::chrono::milliseconds(statsIntervalMs)) {
+        mLastStatsLogTime = now;
+        Log::Write(Log::Level::Info, Fmt("clientstats framesPerSecond:%f, frameDeliveryTime:%f, frameQueueTime:%f, frameLatchTime:%f", 
+            stats.framesPerSecond, stats.frameDeliveryTimeMs, stats.frameQueueTimeMs, stats.frameLatchTimeMs));
+        Log::Write(Log::Level::Info, Fmt("bandKbps:%6d, bandwidthUtilizationKbps:%5d, bandUtilizationPercent:%d%%, roundTripDelayMs:%d, "
+            "jitterUs:%d, totalPacketsReceived:%d, totalPacketsLost:%d, totalPacketsDropped:%d, quality:%d, qualityReasons:%d",
+            stats.bandwidthAvailableKbps, stats.bandwidthUtilizationKbps, stats.bandwidthUtilizationPercent, stats.roundTripDelayMs,
+            stats.jitterUs, stats.totalPacketsReceived, stats.totalPacketsLost, stats.totalPacketsDropped, stats.quality, stats.qualityReasons));    
+        Log::Write(Log::Level::Info, Fmt("frame drops: %s", mFrameDrops.DescribeCounts().c_str()));
+        const LatencyTracker::Snapshot latency = mLatency.TakeSnapshot();
+        Log::Write(Log::Level::Info, Fmt("pose-to-latch ms: n %llu mean %.1f p50 %.1f p90 %.1f p99 %.1f max %.1f, "
+            "pose-to-photon ms: n %llu mean %.1f p50 %.1f p90 %.1f p99 %.1f max %.1f, unmatched %llu, "
+            "input-to-send ms: n %llu p50 %.1f p99 %.1f max %.1f",
+            (unsigned long long)latency.poseToLatch.count, latency.poseToLatch.meanMs, latency.poseToLatch.p50Ms,
+            latency.poseToLatch.p90Ms, latency.poseToLatch.p99Ms, latency.poseToLatch.maxMs,
+            (unsigned long long)latency.poseToPhoton.count, latency.poseToPhoton.meanMs, latency.poseToPhoton.p50Ms,
+            latency.poseToPhoton.p90Ms, latency.poseToPhoton.p99Ms, latency.poseToPhoton.maxMs, (unsigned long long)latency.unmatched,
+            (unsigned long long)latency.inputToSend.count, latency.inputToSend.p50Ms, latency.inputToSend.p99Ms, latency.inputToSend.maxMs));
+    }
 }
 
 bool CloudXRClient::Start() {
     Log::Write(Log::Level::Info, Fmt("CloudXRClient::Start ......"));
+    std::lock_guard<std::mutex> guard(mReceiverMutex);
     return CreateReceiver();
 }
 
 void CloudXRClient::Stop() {
     Log::Write(Log::Level::Info, Fmt("CloudXRClient::Stop ......"));
+    std::lock_guard<std::mutex> guard(mReceiverMutex);
     TeardownReceiver();
 }
 
+// Runs on the polling thread. A failed attempt or a dropped session tears down only the receiver, the audio stream,
+// the EGL share context, the FBOs and the device description are kept so the next attempt is just receiver creation
+// and connect.
+void CloudXRClient::UpdateReconnect() {
+    if (mIsPaused) {
+        return;
+    }
+
+    // Only a live receiver is replaced, one created while paused or backing off already picks up the current pressure.
+    if (mReceiver != nullptr && PerformanceSettings::NeedsReconnect(mPerfPressure, mAppliedPerfPressure)) {
+        Log::Write(Log::Level::Info, Fmt("Backing off for %s performance pressure", PerformanceSettings::ToString(mPerfPressure)));
+        mReconnectRequested = true;
+    }
+
+    // Also covers a server address showing up while idle, Stop is a no-op without a receiver.
+    if (mReconnectRequested.exchange(false)) {
+        Log::Write(Log::Level::Info, Fmt("Reconnecting to apply new options"));
+        mReconnect->Restart();
+        return;
+    }
+
+    const cxrClientState state = mClientState;
+    if (state == cxrClientState_StreamingSessionInProgress) {
+        mReconnect->Update(ReconnectScheduler::Link::Streaming);
+    } else if (state == cxrClientState_ConnectionAttemptFailed || state == cxrClientState_Disconnected) {
+        mReconnect->Update(ReconnectScheduler::Link::Lost);
+    } else {
+        mReconnect->Update(ReconnectScheduler::Link::Pending);
+    }
+}
+
+void CloudXRClient::OnPerformancePressure(PerfPressure pressure) {
+    const PerfPressure previous = mPerfPressure.exchange(pressure);
+    if (pressure == previous) {
+        return;
+    }
+    // Render thread, which must not look at the receiver. UpdateReconnect compares against the receiver it owns.
+    Log::Write(Log::Level::Info, Fmt("Performance pressure %s -> %s", PerformanceSettings::ToString(previous), PerformanceSettings::ToString(pressure)));
+}
+
+// Bitrate is only scaled when one is configured, the server default is unknown here. Foveation is enabled or tightened
+// to keep at most the given share of the periphery. The thermal level adds the resolution factor.
+void CloudXRClient::ApplyPerformanceBackoff(RuntimeOptions* options) {
+    const auto limitFoveation = [options](uint32_t foveation) {
+        options->foveation = options->foveation == 0 ? foveation : std::min(options->foveation, foveation);
+    };
+
+    const PerfPressure pressure = mPerfPressure;
+    mAppliedPerfPressure = pressure;
+    if (pressure != PerfPressure::Normal) {
+        const bool impaired = pressure == PerfPressure::Impaired;
+        if (options->maxVideoBitrateKbps != 0) {
+            options->maxVideoBitrateKbps = std::max(1000u, options->maxVideoBitrateKbps / 4 * (impaired ? 2 : 3));
+        }
+        limitFoveation(impaired ? 50 : 70);
+    }
+
+    const uint32_t thermalLevel = mThermalGovernor.GetLevel();
+    const StreamQuality quality = ThermalGovernor::GetQuality(thermalLevel);
+    mAppliedThermalLevel = thermalLevel;
+    mResolutionFactor = quality.resolutionFactor;
+    if (quality.maxFoveation != 0) {
+        limitFoveation(quality.maxFoveation);
+    }
+
+    if (pressure != PerfPressure::Normal || thermalLevel != 0) {
+        Log::Write(Log::Level::Info, Fmt("%s performance, thermal level %u: bitrate %u kbps, foveation %u, resolution factor %.2f",
+                                         PerformanceSettings::ToString(pressure), thermalLevel, options->maxVideoBitrateKbps,
+                                         options->foveation, mResolutionFactor));
+    }
+}
+
+// Runs on the polling thread about once a second. Resolution and foveation are part of the device description, so a
+// new level reconnects; the refresh rate cap goes through the frame pacing, whose rate change reconnects in turn.
+void CloudXRClient::UpdateThermal() {
+    const auto now = std::chrono::steady_clock::now();
+    const bool first = mLastThermalTime == std::chrono::steady_clock::time_point();
+    if (!first && now - mLastThermalTime < std::chrono::seconds(1)) {
+        return;
+    }
+    const float elapsedSeconds = first ? 1.0f : std::min(std::chrono::duration<float>(now - mLastThermalTime).count(), 5.0f);
+    mLastThermalTime = now;
+
+    float celsius;
+    if (!mThermalSource || !mThermalSource->ReadMaxCelsius(&celsius)) {
+        return;
+    }
+    if (!mThermalGovernor.Update(celsius, mPerfPressure, elapsedSeconds)) {
+        return;
+    }
+    const uint32_t level = mThermalGovernor.GetLevel();
+    mFramePacing.SetRateCap(ThermalGovernor::GetQuality(level).maxRefreshRate);
+    if (level != mAppliedThermalLevel && mReceiver != nullptr) {
+        mReconnectRequested = true;
+    }
+}
+
+void CloudXRClient::SetWakeCallback(std::function<void()> wake) {
+    std::function<void()> previous;
+    {
+        std::lock_guard<std::mutex> lock(mWakeMutex);
+        previous.swap(mWakeCallback);
+        mWakeCallback = std::move(wake);
+    }
+}
+
+void CloudXRClient::WakeMainLoop() const {
+    std::lock_guard<std::mutex> lock(mWakeMutex);
+    if (mWakeCallback) {
+        mWakeCallback();
+    }
+}
+
 void CloudXRClient::SetPaused(bool pause) {
     Log::Write(Log::Level::Info, Fmt("SetPaused %d", pause));
     mIsPaused = pause;
-    if (mIsPaused) {
-        Stop();
-    }
+    mLifecycle->Post(pause ? LifecycleCommand::Pause : LifecycleCommand::Resume);
 }
 
-void CloudXRClient::SetSenserPoseState(XrPosef& pose, XrVector3f& linearVelocity, XrVector3f& angularVelocity, std::vector<XrPosef> &handPose, float ipd) {
+void CloudXRClient::SetSenserPoseState(XrPosef& pose, XrVector3f& linearVelocity, XrVector3f& angularVelocity, const ControllerPoseSample (&controllers)[ControllerCount], float ipd) {
     std::lock_guard<std::mutex> guard(mPoseMutex);
     const float offsetHeight = 1.7f;
     mHeadPose = pose;
@@ -120,14 +430,17 @@ void CloudXRClient::SetSenserPoseState(XrPosef& pose, XrVector3f& linearVelocity
     mLinearVelocity = linearVelocity;
     mAngularVelocity = angularVelocity;
 
-    mHandPose = handPose;
-    for (auto &hand : mHandPose) {
-        hand.position.y += offsetHeight;
+    for (uint32_t hand = 0; hand < ControllerCount; hand++) {
+        mControllerPoses[hand] = controllers[hand];
+        mControllerPoses[hand].pose.position.y += offsetHeight;
+        mControllerPoses[hand].aimPose.position.y += offsetHeight;
     }
     mIPD = ipd;
 }
 
+// Called from the input thread when it runs, the pose callback reads mTrackingState concurrently.
 void CloudXRClient::SetTrackingState(cxrVRTrackingState &trackingState) {
+    std::lock_guard<std::mutex> guard(mPoseMutex);
     for (uint32_t i = 0; i < CXR_NUM_CONTROLLERS; i++) {
 #ifdef CLOUDXR3_4
         uint32_t booleanComps = mTrackingState.controller[i].booleanComps;
@@ -145,6 +458,7 @@ void CloudXRClient::SetTrackingState(cxrVRTrackingState &trackingState) {
 }
 
 void CloudXRClient::GetTrackingState(cxrVRTrackingState *trackingState) {
+    ThreadRoles::ApplyOnce(ThreadRole::Pose);
     std::lock_guard<std::mutex> guard(mPoseMutex);
     ProcessControllers();
 
@@ -154,7 +468,7 @@ void CloudXRClient::GetTrackingState(cxrVRTrackingState *trackingState) {
     mTrackingState.hmd.flags = 0; // reset dynamic flags every frame
     mTrackingState.hmd.flags |= cxrHmdTrackingFlags_HasIPD;
 
-    mTrackingState.hmd.pose = ConvertPose(mHeadPose);
+    mTrackingState.hmd.pose = ConvertPose(mHeadPose, mLinearVelocity, mAngularVelocity);
     mTrackingState.hmd.pose.poseIsValid = cxrTrue;
     mTrackingState.hmd.pose.deviceIsConnected = cxrTrue ;
     mTrackingState.hmd.pose.trackingResult = cxrTrackingResult_Running_OK;
@@ -164,6 +478,7 @@ void CloudXRClient::GetTrackingState(cxrVRTrackingState *trackingState) {
     mTrackingState.hmd.activityLevel = cxrDeviceActivityLevel_UserInteraction;
 #endif
     *trackingState = mTrackingState;
+    mLatency.OnPoseSent(++mPoseSequence, Clock::NowNs());
 }
 
 bool CloudXRClient::SetupFramebuffer(GLuint colorTexture, uint32_t eye, uint32_t width, uint32_t height) {
@@ -189,16 +504,80 @@ bool CloudXRClient::SetupFramebuffer(GLuint colorTexture, uint32_t eye, uint32_t
     return true;
 }
 
-bool CloudXRClient::LatchFrame(cxrFramesLatched *framesLatched) {
-    const uint32_t timeoutMs = 500;
+// The center goes out as an app message once per frame, ahead of the pose the server renders the next frame for.
+void CloudXRClient::OnGazeSample(const GazeSample& sample) {
+    const FovealCenter center = mGazeFilter.Update(sample);
+
+    // Like LatchFrame, never waits for the control thread; a center that cannot be sent is superseded next frame.
+    std::unique_lock<std::mutex> lock(mReceiverMutex, std::try_to_lock);
+    if (!lock.owns_lock() || !mReceiver || mClientState != cxrClientState_StreamingSessionInProgress) {
+        return;
+    }
+    uint8_t buffer[FovealCenterMessageSize];
+    SerializeFovealCenter(center, mGazeSequence++, sample.timeNs, buffer);
+    cxrAppMessage message{};
+    message.data = buffer;
+    message.size = sizeof(buffer);
+    cxrError err = cxrSendAppMessage(mReceiver, &message);
+    if (err != cxrError_Success && mGazeSendErrors++ % 1000 == 0) {
+        Log::Write(Log::Level::Warning, Fmt("cxrSendAppMessage failed [%0d] = %s (%u times)", err, cxrErrorString(err), mGazeSendErrors));
+    }
+}
+
+#ifndef CLOUDXR3_5
+bool CloudXRClient::EnsureController(uint32_t handIndex, const cxrControllerDesc& desc, bool* added) {
+    *added = false;
+    std::lock_guard<std::mutex> controllerLock(mControllerMutex);
+    if (!mReceiver || mClientState != cxrClientState_StreamingSessionInProgress || handIndex >= ControllerCount) {
+        return false;
+    }
+    if (mControllers[handIndex]) {
+        return true;
+    }
+    Log::Write(Log::Level::Info, Fmt("Adding controller index %u, ID %llu, role %s", handIndex, desc.id, desc.role));
+    cxrError err = cxrAddController(mReceiver, &desc, &mControllers[handIndex]);
+    if (err != cxrError_Success) {
+        Log::Write(Log::Level::Error, Fmt("Error adding controller %u: %s", handIndex, cxrErrorString(err)));
+        mControllers[handIndex] = nullptr;
+        return false;
+    }
+    *added = true;
+    return true;
+}
+
+bool CloudXRClient::FireControllerEvents(uint32_t handIndex, const cxrControllerEvent* events, uint32_t eventCount) {
+    std::lock_guard<std::mutex> controllerLock(mControllerMutex);
+    if (!mReceiver || handIndex >= ControllerCount || !mControllers[handIndex]) {
+        return false;
+    }
+    cxrError err = cxrFireControllerEvents(mReceiver, mControllers[handIndex], events, eventCount);
+    if (err != cxrError_Success) {
+        Log::Write(Log::Level::Error, Fmt("cxrFireControllerEvents for controller %u failed: %s", handIndex, cxrErrorString(err)));
+        return false;
+    }
+    return true;
+}
+#endif
+
+bool CloudXRClient::LatchFrame(cxrFramesLatched *framesLatched, uint32_t timeoutMs, bool expected) {
     bool frameValid = false;
-    if (mReceiver) {
+    // Never waits for the control thread, a frame without a receiver is just a missed frame.
+    std::unique_lock<std::mutex> lock(mReceiverMutex, std::try_to_lock);
+    if (lock.owns_lock() && mReceiver) {
         if (mClientState == cxrClientState_StreamingSessionInProgress) {
             cxrError frameErr = cxrLatchFrame(mReceiver, framesLatched, cxrFrameMask_All, timeoutMs);
             frameValid = (frameErr == cxrError_Success);
-            if (!frameValid) {
+            if (frameValid) {
+                const int64_t nowNs = Clock::NowNs();
+                mFrameDrops.OnFrameLatched(nowNs, framesLatched->poseID);
+                mLatency.OnFrameLatched(framesLatched->poseID, nowNs);
+                mLatchedFrameLock = std::move(lock);
+            } else {
                 if (frameErr == cxrError_Frame_Not_Ready) {
-                    Log::Write(Log::Level::Info, Fmt("Error in LatchFrame, frame not ready for %d ms", timeoutMs));
+                    if (expected) {
+                        mFrameDrops.OnLatchTimeout(Clock::NowNs());
+                        Log::Write(Log::Level::Verbose, Fmt("LatchFrame: frame not ready within %u ms", timeoutMs));
+                    }
                 } else {
                     Log::Write(Log::Level::Error, Fmt("Error in LatchFrame [%0d] = %s", frameErr, cxrErrorString(frameErr)));
                 }
@@ -218,6 +597,9 @@ void CloudXRClient::BlitFrame(cxrFramesLatched *framesLatched, bool frameValid,
 
 void CloudXRClient::ReleaseFrame(cxrFramesLatched *framesLatched) {
     cxrReleaseFrame(mReceiver, framesLatched);
+    if (mLatchedFrameLock.owns_lock()) {
+        mLatchedFrameLock.unlock();
+    }
 }
 
 void CloudXRClient::FillBackground() {
@@ -233,48 +615,49 @@ bool CloudXRClient::CreateReceiver() {
     if (mReceiver) {
         return true;
     }
-#ifdef CLOUDXR_READ_CONFIG_IP
-#else
-    //s_options.mServerIP = "192.168.1.104";
-#endif
-    if (s_options.mServerIP.empty()) {
+    RuntimeOptions options = GetOptions();
+    // Nothing tells the client whether the server consumes the foveal center, so the device description keeps the
+    // configured foveation. A stronger factor around a center the server ignores would blur wherever the user looks.
+    const bool gazeFoveation = options.gazeFoveation != 0 && mEyeGazeSupported;
+    if (gazeFoveation) {
+        Log::Write(Log::Level::Info, Fmt("gaze_foveation %u: sending foveal centers, foveation stays %u for servers that ignore them",
+                                         options.gazeFoveation, options.foveation));
+    } else if (options.gazeFoveation != 0) {
+        Log::Write(Log::Level::Warning, Fmt("gaze_foveation is set but eye gaze is not available, keeping fixed foveation"));
+    }
+    // Half as many frames at the same per-frame quality need half the bitrate. Done here so the connection
+    // description and the video stream descriptions get the same value, backoff then scales the halved rate.
+    if (options.halfRate && options.maxVideoBitrateKbps != 0) {
+        options.maxVideoBitrateKbps /= 2;
+    }
+    ApplyPerformanceBackoff(&options);
+    mHalfRate = options.halfRate;
+    mGazeFoveation = gazeFoveation;
+    if (options.serverIP.empty()) {
         Log::Write(Log::Level::Error, Fmt("no server ip specifid!!!!!!"));
         return false;
     }
 
-    GetDeviceDesc(&mDeviceDesc);
+    // The description only depends on the OpenXR system, query it once and reuse it for every reconnect.
+    if (!mDeviceDescValid) {
+        GetDeviceDesc(&mDeviceDesc);
+        mDeviceDescValid = true;
+    }
+    ApplyConnectOptions(&mDeviceDesc, options);
 
     if (mDeviceDesc.receiveAudio) {
-        // Initialize audio playback
-        oboe::AudioStreamBuilder playbackStreamBuilder;
-        playbackStreamBuilder.setDirection(oboe::Direction::Output);
-        playbackStreamBuilder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
-        playbackStreamBuilder.setSharingMode(oboe::SharingMode::Exclusive);
-        playbackStreamBuilder.setFormat(oboe::AudioFormat::I16);
-        playbackStreamBuilder.setChannelCount(oboe::ChannelCount::Stereo);
-        playbackStreamBuilder.setSampleRate(CXR_AUDIO_SAMPLING_RATE);
-
-        oboe::Result ret = playbackStreamBuilder.openStream(mPlaybackStream);
-        if (ret != oboe::Result::OK) {
-            Log::Write(Log::Level::Error, Fmt("Failed to open playback stream. Error: %s", oboe::convertToText(ret)));
-            return cxrError_Failed;
-        }
-
-        int bufferSizeFrames = mPlaybackStream->getFramesPerBurst() * 2;
-        ret = mPlaybackStream->setBufferSizeInFrames(bufferSizeFrames);
-        if (ret != oboe::Result::OK) {
-            Log::Write(Log::Level::Error, Fmt("Failed to set playback stream buffer size to: %d. Error: %s", bufferSizeFrames, oboe::convertToText(ret)));
-            return cxrError_Failed;
+        if (!OpenAudioStream()) {
+            return false;
         }
 
-        ret = mPlaybackStream->start();
+        oboe::Result ret = mPlaybackStream->start();
         if (ret != oboe::Result::OK) {
             Log::Write(Log::Level::Error, Fmt("Failed to start playback stream. Error: %s", oboe::convertToText(ret)));
-            return cxrError_Failed;
+            return false;
         }
     }
 
-    Log::Write(Log::Level::Info, Fmt("Trying to create Receiver at %s.", s_options.mServerIP.c_str()));
+    Log::Write(Log::Level::Info, Fmt("Trying to create Receiver at %s.", options.serverIP.c_str()));
 
     cxrClientCallbacks clientProxy = {nullptr};
     clientProxy.GetTrackingState = [](void *context, cxrVRTrackingState *trackingState) {
@@ -332,6 +715,7 @@ bool CloudXRClient::CreateReceiver() {
         }
         Log::Write(Log::Level::Info, Fmt("----------- clientProxy.UpdateClientState B"));
         reinterpret_cast<CloudXRClient *>(context)->mClientState = state;
+        reinterpret_cast<CloudXRClient *>(context)->WakeMainLoop();
         Log::Write(Log::Level::Info, Fmt("----------- clientProxy.UpdateClientState C"));
     };
 
@@ -366,46 +750,180 @@ bool CloudXRClient::CreateReceiver() {
     desc.logMaxSizeKB = CLOUDXR_LOG_MAX_DEFAULT;
     desc.logMaxAgeDays = CLOUDXR_LOG_MAX_DEFAULT;
 
-    cxrError err = cxrCreateReceiver(&desc, &mReceiver);
+    cxrReceiverHandle receiver = nullptr;
+    cxrError err = cxrCreateReceiver(&desc, &receiver);
     if (err != cxrError_Success) {
         Log::Write(Log::Level::Error, Fmt("Failed to create CloudXR receiver. Error %d, %s.", err, cxrErrorString(err)));
         return false;
     }
+    {
+        std::lock_guard<std::mutex> controllerLock(mControllerMutex);
+        mReceiver = receiver;
+    }
     Log::Write(Log::Level::Info, Fmt("cxrCreateReceiver mReceiver:%p", mReceiver));
 
     mConnectionDesc.async = cxrTrue;
 #ifdef CLOUDXR3_1
-    mConnectionDesc.maxVideoBitrateKbps = s_options.mMaxVideoBitrate;
+    mConnectionDesc.maxVideoBitrateKbps = options.maxVideoBitrateKbps;
 #endif
     mConnectionDesc.clientNetwork = s_options.mClientNetwork;
     mConnectionDesc.topology = s_options.mTopology;
-    err = cxrConnect(mReceiver, s_options.mServerIP.c_str(), &mConnectionDesc);
+    err = cxrConnect(mReceiver, options.serverIP.c_str(), &mConnectionDesc);
     if (!mConnectionDesc.async) {
         if (err != cxrError_Success) {
-            Log::Write(Log::Level::Error, Fmt("Failed to connect to CloudXR server at %s. Error %d, %s.", s_options.mServerIP.c_str(), (int) err, cxrErrorString(err)));
+            Log::Write(Log::Level::Error, Fmt("Failed to connect to CloudXR server at %s. Error %d, %s.", options.serverIP.c_str(), (int) err, cxrErrorString(err)));
             TeardownReceiver();
             return false;
         } else {
             mClientState = cxrClientState_StreamingSessionInProgress;
-            Log::Write(Log::Level::Info, Fmt("Receiver created for server: %s", s_options.mServerIP.c_str()));
+            Log::Write(Log::Level::Info, Fmt("Receiver created for server: %s", options.serverIP.c_str()));
         }
     }
     return true;
 }
 
+// The stream stays open across receivers, TeardownReceiver only stops it.
+bool CloudXRClient::OpenAudioStream() {
+    if (mPlaybackStream) {
+        return true;
+    }
+
+    oboe::AudioStreamBuilder playbackStreamBuilder;
+    playbackStreamBuilder.setDirection(oboe::Direction::Output);
+    playbackStreamBuilder.setPerformanceMode(oboe::PerformanceMode::LowLatency);
+    playbackStreamBuilder.setSharingMode(oboe::SharingMode::Exclusive);
+    playbackStreamBuilder.setFormat(oboe::AudioFormat::I16);
+    playbackStreamBuilder.setChannelCount(oboe::ChannelCount::Stereo);
+    playbackStreamBuilder.setSampleRate(CXR_AUDIO_SAMPLING_RATE);
+
+    std::shared_ptr<oboe::AudioStream> stream;
+    oboe::Result ret = playbackStreamBuilder.openStream(stream);
+    if (ret != oboe::Result::OK) {
+        Log::Write(Log::Level::Error, Fmt("Failed to open playback stream. Error: %s", oboe::convertToText(ret)));
+        return false;
+    }
+
+    int bufferSizeFrames = stream->getFramesPerBurst() * 2;
+    ret = stream->setBufferSizeInFrames(bufferSizeFrames);
+    if (ret != oboe::Result::OK) {
+        Log::Write(Log::Level::Error, Fmt("Failed to set playback stream buffer size to: %d. Error: %s", bufferSizeFrames, oboe::convertToText(ret)));
+        return false;
+    }
+    mPlaybackStream = stream;
+    return true;
+}
+
+// Resolve the server once so the lookup (and the network stack bring-up behind it) is not paid inside cxrConnect.
+void CloudXRClient::WarmUpServerAddress() const {
+    const std::string serverIP = GetOptions().serverIP;
+    if (serverIP.empty()) {
+        return;
+    }
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* result = nullptr;
+    int err = getaddrinfo(serverIP.c_str(), nullptr, &hints, &result);
+    if (err != 0) {
+        Log::Write(Log::Level::Warning, Fmt("Failed to resolve server %s: %s", serverIP.c_str(), gai_strerror(err)));
+        return;
+    }
+    freeaddrinfo(result);
+}
+
+RuntimeOptions CloudXRClient::GetOptions() const {
+    std::lock_guard<std::mutex> guard(mOptionsMutex);
+    return mOptions;
+}
+
+// Runs on the file watcher thread. The launch file is parsed into a local copy, s_options keeps the SDK-only settings
+// from startup.
+void CloudXRClient::ReloadOptions() {
+    CloudXR::ClientOptions launchOptions;
+    launchOptions.ParseFile(Fmt("%s/%s", s_optionsDirectory, s_launchOptionsFile).c_str());
+    const RuntimeOptions options = LoadRuntimeOptions(launchOptions);
+
+    RuntimeOptionMask changed;
+    {
+        std::lock_guard<std::mutex> guard(mOptionsMutex);
+        changed = DiffRuntimeOptions(mOptions, options);
+        mOptions = options;
+    }
+    if (changed == 0) {
+        return;
+    }
+
+    const bool reconnect = RequiresReconnect(changed);
+    Log::Write(Log::Level::Info, Fmt("Options changed: %s%s", DescribeRuntimeOptions(changed).c_str(), reconnect ? " (reconnecting)" : ""));
+    ApplyLiveOptions(options);
+    if (reconnect) {
+        mReconnectRequested = true;
+    }
+}
+
+void CloudXRClient::ApplyLiveOptions(const RuntimeOptions& options) {
+    Log::SetLevel(options.logLevel);
+    mStatsIntervalMs = options.statsIntervalMs;
+    mUseAimPose = options.aimPose;
+    mInputRateHz = options.inputRateHz;
+}
+
+// The SDK reads these only when the receiver is created. The prediction offset is applied to the next receiver
+// without forcing a reconnect, the rest arrive here through RequiresReconnect. The stream fps follows the display rate,
+// halved when the client synthesizes every other frame, CreateReceiver has halved the bitrate to match.
+void CloudXRClient::ApplyConnectOptions(cxrDeviceDesc *desc, const RuntimeOptions& options) const {
+    const float streamFps = options.halfRate ? mFps / 2.0f : mFps;
+    // A negative offset takes prediction away from the server's own latency estimate. Once a stream measured its
+    // pose-to-photon latency, never take away more than that, the server would otherwise render poses from before the
+    // ones it was sent.
+    float predOffsetMs = options.predOffsetMs;
+    if (mLastPoseToPhotonMs > 0 && predOffsetMs < -mLastPoseToPhotonMs) {
+        Log::Write(Log::Level::Info, Fmt("Prediction offset %.1f ms limited by the measured %.1f ms pose-to-photon latency", predOffsetMs,
+                                         mLastPoseToPhotonMs));
+        predOffsetMs = (float)-mLastPoseToPhotonMs;
+    }
+    desc->predOffset = predOffsetMs / 1000.0f;
+    desc->maxResFactor = mResolutionFactor;
+    desc->foveatedScaleFactor = options.foveation;
+#ifdef CLOUDXR3_2
+    desc->fps = streamFps;
+#else
+    for (uint32_t i = 0; i < desc->numVideoStreamDescs; i++) {
+        desc->videoStreamDescs[i].maxBitrate = options.maxVideoBitrateKbps;
+        desc->videoStreamDescs[i].fps = streamFps;
+    }
+#endif
+}
+
 void CloudXRClient::TeardownReceiver() {
     Log::Write(Log::Level::Info, Fmt("TeardownReceiver..."));
-    if (mClientState == cxrClientState_ReadyToConnect) {
+    if (mReceiver == nullptr) {
+        mClientState = cxrClientState_ReadyToConnect;
         return;
     }
-    mClientState = cxrClientState_ReadyToConnect;
     if (mPlaybackStream) {
         mPlaybackStream->stop();
     }
-    if (mReceiver != nullptr) {
+    mFrameDrops.DumpAndReset("receiver torn down");
+    const double poseToPhotonMs = mLatency.GetPoseToPhotonMs();
+    if (poseToPhotonMs > 0) {
+        mLastPoseToPhotonMs = poseToPhotonMs;
+    }
+    {
+        std::lock_guard<std::mutex> controllerLock(mControllerMutex);
         cxrDestroyReceiver(mReceiver);
         mReceiver = nullptr;
+#ifndef CLOUDXR3_5
+        std::fill(std::begin(mControllers), std::end(mControllers), nullptr);
+#endif
     }
+    // Only once the receiver is gone, its pose thread may send poses until cxrDestroyReceiver returns. The next
+    // receiver's pose IDs start at 1 again against an empty ring.
+    mLatency.Reset();
+    mPoseSequence = 0;
+    // Set last, destroying the receiver may still report a final state change.
+    mClientState = cxrClientState_ReadyToConnect;
 }
 
 void CloudXRClient::GetDeviceDesc(cxrDeviceDesc *desc) const {
@@ -435,14 +953,22 @@ void CloudXRClient::GetDeviceDesc(cxrDeviceDesc *desc) const {
                                          configurationViewFovEPIC->recommendedFov.angleUp, configurationViewFovEPIC->recommendedFov.angleDown));
         }
     }
+    uint32_t streamWidth = viewCount > 0 ? configViews[0].recommendedImageRectWidth : 0;
+    uint32_t streamHeight = viewCount > 0 ? configViews[0].recommendedImageRectHeight : 0;
+    if (streamWidth == 0 || streamHeight == 0) {
+        streamWidth = mDeviceProfile->decodeWidth;
+        streamHeight = mDeviceProfile->decodeHeight;
+        Log::Write(Log::Level::Warning, Fmt("No recommended image size, using the device default %ux%u", streamWidth, streamHeight));
+    }
+    Log::Write(Log::Level::Info, Fmt("decoder supports H.264%s", (mDeviceProfile->codecs & DeviceCodec_HEVC) ? ", HEVC" : ""));
+
 #ifdef CLOUDXR3_2
     desc->deliveryType = cxrDeliveryType_Stereo_RGB;
-    desc->width = configViews[0].recommendedImageRectWidth;
-    desc->height = configViews[0].recommendedImageRectHeight;
+    desc->width = streamWidth;
+    desc->height = streamHeight;
     desc->fps = mFps;
 #endif
     desc->ipd = mIPD;
-    desc->predOffset = -0.02f;
     desc->receiveAudio = true;
     desc->sendAudio = false;
     desc->posePollFreq = 0;
@@ -452,7 +978,6 @@ void CloudXRClient::GetDeviceDesc(cxrDeviceDesc *desc) const {
     desc->disablePosePrediction = false;
     desc->angularVelocityInDeviceSpace = false;
     desc->disableVVSync = false;
-    desc->foveatedScaleFactor = (s_options.mFoveation > 0 && s_options.mFoveation < 100) ? s_options.mFoveation : 0;
     desc->maxResFactor = 1.0f;
 
 #ifdef CLOUDXR3_2
@@ -462,8 +987,8 @@ void CloudXRClient::GetDeviceDesc(cxrDeviceDesc *desc) const {
     //closest equivalent is in cxrDeviceDesc. Copied from Oculus
     {
         //correct?
-        int width = configViews[0].recommendedImageRectWidth;
-        int height = configViews[0].recommendedImageRectHeight;
+        int width = streamWidth;
+        int height = streamHeight;
 
         desc->numVideoStreamDescs = CXR_NUM_VIDEO_STREAMS_XR;
         for (uint32_t i = 0; i < desc->numVideoStreamDescs; i++) {
@@ -471,7 +996,6 @@ void CloudXRClient::GetDeviceDesc(cxrDeviceDesc *desc) const {
             desc->videoStreamDescs[i].width = width;
             desc->videoStreamDescs[i].height = height;
             desc->videoStreamDescs[i].fps = mFps;//mTargetDisplayRefresh;
-            desc->videoStreamDescs[i].maxBitrate = s_options.mMaxVideoBitrate;//GOptions.mMaxVideoBitrate;
         }
     }
 #endif
@@ -485,11 +1009,11 @@ void CloudXRClient::GetDeviceDesc(cxrDeviceDesc *desc) const {
             desc->proj[i][3] = -tanf(configurationViewFovEPIC->recommendedFov.angleDown);
         } else {
             Log::Write(Log::Level::Info, Fmt("not get fov,set default value"));
-            //This value 1.09130836f is the value of neo3 (pro/pro eye) tested with a higher version ROM, and the value of pico4 is about 1.27f
-            desc->proj[i][0] = -1.09130836f;
-            desc->proj[i][1] =  1.09130836f;
-            desc->proj[i][2] = -1.09130836f;
-            desc->proj[i][3] =  1.09130836f;
+            const float fovTangent = mDeviceProfile->fallbackFovTangent;
+            desc->proj[i][0] = -fovTangent;
+            desc->proj[i][1] =  fovTangent;
+            desc->proj[i][2] = -fovTangent;
+            desc->proj[i][3] =  fovTangent;
         }
     }
 
@@ -588,8 +1112,9 @@ cxrMatrix34 cxrConvert(const pxrMatrix4f &m) {
     return out;
 }
 
-cxrVector3 cxrConvert(const XrVector3f &v) {
-    return {{v.x / 1000, v.y / 1000, v.z / 1000}};
+// XrSpaceVelocity is in m/s and rad/s, the units cxrTrackedDevicePose expects, so no scaling.
+cxrVector3 cxrConvertVelocity(const XrVector3f &v) {
+    return {{v.x, v.y, v.z}};
 }
 
 /// Use left-multiplication to accumulate transformations.
@@ -660,7 +1185,7 @@ static inline pxrMatrix4f GetTransformFromPose(const XrPosef* pose) {
     return Matrix4f_Multiply(&translation, &rotation);
 }
 
-cxrTrackedDevicePose CloudXRClient::ConvertPose(const XrPosef& inPose, float rotationX) {
+cxrTrackedDevicePose CloudXRClient::ConvertPose(const XrPosef& inPose, const XrVector3f& linearVelocity, const XrVector3f& angularVelocity, float rotationX) {
     pxrMatrix4f transform = GetTransformFromPose(&inPose);
     if (rotationX) {
         const pxrMatrix4f rotation = CreateRotation(rotationX, 0, 0);
@@ -670,8 +1195,8 @@ cxrTrackedDevicePose CloudXRClient::ConvertPose(const XrPosef& inPose, float rot
     cxrTrackedDevicePose TrackedPose{};
     cxrMatrix34 m = cxrConvert(transform);
     cxrMatrixToVecQuat(&m, &TrackedPose.position, &TrackedPose.rotation);
-    TrackedPose.velocity = cxrConvert(mLinearVelocity);
-    TrackedPose.angularVelocity = cxrConvert(mAngularVelocity);
+    TrackedPose.velocity = cxrConvertVelocity(linearVelocity);
+    TrackedPose.angularVelocity = cxrConvertVelocity(angularVelocity);
 
     TrackedPose.poseIsValid = cxrTrue;
 
@@ -679,11 +1204,22 @@ cxrTrackedDevicePose CloudXRClient::ConvertPose(const XrPosef& inPose, float rot
 }
 
 void CloudXRClient::ProcessControllers() {
-    for (int32_t hand = 0; hand < mHandPose.size(); hand++) {
-        XrPosef &pose = mHandPose[hand];
-        mTrackingState.controller[hand].pose = ConvertPose(pose);
-        mTrackingState.controller[hand].pose.deviceIsConnected = cxrTrue;
-        mTrackingState.controller[hand].pose.trackingResult = cxrTrackingResult_Running_OK;
+    const bool useAimPose = mUseAimPose;
+    for (uint32_t hand = 0; hand < ControllerCount && hand < CXR_NUM_CONTROLLERS; hand++) {
+        const ControllerPoseSample& sample = mControllerPoses[hand];
+        cxrTrackedDevicePose& pose = mTrackingState.controller[hand].pose;
+        if (const XrPosef* source = SelectControllerPose(sample, useAimPose)) {
+            pose = ConvertPose(*source, sample.linearVelocity, sample.angularVelocity);
+            pose.trackingResult = cxrTrackingResult_Running_OK;
+        } else {
+            // Keep the last position so the server does not see the controller jump to the origin, but stop it
+            // from extrapolating a stale velocity.
+            pose.poseIsValid = cxrFalse;
+            pose.velocity = {};
+            pose.angularVelocity = {};
+            pose.trackingResult = cxrTrackingResult_Running_OutOfRange;
+        }
+        pose.deviceIsConnected = sample.connected ? cxrTrue : cxrFalse;
     }
 }
 
@@ -702,6 +1238,7 @@ void CloudXRClient::TriggerHaptic(const cxrHapticFeedback *hapticFeedback) {
 }
 
 cxrBool CloudXRClient::RenderAudio(const cxrAudioFrame *audioFrame) {
+    ThreadRoles::ApplyOnce(ThreadRole::Audio);
     if (!mPlaybackStream.get()) {
         return cxrFalse;
     }
@@ -712,5 +1249,6 @@ cxrBool CloudXRClient::RenderAudio(const cxrAudioFrame *audioFrame) {
 }
 
 oboe::DataCallbackResult CloudXRClient::onAudioReady(oboe::AudioStream *oboeStream, void *audioData, int32_t numFrames) {
+    ThreadRoles::ApplyOnce(ThreadRole::Audio);
     return oboe::DataCallbackResult::Continue;
 }
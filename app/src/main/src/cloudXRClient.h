@@ -11,7 +11,23 @@
 #include <GLES3/gl3ext.h>
 #include <map>
 #include <memory>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <mutex>
+#include "reconnect_scheduler.h"
+#include "runtime_options.h"
+#include "file_watcher.h"
+#include "lifecycle_worker.h"
+#include "device_profile.h"
+#include "frame_pacing.h"
+#include "frame_drops.h"
+#include "latency_tracker.h"
+#include "performance_settings.h"
+#include "thermal_governor.h"
+#include "gaze_foveation.h"
+#include "controller_pose.h"
 
 typedef void (*traggerHapticCallback)(void* arg, int controllerIdx, float amplitude, float seconds, float frequency);
 
@@ -22,17 +38,56 @@ public:
 
     ~CloudXRClient();
 
-    void Initialize(XrInstance instance, XrSystemId systemId, XrSession session, float fps, bool isSupportFov, void* arg, traggerHapticCallback traggerHaptic);
+    // OpenXR and EGL independent setup, may run on any thread before Initialize.
+    void Prepare();
 
+    void Initialize(XrInstance instance, XrSystemId systemId, XrSession session, float fps, bool isSupportFov, const DeviceProfile& deviceProfile, void* arg, traggerHapticCallback traggerHaptic);
+
+    // Runtime performance notifications. Rising pressure reconnects with a lower bitrate and stronger foveation,
+    // falling pressure is picked up by the next receiver so a flapping notification cannot cycle the stream.
+    void OnPerformancePressure(PerfPressure pressure);
+
+    // Replaces the sysfs thermal zones the governor reads, must be called before Initialize.
+    void SetThermalSource(std::unique_ptr<ThermalSource> source) { mThermalSource = std::move(source); }
+
+    // Whether the runtime reports eye gaze, must be set before Initialize.
+    void SetEyeGazeSupported(bool supported) { mEyeGazeSupported = supported; }
+
+    // Runs on the thread that changed the client state. Replacing it waits for a call in flight, and the previous
+    // callback is destroyed on the calling thread.
+    void SetWakeCallback(std::function<void()> wake);
+
+    // Lifecycle callbacks only post here, the receiver is torn down or created on the control thread.
     void SetPaused(bool pause);
 
-    bool LatchFrame(cxrFramesLatched *framesLatched);
+    // Called on XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB, the stream is renegotiated to the new rate.
+    void OnDisplayRefreshRateChanged(float rate);
+
+    // timeoutMs is the slack left before the frame has to be submitted, 0 only takes a frame that is already decoded.
+    // A latched frame keeps the receiver alive until ReleaseFrame; while the control thread holds it for creation or
+    // teardown no frame is latched. A missing frame that was not expected, as between half-rate frames, is no drop.
+    bool LatchFrame(cxrFramesLatched *framesLatched, uint32_t timeoutMs, bool expected = true);
 
     void BlitFrame(cxrFramesLatched *framesLatched, bool frameValid, uint32_t eye);
 
     void ReleaseFrame(cxrFramesLatched *framesLatched);
 
-    void SetSenserPoseState(XrPosef& pose, XrVector3f& linearVelocity, XrVector3f& angularVelocity, std::vector<XrPosef> &handPose, float ipd);
+    void SetSenserPoseState(XrPosef& pose, XrVector3f& linearVelocity, XrVector3f& angularVelocity, const ControllerPoseSample (&controllers)[ControllerCount], float ipd);
+
+    // The aim pose is only located when the controller_pose runtime option asks for it.
+    bool IsAimPoseEnabled() const { return mUseAimPose; }
+
+    // 0 when controller input is sampled once per frame on the render thread.
+    uint32_t GetInputRateHz() const { return mInputRateHz; }
+
+    // The current receiver streams at half the display rate.
+    bool IsHalfRate() const { return mHalfRate; }
+
+    // The current receiver was created with gaze foveation, the render loop then reports the gaze every frame.
+    bool IsGazeFoveationActive() const { return mGazeFoveation; }
+
+    // Render thread, after SetSenserPoseState. Filters the gaze and sends the foveal center to the server.
+    void OnGazeSample(const GazeSample& sample);
 
     XrQuaternionf cxrToQuaternion(const cxrMatrix34 &m);
 
@@ -42,20 +97,66 @@ public:
 
     bool SetupFramebuffer(GLuint colorTexture, uint32_t eye, uint32_t width, uint32_t height);
 
-    cxrReceiverHandle GetReceiver() { return mReceiver; }
+#ifndef CLOUDXR3_5
+    // Input thread or render thread. Controller handles belong to the receiver and are dropped with it. Adds the
+    // controller to the current receiver unless it already was, *added is set then so the caller sends every input
+    // once. Returns false when no receiver is streaming or the add failed.
+    bool EnsureController(uint32_t handIndex, const cxrControllerDesc& desc, bool* added);
+
+    // Returns false when the events were not sent: no receiver, no controller on it yet, or a CloudXR error.
+    bool FireControllerEvents(uint32_t handIndex, const cxrControllerEvent* events, uint32_t eventCount);
+#endif
 
-    cxrClientState GetClientState() const {return mClientState;}
+    // Latch timeouts and server repeats are recorded here, the render loop adds the OpenXR side.
+    FrameDropTracker& GetFrameDrops() { return mFrameDrops; }
+
+    // Pose send and latch times are recorded here, the render loop adds the display time of each new frame.
+    LatencyTracker& GetLatencyTracker() { return mLatency; }
+
+    cxrClientState GetClientState() const {return mClientState.load();}
 
 private:
+    // Control thread, from the lifecycle worker.
+    void SetReceiverPaused(bool pause);
+
+    std::chrono::milliseconds GetControlPollInterval() const;
+
+    void PollControl();
+
+    void WakeMainLoop() const;
 
     bool Start();
 
     void Stop();
 
+    void UpdateReconnect();
+
+    RuntimeOptions GetOptions() const;
+
+    void ReloadOptions();
+
+    void ApplyLiveOptions(const RuntimeOptions& options);
+
+    void ApplyConnectOptions(cxrDeviceDesc *desc, const RuntimeOptions& options) const;
+
+    void ApplyPerformanceBackoff(RuntimeOptions* options);
+
+    void UpdateThermal();
+
+    void InitializeFramePacing();
+
+    void UpdateDisplayRate();
+
+    void PollStats();
+
     oboe::DataCallbackResult onAudioReady(oboe::AudioStream *oboeStream, void *audioData, int32_t numFrames) override;
 
     bool CreateReceiver();
 
+    bool OpenAudioStream();
+
+    void WarmUpServerAddress() const;
+
     void TeardownReceiver();
 
     void GetDeviceDesc(cxrDeviceDesc *params) const;
@@ -66,7 +167,7 @@ private:
 
     void TriggerHaptic(const cxrHapticFeedback *);
 
-    cxrTrackedDevicePose ConvertPose(const XrPosef& inPose, float rotationX = 0);
+    cxrTrackedDevicePose ConvertPose(const XrPosef& inPose, const XrVector3f& linearVelocity, const XrVector3f& angularVelocity, float rotationX = 0);
 
     cxrBool RenderAudio(const cxrAudioFrame *audioFrame);
 
@@ -74,12 +175,15 @@ private:
 
 private:
     cxrReceiverHandle mReceiver;
-    cxrClientState mClientState;
+    // Written by the SDK state callback, read by the polling and render threads.
+    std::atomic<cxrClientState> mClientState;
     cxrDeviceDesc mDeviceDesc;
+    bool mDeviceDescValid;
     cxrConnectionDesc mConnectionDesc;
     cxrGraphicsContext mContext;
     cxrVRTrackingState mTrackingState;
 
+    const DeviceProfile* mDeviceProfile = &s_unknownDeviceProfile;
     XrInstance mInstance;
     XrSystemId mSystemId;
     XrSession  mSession;
@@ -89,11 +193,68 @@ private:
     XrVector3f mLinearVelocity;
     XrVector3f mAngularVelocity;
     std::map<uint64_t, std::vector<XrView>> mPoseViewsMap;
-    std::vector<XrPosef> mHandPose;
+    ControllerPoseSample mControllerPoses[ControllerCount];
+    std::atomic<bool> mUseAimPose;
+    std::atomic<uint32_t> mInputRateHz;
+    // Set by the control thread for each receiver it creates.
+    std::atomic<bool> mHalfRate;
+    std::atomic<bool> mGazeFoveation;
+    bool mEyeGazeSupported;
+    // Render thread only.
+    GazeFilter mGazeFilter;
+    uint32_t mGazeSequence;
+    uint32_t mGazeSendErrors;
     std::shared_ptr<oboe::AudioStream> mPlaybackStream;
 
-    bool mIsPaused;
-    bool mWasPaused;
+    // Held by the control thread around receiver creation and teardown, and by the render thread from a successful
+    // latch until the frame is released.
+    std::mutex mReceiverMutex;
+    std::unique_lock<std::mutex> mLatchedFrameLock;
+    // Taken after mReceiverMutex by receiver creation and teardown, and alone by the controller calls. The input thread
+    // then never waits for a latched frame, only for the receiver to be swapped.
+    std::mutex mControllerMutex;
+#ifndef CLOUDXR3_5
+    cxrControllerHandle mControllers[ControllerCount];
+#endif
+    // Its thread is the control thread, the only one that creates or destroys receivers.
+    std::unique_ptr<LifecycleWorker> mLifecycle;
+    // Held while the callback runs, the callback only signals an fd.
+    mutable std::mutex mWakeMutex;
+    std::function<void()> mWakeCallback;
+    // Control thread only.
+    std::unique_ptr<ReconnectScheduler> mReconnect;
+
+    mutable std::mutex mOptionsMutex;
+    RuntimeOptions mOptions;
+    std::unique_ptr<FileWatcher> mOptionsWatcher;
+    std::atomic<bool> mReconnectRequested;
+    std::atomic<uint32_t> mStatsIntervalMs;
+
+    FramePacingController mFramePacing;
+    FrameDropTracker mFrameDrops;
+    LatencyTracker mLatency;
+    // Smoothed pose-to-photon latency of the last receiver that displayed frames, kept across the teardown for the
+    // prediction offset of the next one.
+    double mLastPoseToPhotonMs;
+    std::atomic<PerfPressure> mPerfPressure;
+    // Pressure the current receiver was created for.
+    std::atomic<PerfPressure> mAppliedPerfPressure;
+    // The SDK numbers the poses it polls through GetTrackingState from 1 for every receiver.
+    std::atomic<uint64_t> mPoseSequence;
+    PFN_xrRequestDisplayRefreshRateFB mPfnRequestDisplayRefreshRate;
+    std::atomic<float> mChangedDisplayRate;
+    std::chrono::steady_clock::time_point mLastStatsTime;
+    std::chrono::steady_clock::time_point mLastStatsLogTime;
+    // Thermal state is owned by the polling thread, which also creates the receivers it applies to.
+    std::unique_ptr<ThermalSource> mThermalSource;
+    ThermalGovernor mThermalGovernor;
+    std::chrono::steady_clock::time_point mLastThermalTime;
+    uint32_t mAppliedThermalLevel;
+    float mResolutionFactor;
+    bool mWasStreaming;
+
+    bool mIsPrepared;
+    std::atomic<bool> mIsPaused;
     float mIPD;
     float mFps;
 
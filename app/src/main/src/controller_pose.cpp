@@ -0,0 +1,60 @@
+/*
+    controller grip and aim poses located at the predicted display time
+*/
+#include "controller_pose.h"
+#include "common.h"
+
+void SampleControllerPoses(XrSession session, XrAction gripPoseAction, const ControllerSpaces (&spaces)[ControllerCount], XrSpace baseSpace,
+                           XrTime time, bool sampleAim, ControllerPoseSample (&controllers)[ControllerCount]) {
+    constexpr XrSpaceLocationFlags poseValidBits = XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT;
+
+    for (uint32_t hand = 0; hand < ControllerCount; hand++) {
+        ControllerPoseSample& sample = controllers[hand];
+        sample = ControllerPoseSample();
+
+        XrActionStateGetInfo getInfo{};
+        getInfo.type = XR_TYPE_ACTION_STATE_GET_INFO;
+        getInfo.action = gripPoseAction;
+        getInfo.subactionPath = spaces[hand].subactionPath;
+        XrActionStatePose poseState{};
+        poseState.type = XR_TYPE_ACTION_STATE_POSE;
+        CHECK_XRCMD(xrGetActionStatePose(session, &getInfo, &poseState));
+        sample.connected = poseState.isActive == XR_TRUE;
+
+        XrSpaceVelocity velocity{};
+        velocity.type = XR_TYPE_SPACE_VELOCITY;
+        XrSpaceLocation location{};
+        location.type = XR_TYPE_SPACE_LOCATION;
+        location.next = &velocity;
+        XrResult res = xrLocateSpace(spaces[hand].gripSpace, baseSpace, time, &location);
+        CHECK_XRRESULT(res, "xrLocateSpace");
+        if (XR_UNQUALIFIED_SUCCESS(res) && (location.locationFlags & poseValidBits) == poseValidBits) {
+            sample.poseValid = true;
+            sample.pose = location.pose;
+            if ((velocity.velocityFlags & XR_SPACE_VELOCITY_LINEAR_VALID_BIT) != 0) {
+                sample.linearVelocity = velocity.linearVelocity;
+            }
+            if ((velocity.velocityFlags & XR_SPACE_VELOCITY_ANGULAR_VALID_BIT) != 0) {
+                sample.angularVelocity = velocity.angularVelocity;
+            }
+        }
+
+        if (sampleAim) {
+            XrSpaceLocation aimLocation{};
+            aimLocation.type = XR_TYPE_SPACE_LOCATION;
+            res = xrLocateSpace(spaces[hand].aimSpace, baseSpace, time, &aimLocation);
+            CHECK_XRRESULT(res, "xrLocateSpace");
+            if (XR_UNQUALIFIED_SUCCESS(res) && (aimLocation.locationFlags & poseValidBits) == poseValidBits) {
+                sample.aimValid = true;
+                sample.aimPose = aimLocation.pose;
+            }
+        }
+    }
+}
+
+const XrPosef* SelectControllerPose(const ControllerPoseSample& sample, bool useAimPose) {
+    if (!sample.poseValid) {
+        return nullptr;
+    }
+    return (useAimPose && sample.aimValid) ? &sample.aimPose : &sample.pose;
+}
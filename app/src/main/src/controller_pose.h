@@ -0,0 +1,37 @@
+/*
+    controller grip and aim poses located at the predicted display time
+*/
+
+#pragma once
+#include "pch.h"
+
+// One controller located at the predicted display time. Slot 0 is always the left hand and slot 1 the right, a hand
+// that lost tracking keeps its slot with poseValid cleared.
+struct ControllerPoseSample {
+    XrPosef pose{{0, 0, 0, 1}, {0, 0, 0}};
+    XrVector3f linearVelocity{0, 0, 0};
+    XrVector3f angularVelocity{0, 0, 0};
+    XrPosef aimPose{{0, 0, 0, 1}, {0, 0, 0}};
+    bool connected{false};
+    bool poseValid{false};
+    bool aimValid{false};
+};
+
+static constexpr uint32_t ControllerCount = 2;
+
+// What one hand is located with, in the slot order of ControllerPoseSample.
+struct ControllerSpaces {
+    XrPath subactionPath;
+    XrSpace gripSpace;
+    XrSpace aimSpace;
+};
+
+// Locates every hand's grip pose, and its aim pose when sampleAim is set, in baseSpace. Each slot is rebuilt from what
+// the runtime reports for this frame, so a hand it does not track gets cleared flags and velocities, never the pose
+// of an earlier frame. Throws on runtime errors.
+void SampleControllerPoses(XrSession session, XrAction gripPoseAction, const ControllerSpaces (&spaces)[ControllerCount], XrSpace baseSpace,
+                           XrTime time, bool sampleAim, ControllerPoseSample (&controllers)[ControllerCount]);
+
+// The pose to stream for a sample: the aim pose when asked for and tracked, else the grip pose. Null when the hand is
+// not tracked, the stream then marks it invalid and stops its velocity.
+const XrPosef* SelectControllerPose(const ControllerPoseSample& sample, bool useAimPose);
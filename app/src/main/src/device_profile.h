@@ -0,0 +1,118 @@
+/*
+    per device constants, keyed by the sys.pxr.product.name property
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+typedef enum {
+    DeviceTypeNone = 0,
+    DeviceTypeNeo3,
+    DeviceTypeNeo3Pro,
+    DeviceTypeNeo3ProEye,
+    DeviceTypePico4,
+    DeviceTypePico4Pro,
+} DeviceType;
+
+// ro.build.id "a.b.c" packed one byte per component, so 5.4.0 and 5.10.0 stay ordered.
+#define DEVICE_ROM_VERSION(a, b, c) ((((uint32_t)(a) & 0xFF) << 16) | (((uint32_t)(b) & 0xFF) << 8) | ((uint32_t)(c) & 0xFF))
+
+enum DeviceCodec : uint32_t {
+    DeviceCodec_H264 = 1 << 0,
+    DeviceCodec_HEVC = 1 << 1,
+};
+
+struct DeviceProfile {
+    const char* productName;
+    DeviceType type;
+    const char* interactionProfile;
+    // Symmetric tan(half fov) per eye, used when XR_EPIC_view_configuration_fov is not available.
+    float fallbackFovTangent;
+    float defaultRefreshRate;
+    // Per eye stream size used when the runtime reports no recommended image size.
+    uint32_t decodeWidth;
+    uint32_t decodeHeight;
+    uint32_t codecs;
+    // The Neo3 controllers put the menu button on both hands, later controllers only on the left.
+    bool menuOnBothHands;
+};
+
+// FNV-1a, usable in constant expressions so the table hashes are computed at compile time.
+constexpr uint32_t HashProductName(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (; *name != '\0'; name++) {
+        hash = (hash ^ (uint8_t)*name) * 16777619u;
+    }
+    return hash;
+}
+
+// clang-format off
+constexpr DeviceProfile s_deviceProfiles[] = {
+    // tan 1.09130836 was measured on Neo3 Pro / Pro Eye with a recent ROM. Pico 4 keeps the same fallback as before the
+    // table, it only applies when the runtime lacks XR_EPIC_view_configuration_fov.
+    {"Pico Neo 3 Pro",     DeviceTypeNeo3Pro,    "/interaction_profiles/bytedance/pico_neo3_controller", 1.09130836f, 72.0f, 1832, 1920, DeviceCodec_H264 | DeviceCodec_HEVC, true},
+    {"Pico Neo 3 Pro Eye", DeviceTypeNeo3ProEye, "/interaction_profiles/bytedance/pico_neo3_controller", 1.09130836f, 72.0f, 1832, 1920, DeviceCodec_H264 | DeviceCodec_HEVC, true},
+    {"Pico 4",             DeviceTypePico4,      "/interaction_profiles/bytedance/pico4_controller",     1.09130836f, 72.0f, 2160, 2160, DeviceCodec_H264 | DeviceCodec_HEVC, false},
+    {"PICO 4 Pro",         DeviceTypePico4Pro,   "/interaction_profiles/bytedance/pico4_controller",     1.09130836f, 72.0f, 2160, 2160, DeviceCodec_H264 | DeviceCodec_HEVC, false},
+};
+
+// Anything not in the table: keep the previous behaviour of binding the newest controller profile with the Neo3 FOV.
+constexpr DeviceProfile s_unknownDeviceProfile =
+    {"", DeviceTypeNone, "/interaction_profiles/bytedance/pico4s_controller", 1.09130836f, 72.0f, 1832, 1920, DeviceCodec_H264, false};
+// clang-format on
+
+constexpr size_t s_deviceProfileCount = sizeof(s_deviceProfiles) / sizeof(s_deviceProfiles[0]);
+
+namespace DeviceProfileDetail {
+constexpr uint32_t s_hashes[] = {
+    HashProductName(s_deviceProfiles[0].productName),
+    HashProductName(s_deviceProfiles[1].productName),
+    HashProductName(s_deviceProfiles[2].productName),
+    HashProductName(s_deviceProfiles[3].productName),
+};
+
+constexpr bool HashesUnique() {
+    for (size_t i = 0; i < s_deviceProfileCount; i++) {
+        for (size_t j = i + 1; j < s_deviceProfileCount; j++) {
+            if (s_hashes[i] == s_hashes[j]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+constexpr bool ProfileValid(const DeviceProfile& profile) {
+    return profile.interactionProfile != nullptr && profile.interactionProfile[0] == '/' && profile.fallbackFovTangent > 0.5f &&
+           profile.fallbackFovTangent < 3.0f && profile.defaultRefreshRate >= 60.0f && profile.decodeWidth > 0 &&
+           profile.decodeHeight > 0 && (profile.codecs & DeviceCodec_H264) != 0;
+}
+
+constexpr bool ProfilesValid() {
+    for (size_t i = 0; i < s_deviceProfileCount; i++) {
+        if (!ProfileValid(s_deviceProfiles[i]) || s_deviceProfiles[i].productName[0] == '\0' || s_deviceProfiles[i].type == DeviceTypeNone) {
+            return false;
+        }
+    }
+    return ProfileValid(s_unknownDeviceProfile);
+}
+}  // namespace DeviceProfileDetail
+
+static_assert(sizeof(DeviceProfileDetail::s_hashes) / sizeof(DeviceProfileDetail::s_hashes[0]) == s_deviceProfileCount,
+              "Add the hash of every new profile to s_hashes");
+static_assert(DeviceProfileDetail::HashesUnique(), "Product names must hash to distinct values");
+static_assert(DeviceProfileDetail::ProfilesValid(), "Device profile entry out of range");
+static_assert(HashProductName("Pico 4") == 0xfde7dd28, "HashProductName must stay FNV-1a");
+
+// One hash of the product name, then integer compares; the string compare only confirms the hit.
+inline const DeviceProfile& FindDeviceProfile(const char* productName) {
+    const uint32_t hash = HashProductName(productName);
+    for (size_t i = 0; i < s_deviceProfileCount; i++) {
+        if (DeviceProfileDetail::s_hashes[i] == hash && strcmp(s_deviceProfiles[i].productName, productName) == 0) {
+            return s_deviceProfiles[i];
+        }
+    }
+    return s_unknownDeviceProfile;
+}
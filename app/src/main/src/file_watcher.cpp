@@ -0,0 +1,105 @@
+/*
+    inotify based change notification for option files
+*/
+#include "file_watcher.h"
+#include "common.h"
+#include "thread_policy.h"
+#include <errno.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+FileWatcher::FileWatcher(const std::string& directory, const std::vector<std::string>& fileNames, Callback callback)
+    : mDirectory(directory), mFileNames(fileNames), mCallback(std::move(callback)), mInotifyFd(-1), mStopFd(-1) {
+}
+
+FileWatcher::~FileWatcher() {
+    Stop();
+}
+
+bool FileWatcher::Start() {
+    if (mThread.joinable()) {
+        return true;
+    }
+
+    mInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (mInotifyFd < 0) {
+        Log::Write(Log::Level::Warning, Fmt("inotify_init1 failed: %s", strerror(errno)));
+        return false;
+    }
+    // Only completed writes and renames into place, so a file is never read half written.
+    if (inotify_add_watch(mInotifyFd, mDirectory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        Log::Write(Log::Level::Warning, Fmt("Cannot watch %s: %s", mDirectory.c_str(), strerror(errno)));
+        close(mInotifyFd);
+        mInotifyFd = -1;
+        return false;
+    }
+    mStopFd = eventfd(0, EFD_CLOEXEC);
+    if (mStopFd < 0) {
+        Log::Write(Log::Level::Warning, Fmt("eventfd failed: %s", strerror(errno)));
+        close(mInotifyFd);
+        mInotifyFd = -1;
+        return false;
+    }
+
+    mThread = std::thread([this]() { ThreadLoop(); });
+    return true;
+}
+
+void FileWatcher::Stop() {
+    if (mThread.joinable()) {
+        const uint64_t one = 1;
+        if (write(mStopFd, &one, sizeof(one)) != sizeof(one)) {
+            Log::Write(Log::Level::Error, Fmt("Failed to signal file watcher: %s", strerror(errno)));
+        }
+        mThread.join();
+    }
+    if (mInotifyFd >= 0) {
+        close(mInotifyFd);
+        mInotifyFd = -1;
+    }
+    if (mStopFd >= 0) {
+        close(mStopFd);
+        mStopFd = -1;
+    }
+}
+
+void FileWatcher::ThreadLoop() {
+    ThreadRoles::Apply(ThreadRole::Watcher);
+    alignas(inotify_event) char buffer[4096];
+    pollfd fds[2] = {{mInotifyFd, POLLIN, 0}, {mStopFd, POLLIN, 0}};
+
+    for (;;) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            Log::Write(Log::Level::Error, Fmt("File watcher poll failed: %s", strerror(errno)));
+            return;
+        }
+        if (fds[1].revents != 0) {
+            return;
+        }
+
+        // An editor save usually produces several events, report each watched file once per batch.
+        std::set<std::string> changed;
+        for (;;) {
+            const ssize_t length = read(mInotifyFd, buffer, sizeof(buffer));
+            if (length <= 0) {
+                break;
+            }
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                if (event->len > 0 && std::find(mFileNames.begin(), mFileNames.end(), event->name) != mFileNames.end()) {
+                    changed.insert(event->name);
+                }
+                offset += sizeof(inotify_event) + event->len;
+            }
+        }
+
+        for (const std::string& fileName : changed) {
+            mCallback(fileName);
+        }
+    }
+}
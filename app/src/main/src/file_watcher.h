@@ -0,0 +1,38 @@
+/*
+    inotify based change notification for option files
+*/
+
+#pragma once
+#include "pch.h"
+
+// Watches a directory and calls back with the file name whenever one of the given files is rewritten or replaced.
+// Watching the directory rather than the files keeps working when editors or adb push replace the file by rename.
+// The callback runs on the watcher thread.
+class FileWatcher {
+public:
+    using Callback = std::function<void(const std::string& fileName)>;
+
+    FileWatcher(const std::string& directory, const std::vector<std::string>& fileNames, Callback callback);
+
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Returns false if inotify is not available, options then only load at startup.
+    bool Start();
+
+    void Stop();
+
+private:
+
+    void ThreadLoop();
+
+private:
+    std::string mDirectory;
+    std::vector<std::string> mFileNames;
+    Callback mCallback;
+    std::thread mThread;
+    int mInotifyFd;
+    int mStopFd;
+};
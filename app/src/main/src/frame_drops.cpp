@@ -0,0 +1,131 @@
+/*
+    per cause accounting of dropped, repeated and skipped frames
+*/
+#include "frame_drops.h"
+#include "logger.h"
+#include "common.h"
+
+// Out of line definition, std::min binds it by reference and C++14 has no inline variables.
+constexpr size_t FrameDropTracker::EventCapacity;
+
+const char* FrameDropTracker::ToString(FrameDropCause cause) {
+    switch (cause) {
+        case FrameDropCause::ServerRepeat:
+            return "ServerRepeat";
+        case FrameDropCause::LatchTimeout:
+            return "LatchTimeout";
+        case FrameDropCause::RenderSkipped:
+            return "RenderSkipped";
+        case FrameDropCause::MissedDisplayPeriod:
+            return "MissedDisplayPeriod";
+        case FrameDropCause::TrackingInvalid:
+            return "TrackingInvalid";
+        default:
+            return "Unknown";
+    }
+}
+
+FrameDropTracker::FrameDropTracker() {
+    for (auto& count : m_counts) {
+        count = 0;
+    }
+}
+
+void FrameDropTracker::Record(int64_t nowNs, FrameDropCause cause, uint64_t detail, uint64_t count) {
+    m_counts[(size_t)cause] += count;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events[m_nextEvent] = {nowNs, cause, detail};
+    m_nextEvent = (m_nextEvent + 1) % EventCapacity;
+    m_eventCount = std::min(m_eventCount + 1, EventCapacity);
+}
+
+void FrameDropTracker::OnStreamStarted() {
+    m_resetTimeline = true;
+}
+
+void FrameDropTracker::ResetTimelineIfRequested() {
+    if (m_resetTimeline.exchange(false)) {
+        m_lastDisplayTimeNs = 0;
+        m_lastPoseID = 0;
+        m_hasPoseID = false;
+    }
+}
+
+void FrameDropTracker::OnWaitFrame(int64_t nowNs, int64_t displayTimeNs, int64_t displayPeriodNs, bool shouldRender) {
+    ResetTimelineIfRequested();
+    if (m_lastDisplayTimeNs != 0 && displayPeriodNs > 0) {
+        // Rounded, the runtime's display time predictions jitter by a fraction of a period.
+        const int64_t periods = (displayTimeNs - m_lastDisplayTimeNs + displayPeriodNs / 2) / displayPeriodNs;
+        if (periods > 1) {
+            Record(nowNs, FrameDropCause::MissedDisplayPeriod, (uint64_t)(periods - 1), (uint64_t)(periods - 1));
+        }
+    }
+    m_lastDisplayTimeNs = displayTimeNs;
+
+    if (!shouldRender) {
+        Record(nowNs, FrameDropCause::RenderSkipped, 0);
+    }
+}
+
+void FrameDropTracker::OnViewsLocated(int64_t nowNs, bool valid) {
+    if (!valid) {
+        Record(nowNs, FrameDropCause::TrackingInvalid, 0);
+    }
+}
+
+void FrameDropTracker::OnLatchTimeout(int64_t nowNs) {
+    Record(nowNs, FrameDropCause::LatchTimeout, 0);
+}
+
+void FrameDropTracker::OnFrameLatched(int64_t nowNs, uint64_t poseID) {
+    ResetTimelineIfRequested();
+    if (m_hasPoseID && poseID == m_lastPoseID) {
+        Record(nowNs, FrameDropCause::ServerRepeat, poseID);
+    }
+    m_lastPoseID = poseID;
+    m_hasPoseID = true;
+}
+
+uint64_t FrameDropTracker::GetCount(FrameDropCause cause) const {
+    return m_counts[(size_t)cause];
+}
+
+std::vector<FrameDropTracker::Event> FrameDropTracker::GetEvents() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<Event> events;
+    events.reserve(m_eventCount);
+    const size_t first = (m_nextEvent + EventCapacity - m_eventCount) % EventCapacity;
+    for (size_t i = 0; i < m_eventCount; i++) {
+        events.push_back(m_events[(first + i) % EventCapacity]);
+    }
+    return events;
+}
+
+std::string FrameDropTracker::DescribeCounts() const {
+    std::string text;
+    for (size_t i = 0; i < (size_t)FrameDropCause::Count; i++) {
+        text += Fmt("%s%s:%llu", text.empty() ? "" : ", ", ToString((FrameDropCause)i), (unsigned long long)m_counts[i].load());
+    }
+    return text;
+}
+
+void FrameDropTracker::DumpAndReset(const char* reason) {
+    const std::vector<Event> events = GetEvents();
+    Log::Write(Log::Level::Info, Fmt("Frame drops (%s): %s", reason, DescribeCounts().c_str()));
+    if (!events.empty()) {
+        const int64_t lastNs = events.back().timeNs;
+        for (const Event& event : events) {
+            Log::Write(Log::Level::Info, Fmt("  %9.1f ms %s %llu", (event.timeNs - lastNs) / 1e6, ToString(event.cause),
+                                             (unsigned long long)event.detail));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& count : m_counts) {
+        count = 0;
+    }
+    m_eventCount = 0;
+    m_nextEvent = 0;
+    m_resetTimeline = true;
+}
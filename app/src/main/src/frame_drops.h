@@ -0,0 +1,86 @@
+/*
+    per cause accounting of dropped, repeated and skipped frames
+*/
+
+#pragma once
+#include "pch.h"
+#include <atomic>
+#include <mutex>
+
+enum class FrameDropCause {
+    // The latched frame carries the pose ID of the previous one, the server sent the same frame again.
+    ServerRepeat,
+    // cxrLatchFrame returned cxrError_Frame_Not_Ready before the latch deadline: network or decode was late.
+    LatchTimeout,
+    // xrWaitFrame said shouldRender == false, the runtime is not showing the app.
+    RenderSkipped,
+    // Display periods between two xrWaitFrame calls beyond the first one, the client missed compositor slots.
+    MissedDisplayPeriod,
+    // xrLocateViews returned no valid head pose, nothing was rendered.
+    TrackingInvalid,
+    Count
+};
+
+// Counts every stutter by cause and keeps the most recent ones with their time in a ring, so a hitch seen on the
+// headset can be matched to its cause afterwards. Recording happens on the render thread; counts, events and dumps
+// may be read from any thread.
+class FrameDropTracker {
+public:
+    struct Event {
+        int64_t timeNs;
+        FrameDropCause cause;
+        // Cause specific: the repeated pose ID, or the number of missed display periods.
+        uint64_t detail;
+    };
+
+    static constexpr size_t EventCapacity = 256;
+
+    static const char* ToString(FrameDropCause cause);
+
+    FrameDropTracker();
+
+    // Render thread, in frame order.
+    void OnWaitFrame(int64_t nowNs, int64_t displayTimeNs, int64_t displayPeriodNs, bool shouldRender);
+
+    void OnViewsLocated(int64_t nowNs, bool valid);
+
+    void OnLatchTimeout(int64_t nowNs);
+
+    void OnFrameLatched(int64_t nowNs, uint64_t poseID);
+
+    // Any thread. The next display time and pose ID are not compared against the ones before, a new stream starts its
+    // own timeline.
+    void OnStreamStarted();
+
+    uint64_t GetCount(FrameDropCause cause) const;
+
+    // Oldest first.
+    std::vector<Event> GetEvents() const;
+
+    // Counters on one line, for the periodic stats log.
+    std::string DescribeCounts() const;
+
+    // Logs the counters and the recorded events, then starts over, the frame timeline included.
+    void DumpAndReset(const char* reason);
+
+private:
+    void ResetTimelineIfRequested();
+
+    void Record(int64_t nowNs, FrameDropCause cause, uint64_t detail, uint64_t count = 1);
+
+private:
+    std::atomic<uint64_t> m_counts[(size_t)FrameDropCause::Count];
+
+    mutable std::mutex m_mutex;
+    Event m_events[EventCapacity];
+    size_t m_eventCount{0};
+    size_t m_nextEvent{0};
+
+    // Set from any thread, the render thread clears the fields below before using them.
+    std::atomic<bool> m_resetTimeline{false};
+
+    // Render thread only.
+    int64_t m_lastDisplayTimeNs{0};
+    uint64_t m_lastPoseID{0};
+    bool m_hasPoseID{false};
+};
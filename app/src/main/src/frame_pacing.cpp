@@ -0,0 +1,125 @@
+/*
+    display refresh rate selection from measured stream stats
+*/
+#include "frame_pacing.h"
+#include "logger.h"
+#include "common.h"
+
+FramePacingController::FramePacingController(const Config& config) : m_config(config), m_upgradeHold(config.upgradeHoldSeconds) {
+}
+
+void FramePacingController::Reset(const std::vector<float>& supportedRates, float currentRate) {
+    m_rates = supportedRates;
+    std::sort(m_rates.begin(), m_rates.end());
+    m_currentRate = currentRate;
+    m_upgradeHold = m_config.upgradeHoldSeconds;
+    m_probing = false;
+    OnStreamStarted();
+}
+
+void FramePacingController::OnStreamStarted() {
+    m_warmupRemaining = m_config.warmupSamples;
+    m_fps = 0;
+    m_latencyMs = 0;
+    m_badTime = 0;
+    m_goodTime = 0;
+}
+
+void FramePacingController::OnRateChanged(float rate) {
+    m_currentRate = rate;
+    m_sinceChange = 0;
+    m_badTime = 0;
+    m_goodTime = 0;
+}
+
+void FramePacingController::SetRateCap(float maxRate) {
+    m_rateCap = maxRate;
+}
+
+bool FramePacingController::Sustainable(float rate, float latencyBudget) const {
+    return m_fps >= rate * m_config.sustainRatio && m_latencyMs <= latencyBudget * 1000.0f / rate;
+}
+
+float FramePacingController::Update(const PacingSample& sample, float elapsedSeconds) {
+    if (m_rates.size() < 2 || m_currentRate <= 0) {
+        return 0;
+    }
+    m_sinceChange += elapsedSeconds;
+
+    // The cap is a thermal limit, it does not wait for warmup or dwell. Repeated until the display follows.
+    if (m_rateCap > 0 && m_currentRate > m_rateCap) {
+        float target = m_rates.front();
+        for (float rate : m_rates) {
+            if (rate <= m_rateCap) {
+                target = rate;
+            }
+        }
+        if (target < m_currentRate) {
+            Log::Write(Log::Level::Info, Fmt("Pacing: %.0f Hz is above the %.0f Hz cap, requesting %.0f Hz", m_currentRate, m_rateCap, target));
+            m_probing = false;
+            m_sinceChange = 0;
+            return target;
+        }
+    }
+
+    if (m_warmupRemaining > 0) {
+        m_warmupRemaining--;
+        return 0;
+    }
+
+    if (m_fps == 0 && m_latencyMs == 0) {
+        m_fps = sample.serverFps;
+        m_latencyMs = sample.decodeLatencyMs;
+    } else {
+        m_fps += m_config.smoothing * (sample.serverFps - m_fps);
+        m_latencyMs += m_config.smoothing * (sample.decodeLatencyMs - m_latencyMs);
+    }
+
+    // A probe that survived a full hold window is good, later probes start from the short hold again.
+    if (m_probing && m_sinceChange >= m_upgradeHold) {
+        m_probing = false;
+        m_upgradeHold = m_config.upgradeHoldSeconds;
+    }
+
+    if (!Sustainable(m_currentRate, m_config.latencyBudget)) {
+        m_goodTime = 0;
+        m_badTime += elapsedSeconds;
+        if (m_badTime < m_config.downgradeHoldSeconds || m_sinceChange < m_config.minDwellSeconds) {
+            return 0;
+        }
+
+        float target = m_rates.front();
+        for (float rate : m_rates) {
+            if (rate < m_currentRate && Sustainable(rate, m_config.latencyBudget)) {
+                target = rate;
+            }
+        }
+        if (target >= m_currentRate) {
+            return 0;
+        }
+        if (m_probing) {
+            m_probing = false;
+            m_upgradeHold = std::min(m_upgradeHold * 2.0f, m_config.maxUpgradeHoldSeconds);
+        }
+        Log::Write(Log::Level::Info, Fmt("Pacing: %.1f fps, %.1f ms decode cannot hold %.0f Hz, requesting %.0f Hz", m_fps, m_latencyMs,
+                                         m_currentRate, target));
+        m_sinceChange = 0;
+        m_badTime = 0;
+        return target;
+    }
+
+    m_badTime = 0;
+    m_goodTime += elapsedSeconds;
+    const auto higher = std::upper_bound(m_rates.begin(), m_rates.end(), m_currentRate);
+    if (higher == m_rates.end() || (m_rateCap > 0 && *higher > m_rateCap) || m_goodTime < m_upgradeHold || m_sinceChange < m_config.minDwellSeconds ||
+        m_latencyMs > m_config.upgradeLatencyBudget * 1000.0f / *higher) {
+        return 0;
+    }
+
+    Log::Write(Log::Level::Info, Fmt("Pacing: %.1f fps, %.1f ms decode steady at %.0f Hz, probing %.0f Hz", m_fps, m_latencyMs,
+                                     m_currentRate, *higher));
+    m_probing = true;
+    m_sinceChange = 0;
+    m_goodTime = 0;
+    return *higher;
+}
@@ -0,0 +1,70 @@
+/*
+    display refresh rate selection from measured stream stats
+*/
+
+#pragma once
+#include "pch.h"
+
+// One stats window from cxrGetConnectionStats.
+struct PacingSample {
+    float serverFps;
+    // Time a frame waits on the client before it can be latched, decode included.
+    float decodeLatencyMs;
+};
+
+// Picks the display refresh rate the stream can actually keep up with. Showing a 90 Hz display a 72 fps stream repeats
+// every fourth frame, dropping to 72 Hz removes that judder. Moving down needs the current rate to be missed for a while,
+// moving up needs a long clean run plus latency headroom at the higher rate. A probe that fails quickly doubles the
+// wait before the next one.
+class FramePacingController {
+public:
+    struct Config {
+        float smoothing{0.3f};
+        // Server must deliver at least this fraction of the display rate.
+        float sustainRatio{0.95f};
+        // Decode latency allowed per frame period, and the stricter share required before probing a higher rate.
+        float latencyBudget{1.0f};
+        float upgradeLatencyBudget{0.7f};
+        float downgradeHoldSeconds{3.0f};
+        float upgradeHoldSeconds{10.0f};
+        float maxUpgradeHoldSeconds{160.0f};
+        float minDwellSeconds{5.0f};
+        // Samples ignored after the stream (re)starts while the server ramps up.
+        uint32_t warmupSamples{2};
+    };
+
+    FramePacingController() : FramePacingController(Config{}) {}
+
+    explicit FramePacingController(const Config& config);
+
+    void Reset(const std::vector<float>& supportedRates, float currentRate);
+
+    void OnStreamStarted();
+
+    void OnRateChanged(float rate);
+
+    // Highest rate the pacing may use, 0 for no limit. A current rate above it is dropped on the next update.
+    void SetRateCap(float maxRate);
+
+    // Returns the rate to request, or 0 to keep the current one.
+    float Update(const PacingSample& sample, float elapsedSeconds);
+
+    float GetCurrentRate() const { return m_currentRate; }
+
+private:
+    bool Sustainable(float rate, float latencyBudget) const;
+
+private:
+    Config m_config;
+    std::vector<float> m_rates;
+    float m_currentRate{0};
+    float m_rateCap{0};
+    float m_fps{0};
+    float m_latencyMs{0};
+    uint32_t m_warmupRemaining{0};
+    float m_sinceChange{0};
+    float m_badTime{0};
+    float m_goodTime{0};
+    float m_upgradeHold{0};
+    bool m_probing{false};
+};
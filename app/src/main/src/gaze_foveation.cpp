@@ -0,0 +1,141 @@
+/*
+    eye gaze filtering and the foveal center message sent to the server
+*/
+#include "gaze_foveation.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+void PutLE(uint8_t* out, uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+uint64_t GetLE(const uint8_t* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; i++) {
+        value |= (uint64_t)data[i] << (8 * i);
+    }
+    return value;
+}
+
+void PutFloat(uint8_t* out, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    PutLE(out, bits, 4);
+}
+
+float GetFloat(const uint8_t* data) {
+    const uint32_t bits = (uint32_t)GetLE(data, 4);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+float Length(const XrVector3f& v) {
+    return std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+}
+
+}  // namespace
+
+XrVector3f GazeDirection(const XrQuaternionf& q) {
+    // The orientation applied to (0, 0, -1).
+    return {-2.0f * (q.x * q.z + q.w * q.y), -2.0f * (q.y * q.z - q.w * q.x), -(1.0f - 2.0f * (q.x * q.x + q.y * q.y))};
+}
+
+GazeFilter::GazeFilter(const Config& config) : m_config(config) {
+}
+
+void GazeFilter::Reset() {
+    m_center = FovealCenter{};
+    m_lastDirection = {0, 0, -1};
+    m_hasLast = false;
+    m_hasTime = false;
+    m_lastTimeNs = 0;
+    m_lastValidNs = 0;
+}
+
+FovealCenter GazeFilter::Update(const GazeSample& sample) {
+    const float dt = m_hasTime ? (float)(sample.timeNs - m_lastTimeNs) : 0.0f;
+    m_lastTimeNs = sample.timeNs;
+    m_hasTime = true;
+    m_center.saccade = false;
+
+    // Gaze at or behind the view plane has no tangent, treat it like a lost reading.
+    const float length = Length(sample.direction);
+    const bool usable = sample.valid && length > 0.0f && -sample.direction.z > 0.1f * length;
+    if (!usable) {
+        if (m_center.tracked && sample.timeNs - m_lastValidNs < m_config.blinkHoldNs) {
+            return m_center;
+        }
+        m_center.tracked = false;
+        m_hasLast = false;
+        if (dt > 0.0f) {
+            const float alpha = 1.0f - std::exp(-dt / (float)m_config.recenterTimeConstantNs);
+            m_center.x -= alpha * m_center.x;
+            m_center.y -= alpha * m_center.y;
+        }
+        return m_center;
+    }
+
+    const XrVector3f direction{sample.direction.x / length, sample.direction.y / length, sample.direction.z / length};
+    const float x = std::max(-m_config.maxTangent, std::min(m_config.maxTangent, direction.x / -direction.z));
+    const float y = std::max(-m_config.maxTangent, std::min(m_config.maxTangent, direction.y / -direction.z));
+
+    bool snap = !m_center.tracked || !m_hasLast;
+    if (m_hasLast && dt > 0.0f) {
+        const float cosine = direction.x * m_lastDirection.x + direction.y * m_lastDirection.y + direction.z * m_lastDirection.z;
+        const float degrees = std::acos(std::max(-1.0f, std::min(1.0f, cosine))) * 180.0f / (float)M_PI;
+        if (degrees / (dt * 1e-9f) > m_config.saccadeDegreesPerSecond) {
+            m_center.saccade = true;
+            snap = true;
+        }
+    }
+
+    if (snap || dt <= 0.0f) {
+        m_center.x = x;
+        m_center.y = y;
+    } else {
+        const float alpha = 1.0f - std::exp(-dt / (float)m_config.fixationTimeConstantNs);
+        m_center.x += alpha * (x - m_center.x);
+        m_center.y += alpha * (y - m_center.y);
+    }
+    m_center.tracked = true;
+    m_lastDirection = direction;
+    m_hasLast = true;
+    m_lastValidNs = sample.timeNs;
+    return m_center;
+}
+
+void SerializeFovealCenter(const FovealCenter& center, uint32_t sequence, int64_t sampleTimeNs, uint8_t* out) {
+    uint16_t flags = 0;
+    if (center.tracked) {
+        flags |= FovealCenterFlag_Tracked;
+    }
+    if (center.saccade) {
+        flags |= FovealCenterFlag_Saccade;
+    }
+    PutLE(out, FovealCenterMagic, 4);
+    PutLE(out + 4, FovealCenterVersion, 2);
+    PutLE(out + 6, flags, 2);
+    PutLE(out + 8, sequence, 4);
+    PutFloat(out + 12, center.x);
+    PutFloat(out + 16, center.y);
+    PutLE(out + 20, (uint64_t)sampleTimeNs, 8);
+}
+
+bool ParseFovealCenter(const uint8_t* data, size_t size, FovealCenter* center, uint32_t* sequence, int64_t* sampleTimeNs) {
+    if (size != FovealCenterMessageSize || GetLE(data, 4) != FovealCenterMagic || GetLE(data + 4, 2) != FovealCenterVersion) {
+        return false;
+    }
+    const uint16_t flags = (uint16_t)GetLE(data + 6, 2);
+    center->tracked = (flags & FovealCenterFlag_Tracked) != 0;
+    center->saccade = (flags & FovealCenterFlag_Saccade) != 0;
+    *sequence = (uint32_t)GetLE(data + 8, 4);
+    center->x = GetFloat(data + 12);
+    center->y = GetFloat(data + 16);
+    *sampleTimeNs = (int64_t)GetLE(data + 20, 8);
+    return true;
+}
@@ -0,0 +1,86 @@
+/*
+    eye gaze filtering and the foveal center message sent to the server
+*/
+
+#pragma once
+#include "pch.h"
+
+// One eye gaze reading, direction in view space (-Z forward, +X right, +Y up), not necessarily normalized.
+struct GazeSample {
+    bool valid{false};
+    XrVector3f direction{0, 0, -1};
+    int64_t timeNs{0};
+};
+
+// Where the foveal region should be centered, as tangents of the horizontal and vertical gaze angle in view space so
+// the server can map it through the per eye projection it already has. Both 0 is straight ahead.
+struct FovealCenter {
+    float x{0};
+    float y{0};
+    // The eye is tracked, possibly holding the last fixation over a blink.
+    bool tracked{false};
+    // The gaze moved faster than a fixation can, the server may widen the foveal region for this frame.
+    bool saccade{false};
+};
+
+// Forward direction of an eye gaze pose orientation.
+XrVector3f GazeDirection(const XrQuaternionf& orientation);
+
+// Turns raw eye gaze readings into a stable foveal center. Fixations are smoothed to hide tracker jitter; a saccade
+// jumps straight to the new gaze, the eye sees little during one and a lagging center would blur the landing point.
+// Short losses such as blinks hold the last center, longer ones drift back to the middle of the view.
+class GazeFilter {
+public:
+    struct Config {
+        float saccadeDegreesPerSecond{180.0f};
+        int64_t fixationTimeConstantNs{40000000};
+        int64_t blinkHoldNs{150000000};
+        int64_t recenterTimeConstantNs{300000000};
+        // Gaze further out than this tangent (about 63 degrees) is clamped.
+        float maxTangent{2.0f};
+    };
+
+    GazeFilter() : GazeFilter(Config{}) {}
+
+    explicit GazeFilter(const Config& config);
+
+    void Reset();
+
+    // Samples must come in time order.
+    FovealCenter Update(const GazeSample& sample);
+
+    const FovealCenter& GetCenter() const { return m_center; }
+
+private:
+    Config m_config;
+    FovealCenter m_center;
+    XrVector3f m_lastDirection{0, 0, -1};
+    bool m_hasLast{false};
+    bool m_hasTime{false};
+    int64_t m_lastTimeNs{0};
+    int64_t m_lastValidNs{0};
+};
+
+// Foveal center app message, little endian. Only a server side consumer moves the foveal region with it, a stock
+// server drops the message and keeps the region centered:
+//   0  uint32  magic "FOVC"
+//   4  uint16  version
+//   6  uint16  flags, bit 0 tracked, bit 1 saccade
+//   8  uint32  sequence, increments per message
+//   12 float   x tangent
+//   16 float   y tangent
+//   20 int64   gaze sample time, ns on the client clock
+static constexpr uint32_t FovealCenterMagic = 0x43564F46;
+static constexpr uint16_t FovealCenterVersion = 1;
+static constexpr size_t FovealCenterMessageSize = 28;
+
+enum FovealCenterFlags : uint16_t {
+    FovealCenterFlag_Tracked = 1 << 0,
+    FovealCenterFlag_Saccade = 1 << 1,
+};
+
+// Writes exactly FovealCenterMessageSize bytes.
+void SerializeFovealCenter(const FovealCenter& center, uint32_t sequence, int64_t sampleTimeNs, uint8_t* out);
+
+// False when size, magic or version do not match.
+bool ParseFovealCenter(const uint8_t* data, size_t size, FovealCenter* center, uint32_t* sequence, int64_t* sampleTimeNs);
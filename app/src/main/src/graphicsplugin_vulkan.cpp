@@ -6,15 +6,18 @@
 #include "common.h"
 #include "geometry.h"
 #include "graphicsplugin.h"
+#include "buddy_allocator.h"
+#include "options.h"
+#include "vk_cmd_buffer_state.h"
+#include "vk_pipeline_cache_header.h"
 
 #ifdef XR_USE_GRAPHICS_API_VULKAN
 
 #include <common/xr_linear.h>
 #include <array>
-
-#ifdef USE_ONLINE_VULKAN_SHADERC
-#include <shaderc/shaderc.hpp>
-#endif
+#include <chrono>
+#include <fstream>
+#include <mutex>
 
 #if defined(VK_USE_PLATFORM_WIN32_KHR)
 // Define USE_MIRROR_WINDOW to open a otherwise-unused window for e.g. RenderDoc
@@ -95,93 +98,200 @@ inline VkResult CheckVkResult(VkResult res, const char* originator = nullptr, co
 #define CHECK_VKCMD(cmd) CheckVkResult(cmd, #cmd, FILE_AND_LINE);
 #define CHECK_VKRESULT(res, cmdStr) CheckVkResult(res, cmdStr, FILE_AND_LINE);
 
-#ifdef USE_ONLINE_VULKAN_SHADERC
-constexpr char VertexShaderGlsl[] =
-    R"_(
-    #version 430
-    #extension GL_ARB_separate_shader_objects : enable
-
-    layout (std140, push_constant) uniform buf
-    {
-        mat4 mvp;
-    } ubuf;
+// SPIR-V compiled from vulkan_shaders/cube.vert and cube.frag by glslc at build time, see Android.mk.
+constexpr uint32_t VertexShaderSpv[] =
+#include "vulkan_shaders/vert.spv"
+    ;
+constexpr uint32_t FragmentShaderSpv[] =
+#include "vulkan_shaders/frag.spv"
+    ;
 
-    layout (location = 0) in vec3 Position;
-    layout (location = 1) in vec3 Color;
+// One VkDeviceMemory allocation that is sub-allocated by a BuddyAllocator.
+struct MemoryBlock {
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    uint8_t* mapped{nullptr};
+    BuddyAllocator buddy;
+};
 
-    layout (location = 0) out vec4 oColor;
-    out gl_PerVertex
-    {
-        vec4 gl_Position;
-    };
+// A range of device memory handed out by MemoryAllocator. Bind resources at 'offset' within 'memory'.
+struct MemoryAllocation {
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    VkDeviceSize offset{0};
+    VkDeviceSize size{0};
+    // Persistent host pointer to 'offset' for host visible memory, nullptr otherwise.
+    void* mapped{nullptr};
+
+    uint32_t pool{0};
+    // Owning block, nullptr for a dedicated allocation.
+    MemoryBlock* block{nullptr};
+};
 
-    void main()
-    {
-        oColor.rgba  = Color.rgba;
-        gl_Position = ubuf.mvp * Position;
-    }
-)_";
+// Sub-allocates buffers and images from large per-memory-type blocks instead of calling
+// vkAllocateMemory for every resource. Host visible blocks are mapped once at creation.
+struct MemoryAllocator {
+    // Linear resources (buffers) and optimally tiled images live in separate blocks so neighbouring
+    // ranges never have to honour bufferImageGranularity.
+    enum class ResourceKind { Linear, Optimal };
 
-constexpr char FragmentShaderGlsl[] =
-    R"_(
-    #version 430
-    #extension GL_ARB_separate_shader_objects : enable
+    static const VkFlags defaultFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    static const VkDeviceSize DefaultBlockSize = 16 * 1024 * 1024;
+    static const VkDeviceSize MinBlockSize = 1024 * 1024;
+    static const VkDeviceSize MinAllocationSize = 256;
 
-    layout (location = 0) in vec4 oColor;
+    MemoryAllocator() = default;
 
-    layout (location = 0) out vec4 FragColor;
+    ~MemoryAllocator() { Release(); }
 
-    void main()
-    {
-        FragColor = oColor;
-    }
-)_";
-#endif  // USE_ONLINE_VULKAN_SHADERC
+    MemoryAllocator(const MemoryAllocator&) = delete;
+    MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+    MemoryAllocator(MemoryAllocator&&) = delete;
+    MemoryAllocator& operator=(MemoryAllocator&&) = delete;
 
-struct MemoryAllocator {
     void Init(VkPhysicalDevice physicalDevice, VkDevice device) {
         m_vkDevice = device;
         vkGetPhysicalDeviceMemoryProperties(physicalDevice, &m_memProps);
+        m_pools.resize(m_memProps.memoryTypeCount * 2);
     }
 
-    static const VkFlags defaultFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    void Allocate(VkMemoryRequirements const& memReqs, MemoryAllocation* allocation, VkFlags flags = defaultFlags,
+                  ResourceKind kind = ResourceKind::Linear) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        const uint32_t memoryTypeIndex = FindMemoryType(memReqs.memoryTypeBits, flags);
+        const VkDeviceSize blockSize = BlockSize(memoryTypeIndex);
+
+        *allocation = {};
+        allocation->size = memReqs.size;
+        allocation->pool = memoryTypeIndex * 2 + (kind == ResourceKind::Optimal ? 1 : 0);
+
+        // Resources bigger than half a block, such as eye-sized depth buffers, get their own memory.
+        if (memReqs.size > blockSize / 2) {
+            MemoryBlock dedicated = CreateBlock(memoryTypeIndex, memReqs.size);
+            allocation->memory = dedicated.memory;
+            allocation->mapped = dedicated.mapped;
+            return;
+        }
+
+        Pool& pool = m_pools[allocation->pool];
+        VkDeviceSize offset = 0;
+        MemoryBlock* block = nullptr;
+        for (auto& candidate : pool.blocks) {
+            if (candidate->buddy.Allocate(memReqs.size, memReqs.alignment, &offset)) {
+                block = candidate.get();
+                break;
+            }
+        }
+        if (block == nullptr) {
+            pool.blocks.emplace_back(new MemoryBlock(CreateBlock(memoryTypeIndex, blockSize)));
+            block = pool.blocks.back().get();
+            block->buddy.Init(blockSize, MinAllocationSize);
+            CHECK(block->buddy.Allocate(memReqs.size, memReqs.alignment, &offset));
+        }
+
+        allocation->memory = block->memory;
+        allocation->offset = offset;
+        allocation->mapped = block->mapped != nullptr ? block->mapped + offset : nullptr;
+        allocation->block = block;
+    }
+
+    void Free(MemoryAllocation* allocation) {
+        if (allocation->memory == VK_NULL_HANDLE) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        MemoryBlock* block = allocation->block;
+        if (block == nullptr) {
+            vkFreeMemory(m_vkDevice, allocation->memory, nullptr);
+        } else {
+            block->buddy.Free(allocation->offset);
+
+            // Keep the last block of a pool around so freeing and re-creating a resource does not hit the driver.
+            Pool& pool = m_pools[allocation->pool];
+            if (block->buddy.Empty() && pool.blocks.size() > 1) {
+                vkFreeMemory(m_vkDevice, block->memory, nullptr);
+                pool.blocks.erase(std::find_if(pool.blocks.begin(), pool.blocks.end(),
+                                               [block](const std::unique_ptr<MemoryBlock>& b) { return b.get() == block; }));
+            }
+        }
+
+        *allocation = {};
+    }
+
+    void Release() {
+        if (m_vkDevice != nullptr) {
+            for (auto& pool : m_pools) {
+                for (auto& block : pool.blocks) {
+                    vkFreeMemory(m_vkDevice, block->memory, nullptr);
+                }
+            }
+        }
+        m_pools.clear();
+        m_memoryTypes.clear();
+        m_vkDevice = nullptr;
+    }
+
+   private:
+    struct Pool {
+        std::vector<std::unique_ptr<MemoryBlock>> blocks;
+    };
+
+    uint32_t FindMemoryType(uint32_t memoryTypeBits, VkFlags flags) {
+        const uint64_t key = ((uint64_t)memoryTypeBits << 32) | flags;
+        auto it = m_memoryTypes.find(key);
+        if (it != m_memoryTypes.end()) {
+            return it->second;
+        }
 
-    void Allocate(VkMemoryRequirements const& memReqs, VkDeviceMemory* mem, VkFlags flags = defaultFlags,
-                  const void* pNext = nullptr) const {
         // Search memtypes to find first index with those properties
         for (uint32_t i = 0; i < m_memProps.memoryTypeCount; ++i) {
-            if ((memReqs.memoryTypeBits & (1 << i)) != 0u) {
+            if ((memoryTypeBits & (1 << i)) != 0u) {
                 // Type is available, does it match user properties?
                 if ((m_memProps.memoryTypes[i].propertyFlags & flags) == flags) {
-                    VkMemoryAllocateInfo memAlloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO, pNext};
-                    memAlloc.allocationSize = memReqs.size;
-                    memAlloc.memoryTypeIndex = i;
-                    CHECK_VKCMD(vkAllocateMemory(m_vkDevice, &memAlloc, nullptr, mem));
-                    return;
+                    m_memoryTypes[key] = i;
+                    return i;
                 }
             }
         }
         THROW("Memory format not supported");
     }
 
-   private:
+    // Blocks are capped at an eighth of their heap so small heaps are not exhausted by a single block.
+    VkDeviceSize BlockSize(uint32_t memoryTypeIndex) const {
+        const VkDeviceSize heapSize = m_memProps.memoryHeaps[m_memProps.memoryTypes[memoryTypeIndex].heapIndex].size;
+        VkDeviceSize blockSize = DefaultBlockSize;
+        while (blockSize > MinBlockSize && blockSize > heapSize / 8) {
+            blockSize >>= 1;
+        }
+        return blockSize;
+    }
+
+    MemoryBlock CreateBlock(uint32_t memoryTypeIndex, VkDeviceSize size) {
+        MemoryBlock block;
+        VkMemoryAllocateInfo memAlloc{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        memAlloc.allocationSize = size;
+        memAlloc.memoryTypeIndex = memoryTypeIndex;
+        CHECK_VKCMD(vkAllocateMemory(m_vkDevice, &memAlloc, nullptr, &block.memory));
+
+        if ((m_memProps.memoryTypes[memoryTypeIndex].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) != 0u) {
+            CHECK_VKCMD(vkMapMemory(m_vkDevice, block.memory, 0, VK_WHOLE_SIZE, 0, (void**)&block.mapped));
+        }
+
+        Log::Write(Log::Level::Verbose,
+                   Fmt("Allocated %llu bytes of memory type %u", (unsigned long long)size, memoryTypeIndex));
+        return block;
+    }
+
     VkDevice m_vkDevice{VK_NULL_HANDLE};
     VkPhysicalDeviceMemoryProperties m_memProps{};
+    std::mutex m_mutex;
+    std::vector<Pool> m_pools;
+    std::map<uint64_t, uint32_t> m_memoryTypes;
 };
 
-// CmdBuffer - manage VkCommandBuffer state
+// CmdBuffer - manage VkCommandBuffer state, see vk_cmd_buffer_state.h for the transitions
 struct CmdBuffer {
-#define LIST_CMDBUFFER_STATES(_) \
-    _(Undefined)                 \
-    _(Initialized)               \
-    _(Recording)                 \
-    _(Executable)                \
-    _(Executing)
-    enum class CmdBufferState {
-#define MK_ENUM(name) name,
-        LIST_CMDBUFFER_STATES(MK_ENUM)
-#undef MK_ENUM
-    };
     CmdBufferState state{CmdBufferState::Undefined};
     VkCommandPool pool{VK_NULL_HANDLE};
     VkCommandBuffer buf{VK_NULL_HANDLE};
@@ -195,7 +305,7 @@ struct CmdBuffer {
     CmdBuffer& operator=(CmdBuffer&&) = delete;
 
     ~CmdBuffer() {
-        SetState(CmdBufferState::Undefined);
+        state = CmdBufferState::Undefined;
         if (m_vkDevice != nullptr) {
             if (buf != VK_NULL_HANDLE) {
                 vkFreeCommandBuffers(m_vkDevice, pool, 1, &buf);
@@ -213,28 +323,11 @@ struct CmdBuffer {
         m_vkDevice = nullptr;
     }
 
-    std::string StateString(CmdBufferState s) {
-        switch (s) {
-#define MK_CASE(name)          \
-    case CmdBufferState::name: \
-        return #name;
-            LIST_CMDBUFFER_STATES(MK_CASE)
-#undef MK_CASE
-        }
-        return "(Unknown)";
-    }
-
-#define CHECK_CBSTATE(s)                                                                                           \
-    do                                                                                                             \
-        if (state != (s)) {                                                                                        \
-            Log::Write(Log::Level::Error,                                                                          \
-                       std::string("Expecting state " #s " from ") + __FUNCTION__ + ", in " + StateString(state)); \
-            return false;                                                                                          \
-        }                                                                                                          \
-    while (0)
-
     bool Init(VkDevice device, uint32_t queueFamilyIndex) {
-        CHECK_CBSTATE(CmdBufferState::Undefined);
+        const CmdBufferTransition transition = Transition(CmdBufferEvent::Init);
+        if (!transition.valid) {
+            return false;
+        }
 
         m_vkDevice = device;
 
@@ -254,51 +347,58 @@ struct CmdBuffer {
         VkFenceCreateInfo fenceInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
         CHECK_VKCMD(vkCreateFence(m_vkDevice, &fenceInfo, nullptr, &execFence));
 
-        SetState(CmdBufferState::Initialized);
+        state = transition.next;
         return true;
     }
 
     bool Begin() {
-        CHECK_CBSTATE(CmdBufferState::Initialized);
+        const CmdBufferTransition transition = Transition(CmdBufferEvent::Begin);
+        if (!transition.valid) {
+            return false;
+        }
         VkCommandBufferBeginInfo cmdBeginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
         CHECK_VKCMD(vkBeginCommandBuffer(buf, &cmdBeginInfo));
-        SetState(CmdBufferState::Recording);
+        state = transition.next;
         return true;
     }
 
     bool End() {
-        CHECK_CBSTATE(CmdBufferState::Recording);
+        const CmdBufferTransition transition = Transition(CmdBufferEvent::End);
+        if (!transition.valid) {
+            return false;
+        }
         CHECK_VKCMD(vkEndCommandBuffer(buf));
-        SetState(CmdBufferState::Executable);
+        state = transition.next;
         return true;
     }
 
     bool Exec(VkQueue queue) {
-        CHECK_CBSTATE(CmdBufferState::Executable);
+        const CmdBufferTransition transition = Transition(CmdBufferEvent::Submit);
+        if (!transition.valid) {
+            return false;
+        }
 
         VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
         submitInfo.commandBufferCount = 1;
         submitInfo.pCommandBuffers = &buf;
         CHECK_VKCMD(vkQueueSubmit(queue, 1, &submitInfo, execFence));
 
-        SetState(CmdBufferState::Executing);
+        state = transition.next;
         return true;
     }
 
     bool Wait() {
         // Waiting on a not-in-flight command buffer is a no-op
-        if (state == CmdBufferState::Initialized) {
-            return true;
+        const CmdBufferTransition transition = Transition(CmdBufferEvent::Wait);
+        if (!transition.valid || !transition.needsWork) {
+            return transition.valid;
         }
 
-        CHECK_CBSTATE(CmdBufferState::Executing);
-
         const uint32_t timeoutNs = 1 * 1000 * 1000 * 1000;
         for (int i = 0; i < 5; ++i) {
             auto res = vkWaitForFences(m_vkDevice, 1, &execFence, VK_TRUE, timeoutNs);
             if (res == VK_SUCCESS) {
-                // Buffer can be executed multiple times...
-                SetState(CmdBufferState::Executable);
+                state = transition.next;
                 return true;
             }
             Log::Write(Log::Level::Info, "Waiting for CmdBuffer fence timed out, retrying...");
@@ -308,25 +408,29 @@ struct CmdBuffer {
     }
 
     bool Reset() {
-        if (state != CmdBufferState::Initialized) {
-            CHECK_CBSTATE(CmdBufferState::Executable);
-
-            CHECK_VKCMD(vkResetFences(m_vkDevice, 1, &execFence));
-            CHECK_VKCMD(vkResetCommandBuffer(buf, 0));
-
-            SetState(CmdBufferState::Initialized);
+        const CmdBufferTransition transition = Transition(CmdBufferEvent::Reset);
+        if (!transition.valid || !transition.needsWork) {
+            return transition.valid;
         }
 
+        CHECK_VKCMD(vkResetFences(m_vkDevice, 1, &execFence));
+        CHECK_VKCMD(vkResetCommandBuffer(buf, 0));
+
+        state = transition.next;
         return true;
     }
 
    private:
     VkDevice m_vkDevice{VK_NULL_HANDLE};
 
-    void SetState(CmdBufferState newState) { state = newState; }
-
-#undef CHECK_CBSTATE
-#undef LIST_CMDBUFFER_STATES
+    CmdBufferTransition Transition(CmdBufferEvent event) const {
+        const CmdBufferTransition transition = NextCmdBufferState(state, event);
+        if (!transition.valid) {
+            Log::Write(Log::Level::Error,
+                       Fmt("CmdBuffer %s is not allowed in state %s", CmdBufferEventName(event), CmdBufferStateName(state)));
+        }
+        return transition;
+    }
 };
 
 // ShaderProgram to hold a pair of vertex & fragment shaders
@@ -340,7 +444,7 @@ struct ShaderProgram {
         if (m_vkDevice != nullptr) {
             for (auto& si : shaderInfo) {
                 if (si.module != VK_NULL_HANDLE) {
-                    vkDestroyShaderModule(m_vkDevice, shaderInfo[0].module, nullptr);
+                    vkDestroyShaderModule(m_vkDevice, si.module, nullptr);
                 }
                 si.module = VK_NULL_HANDLE;
             }
@@ -354,16 +458,16 @@ struct ShaderProgram {
     ShaderProgram(ShaderProgram&&) = delete;
     ShaderProgram& operator=(ShaderProgram&&) = delete;
 
-    void LoadVertexShader(const std::vector<uint32_t>& code) { Load(0, code); }
+    void LoadVertexShader(const uint32_t* code, size_t wordCount) { Load(0, code, wordCount); }
 
-    void LoadFragmentShader(const std::vector<uint32_t>& code) { Load(1, code); }
+    void LoadFragmentShader(const uint32_t* code, size_t wordCount) { Load(1, code, wordCount); }
 
     void Init(VkDevice device) { m_vkDevice = device; }
 
    private:
     VkDevice m_vkDevice{VK_NULL_HANDLE};
 
-    void Load(uint32_t index, const std::vector<uint32_t>& code) {
+    void Load(uint32_t index, const uint32_t* code, size_t wordCount) {
         VkShaderModuleCreateInfo modInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
 
         auto& si = shaderInfo[index];
@@ -383,8 +487,8 @@ struct ShaderProgram {
                 THROW(Fmt("Unknown code index %d", index));
         }
 
-        modInfo.codeSize = code.size() * sizeof(code[0]);
-        modInfo.pCode = &code[0];
+        modInfo.codeSize = wordCount * sizeof(code[0]);
+        modInfo.pCode = code;
         CHECK_MSG((modInfo.codeSize > 0) && modInfo.pCode, Fmt("Invalid %s shader ", name.c_str()));
 
         CHECK_VKCMD(vkCreateShaderModule(m_vkDevice, &modInfo, nullptr, &si.module));
@@ -396,9 +500,9 @@ struct ShaderProgram {
 // VertexBuffer base class
 struct VertexBufferBase {
     VkBuffer idxBuf{VK_NULL_HANDLE};
-    VkDeviceMemory idxMem{VK_NULL_HANDLE};
+    MemoryAllocation idxMem{};
     VkBuffer vtxBuf{VK_NULL_HANDLE};
-    VkDeviceMemory vtxMem{VK_NULL_HANDLE};
+    MemoryAllocation vtxMem{};
     VkVertexInputBindingDescription bindDesc{};
     std::vector<VkVertexInputAttributeDescription> attrDesc{};
     struct {
@@ -413,20 +517,14 @@ struct VertexBufferBase {
             if (idxBuf != VK_NULL_HANDLE) {
                 vkDestroyBuffer(m_vkDevice, idxBuf, nullptr);
             }
-            if (idxMem != VK_NULL_HANDLE) {
-                vkFreeMemory(m_vkDevice, idxMem, nullptr);
-            }
+            m_memAllocator->Free(&idxMem);
             if (vtxBuf != VK_NULL_HANDLE) {
                 vkDestroyBuffer(m_vkDevice, vtxBuf, nullptr);
             }
-            if (vtxMem != VK_NULL_HANDLE) {
-                vkFreeMemory(m_vkDevice, vtxMem, nullptr);
-            }
+            m_memAllocator->Free(&vtxMem);
         }
         idxBuf = VK_NULL_HANDLE;
-        idxMem = VK_NULL_HANDLE;
         vtxBuf = VK_NULL_HANDLE;
-        vtxMem = VK_NULL_HANDLE;
         bindDesc = {};
         attrDesc.clear();
         count = {0, 0};
@@ -437,7 +535,7 @@ struct VertexBufferBase {
     VertexBufferBase& operator=(const VertexBufferBase&) = delete;
     VertexBufferBase(VertexBufferBase&&) = delete;
     VertexBufferBase& operator=(VertexBufferBase&&) = delete;
-    void Init(VkDevice device, const MemoryAllocator* memAllocator, const std::vector<VkVertexInputAttributeDescription>& attr) {
+    void Init(VkDevice device, MemoryAllocator* memAllocator, const std::vector<VkVertexInputAttributeDescription>& attr) {
         m_vkDevice = device;
         m_memAllocator = memAllocator;
         attrDesc = attr;
@@ -445,14 +543,14 @@ struct VertexBufferBase {
 
    protected:
     VkDevice m_vkDevice{VK_NULL_HANDLE};
-    void AllocateBufferMemory(VkBuffer buf, VkDeviceMemory* mem) const {
+    void AllocateBufferMemory(VkBuffer buf, MemoryAllocation* mem) const {
         VkMemoryRequirements memReq = {};
         vkGetBufferMemoryRequirements(m_vkDevice, buf, &memReq);
         m_memAllocator->Allocate(memReq, mem);
     }
 
    private:
-    const MemoryAllocator* m_memAllocator{nullptr};
+    MemoryAllocator* m_memAllocator{nullptr};
 };
 
 // VertexBuffer template to wrap the indices and vertices
@@ -464,13 +562,13 @@ struct VertexBuffer : public VertexBufferBase {
         bufInfo.size = sizeof(uint16_t) * idxCount;
         CHECK_VKCMD(vkCreateBuffer(m_vkDevice, &bufInfo, nullptr, &idxBuf));
         AllocateBufferMemory(idxBuf, &idxMem);
-        CHECK_VKCMD(vkBindBufferMemory(m_vkDevice, idxBuf, idxMem, 0));
+        CHECK_VKCMD(vkBindBufferMemory(m_vkDevice, idxBuf, idxMem.memory, idxMem.offset));
 
         bufInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
         bufInfo.size = sizeof(T) * vtxCount;
         CHECK_VKCMD(vkCreateBuffer(m_vkDevice, &bufInfo, nullptr, &vtxBuf));
         AllocateBufferMemory(vtxBuf, &vtxMem);
-        CHECK_VKCMD(vkBindBufferMemory(m_vkDevice, vtxBuf, vtxMem, 0));
+        CHECK_VKCMD(vkBindBufferMemory(m_vkDevice, vtxBuf, vtxMem.memory, vtxMem.offset));
 
         bindDesc.binding = 0;
         bindDesc.stride = sizeof(T);
@@ -482,24 +580,106 @@ struct VertexBuffer : public VertexBufferBase {
     }
 
     void UpdateIndicies(const uint16_t* data, uint32_t elements, uint32_t offset = 0) {
-        uint16_t* map = nullptr;
-        CHECK_VKCMD(vkMapMemory(m_vkDevice, idxMem, sizeof(map[0]) * offset, sizeof(map[0]) * elements, 0, (void**)&map));
+        CHECK_MSG(idxMem.mapped != nullptr, "Index buffer memory is not host visible");
+        uint16_t* map = static_cast<uint16_t*>(idxMem.mapped) + offset;
         for (size_t i = 0; i < elements; ++i) {
             map[i] = data[i];
         }
-        vkUnmapMemory(m_vkDevice, idxMem);
     }
 
     void UpdateVertices(const T* data, uint32_t elements, uint32_t offset = 0) {
-        T* map = nullptr;
-        CHECK_VKCMD(vkMapMemory(m_vkDevice, vtxMem, sizeof(map[0]) * offset, sizeof(map[0]) * elements, 0, (void**)&map));
+        CHECK_MSG(vtxMem.mapped != nullptr, "Vertex buffer memory is not host visible");
+        T* map = static_cast<T*>(vtxMem.mapped) + offset;
         for (size_t i = 0; i < elements; ++i) {
             map[i] = data[i];
         }
-        vkUnmapMemory(m_vkDevice, vtxMem);
     }
 };
 
+// Per-instance model matrices in a persistently mapped buffer, split into a ring of segments.
+// Every submission writes its instances into its own segment, so the CPU never overwrites
+// matrices that an earlier submission may still be reading.
+struct InstanceBuffer {
+    VkBuffer buf{VK_NULL_HANDLE};
+    MemoryAllocation mem{};
+    VkVertexInputBindingDescription bindDesc{};
+    std::vector<VkVertexInputAttributeDescription> attrDesc{};
+    uint32_t segmentCount{0};
+    uint32_t segmentCapacity{0};
+
+    InstanceBuffer() = default;
+
+    ~InstanceBuffer() {
+        Release();
+        bindDesc = {};
+        attrDesc.clear();
+        m_vkDevice = nullptr;
+    }
+
+    InstanceBuffer(const InstanceBuffer&) = delete;
+    InstanceBuffer& operator=(const InstanceBuffer&) = delete;
+    InstanceBuffer(InstanceBuffer&&) = delete;
+    InstanceBuffer& operator=(InstanceBuffer&&) = delete;
+
+    // A mat4 attribute takes four consecutive locations starting at firstLocation.
+    void Init(VkDevice device, MemoryAllocator* memAllocator, uint32_t binding, uint32_t firstLocation) {
+        m_vkDevice = device;
+        m_memAllocator = memAllocator;
+
+        bindDesc.binding = binding;
+        bindDesc.stride = sizeof(XrMatrix4x4f);
+        bindDesc.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+        attrDesc.clear();
+        for (uint32_t column = 0; column < 4; ++column) {
+            attrDesc.push_back({firstLocation + column, binding, VK_FORMAT_R32G32B32A32_SFLOAT, column * 4 * (uint32_t)sizeof(float)});
+        }
+    }
+
+    void Create(uint32_t aSegmentCount, uint32_t aSegmentCapacity) {
+        Release();
+
+        segmentCount = aSegmentCount;
+        segmentCapacity = aSegmentCapacity;
+
+        VkBufferCreateInfo bufInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+        bufInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+        bufInfo.size = sizeof(XrMatrix4x4f) * segmentCount * segmentCapacity;
+        CHECK_VKCMD(vkCreateBuffer(m_vkDevice, &bufInfo, nullptr, &buf));
+
+        VkMemoryRequirements memReq = {};
+        vkGetBufferMemoryRequirements(m_vkDevice, buf, &memReq);
+        m_memAllocator->Allocate(memReq, &mem);
+        CHECK_VKCMD(vkBindBufferMemory(m_vkDevice, buf, mem.memory, mem.offset));
+
+        // Host coherent memory stays mapped for the lifetime of the allocator.
+        CHECK_MSG(mem.mapped != nullptr, "Instance buffer memory is not host visible");
+        m_mapped = static_cast<XrMatrix4x4f*>(mem.mapped);
+    }
+
+    XrMatrix4x4f* Map(uint32_t segment) const { return m_mapped + (size_t)segment * segmentCapacity; }
+
+    VkDeviceSize Offset(uint32_t segment) const { return sizeof(XrMatrix4x4f) * segment * segmentCapacity; }
+
+    void Release() {
+        if (m_vkDevice != nullptr) {
+            if (buf != VK_NULL_HANDLE) {
+                vkDestroyBuffer(m_vkDevice, buf, nullptr);
+            }
+            m_memAllocator->Free(&mem);
+        }
+        buf = VK_NULL_HANDLE;
+        m_mapped = nullptr;
+        segmentCount = 0;
+        segmentCapacity = 0;
+    }
+
+   private:
+    VkDevice m_vkDevice{VK_NULL_HANDLE};
+    MemoryAllocator* m_memAllocator{nullptr};
+    XrMatrix4x4f* m_mapped{nullptr};
+};
+
 // RenderPass wrapper
 struct RenderPass {
     VkFormat colorFmt{};
@@ -558,6 +738,20 @@ struct RenderPass {
             subpass.pDepthStencilAttachment = &depthRef;
         }
 
+        // Several submissions can be in flight at once and successive frames render into the same depth buffer,
+        // so order this pass' attachment accesses after the attachment writes of earlier submissions.
+        VkSubpassDependency dependency{};
+        dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependency.dstSubpass = 0;
+        dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT |
+                                  VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependency.dstStageMask = dependency.srcStageMask;
+        dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+                                   VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        rpInfo.dependencyCount = 1;
+        rpInfo.pDependencies = &dependency;
+
         CHECK_VKCMD(vkCreateRenderPass(m_vkDevice, &rpInfo, nullptr, &pass));
 
         return true;
@@ -702,7 +896,7 @@ struct RenderTarget {
     VkDevice m_vkDevice{VK_NULL_HANDLE};
 };
 
-// Simple vertex MVP xform & color fragment shader layout
+// Simple vertex view-projection xform & color fragment shader layout
 struct PipelineLayout {
     VkPipelineLayout layout{VK_NULL_HANDLE};
 
@@ -721,7 +915,7 @@ struct PipelineLayout {
     void Create(VkDevice device) {
         m_vkDevice = device;
 
-        // MVP matrix is a push_constant
+        // View-projection matrix is a push_constant, model matrices are per-instance vertex attributes
         VkPushConstantRange pcr = {};
         pcr.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
         pcr.offset = 0;
@@ -742,6 +936,136 @@ struct PipelineLayout {
     VkDevice m_vkDevice{VK_NULL_HANDLE};
 };
 
+// VkPipelineCache that is persisted to a file between launches. A saved blob is only handed back to the
+// driver when its header matches the current device, driver caches are not portable across GPUs or drivers.
+struct PipelineCache {
+    VkPipelineCache cache{VK_NULL_HANDLE};
+
+    PipelineCache() = default;
+
+    ~PipelineCache() {
+        if (m_vkDevice != nullptr) {
+            if (cache != VK_NULL_HANDLE) {
+                vkDestroyPipelineCache(m_vkDevice, cache, nullptr);
+            }
+        }
+        cache = VK_NULL_HANDLE;
+        m_vkDevice = nullptr;
+    }
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+    PipelineCache(PipelineCache&&) = delete;
+    PipelineCache& operator=(PipelineCache&&) = delete;
+
+    // An empty path keeps the cache in memory only.
+    void Create(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path) {
+        m_vkDevice = device;
+        m_path = path;
+
+        VkPhysicalDeviceProperties props{};
+        vkGetPhysicalDeviceProperties(physicalDevice, &props);
+        const std::vector<uint8_t> data = Load(props);
+        m_savedData = data;
+
+        VkPipelineCacheCreateInfo cacheInfo{VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO};
+        cacheInfo.initialDataSize = data.size();
+        cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+        if (vkCreatePipelineCache(m_vkDevice, &cacheInfo, nullptr, &cache) != VK_SUCCESS && !data.empty()) {
+            Log::Write(Log::Level::Warning, Fmt("Driver rejected pipeline cache %s, starting empty", m_path.c_str()));
+            cacheInfo.initialDataSize = 0;
+            cacheInfo.pInitialData = nullptr;
+            CHECK_VKCMD(vkCreatePipelineCache(m_vkDevice, &cacheInfo, nullptr, &cache));
+            m_savedData.clear();
+        }
+        m_warm = !m_savedData.empty();
+    }
+
+    // Writes the cache if the driver added to it since it was loaded or last saved. Goes through a temporary file so
+    // an interrupted save never leaves a truncated cache behind.
+    void Save() {
+        if (cache == VK_NULL_HANDLE || m_path.empty()) {
+            return;
+        }
+
+        size_t size = 0;
+        CHECK_VKCMD(vkGetPipelineCacheData(m_vkDevice, cache, &size, nullptr));
+        std::vector<uint8_t> data(size);
+        CHECK_VKCMD(vkGetPipelineCacheData(m_vkDevice, cache, &size, data.data()));
+        data.resize(size);
+        if (data == m_savedData) {
+            Log::Write(Log::Level::Verbose, "Pipeline cache unchanged, not saving");
+            return;
+        }
+
+        const std::string tempPath = m_path + ".tmp";
+        {
+            std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)size);
+            if (!file) {
+                Log::Write(Log::Level::Warning, Fmt("Failed to write pipeline cache %s", tempPath.c_str()));
+                return;
+            }
+        }
+        if (rename(tempPath.c_str(), m_path.c_str()) != 0) {
+            Log::Write(Log::Level::Warning, Fmt("Failed to replace pipeline cache %s", m_path.c_str()));
+            return;
+        }
+        m_savedData = std::move(data);
+        Log::Write(Log::Level::Info, Fmt("Saved %zu byte pipeline cache", size));
+    }
+
+    // Whether Create started from a saved blob the driver accepted.
+    bool IsWarm() const { return m_warm; }
+
+   private:
+    static_assert(PipelineCacheUuidSize == VK_UUID_SIZE, "pipeline cache UUID size");
+    static_assert(PipelineCacheHeaderVersionOne == VK_PIPELINE_CACHE_HEADER_VERSION_ONE, "pipeline cache header version");
+
+    std::vector<uint8_t> Load(const VkPhysicalDeviceProperties& props) const {
+        if (m_path.empty()) {
+            return {};
+        }
+
+        std::ifstream file(m_path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            Log::Write(Log::Level::Info, "No pipeline cache yet, pipelines are built from scratch");
+            return {};
+        }
+        std::vector<uint8_t> data((size_t)file.tellg());
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(data.data()), (std::streamsize)data.size());
+        if (!file) {
+            Log::Write(Log::Level::Warning, Fmt("Failed to read pipeline cache %s", m_path.c_str()));
+            return {};
+        }
+
+        PipelineCacheDevice device{props.vendorID, props.deviceID, {}};
+        memcpy(device.pipelineCacheUUID, props.pipelineCacheUUID, VK_UUID_SIZE);
+        switch (CheckPipelineCacheHeader(data.data(), data.size(), device)) {
+            case PipelineCacheCheck::Valid:
+                Log::Write(Log::Level::Info, Fmt("Loaded %zu byte pipeline cache", data.size()));
+                return data;
+            case PipelineCacheCheck::Truncated:
+                Log::Write(Log::Level::Warning, "Ignoring truncated pipeline cache");
+                return {};
+            case PipelineCacheCheck::BadHeader:
+                Log::Write(Log::Level::Warning, "Ignoring pipeline cache with an unknown header");
+                return {};
+            case PipelineCacheCheck::OtherDevice:
+                Log::Write(Log::Level::Info, "Ignoring pipeline cache from another device or driver");
+                return {};
+        }
+        return {};
+    }
+
+    VkDevice m_vkDevice{VK_NULL_HANDLE};
+    std::string m_path;
+    // What the file holds, the blob that was loaded or last saved.
+    std::vector<uint8_t> m_savedData;
+    bool m_warm{false};
+};
+
 // Pipeline wrapper for rendering pipeline state
 struct Pipeline {
     VkPipeline pipe{VK_NULL_HANDLE};
@@ -753,18 +1077,22 @@ struct Pipeline {
     void Dynamic(VkDynamicState state) { dynamicStateEnables.emplace_back(state); }
 
     void Create(VkDevice device, VkExtent2D size, const PipelineLayout& layout, const RenderPass& rp, const ShaderProgram& sp,
-                const VertexBufferBase& vb) {
+                const VertexBufferBase& vb, const InstanceBuffer& ib, const PipelineCache& cache) {
         m_vkDevice = device;
 
         VkPipelineDynamicStateCreateInfo dynamicState{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
         dynamicState.dynamicStateCount = (uint32_t)dynamicStateEnables.size();
         dynamicState.pDynamicStates = dynamicStateEnables.data();
 
+        const std::array<VkVertexInputBindingDescription, 2> bindings = {vb.bindDesc, ib.bindDesc};
+        std::vector<VkVertexInputAttributeDescription> attributes = vb.attrDesc;
+        attributes.insert(attributes.end(), ib.attrDesc.begin(), ib.attrDesc.end());
+
         VkPipelineVertexInputStateCreateInfo vi{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
-        vi.vertexBindingDescriptionCount = 1;
-        vi.pVertexBindingDescriptions = &vb.bindDesc;
-        vi.vertexAttributeDescriptionCount = (uint32_t)vb.attrDesc.size();
-        vi.pVertexAttributeDescriptions = vb.attrDesc.data();
+        vi.vertexBindingDescriptionCount = (uint32_t)bindings.size();
+        vi.pVertexBindingDescriptions = bindings.data();
+        vi.vertexAttributeDescriptionCount = (uint32_t)attributes.size();
+        vi.pVertexAttributeDescriptions = attributes.data();
 
         VkPipelineInputAssemblyStateCreateInfo ia{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
         ia.primitiveRestartEnable = VK_FALSE;
@@ -851,7 +1179,7 @@ struct Pipeline {
         pipeInfo.layout = layout.layout;
         pipeInfo.renderPass = rp.pass;
         pipeInfo.subpass = 0;
-        CHECK_VKCMD(vkCreateGraphicsPipelines(m_vkDevice, VK_NULL_HANDLE, 1, &pipeInfo, nullptr, &pipe));
+        CHECK_VKCMD(vkCreateGraphicsPipelines(m_vkDevice, cache.cache, 1, &pipeInfo, nullptr, &pipe));
     }
 
     void Release() {
@@ -869,7 +1197,7 @@ struct Pipeline {
 };
 
 struct DepthBuffer {
-    VkDeviceMemory depthMemory{VK_NULL_HANDLE};
+    MemoryAllocation depthMemory{};
     VkImage depthImage{VK_NULL_HANDLE};
 
     DepthBuffer() = default;
@@ -879,13 +1207,11 @@ struct DepthBuffer {
             if (depthImage != VK_NULL_HANDLE) {
                 vkDestroyImage(m_vkDevice, depthImage, nullptr);
             }
-            if (depthMemory != VK_NULL_HANDLE) {
-                vkFreeMemory(m_vkDevice, depthMemory, nullptr);
-            }
+            m_memAllocator->Free(&depthMemory);
         }
         depthImage = VK_NULL_HANDLE;
-        depthMemory = VK_NULL_HANDLE;
         m_vkDevice = nullptr;
+        m_memAllocator = nullptr;
     }
 
     DepthBuffer(DepthBuffer&& other) noexcept : DepthBuffer() {
@@ -894,6 +1220,7 @@ struct DepthBuffer {
         swap(depthImage, other.depthImage);
         swap(depthMemory, other.depthMemory);
         swap(m_vkDevice, other.m_vkDevice);
+        swap(m_memAllocator, other.m_memAllocator);
     }
     DepthBuffer& operator=(DepthBuffer&& other) noexcept {
         if (&other == this) {
@@ -906,12 +1233,14 @@ struct DepthBuffer {
         swap(depthImage, other.depthImage);
         swap(depthMemory, other.depthMemory);
         swap(m_vkDevice, other.m_vkDevice);
+        swap(m_memAllocator, other.m_memAllocator);
         return *this;
     }
 
     void Create(VkDevice device, MemoryAllocator* memAllocator, VkFormat depthFormat,
                 const XrSwapchainCreateInfo& swapchainCreateInfo) {
         m_vkDevice = device;
+        m_memAllocator = memAllocator;
 
         VkExtent2D size = {swapchainCreateInfo.width, swapchainCreateInfo.height};
 
@@ -933,8 +1262,9 @@ struct DepthBuffer {
 
         VkMemoryRequirements memRequirements{};
         vkGetImageMemoryRequirements(device, depthImage, &memRequirements);
-        memAllocator->Allocate(memRequirements, &depthMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
-        CHECK_VKCMD(vkBindImageMemory(device, depthImage, depthMemory, 0));
+        memAllocator->Allocate(memRequirements, &depthMemory, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                               MemoryAllocator::ResourceKind::Optimal);
+        CHECK_VKCMD(vkBindImageMemory(device, depthImage, depthMemory.memory, depthMemory.offset));
     }
 
     void TransitionLayout(CmdBuffer* cmdBuffer, VkImageLayout newLayout) {
@@ -960,6 +1290,7 @@ struct DepthBuffer {
 
    private:
     VkDevice m_vkDevice{VK_NULL_HANDLE};
+    MemoryAllocator* m_memAllocator{nullptr};
     VkImageLayout m_vkLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 };
 
@@ -979,7 +1310,8 @@ struct SwapchainImageContext {
 
     std::vector<XrSwapchainImageBaseHeader*> Create(VkDevice device, MemoryAllocator* memAllocator, uint32_t capacity,
                                                     const XrSwapchainCreateInfo& swapchainCreateInfo, const PipelineLayout& layout,
-                                                    const ShaderProgram& sp, const VertexBuffer<Geometry::Vertex>& vb) {
+                                                    const ShaderProgram& sp, const VertexBuffer<Geometry::Vertex>& vb,
+                                                    const InstanceBuffer& ib, const PipelineCache& cache) {
         m_vkDevice = device;
 
         size = {swapchainCreateInfo.width, swapchainCreateInfo.height};
@@ -989,7 +1321,7 @@ struct SwapchainImageContext {
 
         depthBuffer.Create(m_vkDevice, memAllocator, depthFormat, swapchainCreateInfo);
         rp.Create(m_vkDevice, colorFormat, depthFormat);
-        pipe.Create(m_vkDevice, size, layout, rp, sp, vb);
+        pipe.Create(m_vkDevice, size, layout, rp, sp, vb, ib, cache);
 
         swapchainImages.resize(capacity);
         renderTarget.resize(capacity);
@@ -1251,10 +1583,23 @@ void Swapchain::Present(VkQueue queue, VkSemaphore drawComplete) {
 #endif  // defined(USE_MIRROR_WINDOW)
 
 struct VulkanGraphicsPlugin : public IGraphicsPlugin {
-    VulkanGraphicsPlugin(const std::shared_ptr<Options>& /*unused*/, std::shared_ptr<IPlatformPlugin> /*unused*/) {
+    VulkanGraphicsPlugin(const std::shared_ptr<Options>& options, std::shared_ptr<IPlatformPlugin> /*unused*/) {
         m_graphicsBinding.type = GetGraphicsBindingType();
+        if (!options->CacheDirectory.empty()) {
+            m_pipelineCachePath = options->CacheDirectory + "/vulkan_pipeline_cache.bin";
+        }
     };
 
+    ~VulkanGraphicsPlugin() override {
+        // Submissions may still be in flight, let them retire before the members release their resources.
+        if (m_vkDevice != VK_NULL_HANDLE) {
+            vkDeviceWaitIdle(m_vkDevice);
+        }
+        // The swapchain contexts are declared before the memory allocator, release their depth buffers while it is alive.
+        m_swapchainImageContextMap.clear();
+        m_swapchainImageContexts.clear();
+    }
+
     std::vector<std::string> GetInstanceExtensions() const override { return {XR_KHR_VULKAN_ENABLE2_EXTENSION_NAME}; }
 
     // Note: The output must not outlive the input - this modifies the input and returns a collection of views into that modified
@@ -1415,49 +1760,20 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         m_graphicsBinding.queueIndex = 0;
     }
 
-#ifdef USE_ONLINE_VULKAN_SHADERC
-    // Compile a shader to a SPIR-V binary.
-    std::vector<uint32_t> CompileGlslShader(const std::string& name, shaderc_shader_kind kind, const std::string& source) {
-        shaderc::Compiler compiler;
-        shaderc::CompileOptions options;
-
-        options.SetOptimizationLevel(shaderc_optimization_level_size);
-
-        shaderc::SpvCompilationResult module = compiler.CompileGlslToSpv(source, kind, name.c_str(), options);
-
-        if (module.GetCompilationStatus() != shaderc_compilation_status_success) {
-            Log::Write(Log::Level::Error, Fmt("Shader %s compilation failed: %s", name.c_str(), module.GetErrorMessage().c_str()));
-            return std::vector<uint32_t>();
-        }
-
-        return {module.cbegin(), module.cend()};
-    }
-#endif
-
     void InitializeResources() {
-#ifdef USE_ONLINE_VULKAN_SHADERC
-        auto vertexSPIRV = CompileGlslShader("vertex", shaderc_glsl_default_vertex_shader, VertexShaderGlsl);
-        auto fragmentSPIRV = CompileGlslShader("fragment", shaderc_glsl_default_fragment_shader, FragmentShaderGlsl);
-#else
-        std::vector<uint32_t> vertexSPIRV =
-#include "vulkan_shaders/vert.spv"
-            ;
-        std::vector<uint32_t> fragmentSPIRV =
-#include "vulkan_shaders/frag.spv"
-            ;
-#endif
-        if (vertexSPIRV.empty()) THROW("Failed to compile vertex shader");
-        if (fragmentSPIRV.empty()) THROW("Failed to compile fragment shader");
-
         m_shaderProgram.Init(m_vkDevice);
-        m_shaderProgram.LoadVertexShader(vertexSPIRV);
-        m_shaderProgram.LoadFragmentShader(fragmentSPIRV);
+        m_shaderProgram.LoadVertexShader(VertexShaderSpv, ArraySize(VertexShaderSpv));
+        m_shaderProgram.LoadFragmentShader(FragmentShaderSpv, ArraySize(FragmentShaderSpv));
+
+        m_pipelineCache.Create(m_vkPhysicalDevice, m_vkDevice, m_pipelineCachePath);
 
         // Semaphore to block on draw complete
         VkSemaphoreCreateInfo semInfo{VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO};
         CHECK_VKCMD(vkCreateSemaphore(m_vkDevice, &semInfo, nullptr, &m_vkDrawDone));
 
-        if (!m_cmdBuffer.Init(m_vkDevice, m_queueFamilyIndex)) THROW("Failed to create command buffer");
+        for (CmdBuffer& cmdBuffer : m_cmdBuffers) {
+            if (!cmdBuffer.Init(m_vkDevice, m_queueFamilyIndex)) THROW("Failed to create command buffer");
+        }
 
         m_pipelineLayout.Create(m_vkDevice);
 
@@ -1471,15 +1787,19 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         m_drawBuffer.UpdateIndicies(Geometry::c_cubeIndices, numCubeIdicies, 0);
         m_drawBuffer.UpdateVertices(Geometry::c_cubeVertices, numCubeVerticies, 0);
 
+        m_instanceBuffer.Init(m_vkDevice, &m_memAllocator, 1, 2);
+        m_instanceBuffer.Create(SubmissionsInFlight, InitialInstanceCapacity);
+
 #if defined(USE_MIRROR_WINDOW)
         m_swapchain.Create(m_vkInstance, m_vkPhysicalDevice, m_vkDevice, m_graphicsBinding.queueFamilyIndex);
 
-        m_cmdBuffer.Reset();
-        m_cmdBuffer.Begin();
-        m_swapchain.Prepare(m_cmdBuffer.buf);
-        m_cmdBuffer.End();
-        m_cmdBuffer.Exec(m_vkQueue);
-        m_cmdBuffer.Wait();
+        CmdBuffer& cmdBuffer = m_cmdBuffers[0];
+        cmdBuffer.Reset();
+        cmdBuffer.Begin();
+        m_swapchain.Prepare(cmdBuffer.buf);
+        cmdBuffer.End();
+        cmdBuffer.Exec(m_vkQueue);
+        cmdBuffer.Wait();
 #endif
     }
 
@@ -1510,8 +1830,14 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         m_swapchainImageContexts.emplace_back(GetSwapchainImageType());
         SwapchainImageContext& swapchainImageContext = m_swapchainImageContexts.back();
 
+        const auto start = std::chrono::steady_clock::now();
         std::vector<XrSwapchainImageBaseHeader*> bases = swapchainImageContext.Create(
-            m_vkDevice, &m_memAllocator, capacity, swapchainCreateInfo, m_pipelineLayout, m_shaderProgram, m_drawBuffer);
+            m_vkDevice, &m_memAllocator, capacity, swapchainCreateInfo, m_pipelineLayout, m_shaderProgram, m_drawBuffer,
+            m_instanceBuffer, m_pipelineCache);
+        const auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        // Compare a first launch with the next one for the cold and warm numbers.
+        Log::Write(Log::Level::Info, Fmt("Swapchain pipeline created in %lld us, %s pipeline cache", (long long)elapsed.count(),
+                                         m_pipelineCache.IsWarm() ? "warm" : "cold"));
 
         // Map every swapchainImage base pointer to this context
         for (auto& base : bases) {
@@ -1521,6 +1847,9 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         return bases;
     }
 
+    // Every pipeline exists now. Persist right away, the process may be killed without a clean shutdown.
+    void OnSwapchainsCreated() override { m_pipelineCache.Save(); }
+
     void RenderView(const XrCompositionLayerProjectionView& layerView, const XrSwapchainImageBaseHeader* swapchainImage,
                     int64_t /*swapchainFormat*/, const std::vector<Cube>& cubes) override {
         CHECK(layerView.subImage.imageArrayIndex == 0);  // Texture arrays not supported.
@@ -1528,11 +1857,29 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         auto swapchainContext = m_swapchainImageContextMap[swapchainImage];
         uint32_t imageIndex = swapchainContext->ImageIndex(swapchainImage);
 
-        m_cmdBuffer.Reset();
-        m_cmdBuffer.Begin();
+        if (cubes.size() > m_instanceBuffer.segmentCapacity) {
+            // Grow geometrically so the buffer is only recreated a handful of times.
+            uint32_t newCapacity = m_instanceBuffer.segmentCapacity;
+            while (newCapacity < cubes.size()) {
+                newCapacity *= 2;
+            }
+            CHECK_VKCMD(vkQueueWaitIdle(m_vkQueue));
+            m_instanceBuffer.Create(SubmissionsInFlight, newCapacity);
+        }
+
+        // Each submission slot owns a command buffer and an instance segment. Waiting on the slot's fence
+        // retires the submission that used it SubmissionsInFlight views ago, so recording this view overlaps
+        // with the GPU executing the previous ones.
+        const uint32_t slot = m_submissionIndex;
+        m_submissionIndex = (m_submissionIndex + 1) % SubmissionsInFlight;
+        CmdBuffer& cmdBuffer = m_cmdBuffers[slot];
+        if (!cmdBuffer.Wait()) THROW("Timed out waiting for a previous submission");
+
+        cmdBuffer.Reset();
+        cmdBuffer.Begin();
 
         // Ensure depth is in the right layout
-        swapchainContext->depthBuffer.TransitionLayout(&m_cmdBuffer, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+        swapchainContext->depthBuffer.TransitionLayout(&cmdBuffer, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
 
         // Bind and clear eye render target
         static XrColor4f darkSlateGrey = {0.184313729f, 0.309803933f, 0.309803933f, 1.0f};
@@ -1549,14 +1896,15 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
 
         swapchainContext->BindRenderTarget(imageIndex, &renderPassBeginInfo);
 
-        vkCmdBeginRenderPass(m_cmdBuffer.buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBeginRenderPass(cmdBuffer.buf, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-        vkCmdBindPipeline(m_cmdBuffer.buf, VK_PIPELINE_BIND_POINT_GRAPHICS, swapchainContext->pipe.pipe);
+        vkCmdBindPipeline(cmdBuffer.buf, VK_PIPELINE_BIND_POINT_GRAPHICS, swapchainContext->pipe.pipe);
 
-        // Bind index and vertex buffers
-        vkCmdBindIndexBuffer(m_cmdBuffer.buf, m_drawBuffer.idxBuf, 0, VK_INDEX_TYPE_UINT16);
-        VkDeviceSize offset = 0;
-        vkCmdBindVertexBuffers(m_cmdBuffer.buf, 0, 1, &m_drawBuffer.vtxBuf, &offset);
+        // Bind index, vertex and instance buffers
+        vkCmdBindIndexBuffer(cmdBuffer.buf, m_drawBuffer.idxBuf, 0, VK_INDEX_TYPE_UINT16);
+        const VkBuffer vertexBuffers[] = {m_drawBuffer.vtxBuf, m_instanceBuffer.buf};
+        const VkDeviceSize offsets[] = {0, m_instanceBuffer.Offset(slot)};
+        vkCmdBindVertexBuffers(cmdBuffer.buf, 0, 2, vertexBuffers, offsets);
 
         // Compute the view-projection transform.
         // Note all matrixes (including OpenXR's) are column-major, right-handed.
@@ -1570,26 +1918,23 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
         XrMatrix4x4f_InvertRigidBody(&view, &toView);
         XrMatrix4x4f vp;
         XrMatrix4x4f_Multiply(&vp, &proj, &view);
+        vkCmdPushConstants(cmdBuffer.buf, m_pipelineLayout.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(vp.m), &vp.m[0]);
 
-        // Render each cube
+        // Write the model transform of each cube into this submission's instance segment.
+        XrMatrix4x4f* models = m_instanceBuffer.Map(slot);
         for (const Cube& cube : cubes) {
-            // Compute the model-view-projection transform and push it.
-            XrMatrix4x4f model;
-            XrMatrix4x4f_CreateTranslationRotationScale(&model, &cube.Pose.position, &cube.Pose.orientation, &cube.Scale);
-            XrMatrix4x4f mvp;
-            XrMatrix4x4f_Multiply(&mvp, &vp, &model);
-            vkCmdPushConstants(m_cmdBuffer.buf, m_pipelineLayout.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(mvp.m), &mvp.m[0]);
+            XrMatrix4x4f_CreateTranslationRotationScale(models++, &cube.Pose.position, &cube.Pose.orientation, &cube.Scale);
+        }
 
-            // Draw the cube.
-            vkCmdDrawIndexed(m_cmdBuffer.buf, m_drawBuffer.count.idx, 1, 0, 0, 0);
+        // Draw all cubes with a single instanced draw.
+        if (!cubes.empty()) {
+            vkCmdDrawIndexed(cmdBuffer.buf, m_drawBuffer.count.idx, (uint32_t)cubes.size(), 0, 0, 0);
         }
 
-        vkCmdEndRenderPass(m_cmdBuffer.buf);
+        vkCmdEndRenderPass(cmdBuffer.buf);
 
-        m_cmdBuffer.End();
-        m_cmdBuffer.Exec(m_vkQueue);
-        // XXX Should double-buffer the command buffers, for now just flush
-        m_cmdBuffer.Wait();
+        cmdBuffer.End();
+        cmdBuffer.Exec(m_vkQueue);
 
 #if defined(USE_MIRROR_WINDOW)
         // Cycle the window's swapchain on the last view rendered
@@ -1616,9 +1961,16 @@ struct VulkanGraphicsPlugin : public IGraphicsPlugin {
 
     MemoryAllocator m_memAllocator{};
     ShaderProgram m_shaderProgram{};
-    CmdBuffer m_cmdBuffer{};
+    std::string m_pipelineCachePath;
+    PipelineCache m_pipelineCache{};
+    // Two frames of two views each.
+    static constexpr uint32_t SubmissionsInFlight = 4;
+    std::array<CmdBuffer, SubmissionsInFlight> m_cmdBuffers{};
+    uint32_t m_submissionIndex{0};
     PipelineLayout m_pipelineLayout{};
     VertexBuffer<Geometry::Vertex> m_drawBuffer{};
+    static constexpr uint32_t InitialInstanceCapacity = 64;
+    InstanceBuffer m_instanceBuffer{};
 
 #if defined(USE_MIRROR_WINDOW)
     Swapchain m_swapchain{};
@@ -0,0 +1,44 @@
+/*
+    display frames a half-rate stream is expected to deliver a new video frame on
+*/
+#include "half_rate.h"
+
+void HalfRateScheduler::SetEnabled(bool enabled) {
+    if (enabled == m_enabled) {
+        return;
+    }
+    m_enabled = enabled;
+    m_due = true;
+    m_sinceLatched = 1;
+    m_synthesized = 0;
+    m_late = 0;
+    m_early = 0;
+}
+
+bool HalfRateScheduler::BeginFrame() {
+    if (!m_enabled) {
+        m_due = true;
+        return true;
+    }
+    m_due = m_sinceLatched >= 1;
+    return m_due;
+}
+
+void HalfRateScheduler::OnLatchResult(bool latched) {
+    if (!m_enabled) {
+        return;
+    }
+    if (latched) {
+        if (!m_due) {
+            m_early++;
+        }
+        m_sinceLatched = 0;
+        return;
+    }
+    if (m_due) {
+        m_late++;
+    } else {
+        m_synthesized++;
+    }
+    m_sinceLatched++;
+}
@@ -0,0 +1,43 @@
+/*
+    display frames a half-rate stream is expected to deliver a new video frame on
+*/
+
+#pragma once
+#include "pch.h"
+
+// With the server rendering at half the display rate every other display frame has no new video frame. On those the
+// previous frame is resubmitted with the pose it was rendered for and the compositor reprojects it, so the render loop
+// must neither wait for a frame nor count the repeat as a miss. The phase follows the stream: a frame that shows up on
+// a synthesized slot becomes the new reference, one that is late keeps the next display frame expecting it.
+class HalfRateScheduler {
+public:
+    // Changing the mode starts over from the next latched frame.
+    void SetEnabled(bool enabled);
+
+    bool IsEnabled() const { return m_enabled; }
+
+    // Once per display frame before the latch. True when a new video frame is due, the latch may then wait for it;
+    // otherwise only a frame that is already decoded is taken. Always true while disabled.
+    bool BeginFrame();
+
+    // Whether this display frame's latch returned a frame.
+    void OnLatchResult(bool latched);
+
+    // Display frames filled by reprojection as planned.
+    uint64_t GetSynthesizedCount() const { return m_synthesized; }
+
+    // Due frames that were not there in time.
+    uint64_t GetLateCount() const { return m_late; }
+
+    // New frames that arrived on a synthesized slot and moved the phase.
+    uint64_t GetEarlyCount() const { return m_early; }
+
+private:
+    bool m_enabled{false};
+    bool m_due{true};
+    // Display frames since the last new video frame, the first frame of a stream is due right away.
+    uint32_t m_sinceLatched{1};
+    uint64_t m_synthesized{0};
+    uint64_t m_late{0};
+    uint64_t m_early{0};
+};
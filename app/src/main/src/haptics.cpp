@@ -0,0 +1,67 @@
+/*
+    haptic pulse queue, coalescing and rate limiting between the CloudXR callback and the input thread
+*/
+#include "haptics.h"
+
+HapticScheduler::HapticScheduler(const Config& config) : mConfig(config), mDropped(0), mCoalesced(0) {
+}
+
+bool HapticScheduler::Enqueue(const HapticPulse& pulse) {
+    if (pulse.controller >= MaxControllers || !mQueue.TryPush(pulse)) {
+        mDropped++;
+        return false;
+    }
+    return true;
+}
+
+void HapticScheduler::Merge(ControllerState& state, const HapticPulse& pulse, int64_t nowNs) {
+    // Microsecond rounding, a float carries no more precision than that and 0.1f would otherwise become 100000001ns.
+    const int64_t endNs = pulse.receivedNs + (int64_t)std::llround((double)pulse.seconds * 1e6) * 1000;
+    if (endNs <= nowNs) {
+        return;
+    }
+
+    if (!state.hasPending) {
+        const bool playing = state.playing.endNs > nowNs;
+        if (playing && pulse.amplitude <= state.playing.amplitude && endNs <= state.playing.endNs) {
+            mCoalesced++;
+            return;
+        }
+        state.pending = playing ? state.playing : Vibration{0, 0, 0};
+        state.hasPending = true;
+    } else {
+        mCoalesced++;
+    }
+
+    Vibration& pending = state.pending;
+    if (pulse.amplitude >= pending.amplitude) {
+        pending.amplitude = pulse.amplitude;
+        pending.frequency = pulse.frequency;
+    }
+    pending.endNs = std::max(pending.endNs, endNs);
+}
+
+void HapticScheduler::Dispatch(int64_t nowNs, const std::function<void(const HapticCommand&)>& apply) {
+    HapticPulse pulse;
+    while (mQueue.TryPop(&pulse)) {
+        Merge(mControllers[pulse.controller], pulse, nowNs);
+    }
+
+    for (uint32_t controller = 0; controller < MaxControllers; controller++) {
+        ControllerState& state = mControllers[controller];
+        if (!state.hasPending) {
+            continue;
+        }
+        if (state.applied && nowNs - state.lastApplyNs < mConfig.minIntervalNs) {
+            continue;
+        }
+        state.hasPending = false;
+        if (state.pending.endNs <= nowNs) {
+            continue;
+        }
+        state.playing = state.pending;
+        state.lastApplyNs = nowNs;
+        state.applied = true;
+        apply({controller, state.playing.amplitude, state.playing.endNs - nowNs, state.playing.frequency});
+    }
+}
@@ -0,0 +1,76 @@
+/*
+    haptic pulse queue, coalescing and rate limiting between the CloudXR callback and the input thread
+*/
+
+#pragma once
+#include "pch.h"
+#include "spsc_queue.h"
+
+struct HapticPulse {
+    uint32_t controller;
+    float amplitude;
+    float seconds;
+    float frequency;
+    // Clock::NowNs when the server pulse arrived.
+    int64_t receivedNs;
+};
+
+// One xrApplyHapticFeedback call. A new vibration replaces the one playing on that controller, so durationNs covers
+// everything merged so far.
+struct HapticCommand {
+    uint32_t controller;
+    float amplitude;
+    int64_t durationNs;
+    float frequency;
+};
+
+// Pulses are queued lock-free from the CloudXR callback thread and turned into OpenXR calls on the thread that owns
+// the session. Pulses that overlap on one controller merge into a single vibration with the strongest amplitude and
+// the latest end, and a controller is not re-driven more often than minIntervalNs. A pulse fully covered by what is
+// already playing costs no OpenXR call at all.
+class HapticScheduler {
+public:
+    static constexpr uint32_t MaxControllers = 2;
+
+    struct Config {
+        int64_t minIntervalNs{20000000};
+    };
+
+    HapticScheduler() : HapticScheduler(Config{}) {}
+
+    explicit HapticScheduler(const Config& config);
+
+    // Callback thread. Returns false and counts a drop when the queue is full or the controller index is invalid.
+    bool Enqueue(const HapticPulse& pulse);
+
+    // Session thread. Calls apply for every controller that needs a new vibration at nowNs.
+    void Dispatch(int64_t nowNs, const std::function<void(const HapticCommand&)>& apply);
+
+    uint32_t GetDroppedCount() const { return mDropped; }
+
+    uint32_t GetCoalescedCount() const { return mCoalesced; }
+
+private:
+    struct Vibration {
+        float amplitude;
+        float frequency;
+        int64_t endNs;
+    };
+
+    struct ControllerState {
+        Vibration playing{0, 0, 0};
+        Vibration pending{0, 0, 0};
+        bool hasPending{false};
+        int64_t lastApplyNs{0};
+        bool applied{false};
+    };
+
+    void Merge(ControllerState& state, const HapticPulse& pulse, int64_t nowNs);
+
+private:
+    const Config mConfig;
+    SpscQueue<HapticPulse, 64> mQueue;
+    ControllerState mControllers[MaxControllers];
+    std::atomic<uint32_t> mDropped;
+    uint32_t mCoalesced;
+};
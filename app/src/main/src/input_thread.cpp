@@ -0,0 +1,78 @@
+/*
+    controller input sampling thread that runs at its own rate instead of once per display frame
+*/
+#include "input_thread.h"
+#include "common.h"
+#include "logger.h"
+#include "thread_policy.h"
+
+constexpr std::chrono::milliseconds InputThread::IdleInterval;
+
+InputThread::InputThread(Handlers handlers) : mHandlers(std::move(handlers)), mStop(false), mFailed(false) {
+}
+
+InputThread::~InputThread() {
+    Stop();
+}
+
+void InputThread::Start() {
+    if (mThread.joinable()) {
+        return;
+    }
+    mStop = false;
+    mFailed = false;
+    mThread = std::thread([this]() { ThreadLoop(); });
+}
+
+void InputThread::Stop() {
+    if (!mThread.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mWake.notify_one();
+    mThread.join();
+}
+
+bool InputThread::Sample() {
+    try {
+        mHandlers.sample();
+        return true;
+    } catch (const std::exception& ex) {
+        Log::Write(Log::Level::Error, Fmt("Input thread stopped, sampling once per frame: %s", ex.what()));
+    } catch (...) {
+        Log::Write(Log::Level::Error, "Input thread stopped, sampling once per frame");
+    }
+    mFailed = true;
+    return false;
+}
+
+void InputThread::ThreadLoop() {
+    ThreadRoles::Apply(ThreadRole::Input);
+    std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (!mStop) {
+        const uint32_t rateHz = mHandlers.rateHz();
+        if (rateHz == 0) {
+            mWake.wait_for(lock, IdleInterval, [this]() { return mStop; });
+            next = std::chrono::steady_clock::now();
+            continue;
+        }
+
+        lock.unlock();
+        if (!Sample()) {
+            return;
+        }
+        lock.lock();
+
+        // Fixed rate, but after a stall the next sample is taken right away instead of catching up in a burst.
+        next += std::chrono::nanoseconds(1000000000 / rateHz);
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (next < now) {
+            next = now;
+        }
+        mWake.wait_until(lock, next, [this]() { return mStop; });
+    }
+}
@@ -0,0 +1,51 @@
+/*
+    controller input sampling thread that runs at its own rate instead of once per display frame
+*/
+
+#pragma once
+#include "pch.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+// Calls the sample handler at the rate the rateHz handler returns. The rate is looked up before every sample, so a
+// live option change applies right away; at 0 Hz the render thread samples once per frame and the thread only looks
+// for a new rate now and then. A sample that throws stops the thread, HasFailed then hands sampling back to the
+// render thread until the next Start.
+class InputThread {
+public:
+    struct Handlers {
+        std::function<uint32_t()> rateHz;
+        std::function<void()> sample;
+    };
+
+    // How often a thread at 0 Hz looks for a new rate.
+    static constexpr std::chrono::milliseconds IdleInterval{100};
+
+    explicit InputThread(Handlers handlers);
+
+    ~InputThread();
+
+    InputThread(const InputThread&) = delete;
+    InputThread& operator=(const InputThread&) = delete;
+
+    void Start();
+
+    // Joins, no-op when not started.
+    void Stop();
+
+    bool HasFailed() const { return mFailed; }
+
+private:
+    void ThreadLoop();
+
+    bool Sample();
+
+private:
+    Handlers mHandlers;
+    std::thread mThread;
+    std::mutex mMutex;
+    std::condition_variable mWake;
+    bool mStop;
+    std::atomic<bool> mFailed;
+};
@@ -0,0 +1,58 @@
+/*
+    late-latch deadline from the OpenXR frame timing and the measured submit cost
+*/
+#include "latch_scheduler.h"
+
+LatchScheduler::LatchScheduler(const Config& config) : m_config(config) {
+}
+
+void LatchScheduler::BeginFrame(int64_t displayTimeNs, int64_t displayPeriodNs) {
+    m_displayTimeNs = displayTimeNs;
+    m_displayPeriodNs = displayPeriodNs;
+    m_latched = false;
+}
+
+int64_t LatchScheduler::GetSubmitCostNs() const {
+    if (!m_measured) {
+        return m_config.initialCostNs;
+    }
+    return (int64_t)(m_costMeanNs + m_config.costDeviations * m_costDeviationNs);
+}
+
+int64_t LatchScheduler::GetLatchDeadline() const {
+    if (m_displayTimeNs == 0) {
+        return 0;
+    }
+    const int64_t submitDeadline = m_displayTimeNs - (int64_t)(m_config.compositorLead * m_displayPeriodNs);
+    return submitDeadline - GetSubmitCostNs() - m_config.safetyMarginNs;
+}
+
+uint32_t LatchScheduler::GetLatchTimeoutMs(int64_t nowNs) const {
+    const int64_t slackNs = GetLatchDeadline() - nowNs;
+    if (slackNs <= 0) {
+        return 0;
+    }
+    return (uint32_t)std::min<int64_t>(slackNs / 1000000, UINT32_MAX);
+}
+
+void LatchScheduler::OnLatched(int64_t nowNs) {
+    m_latchedNs = nowNs;
+    m_latched = true;
+}
+
+void LatchScheduler::OnSubmitted(int64_t nowNs) {
+    if (!m_latched) {
+        return;
+    }
+    m_latched = false;
+    const double cost = (double)(nowNs - m_latchedNs);
+    if (!m_measured) {
+        m_measured = true;
+        m_costMeanNs = cost;
+        m_costDeviationNs = 0;
+        return;
+    }
+    // Mean deviation tracks the jitter the way TCP tracks RTT variance, cheap and robust to the odd spike.
+    m_costDeviationNs += m_config.costSmoothing * (std::abs(cost - m_costMeanNs) - m_costDeviationNs);
+    m_costMeanNs += m_config.costSmoothing * (cost - m_costMeanNs);
+}
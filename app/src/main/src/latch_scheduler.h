@@ -0,0 +1,52 @@
+/*
+    late-latch deadline from the OpenXR frame timing and the measured submit cost
+*/
+
+#pragma once
+#include "pch.h"
+
+// Works out how long cxrLatchFrame may wait for a video frame without making xrEndFrame late. The compositor wants the
+// frame compositorLead before its display time; what is left after subtracting the measured latch-to-submit cost
+// (mean plus a multiple of its mean deviation) and a safety margin is the latch timeout. All times are Clock::NowNs.
+class LatchScheduler {
+public:
+    struct Config {
+        // Fraction of the display period before display time the layer has to be submitted by.
+        float compositorLead{1.0f};
+        int64_t safetyMarginNs{1000000};
+        float costSmoothing{0.1f};
+        float costDeviations{2.0f};
+        // Used until the first frame was measured.
+        int64_t initialCostNs{4000000};
+    };
+
+    LatchScheduler() : LatchScheduler(Config{}) {}
+
+    explicit LatchScheduler(const Config& config);
+
+    // From xrWaitFrame, displayTimeNs already converted from XrTime.
+    void BeginFrame(int64_t displayTimeNs, int64_t displayPeriodNs);
+
+    // Latest time the latch may return, 0 before the first BeginFrame.
+    int64_t GetLatchDeadline() const;
+
+    // Whole milliseconds until the latch deadline, rounded down and 0 once it passed.
+    uint32_t GetLatchTimeoutMs(int64_t nowNs) const;
+
+    void OnLatched(int64_t nowNs);
+
+    // After xrEndFrame returned, feeds the latch-to-submit cost of the frame.
+    void OnSubmitted(int64_t nowNs);
+
+    int64_t GetSubmitCostNs() const;
+
+private:
+    Config m_config;
+    int64_t m_displayTimeNs{0};
+    int64_t m_displayPeriodNs{0};
+    int64_t m_latchedNs{0};
+    bool m_latched{false};
+    bool m_measured{false};
+    double m_costMeanNs{0};
+    double m_costDeviationNs{0};
+};
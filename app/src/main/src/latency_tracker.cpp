@@ -0,0 +1,104 @@
+/*
+    motion-to-photon latency from pose IDs sent to the server and echoed back on latch
+*/
+#include "latency_tracker.h"
+
+void LatencyHistogram::Add(int64_t latencyNs) {
+    const double ms = std::max<int64_t>(latencyNs, 0) / 1e6;
+    m_buckets[std::min<size_t>((size_t)(ms / BucketMs), BucketCount - 1)]++;
+    m_count++;
+    m_sumMs += ms;
+    m_maxMs = std::max(m_maxMs, ms);
+}
+
+void LatencyHistogram::Clear() {
+    std::fill(std::begin(m_buckets), std::end(m_buckets), 0);
+    m_count = 0;
+    m_sumMs = 0;
+    m_maxMs = 0;
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize() const {
+    Summary summary{m_count, 0, 0, 0, 0, m_maxMs};
+    if (m_count == 0) {
+        return summary;
+    }
+    summary.meanMs = m_sumMs / m_count;
+
+    const std::pair<double, double*> percentiles[] = {{0.5, &summary.p50Ms}, {0.9, &summary.p90Ms}, {0.99, &summary.p99Ms}};
+    size_t next = 0;
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < BucketCount && next < 3; bucket++) {
+        seen += m_buckets[bucket];
+        while (next < 3 && seen >= (uint64_t)std::ceil(percentiles[next].first * m_count)) {
+            *percentiles[next].second = std::min((bucket + 1) * BucketMs, m_maxMs);
+            next++;
+        }
+    }
+    return summary;
+}
+
+void LatencyTracker::OnPoseSent(uint64_t poseID, int64_t sentNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sent[poseID % PoseCapacity] = {poseID, sentNs};
+}
+
+bool LatencyTracker::FindSent(uint64_t poseID, int64_t* sentNs) const {
+    const SentPose& sent = m_sent[poseID % PoseCapacity];
+    if (sent.poseID != poseID || sent.sentNs == 0) {
+        return false;
+    }
+    *sentNs = sent.sentNs;
+    return true;
+}
+
+void LatencyTracker::OnFrameLatched(uint64_t poseID, int64_t latchedNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int64_t sentNs;
+    if (!FindSent(poseID, &sentNs)) {
+        m_unmatched++;
+        return;
+    }
+    m_poseToLatch.Add(latchedNs - sentNs);
+}
+
+void LatencyTracker::OnFrameDisplayed(uint64_t poseID, int64_t displayNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    int64_t sentNs;
+    if (!FindSent(poseID, &sentNs)) {
+        return;
+    }
+    const double ms = (displayNs - sentNs) / 1e6;
+    m_poseToPhoton.Add(displayNs - sentNs);
+    m_poseToPhotonMs = m_poseToPhotonMs == 0 ? ms : m_poseToPhotonMs + 0.1 * (ms - m_poseToPhotonMs);
+}
+
+void LatencyTracker::OnInputSent(int64_t changedNs, int64_t sentNs) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_inputToSend.Add(sentNs - changedNs);
+}
+
+double LatencyTracker::GetPoseToPhotonMs() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_poseToPhotonMs;
+}
+
+LatencyTracker::Snapshot LatencyTracker::TakeSnapshot() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Snapshot snapshot{m_poseToLatch.Summarize(), m_poseToPhoton.Summarize(), m_unmatched, m_inputToSend.Summarize()};
+    m_poseToLatch.Clear();
+    m_poseToPhoton.Clear();
+    m_inputToSend.Clear();
+    m_unmatched = 0;
+    return snapshot;
+}
+
+void LatencyTracker::Reset() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::fill(std::begin(m_sent), std::end(m_sent), SentPose{0, 0});
+    m_poseToLatch.Clear();
+    m_poseToPhoton.Clear();
+    m_inputToSend.Clear();
+    m_unmatched = 0;
+    m_poseToPhotonMs = 0;
+}
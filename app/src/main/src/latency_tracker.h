@@ -0,0 +1,88 @@
+/*
+    motion-to-photon latency from pose IDs sent to the server and echoed back on latch
+*/
+
+#pragma once
+#include "pch.h"
+#include <mutex>
+
+// Fixed-bucket latency histogram, 0.5 ms buckets up to 250 ms with everything above in the last one.
+class LatencyHistogram {
+public:
+    struct Summary {
+        uint64_t count;
+        double meanMs;
+        double p50Ms;
+        double p90Ms;
+        double p99Ms;
+        double maxMs;
+    };
+
+    static constexpr double BucketMs = 0.5;
+    static constexpr size_t BucketCount = 500;
+
+    void Add(int64_t latencyNs);
+
+    void Clear();
+
+    // Percentiles are bucket upper bounds, so they overstate by at most BucketMs.
+    Summary Summarize() const;
+
+private:
+    uint64_t m_buckets[BucketCount] = {};
+    uint64_t m_count{0};
+    double m_sumMs{0};
+    double m_maxMs{0};
+};
+
+// Remembers when each pose was handed to CloudXR. The latched frame names the pose it was rendered with, which gives
+// pose-to-latch; the display time of the frame it is shown in gives pose-to-photon. Poses older than the ring are
+// forgotten, a frame that names one counts as unmatched.
+class LatencyTracker {
+public:
+    static constexpr size_t PoseCapacity = 1024;
+
+    struct Snapshot {
+        LatencyHistogram::Summary poseToLatch;
+        LatencyHistogram::Summary poseToPhoton;
+        uint64_t unmatched;
+        LatencyHistogram::Summary inputToSend;
+    };
+
+    // Pose callback thread.
+    void OnPoseSent(uint64_t poseID, int64_t sentNs);
+
+    // Render thread, once per latched frame and once more with the display time it was submitted for.
+    void OnFrameLatched(uint64_t poseID, int64_t latchedNs);
+
+    void OnFrameDisplayed(uint64_t poseID, int64_t displayNs);
+
+    // Input thread or render thread, for a controller event from the time the runtime saw the change until it was
+    // handed to CloudXR.
+    void OnInputSent(int64_t changedNs, int64_t sentNs);
+
+    // Smoothed pose-to-photon latency, 0 until the first frame was displayed.
+    double GetPoseToPhotonMs() const;
+
+    // Distributions since the previous call, for the periodic stats log.
+    Snapshot TakeSnapshot();
+
+    void Reset();
+
+private:
+    bool FindSent(uint64_t poseID, int64_t* sentNs) const;
+
+private:
+    struct SentPose {
+        uint64_t poseID;
+        int64_t sentNs;
+    };
+
+    mutable std::mutex m_mutex;
+    SentPose m_sent[PoseCapacity] = {};
+    LatencyHistogram m_poseToLatch;
+    LatencyHistogram m_poseToPhoton;
+    LatencyHistogram m_inputToSend;
+    uint64_t m_unmatched{0};
+    double m_poseToPhotonMs{0};
+};
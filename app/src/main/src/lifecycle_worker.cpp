@@ -0,0 +1,81 @@
+/*
+    control thread that serializes receiver creation and teardown behind posted lifecycle commands
+*/
+#include "lifecycle_worker.h"
+#include "logger.h"
+#include "common.h"
+#include "clock.h"
+#include "thread_policy.h"
+
+LifecycleWorker::LifecycleWorker(Handlers handlers) : mHandlers(std::move(handlers)), mStats{0, 0, 0}, mPaused(true) {
+}
+
+LifecycleWorker::~LifecycleWorker() {
+    Stop();
+}
+
+void LifecycleWorker::Start() {
+    if (!mThread.joinable()) {
+        mThread = std::thread([this]() { ThreadLoop(); });
+    }
+}
+
+void LifecycleWorker::Post(LifecycleCommand command) {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mCommands.push_back({command, Clock::NowNs()});
+    }
+    mWake.notify_one();
+}
+
+void LifecycleWorker::Stop() {
+    if (mThread.joinable()) {
+        Post(LifecycleCommand::Shutdown);
+        mThread.join();
+    }
+}
+
+LifecycleWorker::Stats LifecycleWorker::GetStats() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mStats;
+}
+
+void LifecycleWorker::ThreadLoop() {
+    ThreadRoles::Apply(ThreadRole::Control);
+    while (true) {
+        const std::chrono::milliseconds pollInterval = mHandlers.pollInterval();
+        std::deque<PostedCommand> commands;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWake.wait_for(lock, pollInterval, [this]() { return !mCommands.empty(); });
+            commands.swap(mCommands);
+        }
+
+        for (const PostedCommand& posted : commands) {
+            if (posted.command == LifecycleCommand::Shutdown) {
+                mHandlers.shutdown();
+                return;
+            }
+            Handle(posted);
+        }
+
+        mHandlers.poll();
+    }
+}
+
+void LifecycleWorker::Handle(const PostedCommand& posted) {
+    const bool pause = posted.command == LifecycleCommand::Pause;
+    const int64_t startNs = Clock::NowNs();
+    if (pause != mPaused) {
+        mPaused = pause;
+        mHandlers.setPaused(pause);
+    }
+    const int64_t endNs = Clock::NowNs();
+    Log::Write(Log::Level::Info, Fmt("%s handled %.1f ms after it was posted, took %.1f ms", pause ? "Pause" : "Resume",
+                                     Clock::NsToMs(startNs - posted.postedNs), Clock::NsToMs(endNs - startNs)));
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStats.handled++;
+    mStats.maxQueuedNs = std::max(mStats.maxQueuedNs, startNs - posted.postedNs);
+    mStats.maxHandlerNs = std::max(mStats.maxHandlerNs, endNs - startNs);
+}
@@ -0,0 +1,75 @@
+/*
+    control thread that serializes receiver creation and teardown behind posted lifecycle commands
+*/
+
+#pragma once
+#include "pch.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+enum class LifecycleCommand {
+    Pause,
+    Resume,
+    Shutdown,
+};
+
+// Lifecycle callbacks only post, the handlers run on the worker thread one at a time and in the order the commands
+// were posted, so receiver creation and teardown can never overlap. Repeated pauses or resumes are handled once.
+// Between commands the worker polls, at the interval the pollInterval handler returns.
+class LifecycleWorker {
+public:
+    struct Handlers {
+        // Called when the paused state changes, the first Resume included.
+        std::function<void(bool paused)> setPaused;
+        std::function<void()> poll;
+        std::function<std::chrono::milliseconds()> pollInterval;
+        // Last call on the worker thread.
+        std::function<void()> shutdown;
+    };
+
+    struct Stats {
+        uint64_t handled;
+        // Longest a command waited in the queue and longest its handler took.
+        int64_t maxQueuedNs;
+        int64_t maxHandlerNs;
+    };
+
+    explicit LifecycleWorker(Handlers handlers);
+
+    ~LifecycleWorker();
+
+    LifecycleWorker(const LifecycleWorker&) = delete;
+    LifecycleWorker& operator=(const LifecycleWorker&) = delete;
+
+    void Start();
+
+    // Any thread, never blocks on a handler.
+    void Post(LifecycleCommand command);
+
+    // Posts Shutdown and joins, no-op when not started.
+    void Stop();
+
+    Stats GetStats() const;
+
+private:
+    struct PostedCommand {
+        LifecycleCommand command;
+        int64_t postedNs;
+    };
+
+    void ThreadLoop();
+
+    void Handle(const PostedCommand& posted);
+
+private:
+    Handlers mHandlers;
+    std::thread mThread;
+    mutable std::mutex mMutex;
+    std::condition_variable mWake;
+    std::deque<PostedCommand> mCommands;
+    Stats mStats;
+    // Worker thread only.
+    bool mPaused;
+};
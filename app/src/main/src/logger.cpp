@@ -5,6 +5,7 @@
 #include "pch.h"
 #include "logger.h"
 
+#include <atomic>
 #include <sstream>
 
 #if defined(ANDROID)
@@ -15,7 +16,8 @@
 #endif
 
 namespace {
-Log::Level g_minSeverity{Log::Level::Info};
+// Everything is logged until the runtime options say otherwise.
+std::atomic<Log::Level> g_minSeverity{Log::Level::Verbose};
 std::mutex g_logLock;
 }  // namespace
 
@@ -24,7 +26,7 @@ void SetLevel(Level minSeverity) { g_minSeverity = minSeverity; }
 
 void Write(Level severity, const std::string& msg) {
     if (severity < g_minSeverity) {
-//        return;
+        return;
     }
 
     const auto now = std::chrono::system_clock::now();
@@ -0,0 +1,73 @@
+/*
+    eventfd that other threads signal to wake the main looper
+*/
+#include "loop_waker.h"
+#include "common.h"
+#include "logger.h"
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+constexpr int LoopWaker::LooperId;
+constexpr int IdlePollBackoff::MinMs;
+constexpr int IdlePollBackoff::MaxMs;
+
+LoopWaker::LoopWaker() : mLooper(nullptr), mFd(-1) {
+}
+
+LoopWaker::~LoopWaker() {
+    Detach();
+}
+
+bool LoopWaker::Attach(ALooper* looper) {
+    if (mFd >= 0) {
+        return true;
+    }
+    const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+        Log::Write(Log::Level::Warning, Fmt("eventfd failed: %s", strerror(errno)));
+        return false;
+    }
+    if (ALooper_addFd(looper, fd, LooperId, ALOOPER_EVENT_INPUT, nullptr, nullptr) != 1) {
+        Log::Write(Log::Level::Warning, "ALooper_addFd failed for the main loop eventfd");
+        close(fd);
+        return false;
+    }
+    mLooper = looper;
+    mFd = fd;
+    return true;
+}
+
+void LoopWaker::Detach() {
+    const int fd = mFd.exchange(-1);
+    if (fd < 0) {
+        return;
+    }
+    ALooper_removeFd(mLooper, fd);
+    close(fd);
+    mLooper = nullptr;
+}
+
+void LoopWaker::Wake() {
+    const int fd = mFd;
+    if (fd < 0) {
+        return;
+    }
+    const uint64_t one = 1;
+    // EAGAIN means the counter is saturated, the looper is woken either way.
+    if (write(fd, &one, sizeof(one)) != sizeof(one) && errno != EAGAIN) {
+        Log::Write(Log::Level::Error, Fmt("Failed to wake the main loop: %s", strerror(errno)));
+    }
+}
+
+void LoopWaker::Drain() {
+    const int fd = mFd;
+    if (fd < 0) {
+        return;
+    }
+    // One read returns and clears the whole counter.
+    uint64_t count;
+    if (read(fd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+        Log::Write(Log::Level::Error, Fmt("Failed to drain the main loop eventfd: %s", strerror(errno)));
+    }
+}
@@ -0,0 +1,61 @@
+/*
+    eventfd that other threads signal to wake the main looper
+*/
+
+#pragma once
+#include "pch.h"
+#include <atomic>
+#include <android_native_app_glue.h>
+
+// Registered with the main ALooper next to the glue's command and input pipes, so a thread that changes something
+// the main loop acts on can wake it instead of waiting for the next poll timeout. Wakes coalesce until drained.
+class LoopWaker {
+public:
+    // Any ALooper ident the glue does not use, LOOPER_ID_USER is reserved for exactly this.
+    static constexpr int LooperId = LOOPER_ID_USER;
+
+    LoopWaker();
+
+    ~LoopWaker();
+
+    LoopWaker(const LoopWaker&) = delete;
+    LoopWaker& operator=(const LoopWaker&) = delete;
+
+    // Returns false if the eventfd could not be created, the main loop then relies on its poll timeout alone.
+    bool Attach(ALooper* looper);
+
+    void Detach();
+
+    // Any thread. The fd is closed by Detach, so a thread that may still call Wake has to be stopped from doing so
+    // before Detach, main.cpp clears the client's wake callback first.
+    void Wake();
+
+    // Main thread, after ALooper_pollAll returned LooperId.
+    void Drain();
+
+private:
+    ALooper* mLooper;
+    // Swapped to -1 before the fd is closed, a Wake that runs after Detach sees -1 instead of a closed fd number.
+    std::atomic<int> mFd;
+};
+
+// Timeout of the main loop's blocking poll while no session is running. xrWaitFrame does not throttle the loop then
+// and OpenXR events have no fd to wait on, so xrPollEvent is polled with a backoff that restarts at every wake. A
+// session that becomes ready right after a lifecycle or client event is noticed within milliseconds, an idle headset
+// costs a few polls a second.
+class IdlePollBackoff {
+public:
+    static constexpr int MinMs = 1;
+    static constexpr int MaxMs = 100;
+
+    int GetTimeoutMs() const { return mTimeoutMs; }
+
+    // After an idle iteration, woken if the looper returned an event during it.
+    void OnIdle(bool woken) { mTimeoutMs = woken ? MinMs : std::min(mTimeoutMs * 2, MaxMs); }
+
+    // While the session runs xrWaitFrame paces the loop, the next idle stretch starts short again.
+    void Reset() { mTimeoutMs = MinMs; }
+
+private:
+    int mTimeoutMs{MinMs};
+};
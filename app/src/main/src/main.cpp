@@ -10,6 +10,10 @@
 #include "graphicsplugin.h"
 #include "openxr_program.h"
 #include "cloudXRClient.h"
+#include "startup.h"
+#include "thread_policy.h"
+#include "loop_waker.h"
+#include "clock.h"
 
 namespace {
 
@@ -18,6 +22,28 @@ void ShowHelp() {
     Log::Write(Log::Level::Info, "adb shell setprop debug.xr.formFactor Hmd|Handheld");
     Log::Write(Log::Level::Info, "adb shell setprop debug.xr.viewConfiguration Stereo|Mono");
     Log::Write(Log::Level::Info, "adb shell setprop debug.xr.blendMode Opaque|Additive|AlphaBlend");
+    Log::Write(Log::Level::Info, "adb shell setprop debug.xr.thread.<render|pose|input|audio|control|worker|watcher> <coreMask|big>,<fifoPriority>,<nice>");
+}
+
+// Thread policies have to be in place before the threads of the role are created.
+void UpdateThreadPoliciesFromSystemProperties() {
+    for (uint32_t i = 0; i < (uint32_t)ThreadRole::Count; i++) {
+        const ThreadRole role = (ThreadRole)i;
+        std::string name = ThreadRoles::ToString(role);
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+
+        char value[PROP_VALUE_MAX] = {};
+        if (__system_property_get(("debug.xr.thread." + name).c_str(), value) == 0) {
+            continue;
+        }
+        ThreadPolicy policy;
+        if (ThreadRoles::ParsePolicy(value, &policy)) {
+            ThreadRoles::Configure(role, policy);
+        } else {
+            Log::Write(Log::Level::Warning, Fmt("Ignoring debug.xr.thread.%s=%s", name.c_str(), value));
+            ShowHelp();
+        }
+    }
 }
 
 bool UpdateOptionsFromSystemProperties(Options& options) {
@@ -125,6 +151,7 @@ static int32_t onInputEvent(struct android_app* app, AInputEvent* event){
 #endif
 
 void android_main(struct android_app* app) {
+    Startup::MarkLaunch();
     ALOGE("%s", "ALOGE ------------------ MAIN.CPP -----------------");
     ALOGI("%s", "ALOGI ------------------ MAIN.CPP -----------------");
     ALOGV("%s", "ALOGV ------------------ MAIN.CPP -----------------");
@@ -137,6 +164,10 @@ void android_main(struct android_app* app) {
         JNIEnv* Env;
         app->activity->vm->AttachCurrentThread(&Env, nullptr);
 
+        // After AttachCurrentThread, which resets the thread name.
+        UpdateThreadPoliciesFromSystemProperties();
+        ThreadRoles::Apply(ThreadRole::Render);
+
         AndroidAppState appState = {};
 
         app->userData = &appState;
@@ -147,6 +178,9 @@ void android_main(struct android_app* app) {
         if (!UpdateOptionsFromSystemProperties(*options)) {
             return;
         }
+        if (app->activity->internalDataPath != nullptr) {
+            options->CacheDirectory = app->activity->internalDataPath;
+        }
 
         std::shared_ptr<PlatformData> data = std::make_shared<PlatformData>();
         data->applicationVM = app->activity->vm;
@@ -167,6 +201,20 @@ void android_main(struct android_app* app) {
         program->CreateCloudxrClient();
         appState.program = program;
 
+        // Shared with the client's wake callback, which is cleared again before the waker is detached on every way out
+        // of this scope. The client threads then neither write to a closed fd nor drop the last reference.
+        std::shared_ptr<LoopWaker> waker = std::make_shared<LoopWaker>();
+        waker->Attach(app->looper);
+        program->SetMainLoopWake([waker]() { waker->Wake(); });
+        struct WakeRegistration {
+            ~WakeRegistration() {
+                program->SetMainLoopWake(nullptr);
+                waker->Detach();
+            }
+            IOpenXrProgram* program;
+            LoopWaker* waker;
+        } wakeRegistration{program.get(), waker.get()};
+
         // Initialize the loader for this platform
         PFN_xrInitializeLoaderKHR initializeLoader = nullptr;
         if (XR_SUCCEEDED(xrGetInstanceProcAddr(XR_NULL_HANDLE, "xrInitializeLoaderKHR", (PFN_xrVoidFunction*)(&initializeLoader)))) {
@@ -179,24 +227,42 @@ void android_main(struct android_app* app) {
             initializeLoader((const XrLoaderInitInfoBaseHeaderKHR*)&loaderInitInfoAndroid);
         }
 
-        program->CreateInstance();
-        program->InitializeSystem();
-        program->InitializeSession();
-        program->CreateSwapchains();
-        program->StartCloudxrClient();
+        // Instance, system, session and swapchains stay on this thread in order, the EGL context is made current here.
+        // Client preparation overlaps with them on the pool and the diagnostic enumeration runs after the session exists.
+        ThreadPool startupPool(2);
+        StartupGraph startup(startupPool);
+        const auto prepareClient = startup.Add("PrepareCloudxrClient", StartupGraph::Affinity::Pool, {}, [&]() { program->PrepareCloudxrClient(); });
+        const auto instance = startup.Add("CreateInstance", StartupGraph::Affinity::MainThread, {}, [&]() { program->CreateInstance(); });
+        const auto system = startup.Add("InitializeSystem", StartupGraph::Affinity::MainThread, {instance}, [&]() { program->InitializeSystem(); });
+        const auto session = startup.Add("InitializeSession", StartupGraph::Affinity::MainThread, {system}, [&]() { program->InitializeSession(); });
+        const auto swapchains = startup.Add("CreateSwapchains", StartupGraph::Affinity::MainThread, {session}, [&]() { program->CreateSwapchains(); });
+        startup.Add("StartCloudxrClient", StartupGraph::Affinity::MainThread, {swapchains, prepareClient}, [&]() { program->StartCloudxrClient(); });
+        startup.Add("LogDiagnostics", StartupGraph::Affinity::Pool, {session}, [&]() { program->LogDiagnostics(); }, StartupGraph::Priority::Deferred);
+        startup.Run();
 
+        IdlePollBackoff idlePoll;
+        int64_t idleWakeNs = 0;
         while (app->destroyRequested == 0) {
-            // Read all pending events.
+            // Read all pending events. Only the first poll of an idle iteration blocks, the rest drain what is queued.
+            bool woken = false;
             for (;;) {
                 int events;
                 struct android_poll_source* source;
                 // If the timeout is zero, returns immediately without blocking.
                 // If the timeout is negative, waits indefinitely until an event appears.
-                const int timeoutMilliseconds = (!appState.Resumed && !program->IsSessionRunning() && app->destroyRequested == 0) ? -1 : 0;
-                if (ALooper_pollAll(timeoutMilliseconds, nullptr, &events, (void**)&source) < 0) {
+                int timeoutMilliseconds = 0;
+                if (!woken && !program->IsSessionRunning() && app->destroyRequested == 0) {
+                    timeoutMilliseconds = appState.Resumed ? idlePoll.GetTimeoutMs() : -1;
+                }
+                const int ident = ALooper_pollAll(timeoutMilliseconds, nullptr, &events, (void**)&source);
+                if (ident < 0) {
                     break;
                 }
+                woken = true;
 
+                if (ident == LoopWaker::LooperId) {
+                    waker->Drain();
+                }
                 // Process this event.
                 if (source != nullptr) {
                     source->process(app, source);
@@ -210,13 +276,21 @@ void android_main(struct android_app* app) {
             }
 
             if (!program->IsSessionRunning()) {
-                // Throttle loop since xrWaitFrame won't be called.
-                std::this_thread::sleep_for(std::chrono::milliseconds(250));
+                if (woken && idleWakeNs == 0) {
+                    idleWakeNs = Clock::NowNs();
+                }
+                idlePoll.OnIdle(woken);
                 continue;
             }
+            idlePoll.Reset();
 
             program->PollActions();
             program->RenderFrame();
+
+            if (idleWakeNs != 0) {
+                Log::Write(Log::Level::Info, Fmt("First frame %.1f ms after the idle loop was woken", Clock::NsToMs(Clock::NowNs() - idleWakeNs)));
+                idleWakeNs = 0;
+            }
         }
         app->activity->vm->DetachCurrentThread();
     }
@@ -44,6 +44,12 @@ DESCRIPTION
 
 All matrices are column-major.
 
+Define XR_LINEAR_USE_SIMD before including this header to compile the matrix multiply,
+rigid body inverse, vector transform and bounds helpers with NEON (arm64) or SSE4.1/AVX
+(x86) intrinsics. The function signatures are the same for both backends and the scalar
+code is used when the target does not provide one of these instruction sets. The arm64
+Android build defines it; app/src/test/cpp cross-checks both backends and benchmarks them.
+
 INTERFACE
 =========
 
@@ -104,6 +110,10 @@ inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMa
 inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
                                                 const XrVector3f* mins, const XrVector3f* maxs);
 inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs);
+inline static void XrMatrix4x4f_TransformBoundsArray(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
+                                                     const XrVector3f* mins, const XrVector3f* maxs, const int count);
+inline static int XrMatrix4x4f_CullBoundsArray(bool* culled, const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs,
+                                               const int count);
 
 ================================================================================================
 */
@@ -112,6 +122,20 @@ inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVect
 #include <math.h>
 #include <stdbool.h>
 
+#if defined(XR_LINEAR_USE_SIMD)
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define XR_LINEAR_SIMD_NEON 1
+#elif defined(__SSE4_1__)
+#include <immintrin.h>
+#define XR_LINEAR_SIMD_SSE 1
+#endif
+#endif
+
+#if defined(XR_LINEAR_SIMD_NEON) || defined(XR_LINEAR_SIMD_SSE)
+#define XR_LINEAR_SIMD 1
+#endif
+
 #define MATH_PI 3.14159265358979323846f
 
 #define DEFAULT_NEAR_Z 0.015625f  // exact floating point representation
@@ -133,6 +157,68 @@ struct XrMatrix4x4f {
     float m[16];
 };
 
+#if defined(XR_LINEAR_SIMD)
+
+// Four packed floats, typically one matrix column loaded with XrSimd4f_Load(&matrix->m[4 * column]).
+#if defined(XR_LINEAR_SIMD_NEON)
+typedef float32x4_t XrSimd4f;
+
+inline static XrSimd4f XrSimd4f_Load(const float* src) { return vld1q_f32(src); }
+inline static void XrSimd4f_Store(float* dst, const XrSimd4f v) { vst1q_f32(dst, v); }
+inline static XrSimd4f XrSimd4f_Set(const float x, const float y, const float z, const float w) {
+    const float v[4] = {x, y, z, w};
+    return vld1q_f32(v);
+}
+inline static XrSimd4f XrSimd4f_Splat(const float value) { return vdupq_n_f32(value); }
+inline static XrSimd4f XrSimd4f_Add(const XrSimd4f a, const XrSimd4f b) { return vaddq_f32(a, b); }
+inline static XrSimd4f XrSimd4f_Sub(const XrSimd4f a, const XrSimd4f b) { return vsubq_f32(a, b); }
+inline static XrSimd4f XrSimd4f_Mul(const XrSimd4f a, const XrSimd4f b) { return vmulq_f32(a, b); }
+inline static XrSimd4f XrSimd4f_MulScalar(const XrSimd4f a, const float s) { return vmulq_n_f32(a, s); }
+// Returns a + b * s.
+inline static XrSimd4f XrSimd4f_MulAddScalar(const XrSimd4f a, const XrSimd4f b, const float s) { return vmlaq_n_f32(a, b, s); }
+inline static XrSimd4f XrSimd4f_Abs(const XrSimd4f a) { return vabsq_f32(a); }
+inline static XrSimd4f XrSimd4f_Negate(const XrSimd4f a) { return vnegq_f32(a); }
+// Returns true if any lane of 'a' is greater than the same lane of 'b'.
+inline static bool XrSimd4f_AnyGreater(const XrSimd4f a, const XrSimd4f b) {
+    const uint32x4_t mask = vcgtq_f32(a, b);
+#if defined(__aarch64__)
+    return vmaxvq_u32(mask) != 0;
+#else
+    const uint32x2_t half = vorr_u32(vget_low_u32(mask), vget_high_u32(mask));
+    return (vget_lane_u32(half, 0) | vget_lane_u32(half, 1)) != 0;
+#endif
+}
+#elif defined(XR_LINEAR_SIMD_SSE)
+typedef __m128 XrSimd4f;
+
+inline static XrSimd4f XrSimd4f_Load(const float* src) { return _mm_loadu_ps(src); }
+inline static void XrSimd4f_Store(float* dst, const XrSimd4f v) { _mm_storeu_ps(dst, v); }
+inline static XrSimd4f XrSimd4f_Set(const float x, const float y, const float z, const float w) { return _mm_setr_ps(x, y, z, w); }
+inline static XrSimd4f XrSimd4f_Splat(const float value) { return _mm_set1_ps(value); }
+inline static XrSimd4f XrSimd4f_Add(const XrSimd4f a, const XrSimd4f b) { return _mm_add_ps(a, b); }
+inline static XrSimd4f XrSimd4f_Sub(const XrSimd4f a, const XrSimd4f b) { return _mm_sub_ps(a, b); }
+inline static XrSimd4f XrSimd4f_Mul(const XrSimd4f a, const XrSimd4f b) { return _mm_mul_ps(a, b); }
+inline static XrSimd4f XrSimd4f_MulScalar(const XrSimd4f a, const float s) { return _mm_mul_ps(a, _mm_set1_ps(s)); }
+// Returns a + b * s.
+inline static XrSimd4f XrSimd4f_MulAddScalar(const XrSimd4f a, const XrSimd4f b, const float s) {
+    return _mm_add_ps(a, _mm_mul_ps(b, _mm_set1_ps(s)));
+}
+inline static XrSimd4f XrSimd4f_Abs(const XrSimd4f a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline static XrSimd4f XrSimd4f_Negate(const XrSimd4f a) { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+// Returns true if any lane of 'a' is greater than the same lane of 'b'.
+inline static bool XrSimd4f_AnyGreater(const XrSimd4f a, const XrSimd4f b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)) != 0; }
+#endif
+
+inline static void XrSimd4f_StoreVector3f(XrVector3f* dst, const XrSimd4f v) {
+    float tmp[4];
+    XrSimd4f_Store(tmp, v);
+    dst->x = tmp[0];
+    dst->y = tmp[1];
+    dst->z = tmp[2];
+}
+
+#endif  // XR_LINEAR_SIMD
+
 inline static float XrRcpSqrt(const float x) {
     const float SMALLEST_NON_DENORMAL = 1.1754943508222875e-038f;  // ( 1U << 23 )
     const float rcp = (x >= SMALLEST_NON_DENORMAL) ? 1.0f / sqrtf(x) : 1.0f;
@@ -240,6 +326,19 @@ inline static void XrQuaternionf_Multiply(XrQuaternionf* result, const XrQuatern
 
 // Use left-multiplication to accumulate transformations.
 inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b) {
+#if defined(XR_LINEAR_SIMD)
+    const XrSimd4f a0 = XrSimd4f_Load(&a->m[0]);
+    const XrSimd4f a1 = XrSimd4f_Load(&a->m[4]);
+    const XrSimd4f a2 = XrSimd4f_Load(&a->m[8]);
+    const XrSimd4f a3 = XrSimd4f_Load(&a->m[12]);
+    for (int i = 0; i < 4; i++) {
+        XrSimd4f column = XrSimd4f_MulScalar(a0, b->m[4 * i + 0]);
+        column = XrSimd4f_MulAddScalar(column, a1, b->m[4 * i + 1]);
+        column = XrSimd4f_MulAddScalar(column, a2, b->m[4 * i + 2]);
+        column = XrSimd4f_MulAddScalar(column, a3, b->m[4 * i + 3]);
+        XrSimd4f_Store(&result->m[4 * i], column);
+    }
+#else
     result->m[0] = a->m[0] * b->m[0] + a->m[4] * b->m[1] + a->m[8] * b->m[2] + a->m[12] * b->m[3];
     result->m[1] = a->m[1] * b->m[0] + a->m[5] * b->m[1] + a->m[9] * b->m[2] + a->m[13] * b->m[3];
     result->m[2] = a->m[2] * b->m[0] + a->m[6] * b->m[1] + a->m[10] * b->m[2] + a->m[14] * b->m[3];
@@ -259,6 +358,7 @@ inline static void XrMatrix4x4f_Multiply(XrMatrix4x4f* result, const XrMatrix4x4
     result->m[13] = a->m[1] * b->m[12] + a->m[5] * b->m[13] + a->m[9] * b->m[14] + a->m[13] * b->m[15];
     result->m[14] = a->m[2] * b->m[12] + a->m[6] * b->m[13] + a->m[10] * b->m[14] + a->m[14] * b->m[15];
     result->m[15] = a->m[3] * b->m[12] + a->m[7] * b->m[13] + a->m[11] * b->m[14] + a->m[15] * b->m[15];
+#endif
 }
 
 // Creates the transpose of the given matrix.
@@ -320,6 +420,32 @@ inline static void XrMatrix4x4f_Invert(XrMatrix4x4f* result, const XrMatrix4x4f*
 
 // Calculates the inverse of a rigid body transform.
 inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMatrix4x4f* src) {
+#if defined(XR_LINEAR_SIMD)
+    // Transpose the upper 3x3 into the rows r0, r1 and r2 with a zero w component.
+#if defined(XR_LINEAR_SIMD_NEON)
+    const float32x4x4_t rows = vld4q_f32(src->m);
+    const XrSimd4f r0 = vsetq_lane_f32(0.0f, rows.val[0], 3);
+    const XrSimd4f r1 = vsetq_lane_f32(0.0f, rows.val[1], 3);
+    const XrSimd4f r2 = vsetq_lane_f32(0.0f, rows.val[2], 3);
+#else
+    XrSimd4f r0 = _mm_loadu_ps(&src->m[0]);
+    XrSimd4f r1 = _mm_loadu_ps(&src->m[4]);
+    XrSimd4f r2 = _mm_loadu_ps(&src->m[8]);
+    XrSimd4f r3 = _mm_loadu_ps(&src->m[12]);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    r0 = _mm_blend_ps(r0, _mm_setzero_ps(), 0x8);
+    r1 = _mm_blend_ps(r1, _mm_setzero_ps(), 0x8);
+    r2 = _mm_blend_ps(r2, _mm_setzero_ps(), 0x8);
+#endif
+    XrSimd4f translation = XrSimd4f_MulScalar(r0, src->m[12]);
+    translation = XrSimd4f_MulAddScalar(translation, r1, src->m[13]);
+    translation = XrSimd4f_MulAddScalar(translation, r2, src->m[14]);
+    translation = XrSimd4f_Add(XrSimd4f_Negate(translation), XrSimd4f_Set(0.0f, 0.0f, 0.0f, 1.0f));
+    XrSimd4f_Store(&result->m[0], r0);
+    XrSimd4f_Store(&result->m[4], r1);
+    XrSimd4f_Store(&result->m[8], r2);
+    XrSimd4f_Store(&result->m[12], translation);
+#else
     result->m[0] = src->m[0];
     result->m[1] = src->m[4];
     result->m[2] = src->m[8];
@@ -336,6 +462,7 @@ inline static void XrMatrix4x4f_InvertRigidBody(XrMatrix4x4f* result, const XrMa
     result->m[13] = -(src->m[4] * src->m[12] + src->m[5] * src->m[13] + src->m[6] * src->m[14]);
     result->m[14] = -(src->m[8] * src->m[12] + src->m[9] * src->m[13] + src->m[10] * src->m[14]);
     result->m[15] = 1.0f;
+#endif
 }
 
 // Creates an identity matrix.
@@ -457,6 +584,16 @@ inline static void XrMatrix4x4f_CreateFromQuaternion(XrMatrix4x4f* result, const
 // Creates a combined translation(rotation(scale(object))) matrix.
 inline static void XrMatrix4x4f_CreateTranslationRotationScale(XrMatrix4x4f* result, const XrVector3f* translation,
                                                                const XrQuaternionf* rotation, const XrVector3f* scale) {
+#if defined(XR_LINEAR_SIMD)
+    // translation * rotation * scale only scales the rotation columns and replaces the last column.
+    XrMatrix4x4f rotationMatrix;
+    XrMatrix4x4f_CreateFromQuaternion(&rotationMatrix, rotation);
+
+    XrSimd4f_Store(&result->m[0], XrSimd4f_MulScalar(XrSimd4f_Load(&rotationMatrix.m[0]), scale->x));
+    XrSimd4f_Store(&result->m[4], XrSimd4f_MulScalar(XrSimd4f_Load(&rotationMatrix.m[4]), scale->y));
+    XrSimd4f_Store(&result->m[8], XrSimd4f_MulScalar(XrSimd4f_Load(&rotationMatrix.m[8]), scale->z));
+    XrSimd4f_Store(&result->m[12], XrSimd4f_Set(translation->x, translation->y, translation->z, 1.0f));
+#else
     XrMatrix4x4f scaleMatrix;
     XrMatrix4x4f_CreateScale(&scaleMatrix, scale->x, scale->y, scale->z);
 
@@ -469,6 +606,7 @@ inline static void XrMatrix4x4f_CreateTranslationRotationScale(XrMatrix4x4f* res
     XrMatrix4x4f combinedMatrix;
     XrMatrix4x4f_Multiply(&combinedMatrix, &rotationMatrix, &scaleMatrix);
     XrMatrix4x4f_Multiply(result, &translationMatrix, &combinedMatrix);
+#endif
 }
 
 // Creates a projection matrix based on the specified dimensions.
@@ -688,11 +826,23 @@ inline static void XrMatrix4x4f_GetScale(XrVector3f* result, const XrMatrix4x4f*
 
 // Transforms a 3D vector.
 inline static void XrMatrix4x4f_TransformVector3f(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v) {
+#if defined(XR_LINEAR_SIMD)
+    XrSimd4f r = XrSimd4f_MulAddScalar(XrSimd4f_Load(&m->m[12]), XrSimd4f_Load(&m->m[0]), v->x);
+    r = XrSimd4f_MulAddScalar(r, XrSimd4f_Load(&m->m[4]), v->y);
+    r = XrSimd4f_MulAddScalar(r, XrSimd4f_Load(&m->m[8]), v->z);
+    float tmp[4];
+    XrSimd4f_Store(tmp, r);
+    const float rcpW = 1.0f / tmp[3];
+    result->x = tmp[0] * rcpW;
+    result->y = tmp[1] * rcpW;
+    result->z = tmp[2] * rcpW;
+#else
     const float w = m->m[3] * v->x + m->m[7] * v->y + m->m[11] * v->z + m->m[15];
     const float rcpW = 1.0f / w;
     result->x = (m->m[0] * v->x + m->m[4] * v->y + m->m[8] * v->z + m->m[12]) * rcpW;
     result->y = (m->m[1] * v->x + m->m[5] * v->y + m->m[9] * v->z + m->m[13]) * rcpW;
     result->z = (m->m[2] * v->x + m->m[6] * v->y + m->m[10] * v->z + m->m[14]) * rcpW;
+#endif
 }
 
 // Transforms a 4D vector.
@@ -703,11 +853,36 @@ inline static void XrMatrix4x4f_TransformVector4f(XrVector4f* result, const XrMa
     result->w = m->m[3] * v->x + m->m[7] * v->y + m->m[11] * v->z + m->m[15] * v->w;
 }
 
+#if defined(XR_LINEAR_SIMD)
+// Transforms the 'mins' and 'maxs' bounds with the matrix columns c0, c1, c2 and c3.
+inline static void XrMatrix4x4f_TransformBoundsColumns(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrSimd4f c0,
+                                                       const XrSimd4f c1, const XrSimd4f c2, const XrSimd4f c3,
+                                                       const XrVector3f* mins, const XrVector3f* maxs) {
+    const XrVector3f center = {(mins->x + maxs->x) * 0.5f, (mins->y + maxs->y) * 0.5f, (mins->z + maxs->z) * 0.5f};
+    const XrVector3f extents = {maxs->x - center.x, maxs->y - center.y, maxs->z - center.z};
+
+    XrSimd4f newCenter = XrSimd4f_MulAddScalar(c3, c0, center.x);
+    newCenter = XrSimd4f_MulAddScalar(newCenter, c1, center.y);
+    newCenter = XrSimd4f_MulAddScalar(newCenter, c2, center.z);
+
+    XrSimd4f newExtents = XrSimd4f_Abs(XrSimd4f_MulScalar(c0, extents.x));
+    newExtents = XrSimd4f_Add(newExtents, XrSimd4f_Abs(XrSimd4f_MulScalar(c1, extents.y)));
+    newExtents = XrSimd4f_Add(newExtents, XrSimd4f_Abs(XrSimd4f_MulScalar(c2, extents.z)));
+
+    XrSimd4f_StoreVector3f(resultMins, XrSimd4f_Sub(newCenter, newExtents));
+    XrSimd4f_StoreVector3f(resultMaxs, XrSimd4f_Add(newCenter, newExtents));
+}
+#endif
+
 // Transforms the 'mins' and 'maxs' bounds with the given 'matrix'.
 inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
                                                 const XrVector3f* mins, const XrVector3f* maxs) {
     assert(XrMatrix4x4f_IsAffine(matrix, 1e-4f));
 
+#if defined(XR_LINEAR_SIMD)
+    XrMatrix4x4f_TransformBoundsColumns(resultMins, resultMaxs, XrSimd4f_Load(&matrix->m[0]), XrSimd4f_Load(&matrix->m[4]),
+                                        XrSimd4f_Load(&matrix->m[8]), XrSimd4f_Load(&matrix->m[12]), mins, maxs);
+#else
     const XrVector3f center = {(mins->x + maxs->x) * 0.5f, (mins->y + maxs->y) * 0.5f, (mins->z + maxs->z) * 0.5f};
     const XrVector3f extents = {maxs->x - center.x, maxs->y - center.y, maxs->z - center.z};
     const XrVector3f newCenter = {matrix->m[0] * center.x + matrix->m[4] * center.y + matrix->m[8] * center.z + matrix->m[12],
@@ -719,14 +894,72 @@ inline static void XrMatrix4x4f_TransformBounds(XrVector3f* resultMins, XrVector
         fabsf(extents.x * matrix->m[2]) + fabsf(extents.y * matrix->m[6]) + fabsf(extents.z * matrix->m[10])};
     XrVector3f_Sub(resultMins, &newCenter, &newExtents);
     XrVector3f_Add(resultMaxs, &newCenter, &newExtents);
+#endif
 }
 
+#if defined(XR_LINEAR_SIMD)
+// The four lane corner test of XrMatrix4x4f_CullBounds. 'xyColumns' holds mvp->m[0] to mvp->m[7] splatted to all
+// lanes, so culling an array of bounds splats them once.
+inline static bool XrMatrix4x4f_CullBoundsCorners(const XrSimd4f* xyColumns, const XrMatrix4x4f* mvp, const XrVector3f* mins,
+                                                  const XrVector3f* maxs) {
+    // One lane per corner, corners 0-3 use mins for z and corners 4-7 use maxs for z.
+    const XrSimd4f xs = XrSimd4f_Set(mins->x, maxs->x, mins->x, maxs->x);
+    const XrSimd4f ys = XrSimd4f_Set(mins->y, mins->y, maxs->y, maxs->y);
+    XrSimd4f lo[4];
+    XrSimd4f hi[4];
+    for (int k = 0; k < 4; k++) {
+        const XrSimd4f xy = XrSimd4f_Add(XrSimd4f_Mul(xs, xyColumns[k]), XrSimd4f_Mul(ys, xyColumns[4 + k]));
+        lo[k] = XrSimd4f_Add(xy, XrSimd4f_Splat(mins->z * mvp->m[8 + k] + mvp->m[12 + k]));
+        hi[k] = XrSimd4f_Add(xy, XrSimd4f_Splat(maxs->z * mvp->m[8 + k] + mvp->m[12 + k]));
+    }
+    const XrSimd4f loNegW = XrSimd4f_Negate(lo[3]);
+    const XrSimd4f hiNegW = XrSimd4f_Negate(hi[3]);
+    for (int k = 0; k < 3; k++) {
+        if (!XrSimd4f_AnyGreater(lo[k], loNegW) && !XrSimd4f_AnyGreater(hi[k], hiNegW)) {
+            return true;
+        }
+        if (!XrSimd4f_AnyGreater(lo[3], lo[k]) && !XrSimd4f_AnyGreater(hi[3], hi[k])) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+
 // Returns true if the 'mins' and 'maxs' bounds is completely off to one side of the projection matrix.
 inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs) {
     if (maxs->x <= mins->x && maxs->y <= mins->y && maxs->z <= mins->z) {
         return false;
     }
 
+#if defined(XR_LINEAR_SIMD_SSE) && defined(__AVX__)
+    // One lane per corner, corner i uses maxs for x if (i & 1), for y if (i & 2) and for z if (i & 4).
+    const __m256 xs = _mm256_setr_ps(mins->x, maxs->x, mins->x, maxs->x, mins->x, maxs->x, mins->x, maxs->x);
+    const __m256 ys = _mm256_setr_ps(mins->y, mins->y, maxs->y, maxs->y, mins->y, mins->y, maxs->y, maxs->y);
+    const __m256 zs = _mm256_setr_ps(mins->z, mins->z, mins->z, mins->z, maxs->z, maxs->z, maxs->z, maxs->z);
+    __m256 c[4];
+    for (int k = 0; k < 4; k++) {
+        c[k] = _mm256_add_ps(_mm256_mul_ps(xs, _mm256_set1_ps(mvp->m[k])), _mm256_mul_ps(ys, _mm256_set1_ps(mvp->m[4 + k])));
+        c[k] = _mm256_add_ps(c[k], _mm256_mul_ps(zs, _mm256_set1_ps(mvp->m[8 + k])));
+        c[k] = _mm256_add_ps(c[k], _mm256_set1_ps(mvp->m[12 + k]));
+    }
+    const __m256 negW = _mm256_xor_ps(c[3], _mm256_set1_ps(-0.0f));
+    for (int k = 0; k < 3; k++) {
+        if (_mm256_movemask_ps(_mm256_cmp_ps(c[k], negW, _CMP_GT_OQ)) == 0) {
+            return true;
+        }
+        if (_mm256_movemask_ps(_mm256_cmp_ps(c[3], c[k], _CMP_GT_OQ)) == 0) {
+            return true;
+        }
+    }
+    return false;
+#elif defined(XR_LINEAR_SIMD)
+    XrSimd4f xyColumns[8];
+    for (int k = 0; k < 8; k++) {
+        xyColumns[k] = XrSimd4f_Splat(mvp->m[k]);
+    }
+    return XrMatrix4x4f_CullBoundsCorners(xyColumns, mvp, mins, maxs);
+#else
     XrVector4f c[8];
     for (int i = 0; i < 8; i++) {
         const XrVector4f corner = {(i & 1) != 0 ? maxs->x : mins->x, (i & 2) != 0 ? maxs->y : mins->y,
@@ -782,6 +1015,52 @@ inline static bool XrMatrix4x4f_CullBounds(const XrMatrix4x4f* mvp, const XrVect
         }
     }
     return i == 8;
+#endif
+}
+
+// Transforms 'count' bounds with the same 'matrix'. The result arrays may be the same as the input arrays.
+inline static void XrMatrix4x4f_TransformBoundsArray(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix,
+                                                     const XrVector3f* mins, const XrVector3f* maxs, const int count) {
+    assert(XrMatrix4x4f_IsAffine(matrix, 1e-4f));
+
+#if defined(XR_LINEAR_SIMD)
+    const XrSimd4f c0 = XrSimd4f_Load(&matrix->m[0]);
+    const XrSimd4f c1 = XrSimd4f_Load(&matrix->m[4]);
+    const XrSimd4f c2 = XrSimd4f_Load(&matrix->m[8]);
+    const XrSimd4f c3 = XrSimd4f_Load(&matrix->m[12]);
+    for (int i = 0; i < count; i++) {
+        XrMatrix4x4f_TransformBoundsColumns(&resultMins[i], &resultMaxs[i], c0, c1, c2, c3, &mins[i], &maxs[i]);
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        XrMatrix4x4f_TransformBounds(&resultMins[i], &resultMaxs[i], matrix, &mins[i], &maxs[i]);
+    }
+#endif
+}
+
+// Culls 'count' bounds against the same 'mvp' matrix. Stores one result per bounds in 'culled' and
+// returns the number of bounds that are completely off to one side of the projection matrix.
+inline static int XrMatrix4x4f_CullBoundsArray(bool* culled, const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs,
+                                               const int count) {
+    int culledCount = 0;
+#if defined(XR_LINEAR_SIMD) && !(defined(XR_LINEAR_SIMD_SSE) && defined(__AVX__))
+    // The matrix columns are splatted once for the whole array. With AVX the eight corner test is faster as it is.
+    XrSimd4f xyColumns[8];
+    for (int k = 0; k < 8; k++) {
+        xyColumns[k] = XrSimd4f_Splat(mvp->m[k]);
+    }
+    for (int i = 0; i < count; i++) {
+        const bool empty = maxs[i].x <= mins[i].x && maxs[i].y <= mins[i].y && maxs[i].z <= mins[i].z;
+        culled[i] = !empty && XrMatrix4x4f_CullBoundsCorners(xyColumns, mvp, &mins[i], &maxs[i]);
+        culledCount += culled[i] ? 1 : 0;
+    }
+#else
+    for (int i = 0; i < count; i++) {
+        culled[i] = XrMatrix4x4f_CullBounds(mvp, &mins[i], &maxs[i]);
+        culledCount += culled[i] ? 1 : 0;
+    }
+#endif
+    return culledCount;
 }
 
 #endif  // XR_LINEAR_H_
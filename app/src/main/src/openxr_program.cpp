@@ -13,7 +13,18 @@
 #include <array>
 #include <cmath>
 #include <math.h>
+#include <condition_variable>
+#include <mutex>
 #include "cloudXRClient.h"
+#include "startup.h"
+#include "device_profile.h"
+#include "thread_policy.h"
+#include "clock.h"
+#include "haptics.h"
+#include "latch_scheduler.h"
+#include "half_rate.h"
+#include "performance_settings.h"
+#include "input_thread.h"
 
 namespace {
 
@@ -78,15 +89,6 @@ namespace {
     ////////////////////////////////////////////////////////
     ////////////////////////////////////////////////////////
 
-    typedef enum {
-    DeviceTypeNone = 0,
-    DeviceTypeNeo3,
-    DeviceTypeNeo3Pro,
-    DeviceTypeNeo3ProEye,
-    DeviceTypePico4,
-    DeviceTypePico4Pro,
-}DeviceType;
-
 #if !defined(XR_USE_PLATFORM_WIN32)
 #define strcpy_s(dest, source) strncpy((dest), (source), sizeof(dest))
 #endif
@@ -158,22 +160,22 @@ inline XrReferenceSpaceCreateInfo GetXrReferenceSpaceCreateInfo(const std::strin
     return referenceSpaceCreateInfo;
 }
 
-#ifndef CLOUDXR3_5
-    const int MAX_CONTROLLERS = 2;
-    cxrControllerHandle     m_newControllers[MAX_CONTROLLERS] = {};
-#endif
-
 struct OpenXrProgram : IOpenXrProgram {
     OpenXrProgram(const std::shared_ptr<Options>& options, const std::shared_ptr<IPlatformPlugin>& platformPlugin,
                   const std::shared_ptr<IGraphicsPlugin>& graphicsPlugin)
         : m_options(*options), m_platformPlugin(platformPlugin), m_graphicsPlugin(graphicsPlugin), m_isSupport_epic_view_configuration_fov_extention(false) {}
 
     ~OpenXrProgram() override {
+        StopInputThread();
+
         if (m_input.actionSet != XR_NULL_HANDLE) {
             for (auto hand : {Side::LEFT, Side::RIGHT}) {
                 xrDestroySpace(m_input.handSpace[hand]);
                 xrDestroySpace(m_input.aimSpace[hand]);
             }
+            if (m_input.gazeSpace != XR_NULL_HANDLE) {
+                xrDestroySpace(m_input.gazeSpace);
+            }
             xrDestroyActionSet(m_input.actionSet);
         }
 
@@ -190,6 +192,7 @@ struct OpenXrProgram : IOpenXrProgram {
         }
 
         if (m_instance != XR_NULL_HANDLE) {
+            Clock::InitializeXrTime(XR_NULL_HANDLE, false);
             xrDestroyInstance(m_instance);
         }
     }
@@ -211,9 +214,6 @@ struct OpenXrProgram : IOpenXrProgram {
             Log::Write(Log::Level::Info, Fmt("%sAvailable Extensions: (%d)", indentStr.c_str(), instanceExtensionCount));
             for (const XrExtensionProperties& extension : extensions) {
                 Log::Write(Log::Level::Info, Fmt("%sAvailable Extensions:  Name=%s version=%d", indentStr.c_str(), extension.extensionName, extension.extensionVersion));
-                if (strstr(extension.extensionName, XR_EPIC_VIEW_CONFIGURATION_FOV_EXTENSION_NAME)) {
-                    m_isSupport_epic_view_configuration_fov_extention = true;
-                }
             }
         };
 
@@ -242,6 +242,27 @@ struct OpenXrProgram : IOpenXrProgram {
         }
     }
 
+    // Only the runtime's own extension list is needed to build the instance, layer enumeration is left to LogDiagnostics.
+    void QueryInstanceExtensions() {
+        uint32_t instanceExtensionCount;
+        CHECK_XRCMD(xrEnumerateInstanceExtensionProperties(nullptr, 0, &instanceExtensionCount, nullptr));
+
+        std::vector<XrExtensionProperties> extensions(instanceExtensionCount, {XR_TYPE_EXTENSION_PROPERTIES});
+        CHECK_XRCMD(xrEnumerateInstanceExtensionProperties(nullptr, (uint32_t)extensions.size(), &instanceExtensionCount, extensions.data()));
+
+        for (const XrExtensionProperties& extension : extensions) {
+            if (strcmp(extension.extensionName, XR_EPIC_VIEW_CONFIGURATION_FOV_EXTENSION_NAME) == 0) {
+                m_isSupport_epic_view_configuration_fov_extention = true;
+            } else if (strcmp(extension.extensionName, XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME) == 0) {
+                m_isSupportConvertTimespecTime = true;
+            } else if (strcmp(extension.extensionName, XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME) == 0) {
+                m_isSupportPerformanceSettings = true;
+            } else if (strcmp(extension.extensionName, XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME) == 0) {
+                m_isSupportEyeGaze = true;
+            }
+        }
+    }
+
     void LogInstanceInfo() {
         CHECK(m_instance != XR_NULL_HANDLE);
 
@@ -271,6 +292,18 @@ struct OpenXrProgram : IOpenXrProgram {
             extensions.push_back(XR_EPIC_VIEW_CONFIGURATION_FOV_EXTENSION_NAME);
         }
 
+        if (m_isSupportConvertTimespecTime) {
+            extensions.push_back(XR_KHR_CONVERT_TIMESPEC_TIME_EXTENSION_NAME);
+        }
+
+        if (m_isSupportPerformanceSettings) {
+            extensions.push_back(XR_EXT_PERFORMANCE_SETTINGS_EXTENSION_NAME);
+        }
+
+        if (m_isSupportEyeGaze) {
+            extensions.push_back(XR_EXT_EYE_GAZE_INTERACTION_EXTENSION_NAME);
+        }
+
         XrInstanceCreateInfo createInfo{XR_TYPE_INSTANCE_CREATE_INFO};
         createInfo.next = m_platformPlugin->GetInstanceCreateExtension();
         createInfo.enabledExtensionCount = (uint32_t)extensions.size();
@@ -283,8 +316,9 @@ struct OpenXrProgram : IOpenXrProgram {
     }
 
     void CreateInstance() override {
-        LogLayersAndExtensions();
+        QueryInstanceExtensions();
         CreateInstanceInternal();
+        Clock::InitializeXrTime(m_instance, m_isSupportConvertTimespecTime);
         LogInstanceInfo();
     }
 
@@ -369,7 +403,8 @@ struct OpenXrProgram : IOpenXrProgram {
         CHECK(m_instance != XR_NULL_HANDLE);
         CHECK(m_systemId != XR_NULL_SYSTEM_ID);
 
-        LogViewConfigurations();
+        // Only validate the selected configuration here, the full listing is deferred to LogDiagnostics.
+        LogEnvironmentBlendMode(m_options.Parsed.ViewConfigType);
 
         // The graphics API can initialize the graphics device now that the systemId and instance
         // handle are available.
@@ -418,6 +453,10 @@ struct OpenXrProgram : IOpenXrProgram {
         XrAction XTouchAction{XR_NULL_HANDLE};
         XrAction YTouchAction{XR_NULL_HANDLE};
         XrAction menuAction{XR_NULL_HANDLE};
+
+        // Only created when the system reports eye gaze interaction.
+        XrAction gazeAction{XR_NULL_HANDLE};
+        XrSpace gazeSpace{XR_NULL_HANDLE};
     };
 
     void InitializeActions() {
@@ -639,7 +678,7 @@ struct OpenXrProgram : IOpenXrProgram {
         CHECK_XRCMD(xrStringToPath(m_instance, "/user/hand/left/input/x/touch",  &XTouchPath[Side::LEFT]));
         CHECK_XRCMD(xrStringToPath(m_instance, "/user/hand/left/input/y/touch",  &YTouchPath[Side::LEFT]));
 
-        if (m_deviceROM < 0x540) {
+        if (m_deviceROM < DEVICE_ROM_VERSION(5, 4, 0)) {
             CHECK_XRCMD(xrStringToPath(m_instance, "/user/hand/left/input/back/click", &menuPath[Side::LEFT]));
             CHECK_XRCMD(xrStringToPath(m_instance, "/user/hand/right/input/back/click", &menuPath[Side::RIGHT]));
         } else {
@@ -650,15 +689,7 @@ struct OpenXrProgram : IOpenXrProgram {
         // Suggest bindings for the PICO Controller.
         {
             //see https://registry.khronos.org/OpenXR/specs/1.0/html/xrspec.html#XR_BD_controller_interaction
-            const char* interactionProfilePath = nullptr;
-            if (m_deviceType == DeviceTypeNeo3 || m_deviceType == DeviceTypeNeo3Pro || m_deviceType == DeviceTypeNeo3ProEye) {
-                interactionProfilePath = "/interaction_profiles/bytedance/pico_neo3_controller";
-            } else if (m_deviceType == DeviceTypePico4 || m_deviceType == DeviceTypePico4Pro) {
-                interactionProfilePath = "/interaction_profiles/bytedance/pico4_controller";
-            } else
-            {
-                interactionProfilePath = "/interaction_profiles/bytedance/pico4s_controller";
-            }
+            const char* interactionProfilePath = m_deviceProfile->interactionProfile;
 //            if (m_deviceROM < 0x540) {
 //                interactionProfilePath = "/interaction_profiles/pico/neo3_controller";
 //            }
@@ -703,7 +734,7 @@ struct OpenXrProgram : IOpenXrProgram {
 
                                                             {m_input.menuAction, menuPath[Side::LEFT]}}};
 
-            if (m_deviceType == DeviceTypeNeo3 || m_deviceType == DeviceTypeNeo3Pro || m_deviceType == DeviceTypeNeo3ProEye) {
+            if (m_deviceProfile->menuOnBothHands) {
                 XrActionSuggestedBinding menuRightBinding{m_input.menuAction, menuPath[Side::RIGHT]};
                 bindings.push_back(menuRightBinding);
             }
@@ -730,12 +761,51 @@ struct OpenXrProgram : IOpenXrProgram {
         actionSpaceInfo.subactionPath = m_input.handSubactionPath[Side::RIGHT];
         CHECK_XRCMD(xrCreateActionSpace(m_session, &actionSpaceInfo, &m_input.aimSpace[Side::RIGHT]));
 
+        InitializeGazeAction();
+
         XrSessionActionSetsAttachInfo attachInfo{XR_TYPE_SESSION_ACTION_SETS_ATTACH_INFO};
         attachInfo.countActionSets = 1;
         attachInfo.actionSets = &m_input.actionSet;
         CHECK_XRCMD(xrAttachSessionActionSets(m_session, &attachInfo));
     }
 
+    // The extension can be there on headsets without eye tracking, the system property says whether it works. The
+    // binding lives in its own interaction profile next to the controller one.
+    void InitializeGazeAction() {
+        if (!m_isSupportEyeGaze) {
+            return;
+        }
+        XrSystemEyeGazeInteractionPropertiesEXT eyeGazeProperties{XR_TYPE_SYSTEM_EYE_GAZE_INTERACTION_PROPERTIES_EXT};
+        XrSystemProperties systemProperties{XR_TYPE_SYSTEM_PROPERTIES, &eyeGazeProperties};
+        CHECK_XRCMD(xrGetSystemProperties(m_instance, m_systemId, &systemProperties));
+        Log::Write(Log::Level::Info, Fmt("Eye gaze interaction: %s", eyeGazeProperties.supportsEyeGazeInteraction == XR_TRUE ? "supported" : "not supported"));
+        if (eyeGazeProperties.supportsEyeGazeInteraction != XR_TRUE) {
+            return;
+        }
+
+        XrActionCreateInfo actionInfo{XR_TYPE_ACTION_CREATE_INFO};
+        actionInfo.actionType = XR_ACTION_TYPE_POSE_INPUT;
+        strcpy_s(actionInfo.actionName, "gaze_pose");
+        strcpy_s(actionInfo.localizedActionName, "Gaze_pose");
+        CHECK_XRCMD(xrCreateAction(m_input.actionSet, &actionInfo, &m_input.gazeAction));
+
+        XrPath gazeProfilePath;
+        XrPath gazePosePath;
+        CHECK_XRCMD(xrStringToPath(m_instance, "/interaction_profiles/ext/eye_gaze_interaction", &gazeProfilePath));
+        CHECK_XRCMD(xrStringToPath(m_instance, "/user/eyes_ext/input/gaze_ext/pose", &gazePosePath));
+        XrActionSuggestedBinding binding{m_input.gazeAction, gazePosePath};
+        XrInteractionProfileSuggestedBinding suggestedBindings{XR_TYPE_INTERACTION_PROFILE_SUGGESTED_BINDING};
+        suggestedBindings.interactionProfile = gazeProfilePath;
+        suggestedBindings.suggestedBindings = &binding;
+        suggestedBindings.countSuggestedBindings = 1;
+        CHECK_XRCMD(xrSuggestInteractionProfileBindings(m_instance, &suggestedBindings));
+
+        XrActionSpaceCreateInfo actionSpaceInfo{XR_TYPE_ACTION_SPACE_CREATE_INFO};
+        actionSpaceInfo.action = m_input.gazeAction;
+        actionSpaceInfo.poseInActionSpace.orientation.w = 1.0f;
+        CHECK_XRCMD(xrCreateActionSpace(m_session, &actionSpaceInfo, &m_input.gazeSpace));
+    }
+
     void CreateVisualizedSpaces() {
         CHECK(m_session != XR_NULL_HANDLE);
         XrReferenceSpaceCreateInfo referenceSpaceCreateInfo{XR_TYPE_REFERENCE_SPACE_CREATE_INFO};
@@ -745,25 +815,23 @@ struct OpenXrProgram : IOpenXrProgram {
     }
 
     void GetDeviceInfo() {
-        char buffer[64] = {0};
+        char buffer[PROP_VALUE_MAX] = {0};
         __system_property_get("sys.pxr.product.name", buffer);
-        Log::Write(Log::Level::Info, Fmt("device is: %s", buffer));
-        if (std::string(buffer) == "Pico Neo 3 Pro Eye") {
-            m_deviceType = DeviceTypeNeo3ProEye;
-        } else if (std::string(buffer) == "Pico Neo 3 Pro") {
-            m_deviceType = DeviceTypeNeo3Pro;
-        } else if (std::string(buffer) == "Pico 4") {
-            m_deviceType = DeviceTypePico4;
-        }else if (std::string(buffer) == "PICO 4 Pro") {
-            m_deviceType = DeviceTypePico4Pro;
-        }
+        m_deviceProfile = &FindDeviceProfile(buffer);
+        m_deviceType = m_deviceProfile->type;
+        Log::Write(Log::Level::Info, Fmt("device is: %s%s", buffer, m_deviceType == DeviceTypeNone ? " (no profile, using defaults)" : ""));
 
+        memset(buffer, 0, sizeof(buffer));
         __system_property_get("ro.build.id", buffer);
-        int a, b, c;
-        sscanf(buffer, "%d.%d.%d",&a, &b, &c);
-        m_deviceROM = (a << 8) + (b << 4) + c;
-        Log::Write(Log::Level::Info, Fmt("device ROM: %x", m_deviceROM));
-        if (m_deviceROM < 0x540) {
+        unsigned int a = 0, b = 0, c = 0;
+        if (sscanf(buffer, "%u.%u.%u", &a, &b, &c) == 3) {
+            m_deviceROM = DEVICE_ROM_VERSION(a, b, c);
+        } else {
+            m_deviceROM = 0;
+            Log::Write(Log::Level::Warning, Fmt("Unrecognized ROM version '%s'", buffer));
+        }
+        Log::Write(Log::Level::Info, Fmt("device ROM: %u.%u.%u", a, b, c));
+        if (m_deviceROM < DEVICE_ROM_VERSION(5, 4, 0)) {
             //CHECK_XRRESULT(XR_ERROR_VALIDATION_FAILURE, "This demo can only run on devices with ROM version greater than 540");
         }
     }
@@ -782,9 +850,13 @@ struct OpenXrProgram : IOpenXrProgram {
             CHECK_XRCMD(xrCreateSession(m_instance, &createInfo, &m_session));
         }
 
+        if (m_isSupportPerformanceSettings) {
+            m_perfSettings.Initialize(m_instance, m_session);
+            m_perfSettings.SetStreaming(false);
+        }
+
         GetDeviceInfo();
         Log::Write(Log::Level::Error, Fmt("------------------ CLOUDXR InitializeSession() 0------------ "));
-        LogReferenceSpaces();
         Log::Write(Log::Level::Error, Fmt("------------------ CLOUDXR InitializeSession() 1------------ "));
         InitializeActions();
         Log::Write(Log::Level::Error, Fmt("------------------ CLOUDXR InitializeSession() 2------------ "));
@@ -797,7 +869,9 @@ struct OpenXrProgram : IOpenXrProgram {
         }
 
         CHECK_XRCMD(xrGetInstanceProcAddr(m_instance, "xrGetDisplayRefreshRateFB", (PFN_xrVoidFunction*)&m_pfnXrGetDisplayRefreshRateFB));
-        m_pfnXrGetDisplayRefreshRateFB(m_session, &m_displayRefreshRate);
+        if (XR_FAILED(m_pfnXrGetDisplayRefreshRateFB(m_session, &m_displayRefreshRate)) || m_displayRefreshRate <= 0.0f) {
+            m_displayRefreshRate = m_deviceProfile->defaultRefreshRate;
+        }
         Log::Write(Log::Level::Info, Fmt("device fps:%0.3f", m_displayRefreshRate));
     }
 
@@ -896,6 +970,8 @@ struct OpenXrProgram : IOpenXrProgram {
 
                 m_swapchainImages.insert(std::make_pair(swapchain.handle, std::move(swapchainImages)));
             }
+
+            m_graphicsPlugin->OnSwapchainsCreated();
         }
     }
 
@@ -942,6 +1018,21 @@ struct OpenXrProgram : IOpenXrProgram {
                     LogActionSourceName(m_input.gripPoseAction, "Pose");
                     LogActionSourceName(m_input.hapticAction, "Haptic");
                     break;
+                case XR_TYPE_EVENT_DATA_DISPLAY_REFRESH_RATE_CHANGED_FB: {
+                    const auto& rateChanged = *reinterpret_cast<const XrEventDataDisplayRefreshRateChangedFB*>(event);
+                    m_displayRefreshRate = rateChanged.toDisplayRefreshRate;
+                    if (m_cloudxr.get()) {
+                        m_cloudxr->OnDisplayRefreshRateChanged(rateChanged.toDisplayRefreshRate);
+                    }
+                    break;
+                }
+                case XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT: {
+                    const auto& perfSettings = *reinterpret_cast<const XrEventDataPerfSettingsEXT*>(event);
+                    if (m_perfSettings.OnNotification(perfSettings) && m_cloudxr.get()) {
+                        m_cloudxr->OnPerformancePressure(m_perfSettings.GetPressure());
+                    }
+                    break;
+                }
                 case XR_TYPE_EVENT_DATA_REFERENCE_SPACE_CHANGE_PENDING:
                 default: {
                     Log::Write(Log::Level::Verbose, Fmt("Ignoring event type %d", event->type));
@@ -970,11 +1061,16 @@ struct OpenXrProgram : IOpenXrProgram {
                 sessionBeginInfo.primaryViewConfigurationType = m_options.Parsed.ViewConfigType;
                 CHECK_XRCMD(xrBeginSession(m_session, &sessionBeginInfo));
                 m_sessionRunning = true;
+                StartInputThread();
                 break;
             }
             case XR_SESSION_STATE_STOPPING: {
                 CHECK(m_session != XR_NULL_HANDLE);
                 m_sessionRunning = false;
+                StopInputThread();
+                if (m_perfSettings.EndSession() && m_cloudxr.get()) {
+                    m_cloudxr->OnPerformancePressure(m_perfSettings.GetPressure());
+                }
                 CHECK_XRCMD(xrEndSession(m_session))
                 break;
             }
@@ -1036,23 +1132,114 @@ struct OpenXrProgram : IOpenXrProgram {
 
     bool IsSessionFocused() const override { return m_sessionState == XR_SESSION_STATE_FOCUSED; }
 
-    static uint64_t GetTimeInNS() {
-        struct timespec now;
-        clock_gettime(CLOCK_MONOTONIC, &now);
-        return ((uint64_t)(now.tv_sec * 1e9) + now.tv_nsec);
+    // Runs on the session thread, the CloudXR haptic callback only queues.
+    void ApplyHaptics() {
+        m_haptics.Dispatch(Clock::NowNs(), [this](const HapticCommand& command) {
+            XrHapticVibration vibration{XR_TYPE_HAPTIC_VIBRATION};
+            vibration.amplitude = command.amplitude;
+            vibration.duration = command.durationNs;
+            vibration.frequency = command.frequency > 0.0f ? command.frequency : XR_FREQUENCY_UNSPECIFIED;
+            XrHapticActionInfo hapticActionInfo{XR_TYPE_HAPTIC_ACTION_INFO};
+            hapticActionInfo.action = m_input.hapticAction;
+            hapticActionInfo.subactionPath = m_input.handSubactionPath[command.controller];
+            CHECK_XRCMD(xrApplyHapticFeedback(m_session, &hapticActionInfo, (XrHapticBaseHeader*)&vibration));
+        });
+
+        const uint32_t dropped = m_haptics.GetDroppedCount();
+        if (dropped != m_hapticsDropped) {
+            Log::Write(Log::Level::Warning, Fmt("%u haptic pulses dropped", dropped - m_hapticsDropped));
+            m_hapticsDropped = dropped;
+        }
+    }
+
+    // Grip pose and velocities of both controllers at the display time of the frame, in fixed left/right slots.
+    void SampleControllers(XrTime predictedDisplayTime, bool sampleAim, ControllerPoseSample (&controllers)[ControllerCount]) {
+        static_assert(ControllerCount == Side::COUNT, "one controller slot per hand");
+        ControllerSpaces spaces[ControllerCount];
+        for (auto hand : {Side::LEFT, Side::RIGHT}) {
+            spaces[hand] = {m_input.handSubactionPath[hand], m_input.handSpace[hand], m_input.aimSpace[hand]};
+        }
+        // The input thread may be in xrSyncActions, which updates the pose action states and their spaces.
+        std::lock_guard<std::mutex> inputLock(m_inputMutex);
+        SampleControllerPoses(m_session, m_input.gripPoseAction, spaces, m_appSpace, predictedDisplayTime, sampleAim, controllers);
+    }
+
+    // Gaze relative to the head at the display time of the frame. The sample time is when the tracker saw the eyes,
+    // which can be a little older.
+    GazeSample SampleGaze(XrTime predictedDisplayTime) {
+        GazeSample sample;
+        sample.timeNs = Clock::FromXrTime(predictedDisplayTime);
+        std::lock_guard<std::mutex> inputLock(m_inputMutex);
+
+        XrActionStateGetInfo getInfo{XR_TYPE_ACTION_STATE_GET_INFO};
+        getInfo.action = m_input.gazeAction;
+        XrActionStatePose poseState{XR_TYPE_ACTION_STATE_POSE};
+        CHECK_XRCMD(xrGetActionStatePose(m_session, &getInfo, &poseState));
+        if (poseState.isActive != XR_TRUE) {
+            return sample;
+        }
+
+        XrEyeGazeSampleTimeEXT sampleTime{XR_TYPE_EYE_GAZE_SAMPLE_TIME_EXT};
+        XrSpaceLocation location{XR_TYPE_SPACE_LOCATION, &sampleTime};
+        XrResult res = xrLocateSpace(m_input.gazeSpace, m_ViewSpace, predictedDisplayTime, &location);
+        CHECK_XRRESULT(res, "xrLocateSpace");
+        if (XR_UNQUALIFIED_SUCCESS(res) && (location.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0) {
+            sample.valid = true;
+            sample.direction = GazeDirection(location.pose.orientation);
+            if (sampleTime.time != 0) {
+                sample.timeNs = Clock::FromXrTime(sampleTime.time);
+            }
+        }
+        return sample;
     }
 
     void PollActions() override {
+        ApplyHaptics();
+
+        if (!UseInputThread()) {
+            SampleInput();
+        }
+    }
+
+    // With CloudXR 3.5 input travels in the tracking state, which the SDK polls no faster than poses, so sampling it
+    // faster than the frame rate gains nothing there.
+    bool UseInputThread() const {
+#ifdef CLOUDXR3_5
+        return false;
+#else
+        return m_cloudxr->GetInputRateHz() != 0 && !m_inputThread.HasFailed();
+#endif
+    }
+
+    // Runs for as long as the session does. xrSyncActions and every action state or action space query, on the input
+    // thread and in SampleControllers/SampleGaze on the render thread, hold m_inputMutex. Starting it after
+    // xrBeginSession and joining it before xrEndSession keeps it off the session outside that window.
+    void StartInputThread() {
+#ifndef CLOUDXR3_5
+        m_inputThread.Start();
+#endif
+    }
 
+    void StopInputThread() { m_inputThread.Stop(); }
+
+    // Event time of a changed input is when the runtime saw the change, not when it was read, which may be up to one
+    // sampling period later.
+    template <typename ActionState>
+    static uint64_t EventTimeNs(const ActionState& state, uint64_t sampleNs) {
+        if (state.changedSinceLastSync == XR_TRUE && state.lastChangeTime != 0) {
+            return (uint64_t)Clock::FromXrTime(state.lastChangeTime);
+        }
+        return sampleNs;
+    }
+
+    // Render thread or input thread.
+    void SampleInput() {
+        std::lock_guard<std::mutex> inputLock(m_inputMutex);
         if(m_cloudxr->GetClientState() != cxrClientState_StreamingSessionInProgress) {
             //Log::Write(Log::Level::Info, Fmt("CloudXR PollActions() return ") );
             return;
         }
 
-        Log::Write(Log::Level::Info,
-                   Fmt("CloudXR PollActions() ... ") );
-        const cxrReceiverHandle Receiver = m_cloudxr->GetReceiver();
-
         // Sync actions
         const XrActiveActionSet activeActionSet{m_input.actionSet, XR_NULL_PATH};
         XrActionsSyncInfo syncInfo{XR_TYPE_ACTIONS_SYNC_INFO};
@@ -1070,13 +1257,10 @@ struct OpenXrProgram : IOpenXrProgram {
 
         // Get pose and grab action state and start haptic vibrate when hand is 90% squeezed.
         for (auto hand : {Side::LEFT, Side::RIGHT}) {
-            Log::Write(Log::Level::Info,
-                       Fmt("CloudXR PollActions() left + right ") );
 #ifndef CLOUDXR3_5
             const int handIndex = hand == Side::LEFT ? 0 : (Side::RIGHT ? 1:-1);
-            Log::Write(Log::Level::Info,
-                       Fmt("CloudXR PollActions() cxrAddController() Existing>> handIndex:<%d> address:<%d> ", handIndex, &m_newControllers[handIndex]) );
-            if (!m_newControllers[handIndex]) // null, so open to create+add
+            // Axes are only sent when they move, a newly added controller gets all of them once.
+            bool resync = false;
             {
                 cxrControllerDesc desc = {};
                 //desc.id = capsHeader.DeviceID; // turns out this is NOT UNIQUE.  it's a fixed starting number, incremented, and thus devices can 'swap' IDs.
@@ -1086,34 +1270,13 @@ struct OpenXrProgram : IOpenXrProgram {
                 desc.inputCount = inputCountQuest;
                 desc.inputPaths = inputPathsQuest;
                 desc.inputValueTypes = inputValueTypesQuest;
-#if false
-                CXR_LOGI("Adding controller index %u, ID %llu, role %s", handIndex, desc.id, desc.role);
-                CXR_LOGI("Controller caps bits = 0x%08x", capsHeader.DeviceID, remoteCaps.ControllerCapabilities);
-#else
-                Log::Write( Log::Level::Info, Fmt("Adding controller index %u, ID %llu, role %s", handIndex, desc.id, desc.role) );
-                //Log::Write(Log::Level::Info,Fmt("Controller caps bits = 0x%08x"), capsHeader.DeviceID, remoteCaps.ControllerCapabilities);
-#endif
-                Log::Write(Log::Level::Info,
-                           Fmt("CloudXR PollActions() cxrAddController()... %d ", handIndex) );
-                cxrError e = cxrAddController(Receiver, &desc, &m_newControllers[handIndex]);
-                if (e!=cxrError_Success)
-                {
-                    Log::Write(Log::Level::Info,
-                               Fmt("CloudXR PollActions() cxrAddController() error ") );
-#if false
-                    CXR_LOGE("Error adding controller: %s", cxrErrorString(e));
-#else
-                    Log::Write(Log::Level::Info, Fmt("Error adding controller: %s", cxrErrorString(e)) );
-#endif
-                    // TODO!!! proper example for client to handle client-call errors, fatal vs 'notice'.
+                // Added again to every new receiver, the handles of a torn down one are gone with it.
+                if (!m_cloudxr->EnsureController(handIndex, desc, &resync)) {
                     continue;
-                } else {
-                    Log::Write(Log::Level::Info,
-                               Fmt("CloudXR PollActions() cxrAddController() handIndex:<%d> address:<%d> ", handIndex, &m_newControllers[handIndex]) );
                 }
             }
 #endif
-            const uint64_t inputTimeNS = GetTimeInNS();
+            const uint64_t inputTimeNS = (uint64_t)Clock::NowNs();
 
             XrActionStateGetInfo getInfo{XR_TYPE_ACTION_STATE_GET_INFO};
             getInfo.subactionPath = m_input.handSubactionPath[hand];
@@ -1128,9 +1291,9 @@ struct OpenXrProgram : IOpenXrProgram {
 #ifdef CLOUDXR3_5
                         trackingState.controller[hand].booleanComps |= 1UL << cxrButton_System;
 #else
-                        Log::Write(Log::Level::Info, Fmt("pico keyevent menu %d", hand));
+                        Log::Write(Log::Level::Verbose, Fmt("pico keyevent menu %d", hand));
                         cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                        e.clientTimeNS = inputTimeNS;
+                        e.clientTimeNS = EventTimeNs(menuValue, inputTimeNS);
                         e.clientInputIndex = 1;
                         e.inputValue.valueType = cxrInputValueType_boolean;
                         e.inputValue.vBool = menuValue.currentState == XR_TRUE ? cxrTrue : cxrFalse;
@@ -1148,21 +1311,23 @@ struct OpenXrProgram : IOpenXrProgram {
                 trackingState.controller[hand].scalarComps[cxrAnalog_JoystickX] = thumbstickValue.currentState.x;
                 trackingState.controller[hand].scalarComps[cxrAnalog_JoystickY] = thumbstickValue.currentState.y;
 #else
-                Log::Write(Log::Level::Info, Fmt("pico keyevent thumbstick x %f y %f", thumbstickValue.currentState.x, thumbstickValue.currentState.y));
-                {
-                    cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                    e.clientTimeNS = inputTimeNS;
-                    e.clientInputIndex = 10;
-                    e.inputValue.valueType = cxrInputValueType_float32;
-                    e.inputValue.vF32 = thumbstickValue.currentState.x;// input.Joystick.x;
-                }
+                if (thumbstickValue.changedSinceLastSync == XR_TRUE || resync) {
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent thumbstick x %f y %f", thumbstickValue.currentState.x, thumbstickValue.currentState.y));
+                    {
+                        cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
+                        e.clientTimeNS = EventTimeNs(thumbstickValue, inputTimeNS);
+                        e.clientInputIndex = 10;
+                        e.inputValue.valueType = cxrInputValueType_float32;
+                        e.inputValue.vF32 = thumbstickValue.currentState.x;// input.Joystick.x;
+                    }
 
-                {
-                    cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                    e.clientTimeNS = inputTimeNS;
-                    e.clientInputIndex = 11;
-                    e.inputValue.valueType = cxrInputValueType_float32;
-                    e.inputValue.vF32 = thumbstickValue.currentState.y;// input.Joystick.x;
+                    {
+                        cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
+                        e.clientTimeNS = EventTimeNs(thumbstickValue, inputTimeNS);
+                        e.clientInputIndex = 11;
+                        e.inputValue.valueType = cxrInputValueType_float32;
+                        e.inputValue.vF32 = thumbstickValue.currentState.y;// input.Joystick.x;
+                    }
                 }
 #endif
             }
@@ -1172,9 +1337,9 @@ struct OpenXrProgram : IOpenXrProgram {
             CHECK_XRCMD(xrGetActionStateBoolean(m_session, &getInfo, &thumbstickClick));
             if ((thumbstickClick.isActive == XR_TRUE) && (thumbstickClick.changedSinceLastSync == XR_TRUE)) {
                 if (thumbstickClick.currentState == XR_TRUE) {
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent thumbstick pressed %d",hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent thumbstick pressed %d",hand));
                 } else {
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent thumbstick released %d",hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent thumbstick released %d",hand));
                 }
             }
             // thumbstick touch
@@ -1183,7 +1348,7 @@ struct OpenXrProgram : IOpenXrProgram {
             CHECK_XRCMD(xrGetActionStateBoolean(m_session, &getInfo, &thumbstickTouch));
             if (thumbstickTouch.isActive == XR_TRUE) {
                 if (thumbstickTouch.changedSinceLastSync == XR_TRUE && thumbstickTouch.currentState == XR_TRUE) {
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent thumbstick click %d", hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent thumbstick click %d", hand));
                 }
             }
 
@@ -1195,12 +1360,14 @@ struct OpenXrProgram : IOpenXrProgram {
 #ifdef CLOUDXR3_5
                 trackingState.controller[hand].scalarComps[cxrAnalog_Trigger] = triggerValue.currentState;
 #else
-                Log::Write(Log::Level::Info, Fmt("pico keyevent trigger value %f", triggerValue.currentState));
-                cxrControllerEvent& e = events[handIndex][eventCount[handIndex]++];
-                e.clientTimeNS = inputTimeNS;
-                e.clientInputIndex = 4;
-                e.inputValue.valueType = cxrInputValueType_float32;
-                e.inputValue.vF32 = triggerValue.currentState;//input.IndexTrigger;
+                if (triggerValue.changedSinceLastSync == XR_TRUE || resync) {
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent trigger value %f", triggerValue.currentState));
+                    cxrControllerEvent& e = events[handIndex][eventCount[handIndex]++];
+                    e.clientTimeNS = EventTimeNs(triggerValue, inputTimeNS);
+                    e.clientInputIndex = 4;
+                    e.inputValue.valueType = cxrInputValueType_float32;
+                    e.inputValue.vF32 = triggerValue.currentState;//input.IndexTrigger;
+                }
 #endif
             }
             // trigger touch
@@ -1212,9 +1379,9 @@ struct OpenXrProgram : IOpenXrProgram {
 #ifdef CLOUDXR3_5
                     trackingState.controller[hand].booleanComps |= 1UL << cxrButton_Trigger_Touch;
 #else
-                Log::Write(Log::Level::Info, Fmt("pico keyevent trigger touch %d", hand));
+                Log::Write(Log::Level::Verbose, Fmt("pico keyevent trigger touch %d", hand));
                 cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                e.clientTimeNS = inputTimeNS;
+                e.clientTimeNS = EventTimeNs(triggerTouch, inputTimeNS);
                 e.clientInputIndex = 3;
                 e.inputValue.valueType = cxrInputValueType_boolean;
                 e.inputValue.vBool = triggerTouch.currentState == XR_TRUE ? cxrTrue : cxrFalse;
@@ -1230,9 +1397,9 @@ struct OpenXrProgram : IOpenXrProgram {
 #ifdef CLOUDXR3_5
                     trackingState.controller[hand].booleanComps |= 1UL << cxrButton_Trigger_Click;
 #else
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent trigger click %d", hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent trigger click %d", hand));
                     cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                    e.clientTimeNS = inputTimeNS;
+                    e.clientTimeNS = EventTimeNs(triggerClick, inputTimeNS);
                     e.clientInputIndex = 2;
                     e.inputValue.valueType = cxrInputValueType_boolean;
                     e.inputValue.vBool = triggerClick.currentState == XR_TRUE ? cxrTrue : cxrFalse;
@@ -1248,12 +1415,14 @@ struct OpenXrProgram : IOpenXrProgram {
 #ifdef CLOUDXR3_5
                 trackingState.controller[hand].scalarComps[cxrAnalog_Grip] = squeezeValue.currentState;
 #else
-                Log::Write(Log::Level::Info, Fmt("pico keyevent squeeze value %f", squeezeValue.currentState));
-                cxrControllerEvent& e = events[handIndex][eventCount[handIndex]++];
-                e.clientTimeNS = inputTimeNS;
-                e.clientInputIndex = 7;
-                e.inputValue.valueType = cxrInputValueType_float32;
-                e.inputValue.vF32 = squeezeValue.currentState;// input.GripTrigger;
+                if (squeezeValue.changedSinceLastSync == XR_TRUE || resync) {
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent squeeze value %f", squeezeValue.currentState));
+                    cxrControllerEvent& e = events[handIndex][eventCount[handIndex]++];
+                    e.clientTimeNS = EventTimeNs(squeezeValue, inputTimeNS);
+                    e.clientInputIndex = 7;
+                    e.inputValue.valueType = cxrInputValueType_float32;
+                    e.inputValue.vF32 = squeezeValue.currentState;// input.GripTrigger;
+                }
 #endif
             }
             // squeeze click
@@ -1262,9 +1431,9 @@ struct OpenXrProgram : IOpenXrProgram {
             CHECK_XRCMD(xrGetActionStateBoolean(m_session, &getInfo, &squeezeClick));
             if ((squeezeClick.isActive == XR_TRUE) && (squeezeClick.changedSinceLastSync == XR_TRUE)) {
                 if(squeezeClick.currentState == XR_TRUE) {
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent squeeze click pressed %d", hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent squeeze click pressed %d", hand));
                 } else{
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent squeeze click released %d", hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent squeeze click released %d", hand));
                 }
             }
 
@@ -1274,12 +1443,12 @@ struct OpenXrProgram : IOpenXrProgram {
             CHECK_XRCMD(xrGetActionStateBoolean(m_session, &getInfo, &AValue));
             if ((AValue.isActive == XR_TRUE) && (AValue.changedSinceLastSync == XR_TRUE)) {
                 if(AValue.currentState == XR_TRUE) {
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent A button pressed %d", hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent A button pressed %d", hand));
 #ifdef CLOUDXR3_5
                     trackingState.controller[hand].booleanComps |= 1UL << cxrButton_A;
 #else
                     cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                    e.clientTimeNS = inputTimeNS;
+                    e.clientTimeNS = EventTimeNs(AValue, inputTimeNS);
                     e.clientInputIndex = 12;
                     e.inputValue.valueType = cxrInputValueType_boolean;
                     e.inputValue.vBool = AValue.currentState == XR_TRUE ? cxrTrue : cxrFalse;
@@ -1292,12 +1461,12 @@ struct OpenXrProgram : IOpenXrProgram {
             CHECK_XRCMD(xrGetActionStateBoolean(m_session, &getInfo, &BValue));
             if ((BValue.isActive == XR_TRUE) && (BValue.changedSinceLastSync == XR_TRUE)) {
                 if(BValue.currentState == XR_TRUE) {
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent B button pressed %d", hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent B button pressed %d", hand));
 #ifdef CLOUDXR3_5
                     trackingState.controller[hand].booleanComps |= 1UL << cxrButton_B;
 #else
                     cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                    e.clientTimeNS = inputTimeNS;
+                    e.clientTimeNS = EventTimeNs(BValue, inputTimeNS);
                     e.clientInputIndex = 13;
                     e.inputValue.valueType = cxrInputValueType_boolean;
                     e.inputValue.vBool = BValue.currentState == XR_TRUE ? cxrTrue : cxrFalse;
@@ -1311,12 +1480,12 @@ struct OpenXrProgram : IOpenXrProgram {
             CHECK_XRCMD(xrGetActionStateBoolean(m_session, &getInfo, &XValue));
             if ((XValue.isActive == XR_TRUE) && (XValue.changedSinceLastSync == XR_TRUE)) {
                 if(XValue.currentState == XR_TRUE) {
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent X button pressed %d", hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent X button pressed %d", hand));
 #ifdef CLOUDXR3_5
                     trackingState.controller[hand].booleanComps |= 1UL << cxrButton_X;
 #else
                     cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                    e.clientTimeNS = inputTimeNS;
+                    e.clientTimeNS = EventTimeNs(XValue, inputTimeNS);
                     e.clientInputIndex = 14;
                     e.inputValue.valueType = cxrInputValueType_boolean;
                     e.inputValue.vBool = XValue.currentState == XR_TRUE ? cxrTrue : cxrFalse;
@@ -1329,12 +1498,12 @@ struct OpenXrProgram : IOpenXrProgram {
             CHECK_XRCMD(xrGetActionStateBoolean(m_session, &getInfo, &YValue));
             if ((YValue.isActive == XR_TRUE) && (YValue.changedSinceLastSync == XR_TRUE)) {
                 if(YValue.currentState == XR_TRUE) {
-                    Log::Write(Log::Level::Info, Fmt("pico keyevent Y button pressed %d", hand));
+                    Log::Write(Log::Level::Verbose, Fmt("pico keyevent Y button pressed %d", hand));
 #ifdef CLOUDXR3_5
                     trackingState.controller[hand].booleanComps |= 1UL << cxrButton_Y;
 #else
                     cxrControllerEvent &e = events[handIndex][eventCount[handIndex]++];
-                    e.clientTimeNS = inputTimeNS;
+                    e.clientTimeNS = EventTimeNs(YValue, inputTimeNS);
                     e.clientInputIndex = 15;
                     e.inputValue.valueType = cxrInputValueType_boolean;
                     e.inputValue.vBool = YValue.currentState == XR_TRUE ? cxrTrue : cxrFalse;
@@ -1343,20 +1512,17 @@ struct OpenXrProgram : IOpenXrProgram {
             }
 
 #ifndef CLOUDXR3_5
-            Log::Write(Log::Level::Info, Fmt("----------cloud: keyevent cxrFireControllerEvents() eventCount[%d]: %d", handIndex, eventCount[handIndex]));
             if (eventCount[handIndex])
             {
-                Log::Write(Log::Level::Info, Fmt("----------cloud: keyevent cxrFireControllerEvents() fire hand: %d", handIndex));
-                cxrError err = cxrFireControllerEvents(Receiver, m_newControllers[handIndex], events[handIndex], eventCount[handIndex]);
-                if (err != cxrError_Success)
-                {
-#if false
-                    CXR_LOGE("cxrFireControllerEvents failed: %s", cxrErrorString(err));
-#endif
-                    Log::Write(Log::Level::Info, Fmt("----------cloud: keyevent cxrFireControllerEvents() error %d", handIndex));
-
-                    // TODO: how to handle UNUSUAL API errors? might just return up.
-                    throw("Error firing events"); // just to do something fatal until we can propagate and 'handle' it.
+                Log::Write(Log::Level::Verbose, Fmt("----------cloud: keyevent cxrFireControllerEvents() fire hand: %d", handIndex));
+                // False only when the receiver went away or refused the events, they are dropped with it.
+                if (!m_cloudxr->FireControllerEvents(handIndex, events[handIndex], eventCount[handIndex])) {
+                    eventCount[handIndex] = 0;
+                    continue;
+                }
+                const int64_t sentNs = Clock::NowNs();
+                for (uint32_t i = 0; i < eventCount[handIndex]; i++) {
+                    m_cloudxr->GetLatencyTracker().OnInputSent((int64_t)events[handIndex][i].clientTimeNS, sentNs);
                 }
 #if false
                 // save input state for easy comparison next time, ONLY if we sent the events...
@@ -1381,6 +1547,12 @@ struct OpenXrProgram : IOpenXrProgram {
         XrFrameWaitInfo frameWaitInfo{XR_TYPE_FRAME_WAIT_INFO};
         XrFrameState frameState{XR_TYPE_FRAME_STATE};
         CHECK_XRCMD(xrWaitFrame(m_session, &frameWaitInfo, &frameState));
+        const bool streaming = m_cloudxr->GetClientState() == cxrClientState_StreamingSessionInProgress;
+        m_perfSettings.SetStreaming(streaming);
+        if (streaming) {
+            m_cloudxr->GetFrameDrops().OnWaitFrame(Clock::NowNs(), Clock::FromXrTime(frameState.predictedDisplayTime),
+                                                   frameState.predictedDisplayPeriod, frameState.shouldRender == XR_TRUE);
+        }
 
         XrFrameBeginInfo frameBeginInfo{XR_TYPE_FRAME_BEGIN_INFO};
         CHECK_XRCMD(xrBeginFrame(m_session, &frameBeginInfo));
@@ -1389,7 +1561,8 @@ struct OpenXrProgram : IOpenXrProgram {
         XrCompositionLayerProjection layer{XR_TYPE_COMPOSITION_LAYER_PROJECTION};
         std::vector<XrCompositionLayerProjectionView> projectionLayerViews;
         if (frameState.shouldRender == XR_TRUE) {
-            if (RenderLayer(frameState.predictedDisplayTime, projectionLayerViews, layer)) {
+            m_latchScheduler.BeginFrame(Clock::FromXrTime(frameState.predictedDisplayTime), frameState.predictedDisplayPeriod);
+            if (RenderLayer(frameState.predictedDisplayTime, streaming, projectionLayerViews, layer)) {
                 layers.push_back(reinterpret_cast<XrCompositionLayerBaseHeader*>(&layer));
             }
         }
@@ -1400,9 +1573,45 @@ struct OpenXrProgram : IOpenXrProgram {
         frameEndInfo.layerCount = (uint32_t)layers.size();
         frameEndInfo.layers = layers.data();
         CHECK_XRCMD(xrEndFrame(m_session, &frameEndInfo));
+        m_latchScheduler.OnSubmitted(Clock::NowNs());
     }
 
-    bool RenderLayer(XrTime predictedDisplayTime, std::vector<XrCompositionLayerProjectionView>& projectionLayerViews,
+    // Resubmits the images released last, the compositor reprojects them with the poses they were rendered for. A
+    // planned repeat fills the gap between two half-rate frames and is not a missed deadline.
+    bool RepeatPreviousLayer(std::vector<XrCompositionLayerProjectionView>& projectionLayerViews, XrCompositionLayerProjection& layer,
+                             bool planned) {
+        if (!planned) {
+            m_repeatedFrames++;
+            Log::Write(Log::Level::Verbose, Fmt("Latch deadline missed, repeating the previous frame (%u so far)", m_repeatedFrames));
+        }
+        projectionLayerViews = m_previousLayerViews;
+        layer.space = m_appSpace;
+        layer.layerFlags = m_options.Parsed.EnvironmentBlendMode == XR_ENVIRONMENT_BLEND_MODE_ALPHA_BLEND
+                         ? XR_COMPOSITION_LAYER_BLEND_TEXTURE_SOURCE_ALPHA_BIT | XR_COMPOSITION_LAYER_UNPREMULTIPLIED_ALPHA_BIT
+                         : 0;
+        layer.viewCount = (uint32_t)projectionLayerViews.size();
+        layer.views = projectionLayerViews.data();
+        return true;
+    }
+
+    // Follows the receiver the client is streaming from, the counters of a half-rate period are logged when it ends.
+    void UpdateHalfRate() {
+        const bool halfRate = m_cloudxr->IsHalfRate() && m_cloudxr->GetClientState() == cxrClientState_StreamingSessionInProgress;
+        if (halfRate == m_halfRate.IsEnabled()) {
+            return;
+        }
+        if (m_halfRate.IsEnabled()) {
+            Log::Write(Log::Level::Info, Fmt("Half-rate streaming ended: %llu frames synthesized, %llu late, %llu early",
+                                             (unsigned long long)m_halfRate.GetSynthesizedCount(), (unsigned long long)m_halfRate.GetLateCount(),
+                                             (unsigned long long)m_halfRate.GetEarlyCount()));
+        } else {
+            Log::Write(Log::Level::Info, Fmt("Half-rate streaming, reprojecting every other frame"));
+        }
+        m_halfRate.SetEnabled(halfRate);
+    }
+
+    // streaming is the state the frame was waited in, drops are only counted for frames whose wait was counted too.
+    bool RenderLayer(XrTime predictedDisplayTime, bool streaming, std::vector<XrCompositionLayerProjectionView>& projectionLayerViews,
                      XrCompositionLayerProjection& layer) {
         XrResult res;
         XrViewState viewState{XR_TYPE_VIEW_STATE};
@@ -1417,6 +1626,9 @@ struct OpenXrProgram : IOpenXrProgram {
         CHECK_XRRESULT(res, "xrLocateViews");
         if ((viewState.viewStateFlags & XR_VIEW_STATE_POSITION_VALID_BIT) == 0 ||
             (viewState.viewStateFlags & XR_VIEW_STATE_ORIENTATION_VALID_BIT) == 0) {
+            if (streaming) {
+                m_cloudxr->GetFrameDrops().OnViewsLocated(Clock::NowNs(), false);
+            }
             return false;  // There is no valid tracking poses for the views.
         }
 
@@ -1429,28 +1641,41 @@ struct OpenXrProgram : IOpenXrProgram {
 
         projectionLayerViews.resize(viewCountOutput);
 
-        std::vector<XrPosef> handPose;
-        for (auto hand : {Side::LEFT, Side::RIGHT}) {
-            XrSpaceLocation spaceLocation{XR_TYPE_SPACE_LOCATION};
-            res = xrLocateSpace(m_input.handSpace[hand], m_appSpace, predictedDisplayTime, &spaceLocation);
-            CHECK_XRRESULT(res, "xrLocateSpace");
-            if (XR_UNQUALIFIED_SUCCESS(res)) {
-                if ((spaceLocation.locationFlags & XR_SPACE_LOCATION_POSITION_VALID_BIT) != 0 &&
-                    (spaceLocation.locationFlags & XR_SPACE_LOCATION_ORIENTATION_VALID_BIT) != 0) {
-                    handPose.push_back(spaceLocation.pose);
-                }
-            }
-        }
+        ControllerPoseSample controllers[ControllerCount];
+        SampleControllers(predictedDisplayTime, m_cloudxr->IsAimPoseEnabled(), controllers);
 
         XrSpaceVelocity velocity{XR_TYPE_SPACE_VELOCITY};
         XrSpaceLocation spaceLocation{XR_TYPE_SPACE_LOCATION, &velocity};
         res = xrLocateSpace(m_ViewSpace, m_appSpace, predictedDisplayTime, &spaceLocation);
         CHECK_XRRESULT(res, "xrLocateSpace");
 
-        m_cloudxr->SetSenserPoseState(spaceLocation.pose, velocity.linearVelocity, velocity.angularVelocity, handPose, ipd);
+        m_cloudxr->SetSenserPoseState(spaceLocation.pose, velocity.linearVelocity, velocity.angularVelocity, controllers, ipd);
+        if (m_cloudxr->IsGazeFoveationActive()) {
+            m_cloudxr->OnGazeSample(SampleGaze(predictedDisplayTime));
+        }
 
+        // Everything that does not depend on the video frame is done, wait for it with exactly the remaining slack. On
+        // the display frames a half-rate stream leaves out only a frame that already arrived is taken.
+        UpdateHalfRate();
+        const bool frameDue = m_halfRate.BeginFrame();
         cxrFramesLatched framesLatched{};
-        bool framevaild = m_cloudxr->LatchFrame(&framesLatched);
+        bool framevaild = m_cloudxr->LatchFrame(&framesLatched, frameDue ? m_latchScheduler.GetLatchTimeoutMs(Clock::NowNs()) : 0, frameDue);
+        m_latchScheduler.OnLatched(Clock::NowNs());
+        m_halfRate.OnLatchResult(framevaild);
+        if (m_cloudxr->GetClientState() != cxrClientState_StreamingSessionInProgress) {
+            m_previousLayerViews.clear();
+        } else if (!framevaild && !m_previousLayerViews.empty()) {
+            return RepeatPreviousLayer(projectionLayerViews, layer, !frameDue);
+        }
+        if (framevaild) {
+            m_cloudxr->GetLatencyTracker().OnFrameDisplayed(framesLatched.poseID, Clock::FromXrTime(predictedDisplayTime));
+        }
+        if (framevaild && !m_firstFrameStreamed) {
+            m_firstFrameStreamed = true;
+            Log::Write(Log::Level::Info, Fmt("Time to first streamed frame: %.1f ms", Startup::MillisecondsSinceLaunch()));
+            // The pose and audio callback threads have called in by now.
+            ThreadRoles::LogDiagnostics();
+        }
 
         XrPosef pose[Side::COUNT];
         for (uint32_t i = 0; i < viewCountOutput; i++) {
@@ -1503,6 +1728,7 @@ struct OpenXrProgram : IOpenXrProgram {
 
         if (framevaild) {
             m_cloudxr->ReleaseFrame(&framesLatched);
+            m_previousLayerViews = projectionLayerViews;
         }
 
         layer.space = m_appSpace;
@@ -1520,25 +1746,39 @@ struct OpenXrProgram : IOpenXrProgram {
         return true;
     }
 
+    void PrepareCloudxrClient() override {
+        if (m_cloudxr.get()) {
+            m_cloudxr->Prepare();
+        }
+    }
+
+    void LogDiagnostics() override {
+        LogLayersAndExtensions();
+        LogViewConfigurations();
+        LogReferenceSpaces();
+    }
+
     void SetCloudxrClientPaused(bool pause) override {
+        if (pause) {
+            m_perfSettings.SetStreaming(false);
+        }
         if (m_cloudxr.get()) {
             m_cloudxr->SetPaused(pause);
         }
     }
 
+    void SetMainLoopWake(std::function<void()> wake) override {
+        if (m_cloudxr.get()) {
+            m_cloudxr->SetWakeCallback(std::move(wake));
+        }
+    }
+
     void StartCloudxrClient() override {
         if (m_cloudxr.get()) {
-            m_cloudxr->Initialize(m_instance, m_systemId, m_session, m_displayRefreshRate, m_isSupport_epic_view_configuration_fov_extention, (void*)this, [](void *arg, int controllerIdx, float amplitude, float seconds, float frequency) {
-                Log::Write(Log::Level::Error, Fmt("this:%p, index:%d, amplitude:%f, seconds:%f, frequency:%f", arg, controllerIdx, amplitude, seconds, frequency));
+            m_cloudxr->SetEyeGazeSupported(m_input.gazeSpace != XR_NULL_HANDLE);
+            m_cloudxr->Initialize(m_instance, m_systemId, m_session, m_displayRefreshRate, m_isSupport_epic_view_configuration_fov_extention, *m_deviceProfile, (void*)this, [](void *arg, int controllerIdx, float amplitude, float seconds, float frequency) {
                 OpenXrProgram* thiz = (OpenXrProgram*)arg;
-                XrHapticVibration vibration{XR_TYPE_HAPTIC_VIBRATION};
-                vibration.amplitude = amplitude;
-                vibration.duration = seconds * 1000 * 10000000;  //nanoseconds
-                vibration.frequency = frequency;
-                XrHapticActionInfo hapticActionInfo{XR_TYPE_HAPTIC_ACTION_INFO};
-                hapticActionInfo.action = thiz->m_input.hapticAction;
-                hapticActionInfo.subactionPath = thiz->m_input.handSubactionPath[controllerIdx];
-                CHECK_XRCMD(xrApplyHapticFeedback(thiz->m_session, &hapticActionInfo, (XrHapticBaseHeader*)&vibration));
+                thiz->m_haptics.Enqueue({(uint32_t)controllerIdx, amplitude, seconds, frequency, Clock::NowNs()});
             });
         }
     }
@@ -1570,8 +1810,24 @@ struct OpenXrProgram : IOpenXrProgram {
     PFN_xrGetDisplayRefreshRateFB m_pfnXrGetDisplayRefreshRateFB;
     float m_displayRefreshRate;
     bool m_isSupport_epic_view_configuration_fov_extention;
-    DeviceType m_deviceType;
-    uint32_t m_deviceROM;
+    bool m_isSupportConvertTimespecTime{false};
+    bool m_isSupportPerformanceSettings{false};
+    bool m_isSupportEyeGaze{false};
+    PerformanceSettings m_perfSettings;
+    const DeviceProfile* m_deviceProfile{&s_unknownDeviceProfile};
+    DeviceType m_deviceType{DeviceTypeNone};
+    uint32_t m_deviceROM{0};
+    bool m_firstFrameStreamed{false};
+    HapticScheduler m_haptics;
+    LatchScheduler m_latchScheduler;
+    HalfRateScheduler m_halfRate;
+    std::vector<XrCompositionLayerProjectionView> m_previousLayerViews;
+    uint32_t m_repeatedFrames{0};
+    uint32_t m_hapticsDropped{0};
+
+    std::mutex m_inputMutex;
+    // Declared last, so it is joined before anything SampleInput uses is destroyed.
+    InputThread m_inputThread{{[this]() { return m_cloudxr->GetInputRateHz(); }, [this]() { SampleInput(); }}};
 };
 }  // namespace
 
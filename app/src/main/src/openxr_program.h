@@ -38,9 +38,21 @@ struct IOpenXrProgram {
 
     virtual bool CreateCloudxrClient() = 0;
 
+    // Parse the launch options, open the audio stream and resolve the server address. Does not touch OpenXR or EGL,
+    // so it can run on a worker thread while the instance and session are created.
+    virtual void PrepareCloudxrClient() = 0;
+
     virtual void StartCloudxrClient() = 0;
+
+    // Log layers, extensions, view configurations and reference spaces. Purely informational, run off the startup
+    // critical path once the session exists.
+    virtual void LogDiagnostics() = 0;
     
     virtual void SetCloudxrClientPaused(bool pause) = 0;
+
+    // Called from CloudXR threads whenever the client state changes, to wake a main loop that is waiting. Setting an
+    // empty function returns once no client thread is inside the previous one anymore.
+    virtual void SetMainLoopWake(std::function<void()> wake) = 0;
 };
 
 struct Swapchain {
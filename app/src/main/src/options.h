@@ -15,6 +15,9 @@ struct Options {
 
     std::string AppSpace{"Local"};
 
+    // Writable app-private directory for caches that should survive restarts, empty disables them.
+    std::string CacheDirectory;
+
     struct {
         XrFormFactor FormFactor{XR_FORM_FACTOR_HEAD_MOUNTED_DISPLAY};
 
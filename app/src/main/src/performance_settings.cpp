@@ -0,0 +1,94 @@
+/*
+    CPU and GPU performance level hints through XR_EXT_performance_settings
+*/
+#include "performance_settings.h"
+#include "common.h"
+#include "logger.h"
+
+const char* PerformanceSettings::ToString(PerfPressure pressure) {
+    switch (pressure) {
+        case PerfPressure::Normal:
+            return "Normal";
+        case PerfPressure::Warning:
+            return "Warning";
+        case PerfPressure::Impaired:
+            return "Impaired";
+        default:
+            return "Unknown";
+    }
+}
+
+void PerformanceSettings::Initialize(XrInstance instance, XrSession session) {
+    if (XR_FAILED(xrGetInstanceProcAddr(instance, "xrPerfSettingsSetPerformanceLevelEXT", (PFN_xrVoidFunction*)&m_pfnSetPerformanceLevel))) {
+        m_pfnSetPerformanceLevel = nullptr;
+        Log::Write(Log::Level::Warning, "xrPerfSettingsSetPerformanceLevelEXT is not available");
+        return;
+    }
+    m_session = session;
+    m_levelsSet = false;
+    for (auto& domain : m_notifications) {
+        std::fill(std::begin(domain), std::end(domain), XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+    }
+    m_pressure = PerfPressure::Normal;
+}
+
+void PerformanceSettings::SetStreaming(bool streaming) {
+    if (!IsSupported() || (m_levelsSet && streaming == m_streaming)) {
+        return;
+    }
+    m_streaming = streaming;
+    m_levelsSet = true;
+    // Decode and blit need steady clocks, boost would only buy a thermal budget the stream cannot pay back.
+    const XrPerfSettingsLevelEXT level = streaming ? XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT : XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT;
+    SetLevel(XR_PERF_SETTINGS_DOMAIN_CPU_EXT, level);
+    SetLevel(XR_PERF_SETTINGS_DOMAIN_GPU_EXT, level);
+    Log::Write(Log::Level::Info, Fmt("Performance levels: %s", streaming ? "sustained high" : "power savings"));
+}
+
+void PerformanceSettings::SetLevel(XrPerfSettingsDomainEXT domain, XrPerfSettingsLevelEXT level) {
+    const XrResult result = m_pfnSetPerformanceLevel(m_session, domain, level);
+    if (XR_FAILED(result)) {
+        Log::Write(Log::Level::Warning, Fmt("xrPerfSettingsSetPerformanceLevelEXT(%d, %d) failed: %d", domain, level, result));
+    }
+}
+
+bool PerformanceSettings::OnNotification(const XrEventDataPerfSettingsEXT& event) {
+    Log::Write(Log::Level::Info, Fmt("Performance notification: domain %d subdomain %d level %d -> %d", event.domain, event.subDomain,
+                                     event.fromLevel, event.toLevel));
+    const uint32_t domain = (uint32_t)event.domain - 1;
+    const uint32_t subDomain = (uint32_t)event.subDomain - 1;
+    if (domain >= DomainCount || subDomain >= SubDomainCount) {
+        return false;
+    }
+    m_notifications[domain][subDomain] = event.toLevel;
+
+    XrPerfSettingsNotificationLevelEXT worst = XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT;
+    for (const auto& levels : m_notifications) {
+        for (XrPerfSettingsNotificationLevelEXT level : levels) {
+            worst = std::max(worst, level);
+        }
+    }
+    const PerfPressure pressure = worst >= XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT   ? PerfPressure::Impaired
+                                  : worst >= XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT ? PerfPressure::Warning
+                                                                                       : PerfPressure::Normal;
+    if (pressure == m_pressure) {
+        return false;
+    }
+    m_pressure = pressure;
+    return true;
+}
+
+bool PerformanceSettings::EndSession() {
+    if (!IsSupported()) {
+        return false;
+    }
+    SetStreaming(false);
+    for (auto& domain : m_notifications) {
+        std::fill(std::begin(domain), std::end(domain), XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+    }
+    if (m_pressure == PerfPressure::Normal) {
+        return false;
+    }
+    m_pressure = PerfPressure::Normal;
+    return true;
+}
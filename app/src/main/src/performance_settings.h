@@ -0,0 +1,57 @@
+/*
+    CPU and GPU performance level hints through XR_EXT_performance_settings
+*/
+
+#pragma once
+#include "pch.h"
+
+// How hard the runtime says the device is struggling, the worst over CPU and GPU and all of their subdomains.
+enum class PerfPressure {
+    Normal,
+    Warning,
+    Impaired,
+};
+
+// Asks the runtime for sustained high clocks while a stream is running and for power savings otherwise, and folds its
+// performance notifications into one pressure level. Main thread only. Without the extension every call is a no-op
+// and the pressure stays Normal.
+class PerformanceSettings {
+public:
+    static const char* ToString(PerfPressure pressure);
+
+    // Whether a receiver created under the applied pressure has to be replaced. Only rising pressure does, falling
+    // pressure is picked up by the next receiver so a flapping notification cannot cycle the stream.
+    static bool NeedsReconnect(PerfPressure pressure, PerfPressure applied) { return pressure > applied; }
+
+    // After the session is created, with the extension enabled on the instance.
+    void Initialize(XrInstance instance, XrSession session);
+
+    bool IsSupported() const { return m_pfnSetPerformanceLevel != nullptr; }
+
+    // Levels are only sent to the runtime when they change.
+    void SetStreaming(bool streaming);
+
+    // Returns true when the folded pressure changed.
+    bool OnNotification(const XrEventDataPerfSettingsEXT& event);
+
+    // Before xrEndSession. Puts the levels back to power savings and forgets the notifications, they belong to the
+    // session. Returns true when the folded pressure changed.
+    bool EndSession();
+
+    PerfPressure GetPressure() const { return m_pressure; }
+
+private:
+    void SetLevel(XrPerfSettingsDomainEXT domain, XrPerfSettingsLevelEXT level);
+
+private:
+    static constexpr uint32_t DomainCount = 2;
+    static constexpr uint32_t SubDomainCount = 3;
+
+    PFN_xrPerfSettingsSetPerformanceLevelEXT m_pfnSetPerformanceLevel{nullptr};
+    XrSession m_session{XR_NULL_HANDLE};
+    bool m_levelsSet{false};
+    bool m_streaming{false};
+    // Indexed by domain and subdomain minus one, the spec numbers both from 1.
+    XrPerfSettingsNotificationLevelEXT m_notifications[DomainCount][SubDomainCount] = {};
+    PerfPressure m_pressure{PerfPressure::Normal};
+};
@@ -0,0 +1,53 @@
+/*
+    reconnect backoff policy for the cloudxr client
+*/
+
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <random>
+
+// Exponential backoff with jitter. The n-th retry waits a random time in [(1 - jitter) * d, d] where
+// d = min(maxDelay, initialDelay * multiplier^n), so clients that lost the server together do not come back in lockstep.
+class ReconnectPolicy {
+public:
+    struct Config {
+        std::chrono::milliseconds initialDelay{250};
+        std::chrono::milliseconds maxDelay{8000};
+        float multiplier{2.0f};
+        float jitter{0.5f};
+        // 0 retries forever.
+        uint32_t maxAttempts{0};
+    };
+
+    ReconnectPolicy() : ReconnectPolicy(Config{}) {}
+
+    explicit ReconnectPolicy(const Config& config) : ReconnectPolicy(config, std::random_device{}()) {}
+
+    // A fixed seed gives the same jitter every run, for the tests.
+    ReconnectPolicy(const Config& config, uint32_t seed) : mConfig(config), mAttempts(0), mRandom(seed) {}
+
+    void Reset() { mAttempts = 0; }
+
+    bool Exhausted() const { return mConfig.maxAttempts != 0 && mAttempts >= mConfig.maxAttempts; }
+
+    uint32_t GetAttempts() const { return mAttempts; }
+
+    std::chrono::milliseconds NextDelay() {
+        double delayMs = (double)mConfig.initialDelay.count();
+        for (uint32_t i = 0; i < mAttempts && delayMs < mConfig.maxDelay.count(); i++) {
+            delayMs *= mConfig.multiplier;
+        }
+        delayMs = std::min(delayMs, (double)mConfig.maxDelay.count());
+        mAttempts++;
+
+        std::uniform_real_distribution<double> scale(1.0 - std::min(std::max(mConfig.jitter, 0.0f), 1.0f), 1.0);
+        return std::chrono::milliseconds((int64_t)(delayMs * scale(mRandom)));
+    }
+
+private:
+    Config mConfig;
+    uint32_t mAttempts;
+    std::mt19937 mRandom;
+};
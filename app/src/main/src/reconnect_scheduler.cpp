@@ -0,0 +1,82 @@
+/*
+    control thread reconnect state machine of the cloudxr client
+*/
+#include "reconnect_scheduler.h"
+#include "common.h"
+#include "logger.h"
+
+ReconnectScheduler::ReconnectScheduler(Handlers handlers, const ReconnectPolicy::Config& config)
+    : mHandlers(std::move(handlers)), mPolicy(config), mRetryPending(false), mReconnecting(false), mLastOutageMs(0.0) {
+}
+
+ReconnectScheduler::ReconnectScheduler(Handlers handlers, const ReconnectPolicy::Config& config, uint32_t seed)
+    : mHandlers(std::move(handlers)), mPolicy(config, seed), mRetryPending(false), mReconnecting(false), mLastOutageMs(0.0) {
+}
+
+void ReconnectScheduler::Reset() {
+    mPolicy.Reset();
+    mRetryPending = false;
+    mReconnecting = false;
+}
+
+void ReconnectScheduler::Restart() {
+    mHandlers.stop();
+    Reset();
+    if (!mHandlers.start()) {
+        ScheduleRetry();
+    }
+}
+
+void ReconnectScheduler::ScheduleRetry() {
+    const std::string server = mHandlers.server();
+    if (server.empty()) {
+        return;
+    }
+    if (mPolicy.Exhausted()) {
+        Log::Write(Log::Level::Error, Fmt("Giving up on %s after %u attempts", server.c_str(), mPolicy.GetAttempts()));
+        mReconnecting = false;
+        return;
+    }
+
+    const std::chrono::milliseconds delay = mPolicy.NextDelay();
+    mRetryTime = std::chrono::steady_clock::now() + delay;
+    mRetryPending = true;
+    Log::Write(Log::Level::Info, Fmt("Reconnect attempt %u in %lld ms", mPolicy.GetAttempts(), (long long)delay.count()));
+}
+
+void ReconnectScheduler::Update(Link link) {
+    if (link == Link::Streaming) {
+        if (mReconnecting) {
+            mLastOutageMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mLostTime).count();
+            Log::Write(Log::Level::Info, Fmt("Reconnected after %u attempts in %.1f ms", mPolicy.GetAttempts(), mLastOutageMs));
+            mReconnecting = false;
+        }
+        mPolicy.Reset();
+        return;
+    }
+
+    if (link == Link::Lost) {
+        if (!mReconnecting) {
+            mReconnecting = true;
+            mLostTime = std::chrono::steady_clock::now();
+        }
+        mHandlers.stop();
+        ScheduleRetry();
+        return;
+    }
+
+    if (mRetryPending && std::chrono::steady_clock::now() >= mRetryTime) {
+        mRetryPending = false;
+        if (!mHandlers.start()) {
+            ScheduleRetry();
+        }
+    }
+}
+
+std::chrono::milliseconds ReconnectScheduler::GetPollInterval(std::chrono::milliseconds idleInterval) const {
+    if (!mRetryPending) {
+        return idleInterval;
+    }
+    const auto untilRetry = std::chrono::duration_cast<std::chrono::milliseconds>(mRetryTime - std::chrono::steady_clock::now());
+    return std::max(std::chrono::milliseconds(0), std::min(idleInterval, untilRetry));
+}
@@ -0,0 +1,65 @@
+/*
+    control thread reconnect state machine of the cloudxr client
+*/
+
+#pragma once
+#include "pch.h"
+#include <chrono>
+#include "reconnect_policy.h"
+
+// Driven by the control thread only. A dropped or failed connection tears the receiver down and retries after the
+// policy's backoff, a streaming session resets the backoff and reports how long the outage lasted.
+class ReconnectScheduler {
+public:
+    enum class Link {
+        // Connecting, or idle without a receiver.
+        Pending,
+        Streaming,
+        // The connection attempt failed or the session was dropped, the receiver is still there.
+        Lost,
+    };
+
+    struct Handlers {
+        // Creates the receiver and starts connecting, false if that failed right away.
+        std::function<bool()> start;
+        // Tears the receiver down, a no-op without one.
+        std::function<void()> stop;
+        // The address retries go to, empty when there is nothing to retry.
+        std::function<std::string()> server;
+    };
+
+    explicit ReconnectScheduler(Handlers handlers, const ReconnectPolicy::Config& config = ReconnectPolicy::Config());
+
+    ReconnectScheduler(Handlers handlers, const ReconnectPolicy::Config& config, uint32_t seed);
+
+    // Forgets the backoff and any pending attempt, for a pause or resume.
+    void Reset();
+
+    // Stops, forgets the backoff and starts again at once, for new options.
+    void Restart();
+
+    // Schedules the next attempt, after a start that failed right away.
+    void ScheduleRetry();
+
+    // Acts on the client state and makes a due attempt.
+    void Update(Link link);
+
+    // How long the control thread may sleep before the next Update, at most idleInterval.
+    std::chrono::milliseconds GetPollInterval(std::chrono::milliseconds idleInterval) const;
+
+    bool IsRetryPending() const { return mRetryPending; }
+
+    uint32_t GetAttempts() const { return mPolicy.GetAttempts(); }
+
+    // From the loss of the last dropped session to streaming again, 0 until one reconnected.
+    double GetLastOutageMs() const { return mLastOutageMs; }
+
+private:
+    Handlers mHandlers;
+    ReconnectPolicy mPolicy;
+    std::chrono::steady_clock::time_point mRetryTime;
+    std::chrono::steady_clock::time_point mLostTime;
+    bool mRetryPending;
+    bool mReconnecting;
+    double mLastOutageMs;
+};
@@ -0,0 +1,216 @@
+/*
+    typed client options that can be edited while the app is running
+*/
+#include "runtime_options.h"
+#include "common.h"
+#include <cerrno>
+#include <cstdlib>
+
+namespace {
+
+bool ParseUInt(const std::string& text, uint32_t minValue, uint32_t maxValue, uint32_t* value) {
+    char* end = nullptr;
+    errno = 0;
+    const unsigned long parsed = strtoul(text.c_str(), &end, 10);
+    if (errno != 0 || end == text.c_str() || *end != '\0' || text[0] == '-' || parsed < minValue || parsed > maxValue) {
+        return false;
+    }
+    *value = (uint32_t)parsed;
+    return true;
+}
+
+bool ParseFloat(const std::string& text, float minValue, float maxValue, float* value) {
+    char* end = nullptr;
+    errno = 0;
+    const float parsed = strtof(text.c_str(), &end);
+    if (errno != 0 || end == text.c_str() || *end != '\0' || !(parsed >= minValue && parsed <= maxValue)) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+struct OptionField {
+    const char* key;
+    RuntimeOptionApply apply;
+    const char* expected;
+    bool (*parse)(const std::string& text, RuntimeOptions& options);
+    bool (*equal)(const RuntimeOptions& a, const RuntimeOptions& b);
+};
+
+// clang-format off
+const OptionField s_schema[] = {
+    {"server_ip", RuntimeOptionApply::Reconnect, "a host name or address",
+     [](const std::string& text, RuntimeOptions& o) {
+         if (text.empty() || text.find_first_of(" \t") != std::string::npos) return false;
+         o.serverIP = text;
+         return true;
+     },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.serverIP == b.serverIP; }},
+    {"max_bitrate_kbps", RuntimeOptionApply::Reconnect, "0 (server default) or 1000..200000",
+     [](const std::string& text, RuntimeOptions& o) {
+         uint32_t value;
+         if (!ParseUInt(text, 0, 200000, &value) || (value != 0 && value < 1000)) return false;
+         o.maxVideoBitrateKbps = value;
+         return true;
+     },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.maxVideoBitrateKbps == b.maxVideoBitrateKbps; }},
+    {"foveation", RuntimeOptionApply::Reconnect, "0 (off) or 1..99",
+     [](const std::string& text, RuntimeOptions& o) { return ParseUInt(text, 0, 99, &o.foveation); },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.foveation == b.foveation; }},
+    {"half_rate", RuntimeOptionApply::Reconnect, "on or off",
+     [](const std::string& text, RuntimeOptions& o) {
+         if (EqualsIgnoreCase(text, "on")) {
+             o.halfRate = true;
+         } else if (EqualsIgnoreCase(text, "off")) {
+             o.halfRate = false;
+         } else {
+             return false;
+         }
+         return true;
+     },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.halfRate == b.halfRate; }},
+    {"gaze_foveation", RuntimeOptionApply::Reconnect, "0 (off) or 1..99",
+     [](const std::string& text, RuntimeOptions& o) { return ParseUInt(text, 0, 99, &o.gazeFoveation); },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.gazeFoveation == b.gazeFoveation; }},
+    {"log_level", RuntimeOptionApply::Live, "verbose, info, warning or error",
+     [](const std::string& text, RuntimeOptions& o) {
+         static const std::pair<const char*, Log::Level> levels[] = {
+             {"verbose", Log::Level::Verbose}, {"info", Log::Level::Info}, {"warning", Log::Level::Warning}, {"error", Log::Level::Error}};
+         for (const auto& level : levels) {
+             if (EqualsIgnoreCase(text, level.first)) {
+                 o.logLevel = level.second;
+                 return true;
+             }
+         }
+         return false;
+     },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.logLevel == b.logLevel; }},
+    {"stats_interval_ms", RuntimeOptionApply::Live, "0 (off) or 100..60000",
+     [](const std::string& text, RuntimeOptions& o) {
+         uint32_t value;
+         if (!ParseUInt(text, 0, 60000, &value) || (value != 0 && value < 100)) return false;
+         o.statsIntervalMs = value;
+         return true;
+     },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.statsIntervalMs == b.statsIntervalMs; }},
+    {"pred_offset_ms", RuntimeOptionApply::Live, "-100..100",
+     [](const std::string& text, RuntimeOptions& o) { return ParseFloat(text, -100.0f, 100.0f, &o.predOffsetMs); },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.predOffsetMs == b.predOffsetMs; }},
+    {"controller_pose", RuntimeOptionApply::Live, "grip or aim",
+     [](const std::string& text, RuntimeOptions& o) {
+         if (EqualsIgnoreCase(text, "grip")) {
+             o.aimPose = false;
+         } else if (EqualsIgnoreCase(text, "aim")) {
+             o.aimPose = true;
+         } else {
+             return false;
+         }
+         return true;
+     },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.aimPose == b.aimPose; }},
+    {"input_rate_hz", RuntimeOptionApply::Live, "0 (once per frame) or 100..1000",
+     [](const std::string& text, RuntimeOptions& o) {
+         uint32_t value;
+         if (!ParseUInt(text, 0, 1000, &value) || (value != 0 && value < 100)) return false;
+         o.inputRateHz = value;
+         return true;
+     },
+     [](const RuntimeOptions& a, const RuntimeOptions& b) { return a.inputRateHz == b.inputRateHz; }},
+};
+// clang-format on
+
+static_assert(ArraySize(s_schema) <= sizeof(RuntimeOptionMask) * 8, "RuntimeOptionMask is too small for the schema");
+
+std::string Trim(const std::string& text) {
+    const size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string::npos) {
+        return {};
+    }
+    const size_t last = text.find_last_not_of(" \t\r");
+    return text.substr(first, last - first + 1);
+}
+
+}  // namespace
+
+RuntimeOptions ParseRuntimeOptions(const std::string& text, const RuntimeOptions& base, std::vector<std::string>* errors) {
+    RuntimeOptions options = base;
+    size_t lineStart = 0;
+    for (uint32_t lineNumber = 1; lineStart < text.size(); lineNumber++) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) {
+            lineEnd = text.size();
+        }
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        const size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line.erase(comment);
+        }
+        line = Trim(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        const size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            if (errors) errors->push_back(Fmt("line %u: expected key = value", lineNumber));
+            continue;
+        }
+        const std::string key = Trim(line.substr(0, equals));
+        const std::string value = Trim(line.substr(equals + 1));
+
+        const OptionField* field = nullptr;
+        for (const OptionField& candidate : s_schema) {
+            if (EqualsIgnoreCase(key, candidate.key)) {
+                field = &candidate;
+                break;
+            }
+        }
+        if (field == nullptr) {
+            if (errors) errors->push_back(Fmt("line %u: unknown option '%s'", lineNumber, key.c_str()));
+            continue;
+        }
+
+        RuntimeOptions parsed = options;
+        if (!field->parse(value, parsed)) {
+            if (errors) errors->push_back(Fmt("line %u: %s expects %s, got '%s'", lineNumber, field->key, field->expected, value.c_str()));
+            continue;
+        }
+        options = parsed;
+    }
+    return options;
+}
+
+RuntimeOptionMask DiffRuntimeOptions(const RuntimeOptions& a, const RuntimeOptions& b) {
+    RuntimeOptionMask mask = 0;
+    for (uint32_t i = 0; i < ArraySize(s_schema); i++) {
+        if (!s_schema[i].equal(a, b)) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+bool RequiresReconnect(RuntimeOptionMask changed) {
+    for (uint32_t i = 0; i < ArraySize(s_schema); i++) {
+        if ((changed & (1u << i)) != 0 && s_schema[i].apply == RuntimeOptionApply::Reconnect) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string DescribeRuntimeOptions(RuntimeOptionMask mask) {
+    std::string keys;
+    for (uint32_t i = 0; i < ArraySize(s_schema); i++) {
+        if ((mask & (1u << i)) != 0) {
+            if (!keys.empty()) {
+                keys += ", ";
+            }
+            keys += s_schema[i].key;
+        }
+    }
+    return keys;
+}
@@ -0,0 +1,53 @@
+/*
+    typed client options that can be edited while the app is running
+*/
+
+#pragma once
+#include "pch.h"
+#include "logger.h"
+
+// Settings read from CloudXRRuntimeOptions.txt ("key = value" per line, '#' starts a comment). Server, bitrate and
+// foveation default to what CloudXRLaunchOptions.txt says, so existing launch files keep working.
+struct RuntimeOptions {
+    // Changing these needs a new receiver.
+    std::string serverIP;
+    uint32_t maxVideoBitrateKbps{0};
+    uint32_t foveation{0};
+    // The server renders every other display frame, the client reprojects the previous one in between.
+    bool halfRate{false};
+    // Non-zero sends the foveal center to the server when the headset tracks the eyes, 0 keeps it fixed. The value is
+    // the foveation meant for a server that consumes the foveal center app message, the client itself keeps asking for
+    // foveation.
+    uint32_t gazeFoveation{0};
+
+    // Applied without touching the stream.
+    Log::Level logLevel{Log::Level::Verbose};
+    uint32_t statsIntervalMs{1000};
+    float predOffsetMs{-20.0f};
+    // Controllers are reported with their aim pose instead of the grip pose.
+    bool aimPose{false};
+    // Controller buttons and axes are sampled on their own thread at this rate, 0 samples once per frame.
+    uint32_t inputRateHz{0};
+};
+
+enum class RuntimeOptionApply {
+    // Takes effect right away, or for predOffsetMs with the next receiver, without dropping the current stream.
+    Live,
+    // The current session is torn down and reconnected.
+    Reconnect,
+};
+
+// One bit per schema entry, in schema order.
+using RuntimeOptionMask = uint32_t;
+
+// Parses text on top of base. Malformed lines, unknown keys and out of range values are reported in errors and leave
+// the corresponding field at its base value, so one bad edit does not knock out the rest of the file.
+RuntimeOptions ParseRuntimeOptions(const std::string& text, const RuntimeOptions& base, std::vector<std::string>* errors);
+
+// Bitmask of the schema entries whose value differs between a and b.
+RuntimeOptionMask DiffRuntimeOptions(const RuntimeOptions& a, const RuntimeOptions& b);
+
+bool RequiresReconnect(RuntimeOptionMask changed);
+
+// Comma separated keys of the entries in mask, for logging.
+std::string DescribeRuntimeOptions(RuntimeOptionMask mask);
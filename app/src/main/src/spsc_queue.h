@@ -0,0 +1,49 @@
+/*
+    bounded single-producer single-consumer queue
+*/
+
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+
+// Lock-free ring for handing items from one thread to another without blocking either, e.g. from an SDK callback
+// thread to the render thread. One thread pushes, one thread pops; a full queue rejects the push instead of waiting.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "items are copied in and out of the ring");
+
+public:
+    SpscQueue() : mHead(0), mTail(0) {}
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only.
+    bool TryPush(const T& item) {
+        const size_t tail = mTail.load(std::memory_order_relaxed);
+        if (tail - mHead.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        mItems[tail & (Capacity - 1)] = item;
+        mTail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only.
+    bool TryPop(T* item) {
+        const size_t head = mHead.load(std::memory_order_relaxed);
+        if (head == mTail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        *item = mItems[head & (Capacity - 1)];
+        mHead.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    alignas(64) std::atomic<size_t> mHead;
+    alignas(64) std::atomic<size_t> mTail;
+    T mItems[Capacity];
+};
@@ -0,0 +1,173 @@
+/*
+    startup dependency graph and phase timing
+*/
+#include "startup.h"
+#include "logger.h"
+#include "common.h"
+#include "clock.h"
+#include <atomic>
+
+namespace {
+std::atomic<int64_t> s_launchTimeNs{Clock::NowNs()};
+}  // namespace
+
+namespace Startup {
+void MarkLaunch() { s_launchTimeNs = Clock::NowNs(); }
+
+double MillisecondsSinceLaunch() {
+    return Clock::NsToMs(Clock::NowNs() - s_launchTimeNs);
+}
+}  // namespace Startup
+
+StartupGraph::StartupGraph(ThreadPool& pool): mPool(pool), mCriticalRemaining(0), mPoolRunning(0) {
+}
+
+StartupGraph::~StartupGraph() {
+    // Pool tasks reference this graph, never let them outlive it.
+    Wait();
+}
+
+StartupGraph::TaskId StartupGraph::Add(const char* name, Affinity affinity, const std::vector<TaskId>& dependencies,
+                                       std::function<void()> function, Priority priority) {
+    const TaskId id = mTasks.size();
+    // Run stops serving the main thread once the critical steps are done, a deferred main thread step could be left
+    // unrun. A critical step behind a deferred one would wait on a step whose failure is only logged.
+    if (priority == Priority::Deferred && affinity == Affinity::MainThread) {
+        THROW(Fmt("Deferred startup step %s must run on the pool", name));
+    }
+    for (TaskId dependency : dependencies) {
+        if (dependency >= id) {
+            THROW(Fmt("Startup step %s depends on a step added after it", name));
+        }
+        if (priority == Priority::Critical && mTasks[dependency].priority == Priority::Deferred) {
+            THROW(Fmt("Critical startup step %s depends on deferred step %s", name, mTasks[dependency].name.c_str()));
+        }
+    }
+
+    Task task;
+    task.name = name;
+    task.affinity = affinity;
+    task.priority = priority;
+    task.function = std::move(function);
+    task.pendingDependencies = (uint32_t)dependencies.size();
+    mTasks.push_back(std::move(task));
+
+    for (TaskId dependency : dependencies) {
+        mTasks[dependency].dependents.push_back(id);
+    }
+    if (priority == Priority::Critical) {
+        mCriticalRemaining++;
+    }
+    return id;
+}
+
+void StartupGraph::Run() {
+    Log::Write(Log::Level::Info, Fmt("Startup graph: %zu steps, %u pool threads", mTasks.size(), mPool.GetThreadCount()));
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    for (TaskId id = 0; id < mTasks.size(); id++) {
+        if (mTasks[id].pendingDependencies == 0) {
+            Schedule(id);
+        }
+    }
+
+    for (;;) {
+        mCondition.wait(lock, [this]() { return mFailure || mCriticalRemaining == 0 || !mMainThreadReady.empty(); });
+        if (mFailure || mCriticalRemaining == 0) {
+            break;
+        }
+        const TaskId id = mMainThreadReady.front();
+        mMainThreadReady.pop_front();
+
+        lock.unlock();
+        Execute(id);
+        lock.lock();
+    }
+
+    if (mFailure) {
+        // Let steps already on the pool drain before unwinding, they may reference objects owned by the caller.
+        mCondition.wait(lock, [this]() { return mPoolRunning == 0; });
+        std::rethrow_exception(mFailure);
+    }
+    lock.unlock();
+
+    LogPhases();
+}
+
+void StartupGraph::Wait() {
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]() { return mPoolRunning == 0; });
+}
+
+// Called with mMutex held.
+void StartupGraph::Schedule(TaskId id) {
+    if (mTasks[id].affinity == Affinity::MainThread) {
+        mMainThreadReady.push_back(id);
+        mCondition.notify_all();
+        return;
+    }
+    mPoolRunning++;
+    mPool.Submit([this, id]() { Execute(id); });
+}
+
+void StartupGraph::Execute(TaskId id) {
+    Task& task = mTasks[id];
+    std::exception_ptr error;
+    task.startMs = Startup::MillisecondsSinceLaunch();
+    try {
+        task.function();
+    } catch (...) {
+        error = std::current_exception();
+    }
+    task.endMs = Startup::MillisecondsSinceLaunch();
+    Complete(id, error);
+}
+
+void StartupGraph::Complete(TaskId id, std::exception_ptr error) {
+    Task& task = mTasks[id];
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (error) {
+        if (task.priority == Priority::Critical) {
+            if (!mFailure) {
+                mFailure = error;
+            }
+        } else {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& ex) {
+                Log::Write(Log::Level::Warning, Fmt("Deferred startup step %s failed: %s", task.name.c_str(), ex.what()));
+            } catch (...) {
+                Log::Write(Log::Level::Warning, Fmt("Deferred startup step %s failed", task.name.c_str()));
+            }
+        }
+    } else if (!mFailure) {
+        for (TaskId dependent : task.dependents) {
+            if (--mTasks[dependent].pendingDependencies == 0) {
+                Schedule(dependent);
+            }
+        }
+    }
+
+    if (task.priority == Priority::Critical) {
+        mCriticalRemaining--;
+    } else {
+        Log::Write(Log::Level::Info, Fmt("Deferred startup step %s took %.1f ms", task.name.c_str(), task.endMs - task.startMs));
+    }
+    if (task.affinity == Affinity::Pool) {
+        mPoolRunning--;
+    }
+    mCondition.notify_all();
+}
+
+void StartupGraph::LogPhases() const {
+    for (const Task& task : mTasks) {
+        if (task.priority != Priority::Critical) {
+            continue;
+        }
+        Log::Write(Log::Level::Info, Fmt("Startup phase %-22s %8.1f ms  [%8.1f .. %8.1f] %s", task.name.c_str(),
+                                         task.endMs - task.startMs, task.startMs, task.endMs,
+                                         task.affinity == Affinity::MainThread ? "main" : "pool"));
+    }
+    Log::Write(Log::Level::Info, Fmt("Startup critical path done %.1f ms after launch", Startup::MillisecondsSinceLaunch()));
+}
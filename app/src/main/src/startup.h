@@ -0,0 +1,78 @@
+/*
+    startup dependency graph and phase timing
+*/
+
+#pragma once
+#include "pch.h"
+#include "thread_pool.h"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+
+namespace Startup {
+// Records the process launch time that every startup milestone is reported against.
+void MarkLaunch();
+
+double MillisecondsSinceLaunch();
+}  // namespace Startup
+
+// Runs the startup steps as a dependency graph. Steps that touch the EGL context or must keep OpenXR call order run
+// on the thread that calls Run, everything else goes to the pool as soon as its dependencies are done. Each step is
+// timed relative to launch and the phase table is logged once the critical steps are finished.
+class StartupGraph {
+public:
+    using TaskId = size_t;
+
+    enum class Affinity { MainThread, Pool };
+
+    // Deferred steps are off the critical path: Run does not wait for them and a failure is only logged. They run on the
+    // pool and only deferred steps may depend on them.
+    enum class Priority { Critical, Deferred };
+
+    explicit StartupGraph(ThreadPool& pool);
+
+    ~StartupGraph();
+
+    StartupGraph(const StartupGraph&) = delete;
+    StartupGraph& operator=(const StartupGraph&) = delete;
+
+    TaskId Add(const char* name, Affinity affinity, const std::vector<TaskId>& dependencies, std::function<void()> function,
+               Priority priority = Priority::Critical);
+
+    // Runs until every critical step finished and rethrows the first failure of a critical step.
+    void Run();
+
+    // Blocks until deferred steps still running on the pool are finished.
+    void Wait();
+
+private:
+    struct Task {
+        std::string name;
+        Affinity affinity;
+        Priority priority;
+        std::function<void()> function;
+        std::vector<TaskId> dependents;
+        uint32_t pendingDependencies{0};
+        double startMs{0};
+        double endMs{0};
+    };
+
+    void Schedule(TaskId id);
+
+    void Execute(TaskId id);
+
+    void Complete(TaskId id, std::exception_ptr error);
+
+    void LogPhases() const;
+
+private:
+    ThreadPool& mPool;
+    std::vector<Task> mTasks;
+
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<TaskId> mMainThreadReady;
+    uint32_t mCriticalRemaining;
+    uint32_t mPoolRunning;
+    std::exception_ptr mFailure;
+};
@@ -0,0 +1,124 @@
+/*
+    stream quality governor driven by device temperature and runtime performance notifications
+*/
+#include "thermal_governor.h"
+#include "common.h"
+#include "logger.h"
+#include <dirent.h>
+#include <fstream>
+
+SysfsThermalSource::SysfsThermalSource(const std::string& root, const std::vector<std::string>& typePrefixes)
+    : m_root(root), m_typePrefixes(typePrefixes) {
+}
+
+// Zones do not come and go at runtime, they are listed once.
+void SysfsThermalSource::Scan() {
+    m_scanned = true;
+    DIR* dir = opendir(m_root.c_str());
+    if (dir == nullptr) {
+        Log::Write(Log::Level::Warning, Fmt("No thermal zones under %s", m_root.c_str()));
+        return;
+    }
+    std::vector<std::string> all;
+    std::vector<std::string> matching;
+    while (const dirent* entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if (name.compare(0, 12, "thermal_zone") != 0) {
+            continue;
+        }
+        const std::string zone = m_root + "/" + name;
+        std::string type;
+        std::ifstream(zone + "/type") >> type;
+        all.push_back(zone + "/temp");
+        for (const std::string& prefix : m_typePrefixes) {
+            if (type.compare(0, prefix.size(), prefix) == 0) {
+                matching.push_back(zone + "/temp");
+                break;
+            }
+        }
+    }
+    closedir(dir);
+    m_tempPaths = matching.empty() ? all : matching;
+    Log::Write(Log::Level::Info, Fmt("Thermal governor reads %zu of %zu zones under %s", m_tempPaths.size(), all.size(), m_root.c_str()));
+}
+
+bool SysfsThermalSource::ReadMaxCelsius(float* celsius) {
+    if (!m_scanned) {
+        Scan();
+    }
+    bool found = false;
+    for (const std::string& path : m_tempPaths) {
+        long milliCelsius;
+        std::ifstream file(path);
+        if (!(file >> milliCelsius)) {
+            continue;
+        }
+        // Disabled or unconnected sensors report 0 or nonsense.
+        const float value = milliCelsius / 1000.0f;
+        if (value <= 0.0f || value > 150.0f) {
+            continue;
+        }
+        *celsius = found ? std::max(*celsius, value) : value;
+        found = true;
+    }
+    return found;
+}
+
+StreamQuality ThermalGovernor::GetQuality(uint32_t level) {
+    static const StreamQuality s_levels[LevelCount] = {
+        {1.0f, 0, 0.0f},
+        {0.9f, 70, 0.0f},
+        {0.8f, 50, 0.0f},
+        {0.7f, 40, 72.0f},
+    };
+    return s_levels[std::min(level, LevelCount - 1)];
+}
+
+ThermalGovernor::ThermalGovernor(const Config& config) : m_config(config) {
+}
+
+uint32_t ThermalGovernor::TargetLevel(float celsius, float margin) const {
+    uint32_t level = 0;
+    while (level < LevelCount - 1 && celsius >= m_config.stepDownCelsius[level] - margin) {
+        level++;
+    }
+    return level;
+}
+
+bool ThermalGovernor::Update(float celsius, PerfPressure pressure, float elapsedSeconds) {
+    m_celsius = m_hasSample ? m_celsius + m_config.smoothing * (celsius - m_celsius) : celsius;
+    m_hasSample = true;
+
+    const uint32_t floor = pressure == PerfPressure::Impaired ? 2 : pressure == PerfPressure::Warning ? 1 : 0;
+    const uint32_t hot = std::max(TargetLevel(m_celsius, 0.0f), floor);
+    // The level that would still be chosen with the hysteresis margin, anything below it is cool enough to step up.
+    const uint32_t cool = std::max(TargetLevel(m_celsius, m_config.hysteresisCelsius), floor);
+
+    const uint32_t previous = m_level;
+    if (hot > m_level) {
+        m_coolTime = 0;
+        m_hotTime += elapsedSeconds;
+        // Runtime pressure is already sustained on the runtime side, it applies right away.
+        if (m_hotTime >= m_config.stepDownHoldSeconds || floor > m_level) {
+            m_level = hot;
+            m_hotTime = 0;
+        }
+    } else if (cool < m_level) {
+        m_hotTime = 0;
+        m_coolTime += elapsedSeconds;
+        if (m_coolTime >= m_config.stepUpHoldSeconds) {
+            m_level--;
+            m_coolTime = 0;
+        }
+    } else {
+        m_hotTime = 0;
+        m_coolTime = 0;
+    }
+
+    if (m_level == previous) {
+        return false;
+    }
+    Log::Write(Log::Level::Info, Fmt("Thermal governor: %.1f C, pressure %s, level %u -> %u", m_celsius, PerformanceSettings::ToString(pressure),
+                                     previous, m_level));
+    return true;
+}
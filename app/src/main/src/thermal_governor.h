@@ -0,0 +1,86 @@
+/*
+    stream quality governor driven by device temperature and runtime performance notifications
+*/
+
+#pragma once
+#include "pch.h"
+#include "performance_settings.h"
+
+// Where temperatures come from. The governor only sees this interface, so scripted curves can stand in for a device.
+class ThermalSource {
+public:
+    virtual ~ThermalSource() = default;
+
+    // Hottest zone in degrees Celsius, false when nothing could be read.
+    virtual bool ReadMaxCelsius(float* celsius) = 0;
+};
+
+// Reads <root>/thermal_zone*/temp, which the kernel reports in millidegrees. Zones whose type starts with one of the
+// prefixes are used, or every zone when none matches. The root is a parameter so a fake tree can stand in for sysfs.
+class SysfsThermalSource : public ThermalSource {
+public:
+    explicit SysfsThermalSource(const std::string& root = "/sys/class/thermal", const std::vector<std::string>& typePrefixes = {});
+
+    bool ReadMaxCelsius(float* celsius) override;
+
+private:
+    void Scan();
+
+private:
+    std::string m_root;
+    std::vector<std::string> m_typePrefixes;
+    std::vector<std::string> m_tempPaths;
+    bool m_scanned{false};
+};
+
+// What one governor level allows the stream.
+struct StreamQuality {
+    // cxrDeviceDesc::maxResFactor.
+    float resolutionFactor;
+    // Upper bound on the foveation share kept in the periphery, 0 leaves the configured foveation alone.
+    uint32_t maxFoveation;
+    // Display refresh rate cap for the frame pacing, 0 for none.
+    float maxRefreshRate;
+};
+
+// Steps the stream quality down before the SoC throttles and back up once it has cooled. Temperature is smoothed, a
+// step down needs the threshold exceeded for a short hold and may skip levels, a step up needs the temperature a
+// hysteresis margin below the threshold for a long hold and goes one level at a time. Runtime performance pressure
+// puts a floor under the level.
+class ThermalGovernor {
+public:
+    static constexpr uint32_t LevelCount = 4;
+
+    struct Config {
+        // Smoothed temperature at which levels 1, 2 and 3 start.
+        float stepDownCelsius[LevelCount - 1]{68.0f, 75.0f, 82.0f};
+        float hysteresisCelsius{4.0f};
+        float stepDownHoldSeconds{3.0f};
+        float stepUpHoldSeconds{30.0f};
+        float smoothing{0.3f};
+    };
+
+    static StreamQuality GetQuality(uint32_t level);
+
+    ThermalGovernor() : ThermalGovernor(Config{}) {}
+
+    explicit ThermalGovernor(const Config& config);
+
+    // Returns true when the level changed.
+    bool Update(float celsius, PerfPressure pressure, float elapsedSeconds);
+
+    uint32_t GetLevel() const { return m_level; }
+
+    float GetCelsius() const { return m_celsius; }
+
+private:
+    uint32_t TargetLevel(float celsius, float margin) const;
+
+private:
+    Config m_config;
+    uint32_t m_level{0};
+    float m_celsius{0};
+    bool m_hasSample{false};
+    float m_hotTime{0};
+    float m_coolTime{0};
+};
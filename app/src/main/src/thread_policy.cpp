@@ -0,0 +1,277 @@
+/*
+    per thread role scheduling policy: core affinity, SCHED_FIFO priority and nice level
+*/
+#include "thread_policy.h"
+#include "logger.h"
+#include "common.h"
+#include <errno.h>
+#include <mutex>
+#include <sched.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+struct EffectivePolicy {
+    ThreadRole role;
+    pid_t tid;
+    uint32_t coreMask;
+    int schedPolicy;
+    int priority;
+    int nice;
+};
+
+// The render and pose paths are on the motion-to-photon critical path, audio underruns are audible, the rest is
+// housekeeping that should never compete with them.
+ThreadPolicy s_policies[] = {
+    {ThreadPolicy::BigCores, 2, -10},  // Render
+    {ThreadPolicy::BigCores, 3, -10},  // Pose
+    {ThreadPolicy::AnyCore, 2, -8},    // Input
+    {ThreadPolicy::AnyCore, 1, -16},   // Audio, matches ANDROID_PRIORITY_AUDIO
+    {ThreadPolicy::AnyCore, 0, -2},    // Control
+    {ThreadPolicy::AnyCore, 0, 0},     // Worker
+    {ThreadPolicy::AnyCore, 0, 10},    // Watcher
+};
+static_assert(ArraySize(s_policies) == (size_t)ThreadRole::Count, "one policy per thread role");
+
+const char* s_threadNames[] = {"cxr-render", "cxr-pose", "cxr-input", "cxr-audio", "cxr-control", "cxr-worker", "cxr-watcher"};
+static_assert(ArraySize(s_threadNames) == (size_t)ThreadRole::Count, "one thread name per thread role");
+
+std::mutex s_mutex;
+// Keyed by tid so a thread that applies again replaces its entry. Entries of exited threads are dropped on the next
+// Apply, otherwise every reconnect would add the new CloudXR callback threads for good.
+std::map<pid_t, EffectivePolicy> s_applied;
+
+pid_t CurrentThreadId() {
+    return (pid_t)syscall(SYS_gettid);
+}
+
+// Cores reporting the highest cpuinfo_max_freq, or AnyCore when every core is equal or the sysfs nodes are unreadable.
+uint32_t DetectBigCores() {
+    uint32_t mask = 0;
+    uint32_t coreCount = 0;
+    unsigned long bestFrequency = 0;
+    for (uint32_t cpu = 0; cpu < 32; cpu++) {
+        FILE* file = fopen(Fmt("/sys/devices/system/cpu/cpu%u/cpufreq/cpuinfo_max_freq", cpu).c_str(), "r");
+        if (file == nullptr) {
+            break;
+        }
+        unsigned long frequency = 0;
+        const bool valid = fscanf(file, "%lu", &frequency) == 1;
+        fclose(file);
+        if (!valid) {
+            break;
+        }
+        coreCount++;
+        if (frequency > bestFrequency) {
+            bestFrequency = frequency;
+            mask = 1u << cpu;
+        } else if (frequency == bestFrequency) {
+            mask |= 1u << cpu;
+        }
+    }
+    if (coreCount == 0 || mask == (coreCount == 32 ? 0xffffffffu : (1u << coreCount) - 1)) {
+        return ThreadPolicy::AnyCore;
+    }
+    return mask;
+}
+
+uint32_t ResolveCoreMask(uint32_t coreMask) {
+    if (coreMask == ThreadPolicy::BigCores) {
+        static const uint32_t bigCores = DetectBigCores();
+        return bigCores;
+    }
+    return coreMask;
+}
+
+uint32_t GetCurrentCoreMask() {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) {
+        return 0;
+    }
+    uint32_t mask = 0;
+    for (uint32_t cpu = 0; cpu < 32; cpu++) {
+        if (CPU_ISSET(cpu, &set)) {
+            mask |= 1u << cpu;
+        }
+    }
+    return mask;
+}
+
+const char* SchedPolicyName(int policy) {
+    switch (policy & ~SCHED_RESET_ON_FORK) {
+        case SCHED_OTHER:
+            return "OTHER";
+        case SCHED_FIFO:
+            return "FIFO";
+        case SCHED_RR:
+            return "RR";
+        case SCHED_BATCH:
+            return "BATCH";
+        case SCHED_IDLE:
+            return "IDLE";
+        default:
+            return "?";
+    }
+}
+
+void ApplyAffinity(ThreadRole role, uint32_t coreMask) {
+    if (coreMask == ThreadPolicy::AnyCore) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (uint32_t cpu = 0; cpu < 32; cpu++) {
+        if ((coreMask & (1u << cpu)) != 0) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        Log::Write(Log::Level::Warning,
+                   Fmt("%s: sched_setaffinity(0x%x) failed: %s", ThreadRoles::ToString(role), coreMask, strerror(errno)));
+    }
+}
+
+void ApplyScheduling(ThreadRole role, const ThreadPolicy& policy) {
+    // Library callback threads may already run at a higher real-time priority (AAudio does), never lower them.
+    const int currentPolicy = sched_getscheduler(0) & ~SCHED_RESET_ON_FORK;
+    if (currentPolicy == SCHED_FIFO || currentPolicy == SCHED_RR) {
+        sched_param current = {};
+        if (sched_getparam(0, &current) == 0 && current.sched_priority >= policy.fifoPriority) {
+            return;
+        }
+    }
+
+    if (policy.fifoPriority > 0) {
+        sched_param param = {};
+        param.sched_priority = policy.fifoPriority;
+        // Threads this one spawns start out as ordinary threads again.
+        if (sched_setscheduler(0, SCHED_FIFO | SCHED_RESET_ON_FORK, &param) == 0) {
+            return;
+        }
+        Log::Write(Log::Level::Verbose, Fmt("%s: SCHED_FIFO %d not permitted (%s), using nice %d", ThreadRoles::ToString(role),
+                                            policy.fifoPriority, strerror(errno), policy.nice));
+    }
+
+    // PRIO_PROCESS with a thread id adjusts only that thread on Linux.
+    if (setpriority(PRIO_PROCESS, CurrentThreadId(), policy.nice) != 0) {
+        Log::Write(Log::Level::Warning,
+                   Fmt("%s: setpriority(%d) failed: %s", ThreadRoles::ToString(role), policy.nice, strerror(errno)));
+    }
+}
+}  // namespace
+
+namespace ThreadRoles {
+const char* ToString(ThreadRole role) {
+    switch (role) {
+        case ThreadRole::Render:
+            return "Render";
+        case ThreadRole::Pose:
+            return "Pose";
+        case ThreadRole::Input:
+            return "Input";
+        case ThreadRole::Audio:
+            return "Audio";
+        case ThreadRole::Control:
+            return "Control";
+        case ThreadRole::Worker:
+            return "Worker";
+        case ThreadRole::Watcher:
+            return "Watcher";
+        default:
+            return "Unknown";
+    }
+}
+
+bool ParsePolicy(const std::string& text, ThreadPolicy* policy) {
+    const size_t first = text.find(',');
+    const size_t second = first == std::string::npos ? std::string::npos : text.find(',', first + 1);
+    if (second == std::string::npos) {
+        return false;
+    }
+    const std::string mask = text.substr(0, first);
+    ThreadPolicy parsed = {};
+    char* end = nullptr;
+    if (EqualsIgnoreCase(mask, "big")) {
+        parsed.coreMask = ThreadPolicy::BigCores;
+    } else {
+        parsed.coreMask = (uint32_t)strtoul(mask.c_str(), &end, 0);
+        if (mask.empty() || *end != '\0') {
+            return false;
+        }
+    }
+    parsed.fifoPriority = (int)strtol(text.c_str() + first + 1, &end, 10);
+    if (*end != ',' || parsed.fifoPriority < 0 || parsed.fifoPriority > 99) {
+        return false;
+    }
+    parsed.nice = (int)strtol(text.c_str() + second + 1, &end, 10);
+    if (*end != '\0' || parsed.nice < -20 || parsed.nice > 19) {
+        return false;
+    }
+    *policy = parsed;
+    return true;
+}
+
+void Configure(ThreadRole role, const ThreadPolicy& policy) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_policies[(size_t)role] = policy;
+}
+
+ThreadPolicy GetPolicy(ThreadRole role) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_policies[(size_t)role];
+}
+
+void Apply(ThreadRole role) {
+    const ThreadPolicy policy = GetPolicy(role);
+
+    prctl(PR_SET_NAME, (unsigned long)s_threadNames[(size_t)role], 0, 0, 0);
+    ApplyAffinity(role, ResolveCoreMask(policy.coreMask));
+    ApplyScheduling(role, policy);
+
+    EffectivePolicy effective = {};
+    effective.role = role;
+    effective.tid = CurrentThreadId();
+    effective.coreMask = GetCurrentCoreMask();
+    effective.schedPolicy = sched_getscheduler(0);
+    sched_param param = {};
+    sched_getparam(0, &param);
+    effective.priority = param.sched_priority;
+    errno = 0;
+    effective.nice = getpriority(PRIO_PROCESS, effective.tid);
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (auto it = s_applied.begin(); it != s_applied.end();) {
+        if (it->first != effective.tid && access(Fmt("/proc/self/task/%d", it->first).c_str(), F_OK) != 0) {
+            it = s_applied.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    s_applied[effective.tid] = effective;
+}
+
+void ApplyOnce(ThreadRole role) {
+    // Per role, a library may call back on one thread for several roles, e.g. audio and pose on a shared worker.
+    static thread_local bool applied[(size_t)ThreadRole::Count] = {};
+    if (!applied[(size_t)role]) {
+        applied[(size_t)role] = true;
+        Apply(role);
+    }
+}
+
+void LogDiagnostics() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Log::Write(Log::Level::Info, "Thread policies (requested -> effective):");
+    for (const auto& entry : s_applied) {
+        const EffectivePolicy& effective = entry.second;
+        const ThreadPolicy& requested = s_policies[(size_t)effective.role];
+        Log::Write(Log::Level::Info,
+                   Fmt("  %-7s tid %5d: cores 0x%08x fifo %2d nice %3d -> cores 0x%08x %s %2d nice %3d", ToString(effective.role),
+                       effective.tid, ResolveCoreMask(requested.coreMask), requested.fifoPriority, requested.nice,
+                       effective.coreMask, SchedPolicyName(effective.schedPolicy), effective.priority, effective.nice));
+    }
+}
+}  // namespace ThreadRoles
@@ -0,0 +1,54 @@
+/*
+    per thread role scheduling policy: core affinity, SCHED_FIFO priority and nice level
+*/
+
+#pragma once
+#include "pch.h"
+
+// Threads this client owns or receives callbacks on. Frame latching runs on the render thread, stats on the control
+// thread and logging on whichever thread writes, so those have no role of their own.
+enum class ThreadRole {
+    Render,     // android_main: OpenXR frame loop, CloudXR latch and submit
+    Pose,       // CloudXR GetTrackingState callback
+    Input,      // controller button and axis sampling when it runs faster than the frame rate
+    Audio,      // Oboe playback and CloudXR audio callbacks
+    Control,    // CloudXR connection, reconnect and stats thread
+    Worker,     // startup pool
+    Watcher,    // option file watcher
+    Count
+};
+
+struct ThreadPolicy {
+    // Leaves the affinity alone.
+    static constexpr uint32_t AnyCore = 0;
+    // Resolves to the cores with the highest maximum frequency.
+    static constexpr uint32_t BigCores = 0xffffffff;
+
+    uint32_t coreMask;
+    // SCHED_FIFO priority, 0 keeps SCHED_OTHER.
+    int fifoPriority;
+    // Used for SCHED_OTHER threads and as the fallback when SCHED_FIFO is not permitted, which is the usual case for
+    // an unprivileged app.
+    int nice;
+};
+
+namespace ThreadRoles {
+const char* ToString(ThreadRole role);
+
+// Parses "<coreMask>,<fifoPriority>,<nice>", e.g. "0xf0,2,-10". Masks are hex or decimal, "big" means BigCores.
+bool ParsePolicy(const std::string& text, ThreadPolicy* policy);
+
+// Must be called before the threads of that role are created to take effect.
+void Configure(ThreadRole role, const ThreadPolicy& policy);
+
+ThreadPolicy GetPolicy(ThreadRole role);
+
+// Names the calling thread and applies the role policy to it. The effective result is recorded for LogDiagnostics.
+void Apply(ThreadRole role);
+
+// For callback threads created by a library: applies the role the first time the thread calls in.
+void ApplyOnce(ThreadRole role);
+
+// Logs the requested and the effective policy of every thread that applied a role.
+void LogDiagnostics();
+}  // namespace ThreadRoles
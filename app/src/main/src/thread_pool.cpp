@@ -0,0 +1,151 @@
+/*
+    small work-stealing worker pool used to overlap startup work
+*/
+#include "thread_pool.h"
+#include "logger.h"
+#include "common.h"
+#include "thread_policy.h"
+
+namespace {
+// The pool the calling thread is a worker of, and its index there.
+thread_local ThreadPool* t_pool = nullptr;
+thread_local uint32_t t_workerIndex = 0;
+}  // namespace
+
+ThreadPool::ThreadPool(uint32_t threadCount): mPending(0), mSleeping(0), mStopping(false) {
+    mDeques.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        mDeques.emplace_back(new WorkStealingDeque<Task>());
+    }
+    mThreads.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        mThreads.emplace_back([this, i]() { WorkerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+    for (auto& thread : mThreads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    // Counted before it is visible so a worker never takes a task the count does not include. Pairs with the
+    // sleeping check in WorkerLoop: either this sees the sleeper or the sleeper sees the count.
+    mPending.fetch_add(1);
+
+    Task* item = new Task(std::move(task));
+    if (t_pool == this) {
+        mDeques[t_workerIndex]->Push(item);
+    } else {
+        std::lock_guard<std::mutex> lock(mInjectMutex);
+        mInjectQueue.push_back(item);
+    }
+
+    if (mSleeping.load() != 0) {
+        { std::lock_guard<std::mutex> lock(mMutex); }
+        mCondition.notify_one();
+    }
+}
+
+void ThreadPool::ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function) {
+    if (count == 0) {
+        return;
+    }
+    grainSize = std::max<size_t>(grainSize, 1);
+    const size_t chunks = (count + grainSize - 1) / grainSize;
+
+    // Helpers can start after the loop is finished, so the shared state outlives this call.
+    struct Loop {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto loop = std::make_shared<Loop>();
+    const auto runChunks = [loop, count, grainSize, chunks, &function]() {
+        for (size_t chunk = loop->next.fetch_add(1); chunk < chunks; chunk = loop->next.fetch_add(1)) {
+            const size_t begin = chunk * grainSize;
+            function(begin, std::min(begin + grainSize, count));
+            if (loop->done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->finished.notify_all();
+            }
+        }
+    };
+
+    // A helper that wakes up after the last chunk was claimed returns without touching function.
+    const size_t helpers = std::min<size_t>(chunks - 1, mThreads.size());
+    for (size_t i = 0; i < helpers; i++) {
+        Submit(runChunks);
+    }
+    runChunks();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&]() { return loop->done.load() == chunks; });
+}
+
+ThreadPool::Task* ThreadPool::FindTask(uint32_t index) {
+    if (Task* task = mDeques[index]->Pop()) {
+        return task;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mInjectMutex);
+        if (!mInjectQueue.empty()) {
+            Task* task = mInjectQueue.front();
+            mInjectQueue.pop_front();
+            return task;
+        }
+    }
+    const uint32_t count = (uint32_t)mDeques.size();
+    for (uint32_t i = 1; i < count; i++) {
+        if (Task* task = mDeques[(index + i) % count]->Steal()) {
+            return task;
+        }
+    }
+    return nullptr;
+}
+
+void ThreadPool::Execute(Task* task) {
+    // A throwing task must not take the worker (and with it the process) down, callers that care catch themselves.
+    try {
+        (*task)();
+    } catch (const std::exception& ex) {
+        Log::Write(Log::Level::Error, Fmt("Unhandled exception in pool task: %s", ex.what()));
+    } catch (...) {
+        Log::Write(Log::Level::Error, "Unhandled exception in pool task");
+    }
+    delete task;
+}
+
+void ThreadPool::WorkerLoop(uint32_t index) {
+    ThreadRoles::Apply(ThreadRole::Worker);
+    t_pool = this;
+    t_workerIndex = index;
+
+    for (;;) {
+        if (Task* task = FindTask(index)) {
+            mPending.fetch_sub(1);
+            Execute(task);
+            continue;
+        }
+        if (mPending.load() != 0) {
+            // Counted but not yet visible in a deque, or lost a steal race.
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+        mSleeping.fetch_add(1);
+        mCondition.wait(lock, [this]() { return mStopping || mPending.load() != 0; });
+        mSleeping.fetch_sub(1);
+        if (mStopping && mPending.load() == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,56 @@
+/*
+    small work-stealing worker pool used to overlap startup work
+*/
+
+#pragma once
+#include "pch.h"
+#include "work_stealing_deque.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Fixed set of worker threads. Each worker owns a work-stealing deque: tasks submitted from a worker go to its own
+// deque and run newest first, idle workers steal the oldest task of a busy one. Tasks from other threads enter through
+// a shared queue. Ordering between tasks is not guaranteed, dependent work is chained by the caller (see StartupGraph).
+// The destructor runs every task that was already submitted before joining the workers.
+class ThreadPool {
+public:
+
+    explicit ThreadPool(uint32_t threadCount);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> task);
+
+    // Calls function(begin, end) over [0, count) in chunks of at most grainSize and returns when all chunks are done.
+    // The calling thread works on chunks too, so this may be called from a pool task.
+    void ParallelFor(size_t count, size_t grainSize, const std::function<void(size_t, size_t)>& function);
+
+    uint32_t GetThreadCount() const { return (uint32_t)mThreads.size(); }
+
+private:
+    using Task = std::function<void()>;
+
+    void WorkerLoop(uint32_t index);
+
+    Task* FindTask(uint32_t index);
+
+    void Execute(Task* task);
+
+private:
+    std::vector<std::unique_ptr<WorkStealingDeque<Task>>> mDeques;
+    std::vector<std::thread> mThreads;
+
+    std::mutex mInjectMutex;
+    std::deque<Task*> mInjectQueue;
+
+    // Tasks submitted and not yet taken. Workers only sleep while it is zero.
+    std::atomic<uint32_t> mPending;
+    std::atomic<uint32_t> mSleeping;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    bool mStopping;
+};
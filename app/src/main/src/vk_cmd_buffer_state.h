@@ -0,0 +1,82 @@
+/*
+    lifecycle of a vulkan command buffer as tracked by the vulkan graphics plugin
+*/
+
+#pragma once
+
+// The states a VkCommandBuffer goes through in the plugin. Executing means submitted with a fence that has not been
+// waited on yet, several command buffers can be Executing at once.
+enum class CmdBufferState { Undefined, Initialized, Recording, Executable, Executing };
+
+// The operations CmdBuffer performs on its command buffer.
+enum class CmdBufferEvent { Init, Begin, End, Submit, Wait, Reset };
+
+// Where an event leads. 'valid' is false when the event is not allowed in the current state, the state is then left
+// alone. 'needsWork' is false for the events that are a no-op in the current state, such as waiting on a command buffer
+// that is not in flight, the caller then makes no Vulkan call.
+struct CmdBufferTransition {
+    bool valid;
+    bool needsWork;
+    CmdBufferState next;
+};
+
+inline CmdBufferTransition NextCmdBufferState(CmdBufferState state, CmdBufferEvent event) {
+    const CmdBufferTransition invalid{false, false, state};
+    const CmdBufferTransition noOp{true, false, state};
+    switch (event) {
+        case CmdBufferEvent::Init:
+            return state == CmdBufferState::Undefined ? CmdBufferTransition{true, true, CmdBufferState::Initialized} : invalid;
+        case CmdBufferEvent::Begin:
+            return state == CmdBufferState::Initialized ? CmdBufferTransition{true, true, CmdBufferState::Recording} : invalid;
+        case CmdBufferEvent::End:
+            return state == CmdBufferState::Recording ? CmdBufferTransition{true, true, CmdBufferState::Executable} : invalid;
+        case CmdBufferEvent::Submit:
+            return state == CmdBufferState::Executable ? CmdBufferTransition{true, true, CmdBufferState::Executing} : invalid;
+        case CmdBufferEvent::Wait:
+            // The buffer can be executed again once its fence signalled.
+            if (state == CmdBufferState::Executing) {
+                return {true, true, CmdBufferState::Executable};
+            }
+            return state == CmdBufferState::Initialized || state == CmdBufferState::Executable ? noOp : invalid;
+        case CmdBufferEvent::Reset:
+            if (state == CmdBufferState::Executable) {
+                return {true, true, CmdBufferState::Initialized};
+            }
+            return state == CmdBufferState::Initialized ? noOp : invalid;
+    }
+    return invalid;
+}
+
+inline const char* CmdBufferStateName(CmdBufferState state) {
+    switch (state) {
+        case CmdBufferState::Undefined:
+            return "Undefined";
+        case CmdBufferState::Initialized:
+            return "Initialized";
+        case CmdBufferState::Recording:
+            return "Recording";
+        case CmdBufferState::Executable:
+            return "Executable";
+        case CmdBufferState::Executing:
+            return "Executing";
+    }
+    return "(Unknown)";
+}
+
+inline const char* CmdBufferEventName(CmdBufferEvent event) {
+    switch (event) {
+        case CmdBufferEvent::Init:
+            return "Init";
+        case CmdBufferEvent::Begin:
+            return "Begin";
+        case CmdBufferEvent::End:
+            return "End";
+        case CmdBufferEvent::Submit:
+            return "Submit";
+        case CmdBufferEvent::Wait:
+            return "Wait";
+        case CmdBufferEvent::Reset:
+            return "Reset";
+    }
+    return "(Unknown)";
+}
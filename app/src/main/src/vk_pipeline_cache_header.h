@@ -0,0 +1,50 @@
+/*
+    validation of a saved vulkan pipeline cache blob against the device that is about to use it
+*/
+
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// VK_UUID_SIZE and VK_PIPELINE_CACHE_HEADER_VERSION_ONE, spelled out so the check builds without the Vulkan headers.
+// The plugin static_asserts that they agree.
+constexpr size_t PipelineCacheUuidSize = 16;
+constexpr uint32_t PipelineCacheHeaderVersionOne = 1;
+
+// Layout of VK_PIPELINE_CACHE_HEADER_VERSION_ONE: headerSize, headerVersion, vendorID, deviceID, pipelineCacheUUID.
+constexpr size_t PipelineCacheHeaderSize = 4 * sizeof(uint32_t) + PipelineCacheUuidSize;
+
+// What identifies the driver cache format, from VkPhysicalDeviceProperties.
+struct PipelineCacheDevice {
+    uint32_t vendorID;
+    uint32_t deviceID;
+    uint8_t pipelineCacheUUID[PipelineCacheUuidSize];
+};
+
+// Why a blob is not handed to vkCreatePipelineCache. The driver should ignore a foreign blob itself, checking first keeps
+// that from depending on every mobile driver getting it right.
+enum class PipelineCacheCheck { Valid, Truncated, BadHeader, OtherDevice };
+
+inline PipelineCacheCheck CheckPipelineCacheHeader(const uint8_t* data, size_t size, const PipelineCacheDevice& device) {
+    if (data == nullptr || size < PipelineCacheHeaderSize) {
+        return PipelineCacheCheck::Truncated;
+    }
+
+    // The blob is a plain byte array, fields are read with memcpy since it need not be aligned.
+    uint32_t header[4];
+    memcpy(header, data, sizeof(header));
+    const uint8_t* uuid = data + sizeof(header);
+    if (header[0] < PipelineCacheHeaderSize || header[1] != PipelineCacheHeaderVersionOne) {
+        return PipelineCacheCheck::BadHeader;
+    }
+    // The header claims more than the file holds, the save was cut short.
+    if (header[0] > size) {
+        return PipelineCacheCheck::Truncated;
+    }
+    if (header[2] != device.vendorID || header[3] != device.deviceID ||
+        memcmp(uuid, device.pipelineCacheUUID, PipelineCacheUuidSize) != 0) {
+        return PipelineCacheCheck::OtherDevice;
+    }
+    return PipelineCacheCheck::Valid;
+}
@@ -0,0 +1,116 @@
+/*
+    Chase-Lev work-stealing deque
+*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Lock-free deque of pointers after Chase and Lev, "Dynamic Circular Work-Stealing Deque". The bottom/top handshake
+// uses sequentially consistent operations instead of the standalone fences of Le et al., which costs little at task
+// granularity and keeps the deque checkable with ThreadSanitizer. The owning thread pushes and pops at the bottom, any other thread steals
+// from the top. The ring grows when full; outgrown rings are kept until destruction because a concurrent thief may
+// still be reading one.
+template <typename T>
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(size_t capacity = 256) : mTop(0), mBottom(0) {
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        mRings.emplace_back(new Ring(size));
+        mRing.store(mRings.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Owner only.
+    void Push(T* item) {
+        const int64_t bottom = mBottom.load(std::memory_order_relaxed);
+        const int64_t top = mTop.load(std::memory_order_acquire);
+        Ring* ring = mRing.load(std::memory_order_relaxed);
+        if (bottom - top > (int64_t)ring->mask) {
+            ring = Grow(ring, top, bottom);
+        }
+        ring->Store(bottom, item);
+        mBottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only, newest first. Returns nullptr when empty.
+    T* Pop() {
+        const int64_t bottom = mBottom.load(std::memory_order_relaxed) - 1;
+        Ring* ring = mRing.load(std::memory_order_relaxed);
+        mBottom.store(bottom, std::memory_order_seq_cst);
+        int64_t top = mTop.load(std::memory_order_seq_cst);
+
+        T* item = nullptr;
+        if (top <= bottom) {
+            item = ring->Load(bottom);
+            if (top == bottom) {
+                // Last item, race the thieves for it.
+                if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    item = nullptr;
+                }
+                mBottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+        } else {
+            mBottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Any thread, oldest first. Returns nullptr when empty or when another thread won the race.
+    T* Steal() {
+        int64_t top = mTop.load(std::memory_order_seq_cst);
+        const int64_t bottom = mBottom.load(std::memory_order_seq_cst);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        Ring* ring = mRing.load(std::memory_order_acquire);
+        T* item = ring->Load(top);
+        if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    bool Empty() const {
+        return mBottom.load(std::memory_order_relaxed) <= mTop.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Ring {
+        explicit Ring(size_t size) : mask(size - 1), items(new std::atomic<T*>[size]) {}
+
+        void Store(int64_t index, T* item) { items[index & mask].store(item, std::memory_order_relaxed); }
+
+        T* Load(int64_t index) const { return items[index & mask].load(std::memory_order_relaxed); }
+
+        const size_t mask;
+        std::unique_ptr<std::atomic<T*>[]> items;
+    };
+
+    Ring* Grow(Ring* ring, int64_t top, int64_t bottom) {
+        mRings.emplace_back(new Ring((ring->mask + 1) * 2));
+        Ring* grown = mRings.back().get();
+        for (int64_t i = top; i < bottom; i++) {
+            grown->Store(i, ring->Load(i));
+        }
+        mRing.store(grown, std::memory_order_release);
+        return grown;
+    }
+
+private:
+    // Top and bottom a cache line apart, thieves hammer the first and the owner the second. Padding rather than
+    // alignas(64): the deques are heap allocated and C++14 operator new does not honour extended alignment.
+    std::atomic<int64_t> mTop;
+    char mPadding[64 - sizeof(std::atomic<int64_t>)];
+    std::atomic<int64_t> mBottom;
+    std::atomic<Ring*> mRing;
+    // Owner only.
+    std::vector<std::unique_ptr<Ring>> mRings;
+};
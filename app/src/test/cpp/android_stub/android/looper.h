@@ -0,0 +1,45 @@
+/*
+    the part of the NDK looper API the host tests use, implemented over epoll in looper_stub.cpp
+*/
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct ALooper;
+typedef struct ALooper ALooper;
+
+enum {
+    ALOOPER_PREPARE_ALLOW_NON_CALLBACKS = 1 << 0,
+};
+
+enum {
+    ALOOPER_POLL_WAKE = -1,
+    ALOOPER_POLL_CALLBACK = -2,
+    ALOOPER_POLL_TIMEOUT = -3,
+    ALOOPER_POLL_ERROR = -4,
+};
+
+enum {
+    ALOOPER_EVENT_INPUT = 1 << 0,
+    ALOOPER_EVENT_OUTPUT = 1 << 1,
+    ALOOPER_EVENT_ERROR = 1 << 2,
+    ALOOPER_EVENT_HANGUP = 1 << 3,
+};
+
+typedef int (*ALooper_callbackFunc)(int fd, int events, void* data);
+
+// The calling thread's looper, created on first use. Callbacks are not supported, every fd needs an ident.
+ALooper* ALooper_prepare(int opts);
+
+int ALooper_pollAll(int timeoutMillis, int* outFd, int* outEvents, void** outData);
+
+int ALooper_addFd(ALooper* looper, int fd, int ident, int events, ALooper_callbackFunc callback, void* data);
+
+int ALooper_removeFd(ALooper* looper, int fd);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,12 @@
+/*
+    the looper idents of the native app glue, for client modules that register fds with the main looper
+*/
+
+#pragma once
+#include <android/looper.h>
+
+enum {
+    LOOPER_ID_MAIN = 1,
+    LOOPER_ID_INPUT = 2,
+    LOOPER_ID_USER = 3,
+};
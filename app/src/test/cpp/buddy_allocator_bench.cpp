@@ -0,0 +1,57 @@
+/*
+    BuddyAllocator timings, prints nanoseconds per allocate and free pair
+*/
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "buddy_allocator.h"
+
+namespace {
+
+const uint64_t BlockSize = 16 * 1024 * 1024;
+const uint64_t MinSize = 256;
+
+// Fills the block to 'fill' with random buffer sized ranges, then times freeing a random live range and allocating a
+// new one in its place, the steady state of a block that is in use.
+double NsPerPair(double fill, uint64_t maxSize) {
+    BuddyAllocator buddy;
+    buddy.Init(BlockSize, MinSize);
+
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<uint64_t> sizes(64, maxSize);
+    std::vector<uint64_t> live;
+    uint64_t offset = 0;
+    while (buddy.UsedSize() < BlockSize * fill && buddy.Allocate(sizes(random), 256, &offset)) {
+        live.push_back(offset);
+    }
+
+    const int pairs = 1000000;
+    std::vector<size_t> victims(pairs);
+    std::vector<uint64_t> newSizes(pairs);
+    for (int i = 0; i < pairs; i++) {
+        victims[i] = std::uniform_int_distribution<size_t>(0, live.size() - 1)(random);
+        newSizes[i] = sizes(random);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < pairs; i++) {
+        uint64_t& slot = live[victims[i]];
+        buddy.Free(slot);
+        if (!buddy.Allocate(newSizes[i], 256, &slot)) {
+            // Fragmented too far for this size, put back the smallest range so the live count stays the same.
+            buddy.Allocate(MinSize, 256, &slot);
+        }
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / pairs;
+}
+
+}  // namespace
+
+int main() {
+    printf("%-10s %10s %10s\n", "fill", "<=4 KiB", "<=64 KiB");
+    for (double fill : {0.25, 0.5, 0.75, 0.9}) {
+        printf("%-10.2f %10.1f %10.1f\n", fill, NsPerPair(fill, 4 * 1024), NsPerPair(fill, 64 * 1024));
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+/*
+    BuddyAllocator bookkeeping: alignment, fragmentation and coalescing under churn
+*/
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <vector>
+#include "buddy_allocator.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+const uint64_t BlockSize = 16 * 1024 * 1024;
+const uint64_t MinSize = 256;
+
+uint64_t RoundedSize(uint64_t size, uint64_t alignment) {
+    uint64_t rounded = MinSize;
+    while (rounded < size || rounded < alignment) {
+        rounded <<= 1;
+    }
+    return rounded;
+}
+
+// Live ranges keyed by offset, checked against each other and against the allocator's accounting.
+struct Shadow {
+    std::map<uint64_t, uint64_t> ranges;
+    uint64_t used{0};
+
+    void Add(uint64_t offset, uint64_t size) {
+        auto next = ranges.lower_bound(offset);
+        if (next != ranges.end()) {
+            REQUIRE(offset + size <= next->first);
+        }
+        if (next != ranges.begin()) {
+            auto prev = std::prev(next);
+            REQUIRE(prev->first + prev->second <= offset);
+        }
+        ranges[offset] = size;
+        used += size;
+    }
+
+    void Remove(uint64_t offset) {
+        used -= ranges.at(offset);
+        ranges.erase(offset);
+    }
+};
+
+}  // namespace
+
+TEST_CASE("Allocations are aligned and never overlap", "[buddy_allocator]") {
+    BuddyAllocator buddy;
+    buddy.Init(BlockSize, MinSize);
+    Shadow shadow;
+
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<uint64_t> sizes(1, 256 * 1024);
+    std::uniform_int_distribution<int> alignmentShift(0, 12);
+    for (int i = 0; i < 200; i++) {
+        const uint64_t size = sizes(random);
+        const uint64_t alignment = uint64_t(1) << alignmentShift(random);
+        uint64_t offset = ~uint64_t(0);
+        if (!buddy.Allocate(size, alignment, &offset)) {
+            break;
+        }
+        REQUIRE(offset % alignment == 0);
+        REQUIRE(offset + size <= BlockSize);
+        shadow.Add(offset, RoundedSize(size, alignment));
+        REQUIRE(buddy.UsedSize() == shadow.used);
+    }
+    REQUIRE(shadow.ranges.size() > 50);
+}
+
+TEST_CASE("A full block refuses more and coalesces back once freed", "[buddy_allocator]") {
+    BuddyAllocator buddy;
+    buddy.Init(64 * 1024, MinSize);
+
+    std::vector<uint64_t> offsets;
+    uint64_t offset = 0;
+    while (buddy.Allocate(MinSize, 1, &offset)) {
+        offsets.push_back(offset);
+    }
+    REQUIRE(offsets.size() == 64 * 1024 / MinSize);
+    REQUIRE(buddy.UsedSize() == buddy.Size());
+
+    std::shuffle(offsets.begin(), offsets.end(), std::mt19937(42));
+    for (uint64_t freed : offsets) {
+        buddy.Free(freed);
+    }
+    REQUIRE(buddy.Empty());
+    REQUIRE(buddy.UsedSize() == 0);
+
+    // Every buddy pair merged again, so the whole range is one free block.
+    REQUIRE(buddy.Allocate(buddy.Size(), 1, &offset));
+    REQUIRE(offset == 0);
+}
+
+TEST_CASE("Holes only merge with their own buddy", "[buddy_allocator]") {
+    BuddyAllocator buddy;
+    buddy.Init(4096, MinSize);
+
+    std::vector<uint64_t> offsets;
+    uint64_t offset = 0;
+    while (buddy.Allocate(MinSize, 1, &offset)) {
+        offsets.push_back(offset);
+    }
+
+    // Freeing every other range leaves half the block free, but in holes too small for anything bigger.
+    for (size_t i = 0; i < offsets.size(); i += 2) {
+        buddy.Free(offsets[i]);
+    }
+    REQUIRE(buddy.UsedSize() == buddy.Size() / 2);
+    REQUIRE_FALSE(buddy.Allocate(2 * MinSize, 1, &offset));
+    REQUIRE(buddy.Allocate(MinSize, 1, &offset));
+    buddy.Free(offset);
+
+    // Freeing the neighbours of the holes merges them pairwise, then all the way up.
+    buddy.Free(offsets[1]);
+    REQUIRE(buddy.Allocate(2 * MinSize, 1, &offset));
+    REQUIRE(offset == 0);
+    buddy.Free(offset);
+    for (size_t i = 3; i < offsets.size(); i += 2) {
+        buddy.Free(offsets[i]);
+    }
+    REQUIRE(buddy.Allocate(buddy.Size(), 1, &offset));
+}
+
+TEST_CASE("Oversized requests and bad frees are rejected", "[buddy_allocator]") {
+    BuddyAllocator buddy;
+    REQUIRE_THROWS_AS(buddy.Init(3000, MinSize), std::logic_error);
+
+    buddy.Init(4096, MinSize);
+    uint64_t offset = 0;
+    REQUIRE_FALSE(buddy.Allocate(4097, 1, &offset));
+    REQUIRE_FALSE(buddy.Allocate(1, 8192, &offset));
+    REQUIRE_THROWS_AS(buddy.Free(512), std::logic_error);
+
+    REQUIRE(buddy.Allocate(100, 1, &offset));
+    buddy.Free(offset);
+    REQUIRE_THROWS_AS(buddy.Free(offset), std::logic_error);
+}
+
+TEST_CASE("Random churn keeps the accounting and ends fully coalesced", "[buddy_allocator]") {
+    BuddyAllocator buddy;
+    buddy.Init(BlockSize, MinSize);
+    Shadow shadow;
+
+    // Resource sizes like the plugin's: vertex, index and instance buffers, with a few larger ones.
+    std::mt19937 random(7);
+    std::uniform_int_distribution<uint64_t> smallSizes(64, 64 * 1024);
+    std::uniform_int_distribution<uint64_t> largeSizes(256 * 1024, 2 * 1024 * 1024);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::vector<uint64_t> live;
+    uint64_t failed = 0;
+    for (int i = 0; i < 100000; i++) {
+        const bool allocate = live.empty() || percent(random) < 55;
+        if (allocate) {
+            const uint64_t size = percent(random) < 5 ? largeSizes(random) : smallSizes(random);
+            uint64_t offset = 0;
+            if (buddy.Allocate(size, 256, &offset)) {
+                shadow.Add(offset, RoundedSize(size, 256));
+                live.push_back(offset);
+            } else {
+                failed++;
+            }
+        } else {
+            const size_t index = std::uniform_int_distribution<size_t>(0, live.size() - 1)(random);
+            buddy.Free(live[index]);
+            shadow.Remove(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+        }
+        REQUIRE(buddy.UsedSize() == shadow.used);
+    }
+    INFO("failed allocations: " << failed);
+
+    for (uint64_t offset : live) {
+        buddy.Free(offset);
+    }
+    REQUIRE(buddy.Empty());
+    uint64_t offset = 0;
+    REQUIRE(buddy.Allocate(BlockSize, 1, &offset));
+}
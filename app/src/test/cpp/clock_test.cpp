@@ -0,0 +1,87 @@
+/*
+    clock conversions: nanosecond precision and XrTime conversion while the instance changes
+*/
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "clock.h"
+#include "openxr_stub.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+TEST_CASE("Timespec conversions keep every nanosecond", "[clock]") {
+    // A year of uptime plus an odd nanosecond count is past what a double holds exactly.
+    const int64_t yearNs = 365LL * 24 * 3600 * 1000000000LL + 123456789;
+    for (int64_t ns : {int64_t(0), int64_t(1), int64_t(999999999), int64_t(1000000000), yearNs, int64_t(-1), -yearNs}) {
+        INFO(ns);
+        const timespec time = Clock::ToTimespec(ns);
+        REQUIRE(time.tv_nsec >= 0);
+        REQUIRE(time.tv_nsec < 1000000000);
+        REQUIRE(Clock::FromTimespec(time) == ns);
+    }
+    REQUIRE(Clock::ToTimespec(-1).tv_sec == -1);
+    REQUIRE(Clock::ToTimespec(-1).tv_nsec == 999999999);
+}
+
+TEST_CASE("NowNs is monotonic and on the steady_clock timeline", "[clock]") {
+    const int64_t steadyBefore = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t previous = Clock::NowNs();
+    for (int i = 0; i < 100000; i++) {
+        const int64_t now = Clock::NowNs();
+        REQUIRE(now >= previous);
+        previous = now;
+    }
+    const int64_t steadyAfter = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    REQUIRE(previous >= steadyBefore);
+    REQUIRE(previous <= steadyAfter);
+}
+
+TEST_CASE("XrTime conversion uses the runtime when available and identity otherwise", "[clock]") {
+    const int64_t ns = 5000000000123;
+
+    Clock::InitializeXrTime(XR_NULL_HANDLE, false);
+    REQUIRE(Clock::ToXrTime(ns) == ns);
+    REQUIRE(Clock::FromXrTime(ns) == ns);
+
+    Clock::InitializeXrTime(StubXrInstance(), false);
+    REQUIRE(Clock::ToXrTime(ns) == ns);
+
+    Clock::InitializeXrTime(StubXrInstance(), true);
+    REQUIRE(Clock::ToXrTime(ns) == ns + StubXrTimeOffsetNs);
+    REQUIRE(Clock::FromXrTime(Clock::ToXrTime(ns)) == ns);
+
+    Clock::InitializeXrTime(XR_NULL_HANDLE, false);
+    REQUIRE(Clock::ToXrTime(ns) == ns);
+}
+
+TEST_CASE("XrTime conversion is safe while the instance is replaced", "[clock]") {
+    std::atomic<bool> stop{false};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 4; i++) {
+        readers.emplace_back([&]() {
+            const int64_t ns = 7000000000042;
+            while (!stop) {
+                // Either conversion is fine, a mix of the two within one call is not.
+                const XrTime xrTime = Clock::ToXrTime(ns);
+                if (xrTime != ns && xrTime != ns + StubXrTimeOffsetNs) {
+                    bad++;
+                }
+                const int64_t back = Clock::FromXrTime(ns + StubXrTimeOffsetNs);
+                if (back != ns && back != ns + StubXrTimeOffsetNs) {
+                    bad++;
+                }
+            }
+        });
+    }
+    for (int i = 0; i < 20000; i++) {
+        Clock::InitializeXrTime(i % 2 == 0 ? StubXrInstance() : XR_NULL_HANDLE, i % 2 == 0);
+    }
+    stop = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    Clock::InitializeXrTime(XR_NULL_HANDLE, false);
+    REQUIRE(bad == 0);
+}
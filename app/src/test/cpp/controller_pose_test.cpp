@@ -0,0 +1,142 @@
+/*
+    controller slots and pose validity of the sampled controller poses against the stub runtime
+*/
+#include <stdexcept>
+#include "controller_pose.h"
+#include "openxr_stub.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+constexpr XrSpaceLocationFlags Tracked = XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT |
+                                         XR_SPACE_LOCATION_POSITION_TRACKED_BIT | XR_SPACE_LOCATION_ORIENTATION_TRACKED_BIT;
+
+XrSpace Space(uint64_t id) { return (XrSpace)(uintptr_t)id; }
+
+// Left hand in slot 0 and right hand in slot 1, each with its own grip and aim space.
+struct Hands {
+    Hands() {
+        spaces[0] = {(XrPath)10, Space(0x11), Space(0x12)};
+        spaces[1] = {(XrPath)20, Space(0x21), Space(0x22)};
+    }
+
+    void Sample(bool sampleAim) {
+        SampleControllerPoses((XrSession)(uintptr_t)0x2, (XrAction)(uintptr_t)0x3, spaces, Space(0x1), 1000, sampleAim, controllers);
+    }
+
+    ControllerSpaces spaces[ControllerCount];
+    ControllerPoseSample controllers[ControllerCount];
+};
+
+StubSpaceLocation At(float x, XrSpaceLocationFlags flags = Tracked) {
+    StubSpaceLocation location;
+    location.flags = flags;
+    location.pose.position = {x, 1.0f, -0.5f};
+    location.velocityFlags = XR_SPACE_VELOCITY_LINEAR_VALID_BIT | XR_SPACE_VELOCITY_ANGULAR_VALID_BIT;
+    location.linearVelocity = {x, 0, 0};
+    location.angularVelocity = {0, x, 0};
+    return location;
+}
+
+}  // namespace
+
+TEST_CASE("Controller poses land in the slot of their hand", "[controller_pose]") {
+    StubResetSpaces();
+    Hands hands;
+    StubSetPoseActionActive(hands.spaces[1].subactionPath, true);
+    StubSetSpaceLocation(hands.spaces[1].gripSpace, At(0.3f));
+    StubSetSpaceLocation(hands.spaces[1].aimSpace, At(0.35f));
+
+    // Only the right hand is there, it stays in slot 1.
+    hands.Sample(true);
+    REQUIRE_FALSE(hands.controllers[0].connected);
+    REQUIRE_FALSE(hands.controllers[0].poseValid);
+    REQUIRE_FALSE(hands.controllers[0].aimValid);
+    REQUIRE(hands.controllers[1].connected);
+    REQUIRE(hands.controllers[1].poseValid);
+    REQUIRE(hands.controllers[1].pose.position.x == 0.3f);
+    REQUIRE(hands.controllers[1].linearVelocity.x == 0.3f);
+    REQUIRE(hands.controllers[1].angularVelocity.y == 0.3f);
+    REQUIRE(hands.controllers[1].aimValid);
+    REQUIRE(hands.controllers[1].aimPose.position.x == 0.35f);
+
+    // The left hand joins, each keeps its own slot.
+    StubSetPoseActionActive(hands.spaces[0].subactionPath, true);
+    StubSetSpaceLocation(hands.spaces[0].gripSpace, At(-0.3f));
+    hands.Sample(false);
+    REQUIRE(hands.controllers[0].poseValid);
+    REQUIRE(hands.controllers[0].pose.position.x == -0.3f);
+    REQUIRE(hands.controllers[1].pose.position.x == 0.3f);
+    // Aim is only located when asked for.
+    REQUIRE_FALSE(hands.controllers[0].aimValid);
+    REQUIRE_FALSE(hands.controllers[1].aimValid);
+
+    // What is streamed for each slot.
+    REQUIRE(SelectControllerPose(hands.controllers[0], true) == &hands.controllers[0].pose);
+    hands.Sample(true);
+    REQUIRE(SelectControllerPose(hands.controllers[1], true) == &hands.controllers[1].aimPose);
+    REQUIRE(SelectControllerPose(hands.controllers[1], false) == &hands.controllers[1].pose);
+}
+
+TEST_CASE("Untracked controllers clear their flags instead of keeping the last pose", "[controller_pose]") {
+    StubResetSpaces();
+    Hands hands;
+    for (uint32_t hand = 0; hand < ControllerCount; hand++) {
+        StubSetPoseActionActive(hands.spaces[hand].subactionPath, true);
+        StubSetSpaceLocation(hands.spaces[hand].gripSpace, At(hand == 0 ? -0.3f : 0.3f));
+        StubSetSpaceLocation(hands.spaces[hand].aimSpace, At(hand == 0 ? -0.35f : 0.35f));
+    }
+    hands.Sample(true);
+    REQUIRE(hands.controllers[0].poseValid);
+    REQUIRE(hands.controllers[1].poseValid);
+
+    // The left hand loses orientation and the right one is out of view with only velocities left, both into the same
+    // array the previous frame filled.
+    StubSetSpaceLocation(hands.spaces[0].gripSpace, At(-0.4f, XR_SPACE_LOCATION_POSITION_VALID_BIT));
+    StubSetSpaceLocation(hands.spaces[0].aimSpace, At(-0.45f, XR_SPACE_LOCATION_POSITION_VALID_BIT));
+    StubSetSpaceLocation(hands.spaces[1].gripSpace, At(0.4f, 0));
+    StubSetSpaceLocation(hands.spaces[1].aimSpace, At(0.45f, 0));
+    hands.Sample(true);
+    for (uint32_t hand = 0; hand < ControllerCount; hand++) {
+        const ControllerPoseSample& sample = hands.controllers[hand];
+        INFO("hand " << hand);
+        REQUIRE(sample.connected);
+        REQUIRE_FALSE(sample.poseValid);
+        REQUIRE_FALSE(sample.aimValid);
+        REQUIRE(sample.pose.position.x == 0.0f);
+        REQUIRE(sample.linearVelocity.x == 0.0f);
+        REQUIRE(sample.angularVelocity.y == 0.0f);
+        REQUIRE(SelectControllerPose(sample, true) == nullptr);
+        REQUIRE(SelectControllerPose(sample, false) == nullptr);
+    }
+
+    // A qualified success is not a location either.
+    StubSetSpaceLocation(hands.spaces[0].gripSpace, At(-0.3f));
+    StubSpaceLocation lossPending = At(0.3f);
+    lossPending.result = XR_SESSION_LOSS_PENDING;
+    StubSetSpaceLocation(hands.spaces[1].gripSpace, lossPending);
+    hands.Sample(false);
+    REQUIRE(hands.controllers[0].poseValid);
+    REQUIRE_FALSE(hands.controllers[1].poseValid);
+
+    // A tracked aim with an untracked grip streams nothing, the aim alone is not trusted.
+    StubSetSpaceLocation(hands.spaces[1].gripSpace, At(0.3f, 0));
+    StubSetSpaceLocation(hands.spaces[1].aimSpace, At(0.35f));
+    hands.Sample(true);
+    REQUIRE(hands.controllers[1].aimValid);
+    REQUIRE(SelectControllerPose(hands.controllers[1], true) == nullptr);
+
+    // A disconnected controller is reported as such.
+    StubSetPoseActionActive(hands.spaces[0].subactionPath, false);
+    hands.Sample(false);
+    REQUIRE_FALSE(hands.controllers[0].connected);
+
+    // Runtime errors are not swallowed.
+    StubSpaceLocation lost;
+    lost.result = XR_ERROR_SESSION_LOST;
+    StubSetSpaceLocation(hands.spaces[0].gripSpace, lost);
+    REQUIRE_THROWS(hands.Sample(false));
+    StubResetSpaces();
+}
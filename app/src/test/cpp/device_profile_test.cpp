@@ -0,0 +1,44 @@
+/*
+    device profile table lookups
+*/
+#include <string>
+#include "device_profile.h"
+#include <catch2/catch.hpp>
+
+TEST_CASE("Every table entry is found by its product name", "[device_profile]") {
+    for (size_t i = 0; i < s_deviceProfileCount; i++) {
+        INFO(s_deviceProfiles[i].productName);
+        REQUIRE(&FindDeviceProfile(s_deviceProfiles[i].productName) == &s_deviceProfiles[i]);
+    }
+}
+
+TEST_CASE("Known devices resolve to their settings", "[device_profile]") {
+    const DeviceProfile& neo3 = FindDeviceProfile("Pico Neo 3 Pro Eye");
+    REQUIRE(neo3.type == DeviceTypeNeo3ProEye);
+    REQUIRE(neo3.menuOnBothHands);
+    REQUIRE(std::string(neo3.interactionProfile) == "/interaction_profiles/bytedance/pico_neo3_controller");
+
+    const DeviceProfile& pico4 = FindDeviceProfile("PICO 4 Pro");
+    REQUIRE(pico4.type == DeviceTypePico4Pro);
+    REQUIRE_FALSE(pico4.menuOnBothHands);
+    REQUIRE(pico4.fallbackFovTangent == 1.09130836f);
+    REQUIRE((pico4.codecs & DeviceCodec_HEVC) != 0);
+}
+
+TEST_CASE("Unknown and near-miss names fall back to the default profile", "[device_profile]") {
+    // Product names are matched exactly, the Pico 4 and PICO 4 Pro spellings differ in case on purpose.
+    const char* names[] = {"", "Pico 4 Pro", "pico 4", "Pico 4 ", "Pico Neo 3", "Quest 3"};
+    for (const char* name : names) {
+        INFO(name);
+        const DeviceProfile& profile = FindDeviceProfile(name);
+        REQUIRE(&profile == &s_unknownDeviceProfile);
+        REQUIRE(profile.type == DeviceTypeNone);
+    }
+    REQUIRE(std::string(s_unknownDeviceProfile.interactionProfile) == "/interaction_profiles/bytedance/pico4s_controller");
+}
+
+TEST_CASE("ROM versions order numerically per component", "[device_profile]") {
+    REQUIRE(DEVICE_ROM_VERSION(5, 10, 0) > DEVICE_ROM_VERSION(5, 4, 0));
+    REQUIRE(DEVICE_ROM_VERSION(5, 4, 16) < DEVICE_ROM_VERSION(5, 5, 0));
+    REQUIRE(DEVICE_ROM_VERSION(6, 0, 0) > DEVICE_ROM_VERSION(5, 255, 255));
+}
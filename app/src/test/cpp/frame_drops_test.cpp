@@ -0,0 +1,99 @@
+/*
+    frame drop accounting over scripted render loop timelines
+*/
+#include "frame_drops.h"
+#include <catch2/catch.hpp>
+
+namespace {
+constexpr int64_t PeriodNs = 11111111;  // 90 Hz
+
+// WaitFrame at display period i, with the display time two periods ahead like a real runtime predicts it.
+void WaitFrame(FrameDropTracker& tracker, int64_t period, bool shouldRender = true) {
+    tracker.OnWaitFrame(period * PeriodNs, (period + 2) * PeriodNs, PeriodNs, shouldRender);
+}
+}  // namespace
+
+TEST_CASE("A smooth stream records nothing", "[frame_drops]") {
+    FrameDropTracker tracker;
+    for (int64_t period = 0; period < 1000; period++) {
+        WaitFrame(tracker, period);
+        tracker.OnViewsLocated(period * PeriodNs, true);
+        tracker.OnFrameLatched(period * PeriodNs, (uint64_t)period);
+    }
+    REQUIRE(tracker.GetEvents().empty());
+    for (size_t i = 0; i < (size_t)FrameDropCause::Count; i++) {
+        REQUIRE(tracker.GetCount((FrameDropCause)i) == 0);
+    }
+}
+
+TEST_CASE("Each cause is counted with its detail, in order", "[frame_drops]") {
+    FrameDropTracker tracker;
+    WaitFrame(tracker, 0);
+    tracker.OnFrameLatched(0, 10);
+
+    // Three display periods skipped, plus a little prediction jitter that must not count as a fourth.
+    tracker.OnWaitFrame(4 * PeriodNs, 6 * PeriodNs + PeriodNs / 3, PeriodNs, true);
+    tracker.OnFrameLatched(4 * PeriodNs, 10);
+    tracker.OnLatchTimeout(4 * PeriodNs + 1);
+    WaitFrame(tracker, 5, false);
+    tracker.OnViewsLocated(5 * PeriodNs, false);
+
+    REQUIRE(tracker.GetCount(FrameDropCause::MissedDisplayPeriod) == 3);
+    REQUIRE(tracker.GetCount(FrameDropCause::ServerRepeat) == 1);
+    REQUIRE(tracker.GetCount(FrameDropCause::LatchTimeout) == 1);
+    REQUIRE(tracker.GetCount(FrameDropCause::RenderSkipped) == 1);
+    REQUIRE(tracker.GetCount(FrameDropCause::TrackingInvalid) == 1);
+
+    const std::vector<FrameDropTracker::Event> events = tracker.GetEvents();
+    REQUIRE(events.size() == 5);
+    REQUIRE(events[0].cause == FrameDropCause::MissedDisplayPeriod);
+    REQUIRE(events[0].detail == 3);
+    REQUIRE(events[1].cause == FrameDropCause::ServerRepeat);
+    REQUIRE(events[1].detail == 10);
+    REQUIRE(events[2].cause == FrameDropCause::LatchTimeout);
+    REQUIRE(events[3].cause == FrameDropCause::RenderSkipped);
+    REQUIRE(events[4].cause == FrameDropCause::TrackingInvalid);
+
+    REQUIRE(tracker.DescribeCounts() == "ServerRepeat:1, LatchTimeout:1, RenderSkipped:1, MissedDisplayPeriod:3, TrackingInvalid:1");
+}
+
+TEST_CASE("The event ring keeps the most recent events", "[frame_drops]") {
+    FrameDropTracker tracker;
+    const size_t total = FrameDropTracker::EventCapacity + 10;
+    for (size_t i = 0; i < total; i++) {
+        tracker.OnLatchTimeout((int64_t)i);
+    }
+    const std::vector<FrameDropTracker::Event> events = tracker.GetEvents();
+    REQUIRE(events.size() == FrameDropTracker::EventCapacity);
+    REQUIRE(events.front().timeNs == 10);
+    REQUIRE(events.back().timeNs == (int64_t)total - 1);
+    REQUIRE(tracker.GetCount(FrameDropCause::LatchTimeout) == total);
+}
+
+TEST_CASE("A reset starts a new timeline", "[frame_drops]") {
+    FrameDropTracker tracker;
+    WaitFrame(tracker, 0);
+    tracker.OnFrameLatched(0, 42);
+    tracker.OnLatchTimeout(1);
+
+    tracker.DumpAndReset("test");
+    REQUIRE(tracker.GetEvents().empty());
+    REQUIRE(tracker.GetCount(FrameDropCause::LatchTimeout) == 0);
+
+    // The reconnected stream restarts pose IDs and the display timeline, neither is a drop.
+    WaitFrame(tracker, 1000);
+    tracker.OnFrameLatched(1000 * PeriodNs, 42);
+    REQUIRE(tracker.GetEvents().empty());
+
+    // Same after a stream start without a dump.
+    tracker.OnStreamStarted();
+    WaitFrame(tracker, 5000);
+    tracker.OnFrameLatched(5000 * PeriodNs, 42);
+    REQUIRE(tracker.GetEvents().empty());
+
+    // And comparisons resume afterwards.
+    WaitFrame(tracker, 5002);
+    tracker.OnFrameLatched(5002 * PeriodNs, 42);
+    REQUIRE(tracker.GetCount(FrameDropCause::MissedDisplayPeriod) == 1);
+    REQUIRE(tracker.GetCount(FrameDropCause::ServerRepeat) == 1);
+}
@@ -0,0 +1,135 @@
+/*
+    frame pacing controller driven by scripted connection stats
+*/
+#include <algorithm>
+#include <functional>
+#include "frame_pacing.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+struct RateChange {
+    int second;
+    float rate;
+};
+
+// One stats window per second. The scripted server renders at most 'capacity(t)' fps, the stream never runs faster
+// than the display, and decode latency is whatever the script says. Requested rates take effect on the next window
+// like the display refresh rate request does on the device.
+struct PacingSimulation {
+    FramePacingController controller;
+    std::function<float(int)> capacity{[](int) { return 1000.0f; }};
+    std::function<float(int)> latencyMs{[](int) { return 4.0f; }};
+    std::vector<RateChange> changes;
+    int second{0};
+
+    explicit PacingSimulation(float startRate) { controller.Reset({72.0f, 90.0f}, startRate); }
+
+    void Run(int seconds) {
+        for (const int end = second + seconds; second < end; second++) {
+            const PacingSample sample{std::min(capacity(second), controller.GetCurrentRate()), latencyMs(second)};
+            const float request = controller.Update(sample, 1.0f);
+            if (request != 0) {
+                changes.push_back({second, request});
+                controller.OnRateChanged(request);
+            }
+        }
+    }
+};
+
+}  // namespace
+
+TEST_CASE("A stream that keeps up stays at its rate", "[frame_pacing]") {
+    PacingSimulation sim(90.0f);
+    sim.Run(120);
+    REQUIRE(sim.changes.empty());
+    REQUIRE(sim.controller.GetCurrentRate() == 90.0f);
+}
+
+TEST_CASE("A server stuck at 72 fps moves a 90 Hz display down after the hold", "[frame_pacing]") {
+    PacingSimulation sim(90.0f);
+    sim.capacity = [](int) { return 72.0f; };
+    // Short of the next upgrade probe, which this server would fail again.
+    sim.Run(12);
+
+    REQUIRE(sim.changes.size() == 1);
+    REQUIRE(sim.changes[0].rate == 72.0f);
+    // Two warmup windows, then three bad seconds and the five second dwell both have to pass.
+    REQUIRE(sim.changes[0].second >= 4);
+    REQUIRE(sim.changes[0].second <= 8);
+}
+
+TEST_CASE("Warmup and short glitches do not change the rate", "[frame_pacing]") {
+    PacingSimulation sim(90.0f);
+    // Ramp up during warmup, then a one second hiccup every twenty seconds. Smoothing keeps it under the hold.
+    sim.capacity = [](int t) { return t < 2 ? 30.0f : t % 20 == 10 ? 60.0f : 90.0f; };
+    sim.Run(120);
+    REQUIRE(sim.changes.empty());
+}
+
+TEST_CASE("High decode latency moves the rate down even at full fps", "[frame_pacing]") {
+    PacingSimulation sim(90.0f);
+    // 12 ms does not fit an 11.1 ms period but fits 13.9 ms.
+    sim.latencyMs = [](int) { return 12.0f; };
+    sim.Run(30);
+    REQUIRE(sim.changes.size() == 1);
+    REQUIRE(sim.changes[0].rate == 72.0f);
+}
+
+TEST_CASE("A recovered server is probed at the higher rate after a clean run", "[frame_pacing]") {
+    PacingSimulation sim(72.0f);
+    sim.Run(30);
+    REQUIRE(sim.changes.size() == 1);
+    REQUIRE(sim.changes[0].rate == 90.0f);
+    REQUIRE(sim.changes[0].second >= 10);
+
+    // Latency that fits 90 Hz but leaves no headroom does not probe.
+    PacingSimulation tight(72.0f);
+    tight.latencyMs = [](int) { return 9.0f; };
+    tight.Run(60);
+    REQUIRE(tight.changes.empty());
+}
+
+TEST_CASE("Failed probes back off exponentially", "[frame_pacing]") {
+    PacingSimulation sim(72.0f);
+    // The server manages 72 fps but a little more, which looks like headroom until 90 Hz is tried.
+    sim.capacity = [](int) { return 75.0f; };
+    sim.Run(400);
+
+    std::vector<int> probes;
+    for (const RateChange& change : sim.changes) {
+        if (change.rate == 90.0f) {
+            probes.push_back(change.second);
+        }
+    }
+    REQUIRE(probes.size() >= 3);
+    std::vector<int> gaps;
+    for (size_t i = 1; i < probes.size(); i++) {
+        gaps.push_back(probes[i] - probes[i - 1]);
+    }
+    for (size_t i = 1; i < gaps.size(); i++) {
+        INFO("probe gaps grow: " << gaps[i - 1] << " then " << gaps[i]);
+        REQUIRE(gaps[i] > gaps[i - 1]);
+    }
+    // Every probe fell back to 72 Hz.
+    REQUIRE(sim.changes.back().rate == 72.0f);
+}
+
+TEST_CASE("The rate cap applies immediately and blocks probes above it", "[frame_pacing]") {
+    PacingSimulation sim(90.0f);
+    sim.controller.SetRateCap(72.0f);
+    sim.Run(1);
+    REQUIRE(sim.changes.size() == 1);
+    REQUIRE(sim.changes[0].second == 0);
+    REQUIRE(sim.changes[0].rate == 72.0f);
+
+    sim.Run(120);
+    REQUIRE(sim.changes.size() == 1);
+
+    sim.controller.SetRateCap(0);
+    sim.Run(30);
+    REQUIRE(sim.changes.size() == 2);
+    REQUIRE(sim.changes[1].rate == 90.0f);
+}
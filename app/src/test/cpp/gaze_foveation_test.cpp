@@ -0,0 +1,193 @@
+/*
+    gaze filtering against scripted eye gaze and the foveal center message round trip
+*/
+#include <cmath>
+#include "gaze_foveation.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+constexpr int64_t MsToNs = 1000000;
+
+// Gaze through the point (x, y) on the plane one unit ahead, so the tangents are x and y.
+GazeSample Gaze(float x, float y, int64_t timeMs) {
+    GazeSample sample;
+    sample.valid = true;
+    sample.direction = {x, y, -1.0f};
+    sample.timeNs = timeMs * MsToNs;
+    return sample;
+}
+
+GazeSample Lost(int64_t timeMs) {
+    GazeSample sample;
+    sample.valid = false;
+    sample.timeNs = timeMs * MsToNs;
+    return sample;
+}
+
+}  // namespace
+
+TEST_CASE("GazeDirection rotates the forward axis", "[gaze]") {
+    const XrVector3f forward = GazeDirection({0, 0, 0, 1});
+    REQUIRE(forward.x == Approx(0.0f).margin(1e-6));
+    REQUIRE(forward.y == Approx(0.0f).margin(1e-6));
+    REQUIRE(forward.z == Approx(-1.0f));
+
+    // 90 degrees to the left about +Y.
+    const float half = std::sqrt(0.5f);
+    const XrVector3f left = GazeDirection({0, half, 0, half});
+    REQUIRE(left.x == Approx(-1.0f));
+    REQUIRE(left.y == Approx(0.0f).margin(1e-6));
+    REQUIRE(left.z == Approx(0.0f).margin(1e-6));
+
+    // 30 degrees up about +X.
+    const float s = std::sin(15.0f * (float)M_PI / 180.0f);
+    const float c = std::cos(15.0f * (float)M_PI / 180.0f);
+    const XrVector3f up = GazeDirection({s, 0, 0, c});
+    REQUIRE(up.y / -up.z == Approx(std::tan(30.0f * (float)M_PI / 180.0f)));
+}
+
+TEST_CASE("GazeFilter smooths fixations and snaps on saccades", "[gaze]") {
+    GazeFilter filter;
+
+    // The first reading is taken as is.
+    FovealCenter center = filter.Update(Gaze(0.2f, -0.1f, 0));
+    REQUIRE(center.tracked);
+    REQUIRE_FALSE(center.saccade);
+    REQUIRE(center.x == Approx(0.2f));
+    REQUIRE(center.y == Approx(-0.1f));
+
+    // Jitter well below saccade speed moves the center only part of the way.
+    center = filter.Update(Gaze(0.21f, -0.1f, 10));
+    REQUIRE_FALSE(center.saccade);
+    REQUIRE(center.x > 0.2f);
+    REQUIRE(center.x < 0.21f);
+
+    // Held long enough, the center settles on the fixation.
+    for (int64_t t = 20; t <= 500; t += 10) {
+        center = filter.Update(Gaze(0.21f, -0.1f, t));
+    }
+    REQUIRE(center.x == Approx(0.21f).margin(1e-4));
+
+    // 25 degrees in 10 ms is a saccade, the center lands on the new gaze right away and only for that frame is flagged.
+    center = filter.Update(Gaze(-0.3f, 0.2f, 510));
+    REQUIRE(center.saccade);
+    REQUIRE(center.x == Approx(-0.3f));
+    REQUIRE(center.y == Approx(0.2f));
+    center = filter.Update(Gaze(-0.3f, 0.2f, 520));
+    REQUIRE_FALSE(center.saccade);
+    REQUIRE(center.x == Approx(-0.3f));
+}
+
+TEST_CASE("GazeFilter holds over blinks and recenters after longer losses", "[gaze]") {
+    GazeFilter filter;
+    filter.Update(Gaze(0.5f, 0.25f, 0));
+
+    // Within the blink hold the last center stays, still tracked.
+    for (int64_t t = 10; t < 150; t += 10) {
+        const FovealCenter center = filter.Update(Lost(t));
+        REQUIRE(center.tracked);
+        REQUIRE(center.x == Approx(0.5f));
+        REQUIRE(center.y == Approx(0.25f));
+    }
+
+    // Past it the center drifts back to the middle of the view.
+    FovealCenter center = filter.Update(Lost(160));
+    REQUIRE_FALSE(center.tracked);
+    float previous = center.x;
+    for (int64_t t = 170; t <= 3000; t += 10) {
+        center = filter.Update(Lost(t));
+        REQUIRE(center.x <= previous);
+        previous = center.x;
+    }
+    REQUIRE(center.x == Approx(0.0f).margin(1e-3));
+    REQUIRE(center.y == Approx(0.0f).margin(1e-3));
+
+    // The first reading after the loss is taken as is, not smoothed from the middle.
+    center = filter.Update(Gaze(0.4f, 0.0f, 3010));
+    REQUIRE(center.tracked);
+    REQUIRE(center.x == Approx(0.4f));
+}
+
+TEST_CASE("GazeFilter rejects gaze off the view plane and clamps wide gaze", "[gaze]") {
+    GazeFilter filter;
+
+    GazeSample behind = Gaze(0, 0, 0);
+    behind.direction = {0, 0, 1};
+    REQUIRE_FALSE(filter.Update(behind).tracked);
+
+    GazeSample sideways = Gaze(0, 0, 10);
+    sideways.direction = {1, 0, 0};
+    REQUIRE_FALSE(filter.Update(sideways).tracked);
+
+    // Far out gaze is clamped to the configured tangent, the length of the direction does not matter.
+    GazeSample wide = Gaze(0, 0, 20);
+    wide.direction = {-9.0f, 3.0f, -3.0f};
+    const FovealCenter center = filter.Update(wide);
+    REQUIRE(center.tracked);
+    REQUIRE(center.x == Approx(-GazeFilter::Config{}.maxTangent));
+    REQUIRE(center.y == Approx(1.0f));
+
+    filter.Reset();
+    REQUIRE_FALSE(filter.GetCenter().tracked);
+    REQUIRE(filter.GetCenter().x == 0.0f);
+    REQUIRE(filter.GetCenter().y == 0.0f);
+}
+
+TEST_CASE("Foveal center messages round trip", "[gaze]") {
+    FovealCenter center;
+    center.x = 0.375f;
+    center.y = -1.25f;
+    center.tracked = true;
+    center.saccade = GENERATE(false, true);
+    const uint32_t sequence = 0x89ABCDEF;
+    const int64_t sampleTimeNs = 1234567890123456789;
+
+    uint8_t buffer[FovealCenterMessageSize];
+    SerializeFovealCenter(center, sequence, sampleTimeNs, buffer);
+
+    // Little endian on the wire whatever the host is.
+    REQUIRE(std::string(reinterpret_cast<const char*>(buffer), 4) == "FOVC");
+    REQUIRE(buffer[4] == FovealCenterVersion);
+    REQUIRE(buffer[5] == 0);
+    REQUIRE(buffer[8] == 0xEF);
+    REQUIRE(buffer[11] == 0x89);
+
+    FovealCenter parsed;
+    uint32_t parsedSequence = 0;
+    int64_t parsedTimeNs = 0;
+    REQUIRE(ParseFovealCenter(buffer, sizeof(buffer), &parsed, &parsedSequence, &parsedTimeNs));
+    REQUIRE(parsed.x == center.x);
+    REQUIRE(parsed.y == center.y);
+    REQUIRE(parsed.tracked == center.tracked);
+    REQUIRE(parsed.saccade == center.saccade);
+    REQUIRE(parsedSequence == sequence);
+    REQUIRE(parsedTimeNs == sampleTimeNs);
+
+    SECTION("negative sample times survive") {
+        SerializeFovealCenter(center, 0, -42, buffer);
+        REQUIRE(ParseFovealCenter(buffer, sizeof(buffer), &parsed, &parsedSequence, &parsedTimeNs));
+        REQUIRE(parsedTimeNs == -42);
+    }
+}
+
+TEST_CASE("Foveal center messages are checked before parsing", "[gaze]") {
+    uint8_t buffer[FovealCenterMessageSize + 1] = {};
+    SerializeFovealCenter(FovealCenter{}, 1, 0, buffer);
+
+    FovealCenter parsed;
+    uint32_t sequence = 0;
+    int64_t timeNs = 0;
+    REQUIRE(ParseFovealCenter(buffer, FovealCenterMessageSize, &parsed, &sequence, &timeNs));
+    REQUIRE_FALSE(ParseFovealCenter(buffer, FovealCenterMessageSize - 1, &parsed, &sequence, &timeNs));
+    REQUIRE_FALSE(ParseFovealCenter(buffer, FovealCenterMessageSize + 1, &parsed, &sequence, &timeNs));
+
+    buffer[4]++;
+    REQUIRE_FALSE(ParseFovealCenter(buffer, FovealCenterMessageSize, &parsed, &sequence, &timeNs));
+    buffer[4]--;
+
+    buffer[0] = 'X';
+    REQUIRE_FALSE(ParseFovealCenter(buffer, FovealCenterMessageSize, &parsed, &sequence, &timeNs));
+}
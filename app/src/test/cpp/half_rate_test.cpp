@@ -0,0 +1,98 @@
+/*
+    half-rate scheduling against scripted latch results
+*/
+#include "half_rate.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+// Plays the latch results in order and returns what BeginFrame said for each display frame.
+std::vector<bool> Play(HalfRateScheduler& scheduler, const std::vector<bool>& latched) {
+    std::vector<bool> due;
+    for (bool result : latched) {
+        due.push_back(scheduler.BeginFrame());
+        scheduler.OnLatchResult(result);
+    }
+    return due;
+}
+
+}  // namespace
+
+TEST_CASE("HalfRateScheduler expects every frame while disabled", "[half_rate]") {
+    HalfRateScheduler scheduler;
+    REQUIRE_FALSE(scheduler.IsEnabled());
+    REQUIRE(Play(scheduler, {true, false, false, true}) == std::vector<bool>{true, true, true, true});
+    REQUIRE(scheduler.GetSynthesizedCount() == 0);
+    REQUIRE(scheduler.GetLateCount() == 0);
+    REQUIRE(scheduler.GetEarlyCount() == 0);
+}
+
+TEST_CASE("HalfRateScheduler alternates with a steady half-rate stream", "[half_rate]") {
+    HalfRateScheduler scheduler;
+    scheduler.SetEnabled(true);
+
+    // The first frame of a stream is due right away, then every other one.
+    std::vector<bool> latched;
+    for (int i = 0; i < 90; i++) {
+        latched.push_back(i % 2 == 0);
+    }
+    const std::vector<bool> due = Play(scheduler, latched);
+    REQUIRE(due == latched);
+    REQUIRE(scheduler.GetSynthesizedCount() == 45);
+    REQUIRE(scheduler.GetLateCount() == 0);
+    REQUIRE(scheduler.GetEarlyCount() == 0);
+}
+
+TEST_CASE("HalfRateScheduler follows the phase of the stream", "[half_rate]") {
+    HalfRateScheduler scheduler;
+    scheduler.SetEnabled(true);
+
+    SECTION("a late frame keeps the next display frame expecting it") {
+        // Due on 0, synthesized on 1, late on 2, arrives on 3 and the phase moved by one.
+        const std::vector<bool> due = Play(scheduler, {true, false, false, true, false, true, false});
+        REQUIRE(due == std::vector<bool>{true, false, true, true, false, true, false});
+        REQUIRE(scheduler.GetLateCount() == 1);
+        REQUIRE(scheduler.GetSynthesizedCount() == 3);
+        REQUIRE(scheduler.GetEarlyCount() == 0);
+    }
+    SECTION("a frame on a synthesized slot becomes the new reference") {
+        // Due on 0, early on 1, after which 2 is synthesized and 3 is due.
+        const std::vector<bool> due = Play(scheduler, {true, true, false, true, false});
+        REQUIRE(due == std::vector<bool>{true, false, false, true, false});
+        REQUIRE(scheduler.GetEarlyCount() == 1);
+        REQUIRE(scheduler.GetSynthesizedCount() == 2);
+        REQUIRE(scheduler.GetLateCount() == 0);
+    }
+    SECTION("a stalled stream keeps every frame due") {
+        const std::vector<bool> due = Play(scheduler, {true, false, false, false, false});
+        REQUIRE(due == std::vector<bool>{true, false, true, true, true});
+        REQUIRE(scheduler.GetSynthesizedCount() == 1);
+        REQUIRE(scheduler.GetLateCount() == 3);
+    }
+}
+
+TEST_CASE("HalfRateScheduler starts over when the mode changes", "[half_rate]") {
+    HalfRateScheduler scheduler;
+    scheduler.SetEnabled(true);
+    Play(scheduler, {true, false, false, true, true});
+    REQUIRE(scheduler.GetSynthesizedCount() == 1);
+    REQUIRE(scheduler.GetLateCount() == 1);
+    REQUIRE(scheduler.GetEarlyCount() == 1);
+
+    // The same mode again keeps the counters and the phase.
+    scheduler.SetEnabled(true);
+    REQUIRE(scheduler.GetSynthesizedCount() == 1);
+    REQUIRE_FALSE(scheduler.BeginFrame());
+    scheduler.OnLatchResult(false);
+
+    scheduler.SetEnabled(false);
+    REQUIRE(scheduler.GetSynthesizedCount() == 0);
+    REQUIRE(scheduler.GetLateCount() == 0);
+    REQUIRE(scheduler.GetEarlyCount() == 0);
+
+    // Enabled again, the next latched frame is due right away.
+    scheduler.SetEnabled(true);
+    REQUIRE(Play(scheduler, {true, false, true}) == std::vector<bool>{true, false, true});
+}
@@ -0,0 +1,156 @@
+/*
+    haptic pulse coalescing and rate limiting
+*/
+#include <atomic>
+#include <thread>
+#include "haptics.h"
+#include <catch2/catch.hpp>
+
+namespace {
+constexpr int64_t Ms = 1000000;
+
+HapticPulse Pulse(uint32_t controller, float amplitude, float seconds, int64_t receivedNs) {
+    return {controller, amplitude, seconds, 160.0f, receivedNs};
+}
+
+std::vector<HapticCommand> Dispatch(HapticScheduler& scheduler, int64_t nowNs) {
+    std::vector<HapticCommand> commands;
+    scheduler.Dispatch(nowNs, [&](const HapticCommand& command) { commands.push_back(command); });
+    return commands;
+}
+}  // namespace
+
+TEST_CASE("A single pulse plays for its remaining duration", "[haptics]") {
+    HapticScheduler scheduler;
+    REQUIRE(scheduler.Enqueue(Pulse(1, 0.5f, 0.1f, 1000 * Ms)));
+
+    const std::vector<HapticCommand> commands = Dispatch(scheduler, 1002 * Ms);
+    REQUIRE(commands.size() == 1);
+    REQUIRE(commands[0].controller == 1);
+    REQUIRE(commands[0].amplitude == 0.5f);
+    REQUIRE(commands[0].frequency == 160.0f);
+    // Measured from arrival, the two milliseconds spent in the queue are already gone.
+    REQUIRE(commands[0].durationNs == 98 * Ms);
+
+    REQUIRE(Dispatch(scheduler, 1010 * Ms).empty());
+}
+
+TEST_CASE("Queued pulses merge into one vibration per controller", "[haptics]") {
+    HapticScheduler scheduler;
+    scheduler.Enqueue(Pulse(0, 0.3f, 0.2f, 0));
+    scheduler.Enqueue(Pulse(0, 0.8f, 0.05f, 0));
+    scheduler.Enqueue(Pulse(0, 0.1f, 0.1f, 0));
+    scheduler.Enqueue(Pulse(1, 0.4f, 0.01f, 0));
+
+    const std::vector<HapticCommand> commands = Dispatch(scheduler, 0);
+    REQUIRE(commands.size() == 2);
+    // Strongest amplitude, latest end.
+    REQUIRE(commands[0].controller == 0);
+    REQUIRE(commands[0].amplitude == 0.8f);
+    REQUIRE(commands[0].durationNs == 200 * Ms);
+    REQUIRE(commands[1].controller == 1);
+    REQUIRE(commands[1].durationNs == 10 * Ms);
+    REQUIRE(scheduler.GetCoalescedCount() == 2);
+}
+
+TEST_CASE("A pulse covered by the playing vibration costs no call", "[haptics]") {
+    HapticScheduler scheduler;
+    scheduler.Enqueue(Pulse(0, 0.8f, 0.5f, 0));
+    REQUIRE(Dispatch(scheduler, 0).size() == 1);
+
+    scheduler.Enqueue(Pulse(0, 0.5f, 0.1f, 100 * Ms));
+    REQUIRE(Dispatch(scheduler, 100 * Ms).empty());
+    REQUIRE(scheduler.GetCoalescedCount() == 1);
+
+    // Longer than what plays: re-driven with the playing amplitude kept.
+    scheduler.Enqueue(Pulse(0, 0.2f, 0.5f, 200 * Ms));
+    const std::vector<HapticCommand> commands = Dispatch(scheduler, 200 * Ms);
+    REQUIRE(commands.size() == 1);
+    REQUIRE(commands[0].amplitude == 0.8f);
+    REQUIRE(commands[0].durationNs == 500 * Ms);
+}
+
+TEST_CASE("A controller is not re-driven within the minimum interval", "[haptics]") {
+    HapticScheduler scheduler(HapticScheduler::Config{20 * Ms});
+    scheduler.Enqueue(Pulse(0, 0.2f, 0.1f, 0));
+    REQUIRE(Dispatch(scheduler, 0).size() == 1);
+
+    scheduler.Enqueue(Pulse(0, 0.9f, 0.1f, 5 * Ms));
+    REQUIRE(Dispatch(scheduler, 5 * Ms).empty());
+    scheduler.Enqueue(Pulse(0, 0.6f, 0.2f, 10 * Ms));
+    REQUIRE(Dispatch(scheduler, 10 * Ms).empty());
+
+    // Held back pulses come out together once the interval passed, the other controller was never held back.
+    scheduler.Enqueue(Pulse(1, 0.3f, 0.1f, 15 * Ms));
+    std::vector<HapticCommand> commands = Dispatch(scheduler, 15 * Ms);
+    REQUIRE(commands.size() == 1);
+    REQUIRE(commands[0].controller == 1);
+
+    commands = Dispatch(scheduler, 20 * Ms);
+    REQUIRE(commands.size() == 1);
+    REQUIRE(commands[0].controller == 0);
+    REQUIRE(commands[0].amplitude == 0.9f);
+    REQUIRE(commands[0].durationNs == 190 * Ms);
+}
+
+TEST_CASE("Expired pulses and pending vibrations are dropped silently", "[haptics]") {
+    HapticScheduler scheduler(HapticScheduler::Config{20 * Ms});
+    scheduler.Enqueue(Pulse(0, 1.0f, 0.01f, 0));
+    REQUIRE(Dispatch(scheduler, 50 * Ms).empty());
+
+    scheduler.Enqueue(Pulse(1, 1.0f, 0.001f, 50 * Ms));
+    REQUIRE(Dispatch(scheduler, 50 * Ms).size() == 1);
+    scheduler.Enqueue(Pulse(1, 1.0f, 0.005f, 55 * Ms));
+    REQUIRE(Dispatch(scheduler, 55 * Ms).empty());
+    // Ended before the interval let it through.
+    REQUIRE(Dispatch(scheduler, 70 * Ms).empty());
+    REQUIRE(Dispatch(scheduler, 100 * Ms).empty());
+}
+
+TEST_CASE("Invalid controllers and a full queue count as drops", "[haptics]") {
+    HapticScheduler scheduler;
+    REQUIRE_FALSE(scheduler.Enqueue(Pulse(HapticScheduler::MaxControllers, 1.0f, 0.1f, 0)));
+
+    uint32_t accepted = 0;
+    for (int i = 0; i < 100; i++) {
+        accepted += scheduler.Enqueue(Pulse(0, 0.5f, 0.1f, 0)) ? 1 : 0;
+    }
+    REQUIRE(accepted == 64);
+    REQUIRE(scheduler.GetDroppedCount() == 1 + 36);
+
+    REQUIRE(Dispatch(scheduler, 0).size() == 1);
+    REQUIRE(scheduler.Enqueue(Pulse(0, 0.5f, 0.1f, 0)));
+}
+
+TEST_CASE("Pulses from the callback thread are all accounted for", "[haptics]") {
+    HapticScheduler scheduler(HapticScheduler::Config{0});
+    constexpr uint32_t PulseCount = 100000;
+    std::atomic<bool> done{false};
+    uint32_t accepted = 0;
+    std::thread callback([&]() {
+        for (uint32_t i = 0; i < PulseCount; i++) {
+            // Every pulse louder than the last so none is covered by the playing one.
+            accepted += scheduler.Enqueue(Pulse(i % 2, (float)i / PulseCount, 1.0f, i)) ? 1 : 0;
+        }
+        done = true;
+    });
+
+    uint64_t applied = 0;
+    int64_t now = 0;
+    float lastAmplitude[HapticScheduler::MaxControllers] = {};
+    bool ordered = true;
+    auto apply = [&](const HapticCommand& command) {
+        applied++;
+        ordered = ordered && command.amplitude > lastAmplitude[command.controller];
+        lastAmplitude[command.controller] = command.amplitude;
+    };
+    while (!done) {
+        scheduler.Dispatch(now++, apply);
+    }
+    scheduler.Dispatch(now, apply);
+    callback.join();
+
+    REQUIRE(ordered);
+    REQUIRE(accepted + scheduler.GetDroppedCount() == PulseCount);
+    REQUIRE(applied + scheduler.GetCoalescedCount() == accepted);
+}
@@ -0,0 +1,160 @@
+/*
+    input thread rate, failure handling and input-to-send latency against the stub runtime
+*/
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include "clock.h"
+#include "input_thread.h"
+#include "latency_tracker.h"
+#include "openxr_stub.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+// What SampleInput does for one button: sync, read the state and hand a change to CloudXR stamped with the time the
+// runtime saw it. Runs on the input thread, so it must not use REQUIRE.
+void SampleButton(LatencyTracker* tracker) {
+    XrActionsSyncInfo syncInfo{};
+    syncInfo.type = XR_TYPE_ACTIONS_SYNC_INFO;
+    xrSyncActions(XR_NULL_HANDLE, &syncInfo);
+    XrActionStateGetInfo getInfo{};
+    getInfo.type = XR_TYPE_ACTION_STATE_GET_INFO;
+    XrActionStateBoolean state{};
+    state.type = XR_TYPE_ACTION_STATE_BOOLEAN;
+    xrGetActionStateBoolean(XR_NULL_HANDLE, &getInfo, &state);
+    if (state.changedSinceLastSync == XR_TRUE) {
+        tracker->OnInputSent(Clock::FromXrTime(state.lastChangeTime), Clock::NowNs());
+    }
+}
+
+// Presses and releases the button at random 20..40 ms intervals for the given time, slow enough that sampling once per
+// 72 Hz frame still sees every change.
+void PressButtons(std::chrono::milliseconds duration) {
+    std::mt19937 random(44);
+    std::uniform_int_distribution<int> intervalUs(20000, 40000);
+    bool pressed = false;
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::microseconds(intervalUs(random)));
+        pressed = !pressed;
+        StubSetBooleanAction(pressed, Clock::ToXrTime(Clock::NowNs()));
+    }
+}
+
+}  // namespace
+
+TEST_CASE("InputThread samples at the configured rate", "[input]") {
+    std::atomic<uint32_t> samples{0};
+    InputThread thread({[]() { return 200u; }, [&samples]() { samples++; }});
+    thread.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    thread.Stop();
+    // 60 at 200 Hz, with room for a loaded machine.
+    REQUIRE(samples >= 30);
+    REQUIRE(samples <= 90);
+    REQUIRE_FALSE(thread.HasFailed());
+
+    // Stopped means stopped.
+    const uint32_t stopped = samples;
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    REQUIRE(samples == stopped);
+}
+
+TEST_CASE("InputThread waits at 0 Hz and picks up a live rate change", "[input]") {
+    std::atomic<uint32_t> rateHz{0};
+    std::atomic<uint32_t> samples{0};
+    InputThread thread({[&rateHz]() { return rateHz.load(); }, [&samples]() { samples++; }});
+    thread.Start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+    REQUIRE(samples == 0);
+
+    rateHz = 500;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (samples == 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(samples > 0);
+
+    // Stop does not wait out the idle interval or a slow rate.
+    rateHz = 1;
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    const auto stopStart = std::chrono::steady_clock::now();
+    thread.Stop();
+    REQUIRE(std::chrono::steady_clock::now() - stopStart < std::chrono::milliseconds(500));
+}
+
+TEST_CASE("InputThread stops for good when a sample throws", "[input]") {
+    std::atomic<uint32_t> samples{0};
+    InputThread thread({[]() { return 1000u; },
+                        [&samples]() {
+                            if (++samples == 3) {
+                                throw std::runtime_error("xrSyncActions failed");
+                            }
+                        }});
+    thread.Start();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!thread.HasFailed() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    REQUIRE(thread.HasFailed());
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    REQUIRE(samples == 3);
+    thread.Stop();
+
+    // The next session starts over.
+    thread.Start();
+    REQUIRE_FALSE(thread.HasFailed());
+    const auto restartDeadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (samples == 3 && std::chrono::steady_clock::now() < restartDeadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    thread.Stop();
+    REQUIRE(samples > 3);
+    REQUIRE_FALSE(thread.HasFailed());
+}
+
+TEST_CASE("InputThread cuts input-to-send latency below once per frame sampling", "[input]") {
+    // The stub runtime converts XrTime, so the event times go through the same conversion as on the device.
+    Clock::InitializeXrTime(StubXrInstance(), true);
+    const std::chrono::milliseconds duration(1500);
+    StubSetBooleanAction(false, 0);
+
+    // The render thread at 72 Hz, sampling once per frame.
+    LatencyTracker perFrame;
+    {
+        std::thread presser(PressButtons, duration);
+        const auto framePeriod = std::chrono::nanoseconds(1000000000 / 72);
+        const auto end = std::chrono::steady_clock::now() + duration;
+        for (auto frame = std::chrono::steady_clock::now(); frame < end; frame += framePeriod) {
+            SampleButton(&perFrame);
+            std::this_thread::sleep_until(frame + framePeriod);
+        }
+        presser.join();
+    }
+
+    // The input thread at 500 Hz.
+    LatencyTracker threaded;
+    {
+        InputThread thread({[]() { return 500u; }, [&threaded]() { SampleButton(&threaded); }});
+        thread.Start();
+        PressButtons(duration);
+        thread.Stop();
+    }
+    Clock::InitializeXrTime(XR_NULL_HANDLE, false);
+
+    const LatencyHistogram::Summary frame = perFrame.TakeSnapshot().inputToSend;
+    const LatencyHistogram::Summary input = threaded.TakeSnapshot().inputToSend;
+    WARN("input-to-send once per 72 Hz frame: mean " << frame.meanMs << " ms, p50 " << frame.p50Ms << " ms, p99 " << frame.p99Ms
+                                                     << " ms; input thread at 500 Hz: mean " << input.meanMs << " ms, p50 "
+                                                     << input.p50Ms << " ms, p99 " << input.p99Ms << " ms");
+    REQUIRE(frame.count >= 20);
+    REQUIRE(input.count >= 20);
+    // Half a frame on average against half of a 2 ms period, with a wide margin for scheduling.
+    REQUIRE(input.meanMs < frame.meanMs / 2);
+    REQUIRE(input.p50Ms < frame.p50Ms);
+}
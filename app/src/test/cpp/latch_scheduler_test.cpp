@@ -0,0 +1,122 @@
+/*
+    late-latch deadline against a fake clock and a scripted video frame source
+*/
+#include <functional>
+#include "latch_scheduler.h"
+#include <catch2/catch.hpp>
+
+namespace {
+constexpr int64_t Ms = 1000000;
+constexpr int64_t PeriodNs = 13888889;  // 72 Hz
+
+// The render loop of OpenXrProgram against a fake clock. Each frame: xrWaitFrame returns at the start of the period,
+// cxrLatchFrame waits for the next video frame up to the scheduler timeout, then rendering and xrEndFrame take
+// submitCost(frame). A frame submitted after displayTime - period missed the compositor.
+struct LatchSimulation {
+    LatchScheduler scheduler;
+    // Arrival time of the video frame for a display frame, relative to the start of its period.
+    std::function<int64_t(int)> arrival{[](int) { return 2 * Ms; }};
+    std::function<int64_t(int)> submitCost{[](int) { return 3 * Ms; }};
+    int64_t nowNs{1000 * Ms};
+    int latched{0};
+    int repeated{0};
+    int missed{0};
+    int frame{0};
+
+    void Run(int frames) {
+        for (const int end = frame + frames; frame < end; frame++) {
+            const int64_t periodStart = nowNs;
+            const int64_t displayTime = periodStart + 2 * PeriodNs;
+            scheduler.BeginFrame(displayTime, PeriodNs);
+
+            // cxrLatchFrame waits whole milliseconds.
+            const int64_t timeoutEnd = nowNs + scheduler.GetLatchTimeoutMs(nowNs) * Ms;
+            const int64_t arrivalNs = periodStart + arrival(frame);
+            if (arrivalNs <= timeoutEnd) {
+                nowNs = std::max(nowNs, arrivalNs);
+                latched++;
+            } else {
+                nowNs = timeoutEnd;
+                repeated++;
+            }
+            scheduler.OnLatched(nowNs);
+
+            nowNs += submitCost(frame);
+            scheduler.OnSubmitted(nowNs);
+            if (nowNs > displayTime - PeriodNs) {
+                missed++;
+            }
+            nowNs = std::max(nowNs, periodStart + PeriodNs);
+        }
+    }
+};
+}  // namespace
+
+TEST_CASE("The deadline leaves room for the compositor lead, submit cost and margin", "[latch_scheduler]") {
+    LatchScheduler scheduler;
+    REQUIRE(scheduler.GetLatchDeadline() == 0);
+    REQUIRE(scheduler.GetLatchTimeoutMs(0) == 0);
+
+    scheduler.BeginFrame(100 * Ms, 10 * Ms);
+    // Defaults: one period of lead, 4 ms assumed cost, 1 ms margin.
+    REQUIRE(scheduler.GetLatchDeadline() == 85 * Ms);
+    REQUIRE(scheduler.GetLatchTimeoutMs(80 * Ms) == 5);
+    REQUIRE(scheduler.GetLatchTimeoutMs(80 * Ms + 1) == 4);
+    REQUIRE(scheduler.GetLatchTimeoutMs(85 * Ms) == 0);
+    REQUIRE(scheduler.GetLatchTimeoutMs(90 * Ms) == 0);
+}
+
+TEST_CASE("The submit cost follows measurements with a jitter allowance", "[latch_scheduler]") {
+    LatchScheduler scheduler;
+    scheduler.OnSubmitted(50 * Ms);
+    REQUIRE(scheduler.GetSubmitCostNs() == 4 * Ms);
+
+    scheduler.OnLatched(0);
+    scheduler.OnSubmitted(2 * Ms);
+    REQUIRE(scheduler.GetSubmitCostNs() == 2 * Ms);
+
+    int64_t now = 0;
+    for (int i = 0; i < 200; i++) {
+        scheduler.OnLatched(now);
+        now += i % 2 == 0 ? 2 * Ms : 4 * Ms;
+        scheduler.OnSubmitted(now);
+    }
+    // Mean 3 ms and a mean deviation of about 1 ms, two deviations on top.
+    REQUIRE(scheduler.GetSubmitCostNs() > 4500000);
+    REQUIRE(scheduler.GetSubmitCostNs() < 5500000);
+
+    // A submit without a latch in between is not a measurement.
+    const int64_t before = scheduler.GetSubmitCostNs();
+    scheduler.OnSubmitted(now + 100 * Ms);
+    REQUIRE(scheduler.GetSubmitCostNs() == before);
+}
+
+TEST_CASE("On-time video frames are latched and nothing misses the compositor", "[latch_scheduler]") {
+    LatchSimulation sim;
+    sim.Run(500);
+    REQUIRE(sim.latched == 500);
+    REQUIRE(sim.missed == 0);
+}
+
+TEST_CASE("Late video frames are repeated instead of making the submit late", "[latch_scheduler]") {
+    LatchSimulation sim;
+    // Every tenth frame arrives after the whole period.
+    sim.arrival = [](int frame) { return frame % 10 == 9 ? PeriodNs + 2 * Ms : 2 * Ms; };
+    sim.Run(500);
+    REQUIRE(sim.repeated == 50);
+    REQUIRE(sim.latched == 450);
+    REQUIRE(sim.missed == 0);
+}
+
+TEST_CASE("A slower, jittery submit moves the deadline earlier", "[latch_scheduler]") {
+    LatchSimulation sim;
+    sim.arrival = [](int frame) { return 6 * Ms; };
+    sim.submitCost = [](int frame) { return frame % 3 == 0 ? 9 * Ms : 5 * Ms; };
+    sim.Run(50);
+    const int64_t warmedUpMisses = sim.missed;
+
+    sim.Run(500);
+    // Misses are only possible while the cost is still being learned.
+    REQUIRE(sim.missed == warmedUpMisses);
+    REQUIRE(sim.scheduler.GetSubmitCostNs() >= 9 * Ms);
+}
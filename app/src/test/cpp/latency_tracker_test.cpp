@@ -0,0 +1,157 @@
+/*
+    latency histogram percentiles and pose ID matching of the latency tracker
+*/
+#include "latency_tracker.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+constexpr int64_t MsToNs = 1000000;
+
+}  // namespace
+
+TEST_CASE("LatencyHistogram reports bucket upper bounds", "[latency]") {
+    LatencyHistogram histogram;
+    REQUIRE(histogram.Summarize().count == 0);
+    REQUIRE(histogram.Summarize().p99Ms == 0.0);
+
+    // 1 ms to 100 ms, one sample each.
+    for (int64_t ms = 1; ms <= 100; ms++) {
+        histogram.Add(ms * MsToNs);
+    }
+    LatencyHistogram::Summary summary = histogram.Summarize();
+    REQUIRE(summary.count == 100);
+    REQUIRE(summary.meanMs == Approx(50.5));
+    REQUIRE(summary.maxMs == Approx(100.0));
+    // 50 ms is the lower edge of the 50.0-50.5 ms bucket, its upper bound is reported.
+    REQUIRE(summary.p50Ms == Approx(50.5));
+    REQUIRE(summary.p90Ms == Approx(90.5));
+    REQUIRE(summary.p99Ms == Approx(99.5));
+
+    // Within one bucket the percentile never overstates past the largest sample.
+    histogram.Clear();
+    histogram.Add(7100000);
+    histogram.Add(7200000);
+    summary = histogram.Summarize();
+    REQUIRE(summary.p50Ms == Approx(7.2));
+    REQUIRE(summary.p99Ms == Approx(7.2));
+
+    histogram.Clear();
+    REQUIRE(histogram.Summarize().count == 0);
+    REQUIRE(histogram.Summarize().maxMs == 0.0);
+}
+
+TEST_CASE("LatencyHistogram clamps out of range samples", "[latency]") {
+    LatencyHistogram histogram;
+    histogram.Add(-5 * MsToNs);
+    LatencyHistogram::Summary summary = histogram.Summarize();
+    REQUIRE(summary.p50Ms == 0.0);
+    REQUIRE(summary.meanMs == 0.0);
+
+    // Everything past 250 ms shares the last bucket, the max still has the real value.
+    histogram.Clear();
+    histogram.Add(400 * MsToNs);
+    histogram.Add(900 * MsToNs);
+    summary = histogram.Summarize();
+    REQUIRE(summary.p50Ms == Approx(250.0));
+    REQUIRE(summary.p99Ms == Approx(250.0));
+    REQUIRE(summary.maxMs == Approx(900.0));
+}
+
+TEST_CASE("LatencyTracker pairs frames with the pose they name", "[latency]") {
+    LatencyTracker tracker;
+    const int64_t base = 1000 * MsToNs;
+    for (uint64_t poseID = 1; poseID <= 10; poseID++) {
+        tracker.OnPoseSent(poseID, base + (int64_t)poseID * MsToNs);
+    }
+
+    // Pose 4 went out at 1004 ms, latched 20 ms and displayed 45 ms later.
+    tracker.OnFrameLatched(4, base + 24 * MsToNs);
+    tracker.OnFrameDisplayed(4, base + 49 * MsToNs);
+    REQUIRE(tracker.GetPoseToPhotonMs() == Approx(45.0));
+
+    // The smoothed value moves a tenth of the way to each new frame.
+    tracker.OnFrameLatched(8, base + 28 * MsToNs);
+    tracker.OnFrameDisplayed(8, base + 63 * MsToNs);
+    REQUIRE(tracker.GetPoseToPhotonMs() == Approx(46.0));
+
+    tracker.OnInputSent(base, base + 3 * MsToNs);
+
+    const LatencyTracker::Snapshot snapshot = tracker.TakeSnapshot();
+    REQUIRE(snapshot.unmatched == 0);
+    REQUIRE(snapshot.poseToLatch.count == 2);
+    REQUIRE(snapshot.poseToLatch.meanMs == Approx(20.0));
+    REQUIRE(snapshot.poseToPhoton.count == 2);
+    REQUIRE(snapshot.poseToPhoton.meanMs == Approx(50.0));
+    REQUIRE(snapshot.poseToPhoton.maxMs == Approx(55.0));
+    REQUIRE(snapshot.inputToSend.count == 1);
+    REQUIRE(snapshot.inputToSend.maxMs == Approx(3.0));
+
+    // The snapshot starts new distributions, the sent poses and the smoothed latency are kept.
+    const LatencyTracker::Snapshot next = tracker.TakeSnapshot();
+    REQUIRE(next.poseToLatch.count == 0);
+    REQUIRE(next.poseToPhoton.count == 0);
+    REQUIRE(tracker.GetPoseToPhotonMs() == Approx(46.0));
+    tracker.OnFrameLatched(9, base + 30 * MsToNs);
+    REQUIRE(tracker.TakeSnapshot().poseToLatch.count == 1);
+}
+
+TEST_CASE("LatencyTracker matches poses after the ring wraps", "[latency]") {
+    LatencyTracker tracker;
+    const uint64_t capacity = LatencyTracker::PoseCapacity;
+    const uint64_t last = 2 * capacity + 100;
+    for (uint64_t poseID = 1; poseID <= last; poseID++) {
+        tracker.OnPoseSent(poseID, (int64_t)poseID * MsToNs);
+    }
+
+    // The newest pose in a slot matches with its own send time, not the one it replaced.
+    tracker.OnFrameLatched(last, (int64_t)(last + 30) * MsToNs);
+    tracker.OnFrameLatched(last - capacity + 1, (int64_t)(last - capacity + 1 + 30) * MsToNs);
+    LatencyTracker::Snapshot snapshot = tracker.TakeSnapshot();
+    REQUIRE(snapshot.unmatched == 0);
+    REQUIRE(snapshot.poseToLatch.count == 2);
+    REQUIRE(snapshot.poseToLatch.meanMs == Approx(30.0));
+
+    // Overwritten, never sent and the empty ID are unmatched, and add nothing to the distributions.
+    tracker.OnFrameLatched(last - capacity, (int64_t)(last + 30) * MsToNs);
+    tracker.OnFrameLatched(100, (int64_t)(last + 30) * MsToNs);
+    tracker.OnFrameLatched(last + 1, (int64_t)(last + 30) * MsToNs);
+    tracker.OnFrameLatched(0, (int64_t)(last + 30) * MsToNs);
+    tracker.OnFrameDisplayed(100, (int64_t)(last + 60) * MsToNs);
+    snapshot = tracker.TakeSnapshot();
+    REQUIRE(snapshot.unmatched == 4);
+    REQUIRE(snapshot.poseToLatch.count == 0);
+    REQUIRE(snapshot.poseToPhoton.count == 0);
+    REQUIRE(tracker.GetPoseToPhotonMs() == 0.0);
+}
+
+TEST_CASE("LatencyTracker forgets everything on Reset", "[latency]") {
+    LatencyTracker tracker;
+    for (uint64_t poseID = 1; poseID <= 5; poseID++) {
+        tracker.OnPoseSent(poseID, (int64_t)poseID * MsToNs);
+    }
+    tracker.OnFrameLatched(2, 20 * MsToNs);
+    tracker.OnFrameDisplayed(2, 40 * MsToNs);
+    tracker.OnFrameLatched(99, 40 * MsToNs);
+    tracker.OnInputSent(0, MsToNs);
+    REQUIRE(tracker.GetPoseToPhotonMs() > 0.0);
+
+    tracker.Reset();
+    REQUIRE(tracker.GetPoseToPhotonMs() == 0.0);
+    LatencyTracker::Snapshot snapshot = tracker.TakeSnapshot();
+    REQUIRE(snapshot.unmatched == 0);
+    REQUIRE(snapshot.poseToLatch.count == 0);
+    REQUIRE(snapshot.poseToPhoton.count == 0);
+    REQUIRE(snapshot.inputToSend.count == 0);
+
+    // A new receiver numbers its poses from 1 again, a frame of the old one naming pose 3 must not match.
+    tracker.OnFrameLatched(3, 50 * MsToNs);
+    REQUIRE(tracker.TakeSnapshot().unmatched == 1);
+    tracker.OnPoseSent(1, 100 * MsToNs);
+    tracker.OnFrameLatched(1, 115 * MsToNs);
+    snapshot = tracker.TakeSnapshot();
+    REQUIRE(snapshot.unmatched == 0);
+    REQUIRE(snapshot.poseToLatch.meanMs == Approx(15.0));
+}
@@ -0,0 +1,157 @@
+/*
+    pause/resume command serialization on the lifecycle worker, stressed against a stand-in receiver
+*/
+#include <atomic>
+#include <random>
+#include <thread>
+#include "lifecycle_worker.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+// Stands in for the CloudXR receiver: counts creations and teardowns and every call that would have crashed the SDK,
+// a second create over a live receiver, a destroy without one, or two of them at once.
+struct FakeReceiver {
+    std::atomic<int> live{0};
+    std::atomic<int> inCall{0};
+    std::atomic<int> violations{0};
+    std::atomic<int> created{0};
+    std::atomic<int> destroyed{0};
+    std::mutex mutex;
+
+    void Enter() {
+        if (inCall++ != 0) {
+            violations++;
+        }
+        // Give a racing caller a chance to show.
+        std::this_thread::yield();
+    }
+
+    void Create() {
+        std::lock_guard<std::mutex> lock(mutex);
+        Enter();
+        if (live++ != 0) {
+            violations++;
+        }
+        created++;
+        inCall--;
+    }
+
+    void Destroy() {
+        std::lock_guard<std::mutex> lock(mutex);
+        Enter();
+        if (live == 0) {
+            inCall--;
+            return;
+        }
+        if (--live != 0) {
+            violations++;
+        }
+        destroyed++;
+        inCall--;
+    }
+};
+
+LifecycleWorker::Handlers Drive(FakeReceiver& receiver, std::atomic<int>* polls = nullptr) {
+    LifecycleWorker::Handlers handlers;
+    handlers.setPaused = [&receiver](bool paused) {
+        if (paused) {
+            receiver.Destroy();
+        } else {
+            receiver.Create();
+        }
+    };
+    handlers.poll = [polls]() {
+        if (polls != nullptr) {
+            (*polls)++;
+        }
+    };
+    handlers.pollInterval = []() { return std::chrono::milliseconds(5); };
+    handlers.shutdown = [&receiver]() { receiver.Destroy(); };
+    return handlers;
+}
+}  // namespace
+
+TEST_CASE("Commands are handled in order and repeats are ignored", "[lifecycle]") {
+    FakeReceiver receiver;
+    std::vector<bool> calls;
+    std::mutex callsMutex;
+    LifecycleWorker::Handlers handlers = Drive(receiver);
+    handlers.setPaused = [&](bool paused) {
+        std::lock_guard<std::mutex> lock(callsMutex);
+        calls.push_back(paused);
+    };
+
+    LifecycleWorker worker(handlers);
+    // Posted before the thread runs, like a resume that arrives before Initialize.
+    worker.Post(LifecycleCommand::Pause);
+    worker.Post(LifecycleCommand::Resume);
+    worker.Post(LifecycleCommand::Resume);
+    worker.Post(LifecycleCommand::Pause);
+    worker.Post(LifecycleCommand::Pause);
+    worker.Post(LifecycleCommand::Resume);
+    worker.Start();
+    worker.Stop();
+
+    REQUIRE(calls == std::vector<bool>{false, true, false});
+    REQUIRE(worker.GetStats().handled == 6);
+}
+
+TEST_CASE("The worker polls between commands and stops without a start", "[lifecycle]") {
+    FakeReceiver receiver;
+    std::atomic<int> polls{0};
+    {
+        LifecycleWorker idle(Drive(receiver, &polls));
+        idle.Post(LifecycleCommand::Resume);
+    }
+    REQUIRE(polls == 0);
+    REQUIRE(receiver.created == 0);
+
+    LifecycleWorker worker(Drive(receiver, &polls));
+    worker.Start();
+    worker.Post(LifecycleCommand::Resume);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    worker.Stop();
+    REQUIRE(polls >= 2);
+    // Shutdown tears the receiver down.
+    REQUIRE(receiver.created == 1);
+    REQUIRE(receiver.destroyed == 1);
+    REQUIRE(receiver.live == 0);
+}
+
+TEST_CASE("Racing pause and resume never double-create or double-destroy", "[lifecycle]") {
+    FakeReceiver receiver;
+    LifecycleWorker worker(Drive(receiver));
+    worker.Start();
+
+    // Looper callbacks from several threads racing each other.
+    constexpr int PosterCount = 4;
+    constexpr int PostsPerThread = 2000;
+    std::vector<std::thread> posters;
+    for (int p = 0; p < PosterCount; p++) {
+        posters.emplace_back([&worker, p]() {
+            std::mt19937 random(p);
+            for (int i = 0; i < PostsPerThread; i++) {
+                worker.Post(random() % 2 == 0 ? LifecycleCommand::Pause : LifecycleCommand::Resume);
+                if (random() % 64 == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(random() % 200));
+                }
+            }
+        });
+    }
+    for (std::thread& poster : posters) {
+        poster.join();
+    }
+    worker.Stop();
+
+    const LifecycleWorker::Stats stats = worker.GetStats();
+    REQUIRE(receiver.violations == 0);
+    REQUIRE(receiver.live == 0);
+    REQUIRE(receiver.created == receiver.destroyed);
+    REQUIRE(receiver.created > 0);
+    REQUIRE(stats.handled == (uint64_t)(PosterCount * PostsPerThread));
+    // Handlers are quick here, so any wait is the queue itself. Generous for a loaded CI machine.
+    REQUIRE(stats.maxQueuedNs < 1000000000);
+    WARN("max pause/resume queueing " << stats.maxQueuedNs / 1e6 << " ms, handler " << stats.maxHandlerNs / 1e6 << " ms");
+}
@@ -0,0 +1,187 @@
+/*
+    main loop waker, idle poll backoff and wake-to-first-frame latency against the stub looper and runtime
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+#include "clock.h"
+#include "loop_waker.h"
+#include "openxr_stub.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+void QueueSessionState(XrSessionState state) {
+    XrEventDataBuffer buffer{};
+    XrEventDataSessionStateChanged& event = *reinterpret_cast<XrEventDataSessionStateChanged*>(&buffer);
+    event.type = XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED;
+    event.state = state;
+    StubQueueEvent(buffer);
+}
+
+// The idle part of android_main's loop: block in the looper with the backoff, drain the waker, then poll the runtime.
+// Returns the time the first frame would start, at the iteration that sees the session become ready.
+int64_t RunIdleLoopUntilReady(LoopWaker* waker, IdlePollBackoff* idlePoll) {
+    for (;;) {
+        bool woken = false;
+        for (;;) {
+            const int ident = ALooper_pollAll(woken ? 0 : idlePoll->GetTimeoutMs(), nullptr, nullptr, nullptr);
+            if (ident < 0) {
+                break;
+            }
+            woken = true;
+            if (ident == LoopWaker::LooperId) {
+                waker->Drain();
+            }
+        }
+
+        XrEventDataBuffer event{};
+        event.type = XR_TYPE_EVENT_DATA_BUFFER;
+        bool ready = false;
+        while (xrPollEvent(XR_NULL_HANDLE, &event) == XR_SUCCESS) {
+            if (event.type == XR_TYPE_EVENT_DATA_SESSION_STATE_CHANGED &&
+                reinterpret_cast<const XrEventDataSessionStateChanged&>(event).state == XR_SESSION_STATE_READY) {
+                ready = true;
+            }
+        }
+        if (ready) {
+            idlePoll->Reset();
+            return Clock::NowNs();
+        }
+        idlePoll->OnIdle(woken);
+    }
+}
+
+struct LatencySummary {
+    double meanMs;
+    double p50Ms;
+    double maxMs;
+};
+
+// The session becomes ready at random 20..200 ms into each idle stretch, the client thread wakes the loop or not.
+LatencySummary MeasureWakeToFirstFrame(bool wake, int rounds) {
+    LoopWaker waker;
+    waker.Attach(ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS));
+    IdlePollBackoff idlePoll;
+    std::atomic<int64_t> readyNs{0};
+
+    std::thread client([&]() {
+        std::mt19937 random(46);
+        std::uniform_int_distribution<int> delayMs(20, 200);
+        for (int round = 0; round < rounds; round++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs(random)));
+            readyNs = Clock::NowNs();
+            QueueSessionState(XR_SESSION_STATE_READY);
+            if (wake) {
+                waker.Wake();
+            }
+            // The next stretch starts once the loop saw this one.
+            while (readyNs != 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+    });
+
+    std::vector<double> latenciesMs;
+    for (int round = 0; round < rounds; round++) {
+        const int64_t frameNs = RunIdleLoopUntilReady(&waker, &idlePoll);
+        latenciesMs.push_back(Clock::NsToMs(frameNs - readyNs.load()));
+        readyNs = 0;
+    }
+    client.join();
+    waker.Detach();
+
+    std::sort(latenciesMs.begin(), latenciesMs.end());
+    double sum = 0.0;
+    for (double latency : latenciesMs) {
+        sum += latency;
+    }
+    return {sum / latenciesMs.size(), latenciesMs[latenciesMs.size() / 2], latenciesMs.back()};
+}
+
+}  // namespace
+
+TEST_CASE("LoopWaker wakes the looper once per drain", "[loop_waker]") {
+    ALooper* looper = ALooper_prepare(ALOOPER_PREPARE_ALLOW_NON_CALLBACKS);
+    LoopWaker waker;
+    // Not attached yet, nothing to wake or drain.
+    waker.Wake();
+    waker.Drain();
+    REQUIRE(waker.Attach(looper));
+    REQUIRE(waker.Attach(looper));
+    REQUIRE(ALooper_pollAll(0, nullptr, nullptr, nullptr) == ALOOPER_POLL_TIMEOUT);
+
+    // Wakes from several threads coalesce into one looper event.
+    std::vector<std::thread> wakers;
+    for (int i = 0; i < 3; i++) {
+        wakers.emplace_back([&waker]() { waker.Wake(); });
+    }
+    for (std::thread& thread : wakers) {
+        thread.join();
+    }
+    REQUIRE(ALooper_pollAll(0, nullptr, nullptr, nullptr) == LoopWaker::LooperId);
+    REQUIRE(ALooper_pollAll(0, nullptr, nullptr, nullptr) == LoopWaker::LooperId);
+    waker.Drain();
+    REQUIRE(ALooper_pollAll(0, nullptr, nullptr, nullptr) == ALOOPER_POLL_TIMEOUT);
+
+    // A blocked poll returns as soon as another thread wakes it.
+    std::thread late([&waker]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        waker.Wake();
+    });
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(ALooper_pollAll(5000, nullptr, nullptr, nullptr) == LoopWaker::LooperId);
+    REQUIRE(std::chrono::steady_clock::now() - start < std::chrono::seconds(2));
+    late.join();
+    waker.Drain();
+
+    // Detached, a late Wake from a client thread is a no-op and the looper stays quiet.
+    waker.Detach();
+    std::thread afterDetach([&waker]() { waker.Wake(); });
+    afterDetach.join();
+    waker.Drain();
+    waker.Detach();
+    REQUIRE(ALooper_pollAll(0, nullptr, nullptr, nullptr) == ALOOPER_POLL_TIMEOUT);
+
+    // And it can be attached again.
+    REQUIRE(waker.Attach(looper));
+    waker.Wake();
+    REQUIRE(ALooper_pollAll(0, nullptr, nullptr, nullptr) == LoopWaker::LooperId);
+}
+
+TEST_CASE("IdlePollBackoff doubles to its cap and restarts at every wake", "[loop_waker]") {
+    IdlePollBackoff idlePoll;
+    REQUIRE(idlePoll.GetTimeoutMs() == IdlePollBackoff::MinMs);
+    std::vector<int> timeouts;
+    for (int i = 0; i < 9; i++) {
+        idlePoll.OnIdle(false);
+        timeouts.push_back(idlePoll.GetTimeoutMs());
+    }
+    REQUIRE(timeouts == std::vector<int>{2, 4, 8, 16, 32, 64, 100, 100, 100});
+
+    idlePoll.OnIdle(true);
+    REQUIRE(idlePoll.GetTimeoutMs() == IdlePollBackoff::MinMs);
+    idlePoll.OnIdle(false);
+    idlePoll.OnIdle(false);
+    idlePoll.Reset();
+    REQUIRE(idlePoll.GetTimeoutMs() == IdlePollBackoff::MinMs);
+}
+
+TEST_CASE("LoopWaker cuts wake-to-first-frame latency below the poll backoff", "[loop_waker]") {
+    const LatencySummary polled = MeasureWakeToFirstFrame(false, 12);
+    const LatencySummary woken = MeasureWakeToFirstFrame(true, 12);
+    WARN("session ready to first frame, xrPollEvent backoff alone: mean " << polled.meanMs << " ms, p50 " << polled.p50Ms
+                                                                          << " ms, max " << polled.maxMs
+                                                                          << " ms; woken by the client: mean " << woken.meanMs
+                                                                          << " ms, p50 " << woken.p50Ms << " ms, max "
+                                                                          << woken.maxMs << " ms");
+    // Polling alone is bounded by the backoff cap, with room for a loaded machine.
+    REQUIRE(polled.maxMs < IdlePollBackoff::MaxMs + 50);
+    REQUIRE(woken.p50Ms < 5.0);
+    REQUIRE(woken.meanMs < polled.meanMs / 2);
+}
@@ -0,0 +1,90 @@
+/*
+    the NDK looper API over epoll, one looper per thread like on the device
+*/
+#include <android/looper.h>
+#include <errno.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+struct ALooper {
+    struct Registration {
+        int ident;
+        void* data;
+    };
+
+    ALooper() : epollFd(epoll_create1(EPOLL_CLOEXEC)) {}
+    ~ALooper() { close(epollFd); }
+
+    const int epollFd;
+    // Fds may be removed from other threads while the owner polls.
+    std::mutex mutex;
+    std::map<int, Registration> fds;
+};
+
+extern "C" ALooper* ALooper_prepare(int opts) {
+    thread_local std::unique_ptr<ALooper> t_looper;
+    if (!t_looper) {
+        t_looper.reset(new ALooper());
+    }
+    return t_looper.get();
+}
+
+extern "C" int ALooper_pollAll(int timeoutMillis, int* outFd, int* outEvents, void** outData) {
+    ALooper* looper = ALooper_prepare(0);
+    epoll_event event{};
+    int count;
+    do {
+        count = epoll_wait(looper->epollFd, &event, 1, timeoutMillis);
+    } while (count < 0 && errno == EINTR);
+    if (count < 0) {
+        return ALOOPER_POLL_ERROR;
+    }
+    if (count == 0) {
+        return ALOOPER_POLL_TIMEOUT;
+    }
+
+    std::lock_guard<std::mutex> lock(looper->mutex);
+    const auto registration = looper->fds.find(event.data.fd);
+    if (registration == looper->fds.end()) {
+        // Removed after it became ready.
+        return ALOOPER_POLL_WAKE;
+    }
+    if (outFd != nullptr) {
+        *outFd = event.data.fd;
+    }
+    if (outEvents != nullptr) {
+        *outEvents = (event.events & EPOLLIN) != 0 ? ALOOPER_EVENT_INPUT : ALOOPER_EVENT_ERROR;
+    }
+    if (outData != nullptr) {
+        *outData = registration->second.data;
+    }
+    return registration->second.ident;
+}
+
+extern "C" int ALooper_addFd(ALooper* looper, int fd, int ident, int events, ALooper_callbackFunc callback, void* data) {
+    if (callback != nullptr || ident < 0) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(looper->mutex);
+    epoll_event event{};
+    event.events = (events & ALOOPER_EVENT_INPUT) != 0 ? (uint32_t)EPOLLIN : 0u;
+    event.data.fd = fd;
+    const int op = looper->fds.count(fd) != 0 ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (epoll_ctl(looper->epollFd, op, fd, &event) != 0) {
+        return -1;
+    }
+    looper->fds[fd] = {ident, data};
+    return 1;
+}
+
+extern "C" int ALooper_removeFd(ALooper* looper, int fd) {
+    std::lock_guard<std::mutex> lock(looper->mutex);
+    if (looper->fds.erase(fd) == 0) {
+        return 0;
+    }
+    epoll_ctl(looper->epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    return 1;
+}
@@ -0,0 +1,211 @@
+/*
+    stand-in for the OpenXR loader, the host tests never create an instance
+*/
+#include "openxr_stub.h"
+#include <deque>
+#include <map>
+#include <set>
+#include <mutex>
+
+namespace {
+XrResult XRAPI_CALL ConvertTimespecTimeToTime(XrInstance instance, const timespec* time, XrTime* xrTime) {
+    *xrTime = (XrTime)time->tv_sec * 1000000000 + time->tv_nsec + StubXrTimeOffsetNs;
+    return XR_SUCCESS;
+}
+
+XrResult XRAPI_CALL ConvertTimeToTimespecTime(XrInstance instance, XrTime xrTime, timespec* time) {
+    const int64_t ns = xrTime - StubXrTimeOffsetNs;
+    time->tv_sec = (time_t)(ns / 1000000000);
+    time->tv_nsec = (long)(ns % 1000000000);
+    return XR_SUCCESS;
+}
+
+struct StubPerfLevels {
+    std::mutex mutex;
+    // CPU and GPU, the spec numbers the domains from 1.
+    XrPerfSettingsLevelEXT levels[2]{};
+    uint32_t calls{0};
+};
+
+StubPerfLevels& PerfLevels() {
+    static StubPerfLevels s_levels;
+    return s_levels;
+}
+
+XrResult XRAPI_CALL PerfSettingsSetPerformanceLevel(XrSession session, XrPerfSettingsDomainEXT domain, XrPerfSettingsLevelEXT level) {
+    if (domain != XR_PERF_SETTINGS_DOMAIN_CPU_EXT && domain != XR_PERF_SETTINGS_DOMAIN_GPU_EXT) {
+        return XR_ERROR_VALIDATION_FAILURE;
+    }
+    StubPerfLevels& levels = PerfLevels();
+    std::lock_guard<std::mutex> lock(levels.mutex);
+    levels.levels[domain - 1] = level;
+    levels.calls++;
+    return XR_SUCCESS;
+}
+
+struct StubBooleanAction {
+    std::mutex mutex;
+    // What StubSetBooleanAction set last, and what the last xrSyncActions made visible.
+    bool pending{false};
+    XrTime pendingChangeTime{0};
+    XrActionStateBoolean synced{};
+};
+
+StubBooleanAction& BooleanAction() {
+    static StubBooleanAction s_action;
+    return s_action;
+}
+
+struct StubSpaces {
+    std::mutex mutex;
+    std::map<XrSpace, StubSpaceLocation> locations;
+    std::set<XrPath> activePoseActions;
+};
+
+StubSpaces& Spaces() {
+    static StubSpaces s_spaces;
+    return s_spaces;
+}
+
+struct StubEventQueue {
+    std::mutex mutex;
+    std::deque<XrEventDataBuffer> events;
+};
+
+StubEventQueue& EventQueue() {
+    static StubEventQueue s_queue;
+    return s_queue;
+}
+}  // namespace
+
+void StubSetSpaceLocation(XrSpace space, const StubSpaceLocation& location) {
+    StubSpaces& spaces = Spaces();
+    std::lock_guard<std::mutex> lock(spaces.mutex);
+    spaces.locations[space] = location;
+}
+
+void StubSetPoseActionActive(XrPath subactionPath, bool active) {
+    StubSpaces& spaces = Spaces();
+    std::lock_guard<std::mutex> lock(spaces.mutex);
+    if (active) {
+        spaces.activePoseActions.insert(subactionPath);
+    } else {
+        spaces.activePoseActions.erase(subactionPath);
+    }
+}
+
+void StubResetSpaces() {
+    StubSpaces& spaces = Spaces();
+    std::lock_guard<std::mutex> lock(spaces.mutex);
+    spaces.locations.clear();
+    spaces.activePoseActions.clear();
+}
+
+extern "C" XRAPI_ATTR XrResult XRAPI_CALL xrGetActionStatePose(XrSession session, const XrActionStateGetInfo* getInfo, XrActionStatePose* state) {
+    StubSpaces& spaces = Spaces();
+    std::lock_guard<std::mutex> lock(spaces.mutex);
+    state->isActive = spaces.activePoseActions.count(getInfo->subactionPath) != 0 ? XR_TRUE : XR_FALSE;
+    return XR_SUCCESS;
+}
+
+extern "C" XRAPI_ATTR XrResult XRAPI_CALL xrLocateSpace(XrSpace space, XrSpace baseSpace, XrTime time, XrSpaceLocation* location) {
+    StubSpaces& spaces = Spaces();
+    std::lock_guard<std::mutex> lock(spaces.mutex);
+    StubSpaceLocation stub;
+    const auto found = spaces.locations.find(space);
+    if (found != spaces.locations.end()) {
+        stub = found->second;
+    }
+    // Like a runtime, only what the flags mark as valid is meaningful, the rest is left as the caller passed it.
+    location->locationFlags = stub.flags;
+    if ((stub.flags & (XR_SPACE_LOCATION_POSITION_VALID_BIT | XR_SPACE_LOCATION_ORIENTATION_VALID_BIT)) != 0) {
+        location->pose = stub.pose;
+    }
+    if (location->next != nullptr && static_cast<const XrBaseInStructure*>(location->next)->type == XR_TYPE_SPACE_VELOCITY) {
+        XrSpaceVelocity* velocity = static_cast<XrSpaceVelocity*>(location->next);
+        velocity->velocityFlags = stub.velocityFlags;
+        velocity->linearVelocity = stub.linearVelocity;
+        velocity->angularVelocity = stub.angularVelocity;
+    }
+    return stub.result;
+}
+
+void StubQueueEvent(const XrEventDataBuffer& event) {
+    StubEventQueue& queue = EventQueue();
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.events.push_back(event);
+}
+
+extern "C" XRAPI_ATTR XrResult XRAPI_CALL xrPollEvent(XrInstance instance, XrEventDataBuffer* eventData) {
+    StubEventQueue& queue = EventQueue();
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.events.empty()) {
+        return XR_EVENT_UNAVAILABLE;
+    }
+    *eventData = queue.events.front();
+    queue.events.pop_front();
+    return XR_SUCCESS;
+}
+
+XrPerfSettingsLevelEXT StubPerfLevel(XrPerfSettingsDomainEXT domain) {
+    StubPerfLevels& levels = PerfLevels();
+    std::lock_guard<std::mutex> lock(levels.mutex);
+    return levels.levels[domain - 1];
+}
+
+uint32_t StubPerfLevelCalls() {
+    StubPerfLevels& levels = PerfLevels();
+    std::lock_guard<std::mutex> lock(levels.mutex);
+    return levels.calls;
+}
+
+void StubResetPerfLevels() {
+    StubPerfLevels& levels = PerfLevels();
+    std::lock_guard<std::mutex> lock(levels.mutex);
+    levels.levels[0] = levels.levels[1] = (XrPerfSettingsLevelEXT)0;
+    levels.calls = 0;
+}
+
+void StubSetBooleanAction(bool state, XrTime changeTime) {
+    StubBooleanAction& action = BooleanAction();
+    std::lock_guard<std::mutex> lock(action.mutex);
+    action.pending = state;
+    action.pendingChangeTime = changeTime;
+}
+
+extern "C" XRAPI_ATTR XrResult XRAPI_CALL xrSyncActions(XrSession session, const XrActionsSyncInfo* syncInfo) {
+    StubBooleanAction& action = BooleanAction();
+    std::lock_guard<std::mutex> lock(action.mutex);
+    action.synced.type = XR_TYPE_ACTION_STATE_BOOLEAN;
+    const bool changed = action.synced.currentState != (action.pending ? XR_TRUE : XR_FALSE);
+    action.synced.isActive = XR_TRUE;
+    action.synced.changedSinceLastSync = changed ? XR_TRUE : XR_FALSE;
+    if (changed) {
+        action.synced.currentState = action.pending ? XR_TRUE : XR_FALSE;
+        action.synced.lastChangeTime = action.pendingChangeTime;
+    }
+    return XR_SUCCESS;
+}
+
+extern "C" XRAPI_ATTR XrResult XRAPI_CALL xrGetActionStateBoolean(XrSession session, const XrActionStateGetInfo* getInfo,
+                                                                  XrActionStateBoolean* state) {
+    StubBooleanAction& action = BooleanAction();
+    std::lock_guard<std::mutex> lock(action.mutex);
+    *state = action.synced;
+    return XR_SUCCESS;
+}
+
+extern "C" XRAPI_ATTR XrResult XRAPI_CALL xrGetInstanceProcAddr(XrInstance instance, const char* name, PFN_xrVoidFunction* function) {
+    *function = nullptr;
+    if (instance == XR_NULL_HANDLE) {
+        return XR_ERROR_HANDLE_INVALID;
+    }
+    if (strcmp(name, "xrConvertTimespecTimeToTimeKHR") == 0) {
+        *function = (PFN_xrVoidFunction)&ConvertTimespecTimeToTime;
+    } else if (strcmp(name, "xrConvertTimeToTimespecTimeKHR") == 0) {
+        *function = (PFN_xrVoidFunction)&ConvertTimeToTimespecTime;
+    } else if (strcmp(name, "xrPerfSettingsSetPerformanceLevelEXT") == 0) {
+        *function = (PFN_xrVoidFunction)&PerfSettingsSetPerformanceLevel;
+    }
+    return *function != nullptr ? XR_SUCCESS : XR_ERROR_FUNCTION_UNSUPPORTED;
+}
@@ -0,0 +1,43 @@
+/*
+    stand-in for the OpenXR loader, the host tests never create an instance
+*/
+
+#pragma once
+#include "pch.h"
+
+// Any non-null handle enables the stub XR_KHR_convert_timespec_time functions, which put XrTime this far ahead of
+// CLOCK_MONOTONIC so a conversion that was skipped shows.
+constexpr int64_t StubXrTimeOffsetNs = 1000000000000;
+
+inline XrInstance StubXrInstance() { return (XrInstance)(uintptr_t)0x1; }
+
+// One scripted boolean action for the input tests, xrGetActionStateBoolean reports it for any action. A change set here
+// shows up at the next xrSyncActions, with changedSinceLastSync and lastChangeTime like a runtime reports them.
+void StubSetBooleanAction(bool state, XrTime changeTime);
+
+// Queues an event for xrPollEvent, which hands them out in order from any thread.
+void StubQueueEvent(const XrEventDataBuffer& event);
+
+// The last level xrPerfSettingsSetPerformanceLevelEXT set for a domain, 0 before the first call, and how often it was
+// called since the last StubResetPerfLevels.
+XrPerfSettingsLevelEXT StubPerfLevel(XrPerfSettingsDomainEXT domain);
+uint32_t StubPerfLevelCalls();
+void StubResetPerfLevels();
+
+// What xrLocateSpace reports for one space, whatever it is located in. A space without one is not tracked.
+struct StubSpaceLocation {
+    XrResult result{XR_SUCCESS};
+    XrSpaceLocationFlags flags{0};
+    XrPosef pose{{0, 0, 0, 1}, {0, 0, 0}};
+    XrSpaceVelocityFlags velocityFlags{0};
+    XrVector3f linearVelocity{0, 0, 0};
+    XrVector3f angularVelocity{0, 0, 0};
+};
+
+void StubSetSpaceLocation(XrSpace space, const StubSpaceLocation& location);
+
+// xrGetActionStatePose reports any pose action active for the subaction paths set here.
+void StubSetPoseActionActive(XrPath subactionPath, bool active);
+
+// Forgets the space locations and the active pose actions.
+void StubResetSpaces();
@@ -0,0 +1,200 @@
+/*
+    performance level hints, notification folding and the pressure reconnect decision against the stub runtime
+*/
+#include <vector>
+#include "openxr_stub.h"
+#include "performance_settings.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+XrSession StubSession() { return (XrSession)(uintptr_t)0x2; }
+
+XrEventDataPerfSettingsEXT Notification(XrPerfSettingsDomainEXT domain, XrPerfSettingsSubDomainEXT subDomain,
+                                        XrPerfSettingsNotificationLevelEXT from, XrPerfSettingsNotificationLevelEXT to) {
+    XrEventDataPerfSettingsEXT event{};
+    event.type = XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT;
+    event.domain = domain;
+    event.subDomain = subDomain;
+    event.fromLevel = from;
+    event.toLevel = to;
+    return event;
+}
+
+void QueueNotification(XrPerfSettingsDomainEXT domain, XrPerfSettingsNotificationLevelEXT to) {
+    XrEventDataBuffer buffer{};
+    *reinterpret_cast<XrEventDataPerfSettingsEXT*>(&buffer) =
+        Notification(domain, XR_PERF_SETTINGS_SUB_DOMAIN_THERMAL_EXT, XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT, to);
+    StubQueueEvent(buffer);
+}
+
+// The client's side of the decision: the pressure the main thread forwarded, and the one the live receiver was created
+// with. UpdateReconnect replaces the receiver, and ApplyPerformanceBackoff applies the pressure when it is created.
+struct ControlThread {
+    void Update() {
+        if (hasReceiver && PerformanceSettings::NeedsReconnect(pressure, applied)) {
+            reconnects++;
+            applied = pressure;
+        }
+    }
+
+    void CreateReceiver() {
+        hasReceiver = true;
+        applied = pressure;
+    }
+
+    bool hasReceiver{false};
+    PerfPressure pressure{PerfPressure::Normal};
+    PerfPressure applied{PerfPressure::Normal};
+    uint32_t reconnects{0};
+};
+
+// What PollEvents does with the queued events, the pressure goes to the client only when it changed.
+void PollEvents(PerformanceSettings* settings, ControlThread* control) {
+    XrEventDataBuffer event{};
+    event.type = XR_TYPE_EVENT_DATA_BUFFER;
+    while (xrPollEvent(XR_NULL_HANDLE, &event) == XR_SUCCESS) {
+        if (event.type == XR_TYPE_EVENT_DATA_PERF_SETTINGS_EXT &&
+            settings->OnNotification(reinterpret_cast<const XrEventDataPerfSettingsEXT&>(event))) {
+            control->pressure = settings->GetPressure();
+        }
+        event.type = XR_TYPE_EVENT_DATA_BUFFER;
+    }
+}
+
+}  // namespace
+
+TEST_CASE("PerformanceSettings sends levels only when streaming changes", "[perf_settings]") {
+    StubResetPerfLevels();
+    PerformanceSettings settings;
+    settings.Initialize(StubXrInstance(), StubSession());
+    REQUIRE(settings.IsSupported());
+
+    settings.SetStreaming(false);
+    REQUIRE(StubPerfLevelCalls() == 2);
+    REQUIRE(StubPerfLevel(XR_PERF_SETTINGS_DOMAIN_CPU_EXT) == XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT);
+    REQUIRE(StubPerfLevel(XR_PERF_SETTINGS_DOMAIN_GPU_EXT) == XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT);
+
+    // Called every frame, only the change reaches the runtime.
+    for (int frame = 0; frame < 10; frame++) {
+        settings.SetStreaming(true);
+    }
+    REQUIRE(StubPerfLevelCalls() == 4);
+    REQUIRE(StubPerfLevel(XR_PERF_SETTINGS_DOMAIN_CPU_EXT) == XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT);
+    REQUIRE(StubPerfLevel(XR_PERF_SETTINGS_DOMAIN_GPU_EXT) == XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT);
+
+    // Without the extension nothing is sent and the pressure stays Normal.
+    StubResetPerfLevels();
+    PerformanceSettings unsupported;
+    unsupported.Initialize(XR_NULL_HANDLE, StubSession());
+    REQUIRE_FALSE(unsupported.IsSupported());
+    unsupported.SetStreaming(true);
+    REQUIRE_FALSE(unsupported.EndSession());
+    REQUIRE(StubPerfLevelCalls() == 0);
+}
+
+TEST_CASE("PerformanceSettings folds notifications into the worst level", "[perf_settings]") {
+    PerformanceSettings settings;
+    settings.Initialize(StubXrInstance(), StubSession());
+    const auto cpu = XR_PERF_SETTINGS_DOMAIN_CPU_EXT;
+    const auto gpu = XR_PERF_SETTINGS_DOMAIN_GPU_EXT;
+    const auto normal = XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT;
+    const auto warning = XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT;
+    const auto impaired = XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT;
+
+    // CPU and GPU levels map to the same pressure.
+    REQUIRE(settings.OnNotification(Notification(cpu, XR_PERF_SETTINGS_SUB_DOMAIN_THERMAL_EXT, normal, warning)));
+    REQUIRE(settings.GetPressure() == PerfPressure::Warning);
+    REQUIRE(settings.OnNotification(Notification(gpu, XR_PERF_SETTINGS_SUB_DOMAIN_RENDERING_EXT, normal, impaired)));
+    REQUIRE(settings.GetPressure() == PerfPressure::Impaired);
+
+    // Repeats and a better level elsewhere do not change the worst one.
+    REQUIRE_FALSE(settings.OnNotification(Notification(gpu, XR_PERF_SETTINGS_SUB_DOMAIN_RENDERING_EXT, impaired, impaired)));
+    REQUIRE_FALSE(settings.OnNotification(Notification(cpu, XR_PERF_SETTINGS_SUB_DOMAIN_THERMAL_EXT, warning, normal)));
+    REQUIRE(settings.GetPressure() == PerfPressure::Impaired);
+
+    // Recovery needs every subdomain back to normal.
+    REQUIRE_FALSE(settings.OnNotification(Notification(gpu, XR_PERF_SETTINGS_SUB_DOMAIN_COMPOSITING_EXT, normal, warning)));
+    REQUIRE(settings.OnNotification(Notification(gpu, XR_PERF_SETTINGS_SUB_DOMAIN_RENDERING_EXT, impaired, normal)));
+    REQUIRE(settings.GetPressure() == PerfPressure::Warning);
+    REQUIRE(settings.OnNotification(Notification(gpu, XR_PERF_SETTINGS_SUB_DOMAIN_COMPOSITING_EXT, warning, normal)));
+    REQUIRE(settings.GetPressure() == PerfPressure::Normal);
+
+    // Domains and subdomains the spec does not define are ignored.
+    REQUIRE_FALSE(settings.OnNotification(Notification((XrPerfSettingsDomainEXT)3, XR_PERF_SETTINGS_SUB_DOMAIN_THERMAL_EXT, normal, impaired)));
+    REQUIRE_FALSE(settings.OnNotification(Notification(cpu, (XrPerfSettingsSubDomainEXT)0, normal, impaired)));
+    REQUIRE(settings.GetPressure() == PerfPressure::Normal);
+}
+
+TEST_CASE("PerformanceSettings restores the levels when the session ends", "[perf_settings]") {
+    StubResetPerfLevels();
+    PerformanceSettings settings;
+    settings.Initialize(StubXrInstance(), StubSession());
+    settings.SetStreaming(true);
+    REQUIRE(settings.OnNotification(Notification(XR_PERF_SETTINGS_DOMAIN_GPU_EXT, XR_PERF_SETTINGS_SUB_DOMAIN_THERMAL_EXT,
+                                                 XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT, XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT)));
+
+    // The session stops while streaming: power savings again, and the next session starts from Normal.
+    REQUIRE(settings.EndSession());
+    REQUIRE(settings.GetPressure() == PerfPressure::Normal);
+    REQUIRE(StubPerfLevel(XR_PERF_SETTINGS_DOMAIN_CPU_EXT) == XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT);
+    REQUIRE(StubPerfLevel(XR_PERF_SETTINGS_DOMAIN_GPU_EXT) == XR_PERF_SETTINGS_LEVEL_POWER_SAVINGS_EXT);
+    const uint32_t calls = StubPerfLevelCalls();
+    REQUIRE_FALSE(settings.EndSession());
+    REQUIRE(StubPerfLevelCalls() == calls);
+
+    // A session that begins again streams with sustained high clocks.
+    settings.SetStreaming(true);
+    REQUIRE(StubPerfLevel(XR_PERF_SETTINGS_DOMAIN_CPU_EXT) == XR_PERF_SETTINGS_LEVEL_SUSTAINED_HIGH_EXT);
+}
+
+TEST_CASE("Rising pressure from polled events replaces the receiver, flapping does not", "[perf_settings]") {
+    PerformanceSettings settings;
+    settings.Initialize(StubXrInstance(), StubSession());
+    ControlThread control;
+    const auto cpu = XR_PERF_SETTINGS_DOMAIN_CPU_EXT;
+    const auto gpu = XR_PERF_SETTINGS_DOMAIN_GPU_EXT;
+
+    // Without a receiver nothing is replaced, the next one is created with the current pressure.
+    QueueNotification(cpu, XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT);
+    PollEvents(&settings, &control);
+    control.Update();
+    REQUIRE(control.reconnects == 0);
+    control.CreateReceiver();
+    REQUIRE(control.applied == PerfPressure::Warning);
+
+    // The level flaps between normal and warning for a while, the receiver already runs with warning.
+    for (int i = 0; i < 10; i++) {
+        QueueNotification(cpu, i % 2 == 0 ? XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT : XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT);
+        PollEvents(&settings, &control);
+        control.Update();
+    }
+    REQUIRE(control.reconnects == 0);
+
+    // Impaired replaces it once, several notifications in one poll count as one change.
+    QueueNotification(gpu, XR_PERF_SETTINGS_NOTIF_LEVEL_WARNING_EXT);
+    QueueNotification(gpu, XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT);
+    PollEvents(&settings, &control);
+    control.Update();
+    control.Update();
+    REQUIRE(control.reconnects == 1);
+    REQUIRE(control.applied == PerfPressure::Impaired);
+
+    // Falling back to normal keeps the receiver, rising to impaired again needs nothing new either.
+    QueueNotification(gpu, XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+    QueueNotification(cpu, XR_PERF_SETTINGS_NOTIF_LEVEL_NORMAL_EXT);
+    PollEvents(&settings, &control);
+    control.Update();
+    REQUIRE(control.pressure == PerfPressure::Normal);
+    QueueNotification(gpu, XR_PERF_SETTINGS_NOTIF_LEVEL_IMPAIRED_EXT);
+    PollEvents(&settings, &control);
+    control.Update();
+    REQUIRE(control.reconnects == 1);
+
+    REQUIRE(PerformanceSettings::NeedsReconnect(PerfPressure::Warning, PerfPressure::Normal));
+    REQUIRE(PerformanceSettings::NeedsReconnect(PerfPressure::Impaired, PerfPressure::Warning));
+    REQUIRE_FALSE(PerformanceSettings::NeedsReconnect(PerfPressure::Normal, PerfPressure::Warning));
+    REQUIRE_FALSE(PerformanceSettings::NeedsReconnect(PerfPressure::Warning, PerfPressure::Warning));
+}
@@ -0,0 +1,112 @@
+/*
+    exponential growth, cap, jitter bounds and reset of the reconnect backoff, with fixed seeds
+*/
+#include <algorithm>
+#include <vector>
+#include "reconnect_policy.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+std::vector<int64_t> NextDelaysMs(ReconnectPolicy* policy, int count) {
+    std::vector<int64_t> delays;
+    for (int i = 0; i < count; i++) {
+        delays.push_back(policy->NextDelay().count());
+    }
+    return delays;
+}
+
+}  // namespace
+
+TEST_CASE("ReconnectPolicy grows exponentially up to the cap", "[reconnect]") {
+    ReconnectPolicy::Config config;
+    config.jitter = 0.0f;
+    ReconnectPolicy policy(config, 1);
+    REQUIRE(NextDelaysMs(&policy, 8) == std::vector<int64_t>{250, 500, 1000, 2000, 4000, 8000, 8000, 8000});
+    REQUIRE(policy.GetAttempts() == 8);
+
+    // A cap that is not a step of the growth is still hit exactly, and stays put for ever after.
+    config.initialDelay = std::chrono::milliseconds(100);
+    config.maxDelay = std::chrono::milliseconds(1000);
+    config.multiplier = 3.0f;
+    ReconnectPolicy tripling(config, 1);
+    REQUIRE(NextDelaysMs(&tripling, 5) == std::vector<int64_t>{100, 300, 900, 1000, 1000});
+    for (int i = 0; i < 1000; i++) {
+        tripling.NextDelay();
+    }
+    REQUIRE(tripling.NextDelay().count() == 1000);
+}
+
+TEST_CASE("ReconnectPolicy jitters within its bounds", "[reconnect]") {
+    const uint32_t seed = GENERATE(1u, 7u, 12345u);
+    ReconnectPolicy::Config config;
+    ReconnectPolicy policy(config, seed);
+
+    // Each attempt waits in [(1 - jitter) * d, d], and the draws use the whole range.
+    const std::vector<int64_t> nominal{250, 500, 1000, 2000, 4000, 8000};
+    std::vector<int64_t> lowest(nominal.size(), INT64_MAX);
+    std::vector<int64_t> highest(nominal.size(), 0);
+    for (int round = 0; round < 500; round++) {
+        policy.Reset();
+        for (size_t attempt = 0; attempt < nominal.size(); attempt++) {
+            const int64_t delay = policy.NextDelay().count();
+            REQUIRE(delay >= nominal[attempt] / 2);
+            REQUIRE(delay <= nominal[attempt]);
+            lowest[attempt] = std::min(lowest[attempt], delay);
+            highest[attempt] = std::max(highest[attempt], delay);
+        }
+    }
+    for (size_t attempt = 0; attempt < nominal.size(); attempt++) {
+        REQUIRE(lowest[attempt] < nominal[attempt] * 6 / 10);
+        REQUIRE(highest[attempt] > nominal[attempt] * 9 / 10);
+    }
+
+    // The same seed replays the same waits, another seed does not.
+    ReconnectPolicy replay(config, seed);
+    ReconnectPolicy again(config, seed);
+    ReconnectPolicy other(config, seed + 1);
+    const std::vector<int64_t> delays = NextDelaysMs(&replay, 6);
+    REQUIRE(NextDelaysMs(&again, 6) == delays);
+    REQUIRE(NextDelaysMs(&other, 6) != delays);
+}
+
+TEST_CASE("ReconnectPolicy clamps the jitter fraction", "[reconnect]") {
+    ReconnectPolicy::Config config;
+    config.jitter = 3.0f;
+    ReconnectPolicy full(config, 3);
+    for (int i = 0; i < 100; i++) {
+        full.Reset();
+        const int64_t delay = full.NextDelay().count();
+        REQUIRE(delay >= 0);
+        REQUIRE(delay <= 250);
+    }
+
+    config.jitter = -1.0f;
+    ReconnectPolicy none(config, 3);
+    REQUIRE(NextDelaysMs(&none, 3) == std::vector<int64_t>{250, 500, 1000});
+}
+
+TEST_CASE("ReconnectPolicy starts over after a successful connect", "[reconnect]") {
+    ReconnectPolicy::Config config;
+    config.jitter = 0.0f;
+    config.maxAttempts = 4;
+    ReconnectPolicy policy(config, 5);
+    REQUIRE_FALSE(policy.Exhausted());
+    NextDelaysMs(&policy, 4);
+    REQUIRE(policy.Exhausted());
+    REQUIRE(policy.GetAttempts() == 4);
+
+    // What the client does once the stream is up again.
+    policy.Reset();
+    REQUIRE_FALSE(policy.Exhausted());
+    REQUIRE(policy.GetAttempts() == 0);
+    REQUIRE(policy.NextDelay().count() == 250);
+
+    // 0 retries for ever.
+    config.maxAttempts = 0;
+    ReconnectPolicy forever(config, 5);
+    NextDelaysMs(&forever, 100);
+    REQUIRE_FALSE(forever.Exhausted());
+}
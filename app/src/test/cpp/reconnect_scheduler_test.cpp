@@ -0,0 +1,342 @@
+/*
+    reconnect state machine, and reconnect times against a stand-in server that drops the connection on command
+*/
+#include <algorithm>
+#include <arpa/inet.h>
+#include <cerrno>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <netinet/in.h>
+#include <sstream>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "reconnect_scheduler.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+// Counts the handler calls, start fails while startFails is set.
+struct FakeReceiver {
+    ReconnectScheduler::Handlers Handlers() {
+        ReconnectScheduler::Handlers handlers;
+        handlers.start = [this]() {
+            starts++;
+            return !startFails;
+        };
+        handlers.stop = [this]() { stops++; };
+        handlers.server = [this]() { return server; };
+        return handlers;
+    }
+
+    int starts{0};
+    int stops{0};
+    bool startFails{false};
+    std::string server{"192.168.0.2"};
+};
+
+ReconnectPolicy::Config ShortDelays() {
+    ReconnectPolicy::Config config;
+    config.initialDelay = std::chrono::milliseconds(4);
+    config.maxDelay = std::chrono::milliseconds(32);
+    config.jitter = 0.0f;
+    return config;
+}
+
+// Updates like the control thread until the pending attempt was made.
+void UpdateUntilAttempt(ReconnectScheduler* scheduler, const FakeReceiver& receiver) {
+    const int starts = receiver.starts;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (receiver.starts == starts && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(scheduler->GetPollInterval(std::chrono::milliseconds(100)));
+        scheduler->Update(ReconnectScheduler::Link::Pending);
+    }
+}
+
+// Accepts on a loopback port until told to go down, and closes every accepted connection when it drops them.
+class StandInServer {
+public:
+    StandInServer() : mListenFd(-1), mPort(0), mStop(false) {
+        Listen();
+        mThread = std::thread([this]() { AcceptLoop(); });
+    }
+
+    ~StandInServer() {
+        mStop = true;
+        mThread.join();
+        SetDown();
+    }
+
+    uint16_t GetPort() const { return mPort; }
+
+    // Connection attempts are refused and the open connections are closed.
+    void SetDown() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        for (int fd : mConnections) {
+            close(fd);
+        }
+        mConnections.clear();
+        if (mListenFd >= 0) {
+            close(mListenFd);
+            mListenFd = -1;
+        }
+    }
+
+    void SetUp() { Listen(); }
+
+private:
+    void Listen() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mListenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        const int reuse = 1;
+        setsockopt(mListenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(mPort);
+        bind(mListenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        listen(mListenFd, 4);
+        socklen_t length = sizeof(address);
+        getsockname(mListenFd, reinterpret_cast<sockaddr*>(&address), &length);
+        mPort = ntohs(address.sin_port);
+    }
+
+    void AcceptLoop() {
+        while (!mStop) {
+            {
+                std::lock_guard<std::mutex> lock(mMutex);
+                if (mListenFd >= 0) {
+                    const int fd = accept4(mListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                    if (fd >= 0) {
+                        mConnections.push_back(fd);
+                    }
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    std::mutex mMutex;
+    int mListenFd;
+    uint16_t mPort;
+    std::vector<int> mConnections;
+    std::atomic<bool> mStop;
+    std::thread mThread;
+};
+
+// The client side: the receiver is a TCP connection to the stand-in server, and the control thread runs the scheduler
+// every poll interval like the lifecycle worker does.
+class StandInClient {
+public:
+    explicit StandInClient(uint16_t port) : mPort(port), mFd(-1), mFailed(false), mStreaming(false), mOutageMs(0.0), mStop(false) {
+        ReconnectScheduler::Handlers handlers;
+        handlers.start = [this]() { return Start(); };
+        handlers.stop = [this]() { Stop(); };
+        handlers.server = []() { return std::string("127.0.0.1"); };
+        mScheduler.reset(new ReconnectScheduler(std::move(handlers), ReconnectPolicy::Config(), 32));
+        mThread = std::thread([this]() { ControlLoop(); });
+    }
+
+    ~StandInClient() {
+        mStop = true;
+        mThread.join();
+        Stop();
+    }
+
+    bool IsStreaming() const { return mStreaming; }
+
+    double GetOutageMs() const { return mOutageMs; }
+
+    uint32_t GetAttempts() const { return mAttempts; }
+
+private:
+    bool Start() {
+        mFd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(mPort);
+        // Like the receiver, a refused connection shows up as a failed attempt on the next poll.
+        mFailed = connect(mFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0;
+        return true;
+    }
+
+    void Stop() {
+        if (mFd >= 0) {
+            close(mFd);
+            mFd = -1;
+        }
+        mFailed = false;
+    }
+
+    ReconnectScheduler::Link GetLink() const {
+        if (mFd < 0) {
+            return ReconnectScheduler::Link::Pending;
+        }
+        if (mFailed) {
+            return ReconnectScheduler::Link::Lost;
+        }
+        char byte;
+        const ssize_t received = recv(mFd, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+            return ReconnectScheduler::Link::Lost;
+        }
+        return ReconnectScheduler::Link::Streaming;
+    }
+
+    void ControlLoop() {
+        // The first connect, what a resume does.
+        if (!Start()) {
+            mScheduler->ScheduleRetry();
+        }
+        while (!mStop) {
+            const ReconnectScheduler::Link link = GetLink();
+            mScheduler->Update(link);
+            mStreaming = link == ReconnectScheduler::Link::Streaming;
+            mOutageMs = mScheduler->GetLastOutageMs();
+            mAttempts = std::max(mAttempts.load(), mScheduler->GetAttempts());
+            std::this_thread::sleep_for(mScheduler->GetPollInterval(std::chrono::milliseconds(100)));
+        }
+    }
+
+    const uint16_t mPort;
+    int mFd;
+    bool mFailed;
+    std::unique_ptr<ReconnectScheduler> mScheduler;
+    std::atomic<bool> mStreaming;
+    std::atomic<double> mOutageMs;
+    std::atomic<uint32_t> mAttempts{0};
+    std::atomic<bool> mStop;
+    std::thread mThread;
+};
+
+bool WaitFor(const std::function<bool()>& condition, std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!condition()) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+}  // namespace
+
+TEST_CASE("ReconnectScheduler retries a lost session with backoff", "[reconnect]") {
+    FakeReceiver receiver;
+    ReconnectScheduler scheduler(receiver.Handlers(), ShortDelays(), 1);
+    REQUIRE(scheduler.GetPollInterval(std::chrono::milliseconds(100)) == std::chrono::milliseconds(100));
+
+    // Nothing to do while connecting or streaming.
+    scheduler.Update(ReconnectScheduler::Link::Pending);
+    scheduler.Update(ReconnectScheduler::Link::Streaming);
+    REQUIRE(receiver.starts == 0);
+    REQUIRE_FALSE(scheduler.IsRetryPending());
+
+    // The drop tears the receiver down and waits out the first delay before starting again.
+    scheduler.Update(ReconnectScheduler::Link::Lost);
+    REQUIRE(receiver.stops == 1);
+    REQUIRE(scheduler.IsRetryPending());
+    REQUIRE(scheduler.GetAttempts() == 1);
+    REQUIRE(scheduler.GetPollInterval(std::chrono::milliseconds(100)) <= std::chrono::milliseconds(4));
+    UpdateUntilAttempt(&scheduler, receiver);
+    REQUIRE(receiver.starts == 1);
+
+    // Each failed attempt waits longer.
+    scheduler.Update(ReconnectScheduler::Link::Lost);
+    REQUIRE(scheduler.GetAttempts() == 2);
+    const auto secondWait = scheduler.GetPollInterval(std::chrono::milliseconds(100));
+    REQUIRE(secondWait > std::chrono::milliseconds(4));
+    REQUIRE(secondWait <= std::chrono::milliseconds(8));
+    UpdateUntilAttempt(&scheduler, receiver);
+    REQUIRE(receiver.starts == 2);
+
+    // Streaming again resets the backoff and reports the outage.
+    REQUIRE(scheduler.GetLastOutageMs() == 0.0);
+    scheduler.Update(ReconnectScheduler::Link::Streaming);
+    REQUIRE(scheduler.GetAttempts() == 0);
+    REQUIRE(scheduler.GetLastOutageMs() >= 12.0);
+    scheduler.Update(ReconnectScheduler::Link::Lost);
+    REQUIRE(scheduler.GetAttempts() == 1);
+}
+
+TEST_CASE("ReconnectScheduler retries a start that failed at once", "[reconnect]") {
+    FakeReceiver receiver;
+    receiver.startFails = true;
+    ReconnectScheduler scheduler(receiver.Handlers(), ShortDelays(), 1);
+    scheduler.ScheduleRetry();
+    for (int attempt = 1; attempt <= 5; attempt++) {
+        UpdateUntilAttempt(&scheduler, receiver);
+        REQUIRE(receiver.starts == attempt);
+        // Rescheduled right away, the stop is only for a receiver that was lost.
+        REQUIRE(scheduler.IsRetryPending());
+    }
+    REQUIRE(receiver.stops == 0);
+    REQUIRE(scheduler.GetAttempts() == 6);
+
+    // New options start over at once.
+    receiver.startFails = false;
+    scheduler.Restart();
+    REQUIRE(receiver.stops == 1);
+    REQUIRE(receiver.starts == 6);
+    REQUIRE(scheduler.GetAttempts() == 0);
+    REQUIRE_FALSE(scheduler.IsRetryPending());
+}
+
+TEST_CASE("ReconnectScheduler gives up without a server or attempts left", "[reconnect]") {
+    FakeReceiver receiver;
+    receiver.server.clear();
+    ReconnectScheduler idle(receiver.Handlers(), ShortDelays(), 1);
+    idle.Update(ReconnectScheduler::Link::Lost);
+    REQUIRE(receiver.stops == 1);
+    REQUIRE_FALSE(idle.IsRetryPending());
+
+    receiver.server = "192.168.0.2";
+    ReconnectPolicy::Config config = ShortDelays();
+    config.maxAttempts = 2;
+    ReconnectScheduler limited(receiver.Handlers(), config, 1);
+    limited.Update(ReconnectScheduler::Link::Lost);
+    UpdateUntilAttempt(&limited, receiver);
+    limited.Update(ReconnectScheduler::Link::Lost);
+    UpdateUntilAttempt(&limited, receiver);
+    limited.Update(ReconnectScheduler::Link::Lost);
+    REQUIRE(receiver.starts == 2);
+    REQUIRE_FALSE(limited.IsRetryPending());
+
+    // A pause or resume forgets the attempts.
+    limited.Reset();
+    limited.ScheduleRetry();
+    REQUIRE(limited.IsRetryPending());
+}
+
+TEST_CASE("ReconnectScheduler reconnect time after the server drops the connection", "[reconnect]") {
+    StandInServer server;
+    StandInClient client(server.GetPort());
+    REQUIRE(WaitFor([&client]() { return client.IsStreaming(); }, std::chrono::seconds(2)));
+
+    // The server closes the connection and refuses new ones for this long, with the default backoff.
+    const std::vector<int> outagesMs{0, 300, 1000};
+    std::ostringstream report;
+    double previousOutageMs = 0.0;
+    for (int outageMs : outagesMs) {
+        server.SetDown();
+        std::this_thread::sleep_for(std::chrono::milliseconds(outageMs));
+        server.SetUp();
+        REQUIRE(WaitFor([&]() { return client.IsStreaming() && client.GetOutageMs() != previousOutageMs; }, std::chrono::seconds(10)));
+        const double reconnectMs = client.GetOutageMs();
+        previousOutageMs = reconnectMs;
+        report << outageMs << " ms down: streaming after " << reconnectMs << " ms; ";
+
+        // The loss is noticed within a control poll, and after the server is back the wait is at most one backoff
+        // delay, which after a second of refused attempts is 2 s nominal.
+        REQUIRE(reconnectMs >= outageMs - 100);
+        REQUIRE(reconnectMs <= outageMs + 2500);
+    }
+    WARN("reconnect time with the default backoff: " << report.str());
+    REQUIRE(client.GetAttempts() >= 2);
+}
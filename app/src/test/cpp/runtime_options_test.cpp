@@ -0,0 +1,185 @@
+/*
+    runtime options parsing, change classification and the file watcher that triggers reloads
+*/
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <unistd.h>
+#include "file_watcher.h"
+#include "runtime_options.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+RuntimeOptions Parse(const std::string& text, std::vector<std::string>* errors = nullptr, const RuntimeOptions& base = {}) {
+    std::vector<std::string> ignored;
+    return ParseRuntimeOptions(text, base, errors != nullptr ? errors : &ignored);
+}
+
+// Temporary directory removed with everything in it at the end of the test.
+struct TempDirectory {
+    std::string path;
+
+    TempDirectory() {
+        char pattern[] = "/tmp/runtime_options_test.XXXXXX";
+        REQUIRE(mkdtemp(pattern) != nullptr);
+        path = pattern;
+    }
+
+    ~TempDirectory() { REQUIRE(system(("rm -rf " + path).c_str()) == 0); }
+
+    void Write(const std::string& name, const std::string& text) const {
+        std::ofstream file(path + "/" + name, std::ios::trunc);
+        file << text;
+    }
+};
+
+}  // namespace
+
+TEST_CASE("Every key is parsed, case and whitespace insensitive", "[runtime_options]") {
+    std::vector<std::string> errors;
+    const RuntimeOptions options = Parse(
+        "# CloudXRRuntimeOptions.txt\n"
+        "server_ip = 192.168.1.10\n"
+        "  MAX_BITRATE_KBPS=50000  \n"
+        "foveation = 50 # trailing comment\n"
+        "half_rate = On\r\n"
+        "gaze_foveation = 70\n"
+        "log_level = warning\n"
+        "stats_interval_ms = 0\n"
+        "pred_offset_ms = -12.5\n"
+        "controller_pose = aim\n"
+        "input_rate_hz = 500\n",
+        &errors);
+
+    REQUIRE(errors.empty());
+    REQUIRE(options.serverIP == "192.168.1.10");
+    REQUIRE(options.maxVideoBitrateKbps == 50000);
+    REQUIRE(options.foveation == 50);
+    REQUIRE(options.halfRate);
+    REQUIRE(options.gazeFoveation == 70);
+    REQUIRE(options.logLevel == Log::Level::Warning);
+    REQUIRE(options.statsIntervalMs == 0);
+    REQUIRE(options.predOffsetMs == -12.5f);
+    REQUIRE(options.aimPose);
+    REQUIRE(options.inputRateHz == 500);
+}
+
+TEST_CASE("Bad lines are reported and keep the base value", "[runtime_options]") {
+    RuntimeOptions base;
+    base.serverIP = "10.0.0.1";
+    base.foveation = 30;
+    base.inputRateHz = 250;
+
+    std::vector<std::string> errors;
+    const RuntimeOptions options = Parse(
+        "foveation = 100\n"
+        "input_rate_hz = 50\n"
+        "max_bitrate_kbps = -5\n"
+        "server_ip = has space\n"
+        "pred_offset_ms = fast\n"
+        "no equals sign\n"
+        "unknown_key = 1\n"
+        "log_level = info\n",
+        &errors, base);
+
+    REQUIRE(errors.size() == 7);
+    REQUIRE(errors[0].find("line 1: foveation expects") == 0);
+    REQUIRE(errors[5] == "line 6: expected key = value");
+    REQUIRE(errors[6] == "line 7: unknown option 'unknown_key'");
+
+    // The good line after the bad ones still applies.
+    REQUIRE(options.logLevel == Log::Level::Info);
+    REQUIRE(options.serverIP == "10.0.0.1");
+    REQUIRE(options.foveation == 30);
+    REQUIRE(options.inputRateHz == 250);
+    REQUIRE(options.maxVideoBitrateKbps == 0);
+    REQUIRE(options.predOffsetMs == RuntimeOptions{}.predOffsetMs);
+}
+
+TEST_CASE("Range limits are inclusive and 0 is always allowed where it means off", "[runtime_options]") {
+    REQUIRE(Parse("max_bitrate_kbps = 1000").maxVideoBitrateKbps == 1000);
+    REQUIRE(Parse("max_bitrate_kbps = 200000").maxVideoBitrateKbps == 200000);
+    REQUIRE(Parse("max_bitrate_kbps = 999\nmax_bitrate_kbps = 200001").maxVideoBitrateKbps == 0);
+    REQUIRE(Parse("stats_interval_ms = 100").statsIntervalMs == 100);
+    REQUIRE(Parse("stats_interval_ms = 99").statsIntervalMs == RuntimeOptions{}.statsIntervalMs);
+    REQUIRE(Parse("input_rate_hz = 1000").inputRateHz == 1000);
+    REQUIRE(Parse("pred_offset_ms = 100").predOffsetMs == 100.0f);
+    REQUIRE(Parse("pred_offset_ms = 100.5").predOffsetMs == RuntimeOptions{}.predOffsetMs);
+    REQUIRE(Parse("foveation = 0").foveation == 0);
+    REQUIRE(Parse("foveation = 99").foveation == 99);
+}
+
+TEST_CASE("Changes are classified as live or reconnect per key", "[runtime_options]") {
+    const RuntimeOptions base = Parse("server_ip = 10.0.0.1");
+
+    struct Case {
+        const char* text;
+        const char* key;
+        bool reconnect;
+    };
+    const Case cases[] = {
+        {"server_ip = 10.0.0.2", "server_ip", true},
+        {"max_bitrate_kbps = 30000", "max_bitrate_kbps", true},
+        {"foveation = 40", "foveation", true},
+        {"half_rate = on", "half_rate", true},
+        {"gaze_foveation = 60", "gaze_foveation", true},
+        {"log_level = error", "log_level", false},
+        {"stats_interval_ms = 5000", "stats_interval_ms", false},
+        {"pred_offset_ms = 0", "pred_offset_ms", false},
+        {"controller_pose = aim", "controller_pose", false},
+        {"input_rate_hz = 120", "input_rate_hz", false},
+    };
+    for (const Case& c : cases) {
+        INFO(c.text);
+        const RuntimeOptionMask changed = DiffRuntimeOptions(base, Parse(c.text, nullptr, base));
+        REQUIRE(DescribeRuntimeOptions(changed) == c.key);
+        REQUIRE(RequiresReconnect(changed) == c.reconnect);
+    }
+
+    // Rewriting the same values changes nothing, one reconnect key among live ones reconnects.
+    REQUIRE(DiffRuntimeOptions(base, Parse("server_ip = 10.0.0.1", nullptr, base)) == 0);
+    const RuntimeOptionMask mixed = DiffRuntimeOptions(base, Parse("log_level = info\nfoveation = 10", nullptr, base));
+    REQUIRE(DescribeRuntimeOptions(mixed) == "foveation, log_level");
+    REQUIRE(RequiresReconnect(mixed));
+}
+
+TEST_CASE("The watcher reports rewrites and renames of watched files only", "[runtime_options]") {
+    TempDirectory directory;
+
+    std::mutex mutex;
+    std::condition_variable changedCondition;
+    std::vector<std::string> changed;
+    FileWatcher watcher(directory.path, {"CloudXRRuntimeOptions.txt"}, [&](const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        changed.push_back(name);
+        changedCondition.notify_all();
+    });
+    REQUIRE(watcher.Start());
+
+    auto waitForChanges = [&](size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        return changedCondition.wait_for(lock, std::chrono::seconds(5), [&]() { return changed.size() >= count; });
+    };
+
+    directory.Write("other.txt", "ignored");
+    directory.Write("CloudXRRuntimeOptions.txt", "foveation = 10\n");
+    REQUIRE(waitForChanges(1));
+
+    // adb push and most editors replace the file by renaming a temporary one over it.
+    directory.Write("CloudXRRuntimeOptions.txt.tmp", "foveation = 20\n");
+    REQUIRE(rename((directory.path + "/CloudXRRuntimeOptions.txt.tmp").c_str(),
+                   (directory.path + "/CloudXRRuntimeOptions.txt").c_str()) == 0);
+    REQUIRE(waitForChanges(2));
+
+    watcher.Stop();
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const std::string& name : changed) {
+        REQUIRE(name == "CloudXRRuntimeOptions.txt");
+    }
+}
@@ -0,0 +1,94 @@
+/*
+    StartupGraph ordering, failure handling and the graphs Add rejects
+*/
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "startup.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+using Affinity = StartupGraph::Affinity;
+using Priority = StartupGraph::Priority;
+
+TEST_CASE("Steps run after their dependencies and main thread steps on the caller", "[startup]") {
+    ThreadPool pool(3);
+    StartupGraph graph(pool);
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&](const char* name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(name);
+    };
+    auto indexOf = [&](const char* name) { return std::find(order.begin(), order.end(), name) - order.begin(); };
+
+    const std::thread::id caller = std::this_thread::get_id();
+    std::thread::id mainStepThread;
+    const auto a = graph.Add("a", Affinity::Pool, {}, [&]() { record("a"); });
+    const auto b = graph.Add("b", Affinity::Pool, {}, [&]() { record("b"); });
+    const auto c = graph.Add("c", Affinity::MainThread, {a, b}, [&]() {
+        mainStepThread = std::this_thread::get_id();
+        record("c");
+    });
+    graph.Add("d", Affinity::Pool, {c}, [&]() { record("d"); });
+    graph.Run();
+
+    REQUIRE(order.size() == 4);
+    REQUIRE(indexOf("c") > indexOf("a"));
+    REQUIRE(indexOf("c") > indexOf("b"));
+    REQUIRE(indexOf("d") > indexOf("c"));
+    REQUIRE(mainStepThread == caller);
+}
+
+TEST_CASE("A failed critical step stops its dependents and is rethrown", "[startup]") {
+    ThreadPool pool(2);
+    StartupGraph graph(pool);
+
+    std::atomic<bool> dependentRan{false};
+    const auto failing = graph.Add("failing", Affinity::Pool, {}, []() { throw std::runtime_error("no runtime"); });
+    graph.Add("dependent", Affinity::MainThread, {failing}, [&]() { dependentRan = true; });
+
+    REQUIRE_THROWS_WITH(graph.Run(), "no runtime");
+    REQUIRE_FALSE(dependentRan);
+}
+
+TEST_CASE("A failed deferred step only stops deferred dependents", "[startup]") {
+    ThreadPool pool(2);
+    StartupGraph graph(pool);
+
+    std::atomic<bool> deferredDependentRan{false};
+    std::atomic<bool> criticalRan{false};
+    const auto critical = graph.Add("critical", Affinity::MainThread, {}, [&]() { criticalRan = true; });
+    const auto diagnostics = graph.Add("diagnostics", Affinity::Pool, {critical}, []() { throw std::runtime_error("no data"); },
+                                       Priority::Deferred);
+    graph.Add("report", Affinity::Pool, {diagnostics}, [&]() { deferredDependentRan = true; }, Priority::Deferred);
+
+    REQUIRE_NOTHROW(graph.Run());
+    graph.Wait();
+    REQUIRE(criticalRan);
+    REQUIRE_FALSE(deferredDependentRan);
+}
+
+TEST_CASE("Add rejects graphs Run could not finish", "[startup]") {
+    ThreadPool pool(1);
+    StartupGraph graph(pool);
+
+    const auto critical = graph.Add("critical", Affinity::Pool, {}, []() {});
+    const auto deferred = graph.Add("deferred", Affinity::Pool, {critical}, []() {}, Priority::Deferred);
+
+    // Run stops serving the main thread once the critical steps are done.
+    REQUIRE_THROWS_AS(graph.Add("deferred main", Affinity::MainThread, {}, []() {}, Priority::Deferred), std::logic_error);
+    // A failed deferred step is only logged, a critical one behind it would never be scheduled.
+    REQUIRE_THROWS_AS(graph.Add("behind deferred", Affinity::Pool, {deferred}, []() {}), std::logic_error);
+    REQUIRE_THROWS_AS(graph.Add("forward", Affinity::Pool, {5}, []() {}), std::logic_error);
+
+    // Rejected steps leave no trace, the valid graph still runs to completion.
+    std::atomic<bool> lastRan{false};
+    graph.Add("last", Affinity::MainThread, {critical}, [&]() { lastRan = true; });
+    REQUIRE_NOTHROW(graph.Run());
+    REQUIRE(lastRan);
+}
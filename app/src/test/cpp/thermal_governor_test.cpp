@@ -0,0 +1,200 @@
+/*
+    thermal governor levels against scripted temperatures and the sysfs source against a fake thermal tree
+*/
+#include <cstdlib>
+#include <fstream>
+#include <sys/stat.h>
+#include "thermal_governor.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+// Stand-in for /sys/class/thermal, removed with everything in it at the end of the test.
+struct FakeThermalTree {
+    std::string root;
+
+    FakeThermalTree() {
+        char pattern[] = "/tmp/thermal_governor_test.XXXXXX";
+        REQUIRE(mkdtemp(pattern) != nullptr);
+        root = pattern;
+    }
+
+    ~FakeThermalTree() { REQUIRE(system(("rm -rf " + root).c_str()) == 0); }
+
+    void AddZone(int index, const std::string& type, const std::string& temp) const {
+        const std::string zone = root + "/thermal_zone" + std::to_string(index);
+        REQUIRE(mkdir(zone.c_str(), 0755) == 0);
+        std::ofstream(zone + "/type") << type << "\n";
+        SetTemp(index, temp);
+    }
+
+    void SetTemp(int index, const std::string& temp) const {
+        std::ofstream(root + "/thermal_zone" + std::to_string(index) + "/temp", std::ios::trunc) << temp << "\n";
+    }
+};
+
+// No smoothing, so every sample is the temperature the governor decides on.
+ThermalGovernor::Config Unsmoothed() {
+    ThermalGovernor::Config config;
+    config.smoothing = 1.0f;
+    return config;
+}
+
+// Feeds one sample per second and returns how many level changes it saw.
+int Run(ThermalGovernor& governor, float celsius, int seconds, PerfPressure pressure = PerfPressure::Normal) {
+    int changes = 0;
+    for (int i = 0; i < seconds; i++) {
+        changes += governor.Update(celsius, pressure, 1.0f) ? 1 : 0;
+    }
+    return changes;
+}
+
+}  // namespace
+
+TEST_CASE("SysfsThermalSource reports the hottest valid zone", "[thermal]") {
+    FakeThermalTree tree;
+    tree.AddZone(0, "cpu-0-0", "45000");
+    tree.AddZone(1, "gpuss-0", "52500");
+    // Disabled and unconnected sensors.
+    tree.AddZone(2, "battery", "0");
+    tree.AddZone(3, "pa-therm", "200000");
+    tree.AddZone(4, "skin", "garbage");
+
+    float celsius = 0;
+    SECTION("every zone without prefixes") {
+        SysfsThermalSource source(tree.root);
+        REQUIRE(source.ReadMaxCelsius(&celsius));
+        REQUIRE(celsius == 52.5f);
+    }
+    SECTION("only the zones matching a prefix") {
+        SysfsThermalSource source(tree.root, {"cpu"});
+        REQUIRE(source.ReadMaxCelsius(&celsius));
+        REQUIRE(celsius == 45.0f);
+    }
+    SECTION("every zone when no prefix matches") {
+        SysfsThermalSource source(tree.root, {"modem"});
+        REQUIRE(source.ReadMaxCelsius(&celsius));
+        REQUIRE(celsius == 52.5f);
+    }
+    SECTION("temperatures are read again, zones are not") {
+        SysfsThermalSource source(tree.root, {"cpu"});
+        REQUIRE(source.ReadMaxCelsius(&celsius));
+        tree.SetTemp(0, "61000");
+        tree.AddZone(5, "cpu-1-0", "90000");
+        REQUIRE(source.ReadMaxCelsius(&celsius));
+        REQUIRE(celsius == 61.0f);
+    }
+}
+
+TEST_CASE("SysfsThermalSource without readable zones", "[thermal]") {
+    FakeThermalTree tree;
+    float celsius = -1.0f;
+
+    SysfsThermalSource missing(tree.root + "/absent");
+    REQUIRE_FALSE(missing.ReadMaxCelsius(&celsius));
+
+    SysfsThermalSource empty(tree.root);
+    REQUIRE_FALSE(empty.ReadMaxCelsius(&celsius));
+
+    tree.AddZone(0, "battery", "0");
+    SysfsThermalSource disabled(tree.root);
+    REQUIRE_FALSE(disabled.ReadMaxCelsius(&celsius));
+    REQUIRE(celsius == -1.0f);
+}
+
+TEST_CASE("ThermalGovernor steps down after the hold and may skip levels", "[thermal]") {
+    ThermalGovernor governor(Unsmoothed());
+    REQUIRE(Run(governor, 50.0f, 10) == 0);
+    REQUIRE(governor.GetLevel() == 0);
+
+    // Just over the first threshold, the change comes with the third second.
+    REQUIRE(Run(governor, 70.0f, 2) == 0);
+    REQUIRE(governor.Update(70.0f, PerfPressure::Normal, 1.0f));
+    REQUIRE(governor.GetLevel() == 1);
+
+    // Over the last threshold goes straight to the last level.
+    REQUIRE(Run(governor, 85.0f, 3) == 1);
+    REQUIRE(governor.GetLevel() == 3);
+}
+
+TEST_CASE("ThermalGovernor ignores heat shorter than the hold", "[thermal]") {
+    SECTION("interrupted heat starts the hold over") {
+        ThermalGovernor governor(Unsmoothed());
+        Run(governor, 70.0f, 2);
+        Run(governor, 60.0f, 1);
+        REQUIRE(Run(governor, 70.0f, 2) == 0);
+        REQUIRE(governor.GetLevel() == 0);
+    }
+    SECTION("a one second spike is smoothed away") {
+        ThermalGovernor governor;
+        Run(governor, 50.0f, 10);
+        REQUIRE(Run(governor, 90.0f, 1) == 0);
+        REQUIRE(Run(governor, 50.0f, 10) == 0);
+        REQUIRE(governor.GetLevel() == 0);
+
+        // Sustained heat still gets through the smoothing.
+        Run(governor, 90.0f, 20);
+        REQUIRE(governor.GetLevel() == ThermalGovernor::LevelCount - 1);
+    }
+}
+
+TEST_CASE("ThermalGovernor steps up one level at a time below the hysteresis", "[thermal]") {
+    ThermalGovernor governor(Unsmoothed());
+    Run(governor, 85.0f, 3);
+    REQUIRE(governor.GetLevel() == 3);
+
+    // Below the 82 C threshold but within the 4 C margin, the level is kept.
+    REQUIRE(Run(governor, 80.0f, 120) == 0);
+    REQUIRE(governor.GetLevel() == 3);
+
+    // Out of the margin, the step up needs the long hold.
+    REQUIRE(Run(governor, 77.0f, 29) == 0);
+    REQUIRE(Run(governor, 77.0f, 1) == 1);
+    REQUIRE(governor.GetLevel() == 2);
+    REQUIRE(Run(governor, 77.0f, 120) == 0);
+
+    // Cool enough for level 0, but that takes a hold per level.
+    REQUIRE(Run(governor, 50.0f, 30) == 1);
+    REQUIRE(governor.GetLevel() == 1);
+    REQUIRE(Run(governor, 50.0f, 30) == 1);
+    REQUIRE(governor.GetLevel() == 0);
+}
+
+TEST_CASE("ThermalGovernor puts a floor under the level for runtime pressure", "[thermal]") {
+    ThermalGovernor governor(Unsmoothed());
+
+    // Pressure applies without a hold, however cool the device is.
+    REQUIRE(governor.Update(50.0f, PerfPressure::Warning, 0.1f));
+    REQUIRE(governor.GetLevel() == 1);
+    REQUIRE(governor.Update(50.0f, PerfPressure::Impaired, 0.1f));
+    REQUIRE(governor.GetLevel() == 2);
+
+    // The floor holds for as long as the pressure does.
+    REQUIRE(Run(governor, 50.0f, 120, PerfPressure::Warning) == 1);
+    REQUIRE(governor.GetLevel() == 1);
+
+    // Heat still steps down past the floor.
+    REQUIRE(Run(governor, 85.0f, 3, PerfPressure::Warning) == 1);
+    REQUIRE(governor.GetLevel() == 3);
+
+    // Once the pressure is gone the level comes back with the regular holds.
+    REQUIRE(Run(governor, 50.0f, 29) == 0);
+    REQUIRE(Run(governor, 50.0f, 1) == 1);
+    REQUIRE(governor.GetLevel() == 2);
+}
+
+TEST_CASE("ThermalGovernor quality drops with the level", "[thermal]") {
+    const uint32_t last = ThermalGovernor::LevelCount - 1;
+    REQUIRE(ThermalGovernor::GetQuality(0).resolutionFactor == 1.0f);
+    REQUIRE(ThermalGovernor::GetQuality(0).maxFoveation == 0);
+    REQUIRE(ThermalGovernor::GetQuality(0).maxRefreshRate == 0.0f);
+    for (uint32_t level = 1; level <= last; level++) {
+        REQUIRE(ThermalGovernor::GetQuality(level).resolutionFactor < ThermalGovernor::GetQuality(level - 1).resolutionFactor);
+        REQUIRE(ThermalGovernor::GetQuality(level).maxFoveation > 0);
+    }
+    REQUIRE(ThermalGovernor::GetQuality(last).maxRefreshRate > 0.0f);
+    // Out of range levels are clamped to the last one.
+    REQUIRE(ThermalGovernor::GetQuality(last + 5).resolutionFactor == ThermalGovernor::GetQuality(last).resolutionFactor);
+}
@@ -0,0 +1,60 @@
+/*
+    thread role policy parsing and per role application
+*/
+#include <string>
+#include <thread>
+#include <sys/prctl.h>
+#include "thread_policy.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+std::string CurrentThreadName() {
+    char name[16] = {};
+    prctl(PR_GET_NAME, (unsigned long)name, 0, 0, 0);
+    return name;
+}
+}  // namespace
+
+TEST_CASE("Policies parse masks, priorities and nice levels", "[thread_policy]") {
+    ThreadPolicy policy{};
+    REQUIRE(ThreadRoles::ParsePolicy("0xf0,2,-10", &policy));
+    REQUIRE(policy.coreMask == 0xf0);
+    REQUIRE(policy.fifoPriority == 2);
+    REQUIRE(policy.nice == -10);
+    REQUIRE(ThreadRoles::ParsePolicy("big,0,19", &policy));
+    REQUIRE(policy.coreMask == (uint32_t)ThreadPolicy::BigCores);
+
+    const ThreadPolicy before = policy;
+    for (const char* text : {"", "0xf0", "0xf0,2", "0xf0,100,0", "0xf0,2,-21", "0xf0,2,20", "zz,2,0", "0xf0,2,0,1"}) {
+        INFO(text);
+        REQUIRE_FALSE(ThreadRoles::ParsePolicy(text, &policy));
+        REQUIRE(policy.coreMask == before.coreMask);
+    }
+}
+
+TEST_CASE("ApplyOnce applies each role once per thread", "[thread_policy]") {
+    // Affinity and priority changes may be refused on the host, the thread name is always set.
+    std::thread thread([]() {
+        prctl(PR_SET_NAME, (unsigned long)"test", 0, 0, 0);
+        ThreadRoles::ApplyOnce(ThreadRole::Audio);
+        REQUIRE(CurrentThreadName() == "cxr-audio");
+
+        // The same thread calling back for another role gets that role too.
+        ThreadRoles::ApplyOnce(ThreadRole::Pose);
+        REQUIRE(CurrentThreadName() == "cxr-pose");
+
+        prctl(PR_SET_NAME, (unsigned long)"test", 0, 0, 0);
+        ThreadRoles::ApplyOnce(ThreadRole::Audio);
+        ThreadRoles::ApplyOnce(ThreadRole::Pose);
+        REQUIRE(CurrentThreadName() == "test");
+    });
+    thread.join();
+
+    // Threads that exit between reconnects are dropped from the diagnostics, logging must not trip over them.
+    for (int i = 0; i < 64; i++) {
+        std::thread([]() { ThreadRoles::ApplyOnce(ThreadRole::Audio); }).join();
+    }
+    ThreadRoles::LogDiagnostics();
+}
@@ -0,0 +1,174 @@
+/*
+    ThreadPool against a mutex-queue pool, prints task throughput and submit-to-start latency
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "thread_pool.h"
+
+namespace {
+
+// The baseline: one queue behind one mutex, every submit and every take goes through it.
+class MutexQueuePool {
+public:
+    explicit MutexQueuePool(uint32_t threadCount) {
+        for (uint32_t i = 0; i < threadCount; i++) {
+            mThreads.emplace_back([this]() { WorkerLoop(); });
+        }
+    }
+
+    ~MutexQueuePool() {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStopping = true;
+        }
+        mCondition.notify_all();
+        for (auto& thread : mThreads) {
+            thread.join();
+        }
+    }
+
+    void Submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTasks.push_back(std::move(task));
+        }
+        mCondition.notify_one();
+    }
+
+private:
+    void WorkerLoop() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mMutex);
+                mCondition.wait(lock, [this]() { return mStopping || !mTasks.empty(); });
+                if (mTasks.empty()) {
+                    return;
+                }
+                task = std::move(mTasks.front());
+                mTasks.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> mThreads;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    std::deque<std::function<void()>> mTasks;
+    bool mStopping{false};
+};
+
+int64_t NowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void WaitFor(const std::atomic<uint32_t>& counter, uint32_t target) {
+    while (counter.load() < target) {
+        std::this_thread::yield();
+    }
+}
+
+// A few hundred nanoseconds of work, about what a small startup or telemetry task does per item.
+void Work() {
+    volatile uint32_t x = 1;
+    for (int i = 0; i < 200; i++) {
+        x = x * 1664525u + 1013904223u;
+    }
+}
+
+// Tasks per second for tiny tasks all submitted from outside the pool.
+template <typename Pool>
+double ExternalTasksPerSecond(uint32_t threads) {
+    const uint32_t count = 200000;
+    std::atomic<uint32_t> done{0};
+    Pool pool(threads);
+    const int64_t start = NowNs();
+    for (uint32_t i = 0; i < count; i++) {
+        pool.Submit([&done]() {
+            Work();
+            done++;
+        });
+    }
+    WaitFor(done, count);
+    return count / ((NowNs() - start) / 1e9);
+}
+
+// Tasks per second when every task fans out into children from inside the pool, the startup graph pattern.
+template <typename Pool>
+double FanOutTasksPerSecond(uint32_t threads) {
+    const uint32_t roots = 2000;
+    const uint32_t children = 64;
+    std::atomic<uint32_t> done{0};
+    Pool pool(threads);
+    const int64_t start = NowNs();
+    for (uint32_t i = 0; i < roots; i++) {
+        pool.Submit([&pool, &done]() {
+            for (uint32_t j = 0; j < children; j++) {
+                pool.Submit([&done]() {
+                    Work();
+                    done++;
+                });
+            }
+            done++;
+        });
+    }
+    WaitFor(done, roots * (children + 1));
+    return roots * (children + 1) / ((NowNs() - start) / 1e9);
+}
+
+// Submit-to-start latency of tasks arriving in small bursts, as percentiles in microseconds.
+template <typename Pool>
+void StartLatencyUs(uint32_t threads, double* p50, double* p99, double* max) {
+    const uint32_t bursts = 2000;
+    const uint32_t burstSize = 16;
+    std::vector<int64_t> latencies(bursts * burstSize);
+    std::atomic<uint32_t> done{0};
+    Pool pool(threads);
+    for (uint32_t b = 0; b < bursts; b++) {
+        for (uint32_t i = 0; i < burstSize; i++) {
+            int64_t* latency = &latencies[b * burstSize + i];
+            const int64_t submitted = NowNs();
+            pool.Submit([latency, submitted, &done]() {
+                *latency = NowNs() - submitted;
+                Work();
+                done++;
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    WaitFor(done, bursts * burstSize);
+    std::sort(latencies.begin(), latencies.end());
+    *p50 = latencies[latencies.size() / 2] / 1e3;
+    *p99 = latencies[latencies.size() * 99 / 100] / 1e3;
+    *max = latencies.back() / 1e3;
+}
+
+template <typename Pool>
+void Run(const char* name, uint32_t threads) {
+    double p50, p99, max;
+    StartLatencyUs<Pool>(threads, &p50, &p99, &max);
+    printf("%-14s %12.0f %12.0f %10.1f %10.1f %10.1f\n", name, ExternalTasksPerSecond<Pool>(threads), FanOutTasksPerSecond<Pool>(threads),
+           p50, p99, max);
+}
+
+}  // namespace
+
+int main() {
+    const uint32_t threads = std::max(2u, std::thread::hardware_concurrency());
+    printf("%u worker threads, tasks per second and submit-to-start latency in microseconds\n", threads);
+    printf("%-14s %12s %12s %10s %10s %10s\n", "pool", "external/s", "fan-out/s", "p50 us", "p99 us", "max us");
+    for (int round = 0; round < 2; round++) {
+        Run<MutexQueuePool>("mutex queue", threads);
+        Run<ThreadPool>("work stealing", threads);
+    }
+    return 0;
+}
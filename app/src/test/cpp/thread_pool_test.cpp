@@ -0,0 +1,242 @@
+/*
+    work-stealing deque races and the thread pool's task, parallel-for and shutdown guarantees
+*/
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "thread_pool.h"
+#include "work_stealing_deque.h"
+// check.h and Catch2 both define CHECK, the tests only use REQUIRE.
+#undef CHECK
+#include <catch2/catch.hpp>
+
+namespace {
+
+// Items handed through a deque, each records how often it was taken.
+struct Item {
+    std::atomic<uint32_t> taken{0};
+};
+
+uint32_t CountTakenOnce(const std::vector<Item>& items) {
+    uint32_t once = 0;
+    for (const Item& item : items) {
+        once += item.taken == 1 ? 1 : 0;
+    }
+    return once;
+}
+
+}  // namespace
+
+TEST_CASE("WorkStealingDeque pops newest and steals oldest", "[thread_pool]") {
+    // Starts small so the pushes grow the ring twice.
+    WorkStealingDeque<Item> deque(4);
+    std::vector<Item> items(20);
+    REQUIRE(deque.Empty());
+    REQUIRE(deque.Pop() == nullptr);
+    REQUIRE(deque.Steal() == nullptr);
+
+    for (Item& item : items) {
+        deque.Push(&item);
+    }
+    REQUIRE_FALSE(deque.Empty());
+    REQUIRE(deque.Steal() == &items[0]);
+    REQUIRE(deque.Steal() == &items[1]);
+    REQUIRE(deque.Pop() == &items[19]);
+    REQUIRE(deque.Pop() == &items[18]);
+
+    // Interleaved from both ends until it is empty, nothing twice and nothing left out.
+    std::vector<Item*> rest;
+    for (int i = 0; i < 16; i++) {
+        rest.push_back(i % 2 == 0 ? deque.Pop() : deque.Steal());
+    }
+    REQUIRE(deque.Empty());
+    REQUIRE(deque.Pop() == nullptr);
+    REQUIRE(deque.Steal() == nullptr);
+    for (int i = 2; i < 18; i++) {
+        REQUIRE(std::count(rest.begin(), rest.end(), &items[i]) == 1);
+    }
+}
+
+TEST_CASE("WorkStealingDeque hands every item out once under concurrent steals", "[thread_pool]") {
+    constexpr size_t ItemCount = 200000;
+    constexpr int ThiefCount = 3;
+    std::vector<Item> items(ItemCount);
+    WorkStealingDeque<Item> deque(16);
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> thieves;
+    for (int t = 0; t < ThiefCount; t++) {
+        thieves.emplace_back([&]() {
+            while (!done) {
+                if (Item* item = deque.Steal()) {
+                    item->taken++;
+                }
+            }
+        });
+    }
+
+    // The owner pushes in bursts and pops some of its own work back, growing the ring on the way.
+    size_t pushed = 0;
+    while (pushed < ItemCount) {
+        for (int i = 0; i < 64 && pushed < ItemCount; i++) {
+            deque.Push(&items[pushed++]);
+        }
+        for (int i = 0; i < 16; i++) {
+            if (Item* item = deque.Pop()) {
+                item->taken++;
+            }
+        }
+    }
+    while (Item* item = deque.Pop()) {
+        item->taken++;
+    }
+    done = true;
+    for (std::thread& thief : thieves) {
+        thief.join();
+    }
+
+    REQUIRE(deque.Empty());
+    REQUIRE(CountTakenOnce(items) == ItemCount);
+}
+
+TEST_CASE("WorkStealingDeque gives the last item to exactly one of owner and thief", "[thread_pool]") {
+    // Every round pushes one item and pops it while a thief tries to steal it, the top == bottom race in Pop. Some
+    // rounds yield in between so the thief also wins on a single core.
+    constexpr size_t Rounds = 100000;
+    std::vector<Item> items(Rounds);
+    WorkStealingDeque<Item> deque;
+    std::atomic<bool> done{false};
+    std::atomic<uint32_t> stolen{0};
+
+    std::thread thief([&]() {
+        while (!done) {
+            if (Item* item = deque.Steal()) {
+                item->taken++;
+                stolen++;
+            }
+        }
+    });
+
+    uint32_t popped = 0;
+    for (size_t i = 0; i < Rounds; i++) {
+        deque.Push(&items[i]);
+        if (i % 16 == 0) {
+            std::this_thread::yield();
+        }
+        if (Item* item = deque.Pop()) {
+            item->taken++;
+            popped++;
+        }
+    }
+    done = true;
+    thief.join();
+
+    WARN("single item race: owner " << popped << ", thief " << stolen.load());
+    REQUIRE(stolen > 0);
+    REQUIRE(popped + stolen == Rounds);
+    REQUIRE(CountTakenOnce(items) == Rounds);
+}
+
+TEST_CASE("ThreadPool runs tasks from outside and from its own workers", "[thread_pool]") {
+    std::atomic<uint32_t> ran{0};
+    {
+        ThreadPool pool(3);
+        REQUIRE(pool.GetThreadCount() == 3);
+        for (int i = 0; i < 1000; i++) {
+            // Each outside task fans out into tasks on the worker's own deque, which idle workers steal.
+            pool.Submit([&pool, &ran]() {
+                ran++;
+                for (int j = 0; j < 4; j++) {
+                    pool.Submit([&ran]() { ran++; });
+                }
+            });
+        }
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (ran < 5000 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        REQUIRE(ran == 5000);
+    }
+    REQUIRE(ran == 5000);
+}
+
+TEST_CASE("ThreadPool keeps its workers when a task throws", "[thread_pool]") {
+    std::atomic<uint32_t> ran{0};
+    {
+        ThreadPool pool(1);
+        pool.Submit([]() { throw std::runtime_error("task failed"); });
+        pool.Submit([]() { throw 42; });
+        pool.Submit([&ran]() { ran++; });
+    }
+    REQUIRE(ran == 1);
+}
+
+TEST_CASE("ThreadPool runs queued work before shutting down", "[thread_pool]") {
+    constexpr uint32_t TaskCount = 2000;
+    std::atomic<uint32_t> ran{0};
+    std::atomic<uint32_t> children{0};
+    {
+        ThreadPool pool(2);
+        for (uint32_t i = 0; i < TaskCount; i++) {
+            pool.Submit([&pool, &ran, &children]() {
+                ran++;
+                // Submitted while the destructor may already be waiting, still run.
+                pool.Submit([&children]() { children++; });
+            });
+        }
+        // Destroyed with most of the work still queued.
+    }
+    REQUIRE(ran == TaskCount);
+    REQUIRE(children == TaskCount);
+}
+
+TEST_CASE("ParallelFor covers every index exactly once", "[thread_pool]") {
+    ThreadPool pool(3);
+    const size_t count = GENERATE(as<size_t>(), 0, 1, 7, 13, 1000, 10007);
+    const size_t grain = GENERATE(as<size_t>(), 0, 1, 13, 64, 20000);
+    INFO("count " << count << ", grain " << grain);
+
+    std::unique_ptr<std::atomic<uint32_t>[]> hits(new std::atomic<uint32_t>[count + 1]);
+    for (size_t i = 0; i < count; i++) {
+        hits[i] = 0;
+    }
+    std::atomic<bool> badChunk{false};
+    pool.ParallelFor(count, grain, [&](size_t begin, size_t end) {
+        if (end - begin > std::max<size_t>(grain, 1) || begin >= end || end > count) {
+            badChunk = true;
+        }
+        for (size_t i = begin; i < end && i < count; i++) {
+            hits[i]++;
+        }
+    });
+
+    REQUIRE_FALSE(badChunk);
+    size_t once = 0;
+    for (size_t i = 0; i < count; i++) {
+        once += hits[i] == 1 ? 1 : 0;
+    }
+    REQUIRE(once == count);
+}
+
+TEST_CASE("ParallelFor can be nested in pool tasks", "[thread_pool]") {
+    ThreadPool pool(2);
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint32_t> outerDone{0};
+    // More outer loops than workers, each worker blocks in an inner loop that only completes by running chunks itself.
+    pool.ParallelFor(8, 1, [&](size_t begin, size_t end) {
+        pool.ParallelFor(1000, 10, [&](size_t innerBegin, size_t innerEnd) {
+            uint64_t local = 0;
+            for (size_t i = innerBegin; i < innerEnd; i++) {
+                local += i;
+            }
+            sum += local;
+        });
+        outerDone++;
+    });
+    REQUIRE(outerDone == 8);
+    REQUIRE(sum == 8 * (999 * 1000 / 2));
+}
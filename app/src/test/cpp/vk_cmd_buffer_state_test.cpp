@@ -0,0 +1,102 @@
+/*
+    CmdBuffer state transitions of the vulkan graphics plugin
+*/
+#include <catch2/catch.hpp>
+#include <vector>
+#include "vk_cmd_buffer_state.h"
+
+namespace {
+
+const std::vector<CmdBufferState> AllStates{CmdBufferState::Undefined, CmdBufferState::Initialized, CmdBufferState::Recording,
+                                            CmdBufferState::Executable, CmdBufferState::Executing};
+
+const std::vector<CmdBufferEvent> AllEvents{CmdBufferEvent::Init,   CmdBufferEvent::Begin, CmdBufferEvent::End,
+                                            CmdBufferEvent::Submit, CmdBufferEvent::Wait,  CmdBufferEvent::Reset};
+
+// Applies the event like CmdBuffer does and fails the test if it is rejected.
+CmdBufferState Apply(CmdBufferState state, CmdBufferEvent event) {
+    const CmdBufferTransition transition = NextCmdBufferState(state, event);
+    INFO(CmdBufferEventName(event) << " in " << CmdBufferStateName(state));
+    REQUIRE(transition.valid);
+    return transition.next;
+}
+
+}  // namespace
+
+TEST_CASE("A command buffer cycles through record, submit and wait", "[vk_cmd_buffer_state]") {
+    CmdBufferState state = Apply(CmdBufferState::Undefined, CmdBufferEvent::Init);
+    REQUIRE(state == CmdBufferState::Initialized);
+
+    // RenderView waits on the slot and resets it before every recording.
+    for (int frame = 0; frame < 3; frame++) {
+        state = Apply(state, CmdBufferEvent::Wait);
+        state = Apply(state, CmdBufferEvent::Reset);
+        REQUIRE(state == CmdBufferState::Initialized);
+        state = Apply(state, CmdBufferEvent::Begin);
+        REQUIRE(state == CmdBufferState::Recording);
+        state = Apply(state, CmdBufferEvent::End);
+        REQUIRE(state == CmdBufferState::Executable);
+        state = Apply(state, CmdBufferEvent::Submit);
+        REQUIRE(state == CmdBufferState::Executing);
+    }
+
+    state = Apply(state, CmdBufferEvent::Wait);
+    REQUIRE(state == CmdBufferState::Executable);
+}
+
+TEST_CASE("Waiting or resetting an idle command buffer does no work", "[vk_cmd_buffer_state]") {
+    for (CmdBufferState state : {CmdBufferState::Initialized, CmdBufferState::Executable}) {
+        const CmdBufferTransition wait = NextCmdBufferState(state, CmdBufferEvent::Wait);
+        REQUIRE(wait.valid);
+        REQUIRE_FALSE(wait.needsWork);
+        REQUIRE(wait.next == state);
+    }
+
+    const CmdBufferTransition reset = NextCmdBufferState(CmdBufferState::Initialized, CmdBufferEvent::Reset);
+    REQUIRE(reset.valid);
+    REQUIRE_FALSE(reset.needsWork);
+    REQUIRE(reset.next == CmdBufferState::Initialized);
+
+    // Only the fence of a submitted buffer has to be waited on and reset.
+    REQUIRE(NextCmdBufferState(CmdBufferState::Executing, CmdBufferEvent::Wait).needsWork);
+    REQUIRE(NextCmdBufferState(CmdBufferState::Executable, CmdBufferEvent::Reset).needsWork);
+}
+
+TEST_CASE("Out of order events are rejected and keep the state", "[vk_cmd_buffer_state]") {
+    // The allowed (state, event) pairs, everything else must be rejected.
+    auto allowed = [](CmdBufferState state, CmdBufferEvent event) {
+        switch (event) {
+            case CmdBufferEvent::Init:
+                return state == CmdBufferState::Undefined;
+            case CmdBufferEvent::Begin:
+                return state == CmdBufferState::Initialized;
+            case CmdBufferEvent::End:
+                return state == CmdBufferState::Recording;
+            case CmdBufferEvent::Submit:
+                return state == CmdBufferState::Executable;
+            case CmdBufferEvent::Wait:
+                return state == CmdBufferState::Initialized || state == CmdBufferState::Executable ||
+                       state == CmdBufferState::Executing;
+            case CmdBufferEvent::Reset:
+                return state == CmdBufferState::Initialized || state == CmdBufferState::Executable;
+        }
+        return false;
+    };
+
+    for (CmdBufferState state : AllStates) {
+        for (CmdBufferEvent event : AllEvents) {
+            INFO(CmdBufferEventName(event) << " in " << CmdBufferStateName(state));
+            const CmdBufferTransition transition = NextCmdBufferState(state, event);
+            REQUIRE(transition.valid == allowed(state, event));
+            if (!transition.valid) {
+                REQUIRE_FALSE(transition.needsWork);
+                REQUIRE(transition.next == state);
+            }
+        }
+    }
+
+    // A submitted buffer can neither be recorded into nor reset before its fence was waited on.
+    REQUIRE_FALSE(NextCmdBufferState(CmdBufferState::Executing, CmdBufferEvent::Begin).valid);
+    REQUIRE_FALSE(NextCmdBufferState(CmdBufferState::Executing, CmdBufferEvent::Reset).valid);
+    REQUIRE_FALSE(NextCmdBufferState(CmdBufferState::Recording, CmdBufferEvent::Submit).valid);
+}
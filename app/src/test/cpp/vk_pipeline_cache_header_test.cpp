@@ -0,0 +1,100 @@
+/*
+    header check of saved pipeline cache blobs: truncated files, foreign headers and other devices
+*/
+#include <catch2/catch.hpp>
+#include <vector>
+#include "vk_pipeline_cache_header.h"
+
+namespace {
+
+PipelineCacheDevice Device(uint32_t vendorID, uint32_t deviceID, uint8_t uuidByte) {
+    PipelineCacheDevice device{vendorID, deviceID, {}};
+    memset(device.pipelineCacheUUID, uuidByte, PipelineCacheUuidSize);
+    return device;
+}
+
+// What vkGetPipelineCacheData returns: the version one header followed by the driver's own data.
+std::vector<uint8_t> Blob(const PipelineCacheDevice& device, size_t payloadSize) {
+    const uint32_t header[4] = {(uint32_t)PipelineCacheHeaderSize, PipelineCacheHeaderVersionOne, device.vendorID, device.deviceID};
+    std::vector<uint8_t> blob(PipelineCacheHeaderSize + payloadSize, 0xAB);
+    memcpy(blob.data(), header, sizeof(header));
+    memcpy(blob.data() + sizeof(header), device.pipelineCacheUUID, PipelineCacheUuidSize);
+    return blob;
+}
+
+void SetHeaderField(std::vector<uint8_t>* blob, size_t index, uint32_t value) {
+    memcpy(blob->data() + index * sizeof(uint32_t), &value, sizeof(value));
+}
+
+PipelineCacheCheck Check(const std::vector<uint8_t>& blob, const PipelineCacheDevice& device) {
+    return CheckPipelineCacheHeader(blob.data(), blob.size(), device);
+}
+
+}  // namespace
+
+TEST_CASE("A blob saved on the same device is used", "[pipeline_cache]") {
+    const PipelineCacheDevice device = Device(0x5143, 0x6030001, 0x42);
+    REQUIRE(Check(Blob(device, 4096), device) == PipelineCacheCheck::Valid);
+    // A driver may save the header alone.
+    REQUIRE(Check(Blob(device, 0), device) == PipelineCacheCheck::Valid);
+
+    // The blob is read into a byte vector, the check must not assume the fields are aligned.
+    const std::vector<uint8_t> blob = Blob(device, 64);
+    std::vector<uint8_t> shifted(blob.size() + 1);
+    memcpy(shifted.data() + 1, blob.data(), blob.size());
+    REQUIRE(CheckPipelineCacheHeader(shifted.data() + 1, blob.size(), device) == PipelineCacheCheck::Valid);
+}
+
+TEST_CASE("Truncated blobs are rejected", "[pipeline_cache]") {
+    const PipelineCacheDevice device = Device(0x5143, 0x6030001, 0x42);
+    const std::vector<uint8_t> blob = Blob(device, 256);
+
+    // Every cut inside the header.
+    for (size_t size = 0; size < PipelineCacheHeaderSize; size++) {
+        INFO("size " << size);
+        REQUIRE(CheckPipelineCacheHeader(blob.data(), size, device) == PipelineCacheCheck::Truncated);
+    }
+    REQUIRE(CheckPipelineCacheHeader(nullptr, 0, device) == PipelineCacheCheck::Truncated);
+
+    // A header that claims more than the file holds.
+    std::vector<uint8_t> longHeader = Blob(device, 8);
+    SetHeaderField(&longHeader, 0, (uint32_t)longHeader.size() + 1);
+    REQUIRE(Check(longHeader, device) == PipelineCacheCheck::Truncated);
+
+    // Cuts in the driver data after a complete header are left to the driver, its own data carries the sizes.
+    REQUIRE(CheckPipelineCacheHeader(blob.data(), PipelineCacheHeaderSize + 1, device) == PipelineCacheCheck::Valid);
+}
+
+TEST_CASE("Blobs with a foreign header are rejected", "[pipeline_cache]") {
+    const PipelineCacheDevice device = Device(0x5143, 0x6030001, 0x42);
+
+    std::vector<uint8_t> shortHeader = Blob(device, 64);
+    SetHeaderField(&shortHeader, 0, (uint32_t)PipelineCacheHeaderSize - 1);
+    REQUIRE(Check(shortHeader, device) == PipelineCacheCheck::BadHeader);
+
+    std::vector<uint8_t> otherVersion = Blob(device, 64);
+    SetHeaderField(&otherVersion, 1, 2);
+    REQUIRE(Check(otherVersion, device) == PipelineCacheCheck::BadHeader);
+
+    // Not a pipeline cache at all.
+    const std::vector<uint8_t> garbage(256, 0xFF);
+    REQUIRE(Check(garbage, device) == PipelineCacheCheck::BadHeader);
+    const std::vector<uint8_t> zeros(256, 0);
+    REQUIRE(Check(zeros, device) == PipelineCacheCheck::BadHeader);
+}
+
+TEST_CASE("Blobs from another device or driver are rejected", "[pipeline_cache]") {
+    const PipelineCacheDevice device = Device(0x5143, 0x6030001, 0x42);
+    const std::vector<uint8_t> blob = Blob(device, 256);
+
+    REQUIRE(Check(blob, Device(0x13B5, 0x6030001, 0x42)) == PipelineCacheCheck::OtherDevice);
+    REQUIRE(Check(blob, Device(0x5143, 0x6040001, 0x42)) == PipelineCacheCheck::OtherDevice);
+
+    // A driver update changes the UUID alone, one differing byte anywhere in it is enough.
+    for (size_t byte = 0; byte < PipelineCacheUuidSize; byte++) {
+        PipelineCacheDevice updated = device;
+        updated.pipelineCacheUUID[byte] ^= 1;
+        INFO("uuid byte " << byte);
+        REQUIRE(Check(blob, updated) == PipelineCacheCheck::OtherDevice);
+    }
+}
@@ -0,0 +1,488 @@
+/*
+    one draw per cube against one instanced draw of all cubes, command recording and GPU time per view
+*/
+#include "pch.h"
+#include "geometry.h"
+#include <common/xr_linear.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The plugin's own shaders: viewProj as a push constant and the model matrix as an instance attribute.
+constexpr uint32_t VertexShaderSpv[] =
+#include "vulkan_shaders/vert.spv"
+    ;
+constexpr uint32_t FragmentShaderSpv[] =
+#include "vulkan_shaders/frag.spv"
+    ;
+
+// About one eye of the headset.
+constexpr uint32_t Width = 1600;
+constexpr uint32_t Height = 1600;
+constexpr VkFormat ColorFormat = VK_FORMAT_R8G8B8A8_UNORM;
+constexpr VkFormat DepthFormat = VK_FORMAT_D32_SFLOAT;
+constexpr uint32_t MaxObjects = 1000;
+
+void CheckVk(VkResult result, const char* what) {
+    if (result != VK_SUCCESS) {
+        throw std::runtime_error(std::string(what) + " failed: " + std::to_string(result));
+    }
+}
+
+#define CHECK_VK(cmd) CheckVk(cmd, #cmd)
+
+struct Buffer {
+    VkBuffer buffer{VK_NULL_HANDLE};
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    void* mapped{nullptr};
+};
+
+struct Image {
+    VkImage image{VK_NULL_HANDLE};
+    VkDeviceMemory memory{VK_NULL_HANDLE};
+    VkImageView view{VK_NULL_HANDLE};
+};
+
+struct Timing {
+    double recordUs;
+    double gpuUs;
+};
+
+// A headless device that renders the cube scene into an offscreen target, the same pipeline state as the plugin.
+class DrawBench {
+public:
+    DrawBench() {
+        CreateDevice();
+        CreateTarget();
+        CreatePipeline();
+        CreateBuffers();
+        CreateCommands();
+    }
+
+    ~DrawBench() {
+        vkDeviceWaitIdle(m_device);
+        vkDestroyQueryPool(m_device, m_queries, nullptr);
+        vkDestroyFence(m_device, m_fence, nullptr);
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        for (Buffer* buffer : {&m_vertices, &m_indices, &m_instances}) {
+            vkDestroyBuffer(m_device, buffer->buffer, nullptr);
+            vkFreeMemory(m_device, buffer->memory, nullptr);
+        }
+        vkDestroyPipeline(m_device, m_pipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        vkDestroyFramebuffer(m_device, m_framebuffer, nullptr);
+        vkDestroyRenderPass(m_device, m_renderPass, nullptr);
+        for (Image* image : {&m_color, &m_depth}) {
+            vkDestroyImageView(m_device, image->view, nullptr);
+            vkDestroyImage(m_device, image->image, nullptr);
+            vkFreeMemory(m_device, image->memory, nullptr);
+        }
+        vkDestroyDevice(m_device, nullptr);
+        vkDestroyInstance(m_instance, nullptr);
+    }
+
+    const char* GetDeviceName() const { return m_properties.deviceName; }
+
+    // Median recording time and GPU time of one view with objectCount cubes.
+    Timing Measure(uint32_t objectCount, bool instanced, uint32_t iterations) {
+        std::vector<double> recordUs;
+        std::vector<double> gpuUs;
+        for (uint32_t i = 0; i < iterations + 10; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            Record(objectCount, instanced, (float)i * 0.01f);
+            const auto recorded = std::chrono::steady_clock::now();
+
+            VkSubmitInfo submitInfo{VK_STRUCTURE_TYPE_SUBMIT_INFO};
+            submitInfo.commandBufferCount = 1;
+            submitInfo.pCommandBuffers = &m_commandBuffer;
+            CHECK_VK(vkQueueSubmit(m_queue, 1, &submitInfo, m_fence));
+            CHECK_VK(vkWaitForFences(m_device, 1, &m_fence, VK_TRUE, UINT64_MAX));
+            CHECK_VK(vkResetFences(m_device, 1, &m_fence));
+
+            uint64_t timestamps[2] = {};
+            CHECK_VK(vkGetQueryPoolResults(m_device, m_queries, 0, 2, sizeof(timestamps), timestamps, sizeof(uint64_t),
+                                           VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+            // The first iterations warm up the driver and the caches.
+            if (i >= 10) {
+                recordUs.push_back(std::chrono::duration<double, std::micro>(recorded - start).count());
+                gpuUs.push_back((double)(timestamps[1] - timestamps[0]) * m_properties.limits.timestampPeriod / 1000.0);
+            }
+        }
+        std::sort(recordUs.begin(), recordUs.end());
+        std::sort(gpuUs.begin(), gpuUs.end());
+        return {recordUs[recordUs.size() / 2], gpuUs[gpuUs.size() / 2]};
+    }
+
+private:
+    void CreateDevice() {
+        VkApplicationInfo appInfo{VK_STRUCTURE_TYPE_APPLICATION_INFO};
+        appInfo.pApplicationName = "vulkan_draw_bench";
+        appInfo.apiVersion = VK_API_VERSION_1_0;
+        VkInstanceCreateInfo instanceInfo{VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO};
+        instanceInfo.pApplicationInfo = &appInfo;
+        CHECK_VK(vkCreateInstance(&instanceInfo, nullptr, &m_instance));
+
+        uint32_t deviceCount = 0;
+        CHECK_VK(vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr));
+        if (deviceCount == 0) {
+            throw std::runtime_error("no Vulkan device");
+        }
+        std::vector<VkPhysicalDevice> devices(deviceCount);
+        CHECK_VK(vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data()));
+        m_physicalDevice = devices[0];
+        vkGetPhysicalDeviceProperties(m_physicalDevice, &m_properties);
+        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+
+        uint32_t familyCount = 0;
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &familyCount, nullptr);
+        std::vector<VkQueueFamilyProperties> families(familyCount);
+        vkGetPhysicalDeviceQueueFamilyProperties(m_physicalDevice, &familyCount, families.data());
+        m_queueFamily = UINT32_MAX;
+        for (uint32_t i = 0; i < familyCount; i++) {
+            if ((families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0 && families[i].timestampValidBits != 0) {
+                m_queueFamily = i;
+                break;
+            }
+        }
+        if (m_queueFamily == UINT32_MAX) {
+            throw std::runtime_error("no graphics queue with timestamps");
+        }
+
+        const float priority = 1.0f;
+        VkDeviceQueueCreateInfo queueInfo{VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO};
+        queueInfo.queueFamilyIndex = m_queueFamily;
+        queueInfo.queueCount = 1;
+        queueInfo.pQueuePriorities = &priority;
+        VkDeviceCreateInfo deviceInfo{VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO};
+        deviceInfo.queueCreateInfoCount = 1;
+        deviceInfo.pQueueCreateInfos = &queueInfo;
+        CHECK_VK(vkCreateDevice(m_physicalDevice, &deviceInfo, nullptr, &m_device));
+        vkGetDeviceQueue(m_device, m_queueFamily, 0, &m_queue);
+    }
+
+    uint32_t FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags flags) const {
+        for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++) {
+            if ((typeBits & (1u << i)) != 0 && (m_memoryProperties.memoryTypes[i].propertyFlags & flags) == flags) {
+                return i;
+            }
+        }
+        throw std::runtime_error("no suitable memory type");
+    }
+
+    VkDeviceMemory Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags flags) {
+        VkMemoryAllocateInfo allocInfo{VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO};
+        allocInfo.allocationSize = requirements.size;
+        allocInfo.memoryTypeIndex = FindMemoryType(requirements.memoryTypeBits, flags);
+        VkDeviceMemory memory;
+        CHECK_VK(vkAllocateMemory(m_device, &allocInfo, nullptr, &memory));
+        return memory;
+    }
+
+    void CreateImage(Image* image, VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect) {
+        VkImageCreateInfo imageInfo{VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO};
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = {Width, Height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = usage;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        CHECK_VK(vkCreateImage(m_device, &imageInfo, nullptr, &image->image));
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(m_device, image->image, &requirements);
+        image->memory = Allocate(requirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+        CHECK_VK(vkBindImageMemory(m_device, image->image, image->memory, 0));
+
+        VkImageViewCreateInfo viewInfo{VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO};
+        viewInfo.image = image->image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange = {aspect, 0, 1, 0, 1};
+        CHECK_VK(vkCreateImageView(m_device, &viewInfo, nullptr, &image->view));
+    }
+
+    void CreateTarget() {
+        CreateImage(&m_color, ColorFormat, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_ASPECT_COLOR_BIT);
+        CreateImage(&m_depth, DepthFormat, VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_IMAGE_ASPECT_DEPTH_BIT);
+
+        VkAttachmentDescription attachments[2] = {};
+        attachments[0].format = ColorFormat;
+        attachments[0].samples = VK_SAMPLE_COUNT_1_BIT;
+        attachments[0].loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        attachments[0].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        attachments[0].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        attachments[0].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[0].initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        attachments[1] = attachments[0];
+        attachments[1].format = DepthFormat;
+        attachments[1].storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference colorRef = {0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        VkAttachmentReference depthRef = {1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+        VkSubpassDescription subpass = {};
+        subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpass.colorAttachmentCount = 1;
+        subpass.pColorAttachments = &colorRef;
+        subpass.pDepthStencilAttachment = &depthRef;
+
+        VkRenderPassCreateInfo passInfo{VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO};
+        passInfo.attachmentCount = 2;
+        passInfo.pAttachments = attachments;
+        passInfo.subpassCount = 1;
+        passInfo.pSubpasses = &subpass;
+        CHECK_VK(vkCreateRenderPass(m_device, &passInfo, nullptr, &m_renderPass));
+
+        const VkImageView views[2] = {m_color.view, m_depth.view};
+        VkFramebufferCreateInfo framebufferInfo{VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO};
+        framebufferInfo.renderPass = m_renderPass;
+        framebufferInfo.attachmentCount = 2;
+        framebufferInfo.pAttachments = views;
+        framebufferInfo.width = Width;
+        framebufferInfo.height = Height;
+        framebufferInfo.layers = 1;
+        CHECK_VK(vkCreateFramebuffer(m_device, &framebufferInfo, nullptr, &m_framebuffer));
+    }
+
+    VkShaderModule CreateShader(const uint32_t* code, size_t size) {
+        VkShaderModuleCreateInfo moduleInfo{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
+        moduleInfo.codeSize = size;
+        moduleInfo.pCode = code;
+        VkShaderModule module;
+        CHECK_VK(vkCreateShaderModule(m_device, &moduleInfo, nullptr, &module));
+        return module;
+    }
+
+    void CreatePipeline() {
+        VkPushConstantRange pushRange = {VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(XrMatrix4x4f)};
+        VkPipelineLayoutCreateInfo layoutInfo{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        layoutInfo.pushConstantRangeCount = 1;
+        layoutInfo.pPushConstantRanges = &pushRange;
+        CHECK_VK(vkCreatePipelineLayout(m_device, &layoutInfo, nullptr, &m_pipelineLayout));
+
+        const VkShaderModule vertexShader = CreateShader(VertexShaderSpv, sizeof(VertexShaderSpv));
+        const VkShaderModule fragmentShader = CreateShader(FragmentShaderSpv, sizeof(FragmentShaderSpv));
+        VkPipelineShaderStageCreateInfo stages[2] = {};
+        stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+        stages[0].module = vertexShader;
+        stages[0].pName = "main";
+        stages[1] = stages[0];
+        stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+        stages[1].module = fragmentShader;
+
+        // Binding 0 the cube vertices, binding 1 one model matrix per instance at locations 2-5.
+        const VkVertexInputBindingDescription bindings[2] = {{0, sizeof(Geometry::Vertex), VK_VERTEX_INPUT_RATE_VERTEX},
+                                                             {1, sizeof(XrMatrix4x4f), VK_VERTEX_INPUT_RATE_INSTANCE}};
+        std::vector<VkVertexInputAttributeDescription> attributes = {
+            {0, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Geometry::Vertex, Position)},
+            {1, 0, VK_FORMAT_R32G32B32_SFLOAT, offsetof(Geometry::Vertex, Color)}};
+        for (uint32_t column = 0; column < 4; column++) {
+            attributes.push_back({2 + column, 1, VK_FORMAT_R32G32B32A32_SFLOAT, column * 4 * (uint32_t)sizeof(float)});
+        }
+        VkPipelineVertexInputStateCreateInfo vertexInput{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+        vertexInput.vertexBindingDescriptionCount = 2;
+        vertexInput.pVertexBindingDescriptions = bindings;
+        vertexInput.vertexAttributeDescriptionCount = (uint32_t)attributes.size();
+        vertexInput.pVertexAttributeDescriptions = attributes.data();
+
+        VkPipelineInputAssemblyStateCreateInfo inputAssembly{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
+        inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+        const VkViewport viewport = {0, 0, (float)Width, (float)Height, 0, 1};
+        const VkRect2D scissor = {{0, 0}, {Width, Height}};
+        VkPipelineViewportStateCreateInfo viewportState{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO};
+        viewportState.viewportCount = 1;
+        viewportState.pViewports = &viewport;
+        viewportState.scissorCount = 1;
+        viewportState.pScissors = &scissor;
+
+        VkPipelineRasterizationStateCreateInfo rasterization{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO};
+        rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterization.cullMode = VK_CULL_MODE_BACK_BIT;
+        rasterization.frontFace = VK_FRONT_FACE_CLOCKWISE;
+        rasterization.lineWidth = 1.0f;
+
+        VkPipelineMultisampleStateCreateInfo multisample{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO};
+        multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+        VkPipelineDepthStencilStateCreateInfo depthStencil{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
+        depthStencil.depthTestEnable = VK_TRUE;
+        depthStencil.depthWriteEnable = VK_TRUE;
+        depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+        VkPipelineColorBlendAttachmentState blendAttachment = {};
+        blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        VkPipelineColorBlendStateCreateInfo colorBlend{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO};
+        colorBlend.attachmentCount = 1;
+        colorBlend.pAttachments = &blendAttachment;
+
+        VkGraphicsPipelineCreateInfo pipelineInfo{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+        pipelineInfo.stageCount = 2;
+        pipelineInfo.pStages = stages;
+        pipelineInfo.pVertexInputState = &vertexInput;
+        pipelineInfo.pInputAssemblyState = &inputAssembly;
+        pipelineInfo.pViewportState = &viewportState;
+        pipelineInfo.pRasterizationState = &rasterization;
+        pipelineInfo.pMultisampleState = &multisample;
+        pipelineInfo.pDepthStencilState = &depthStencil;
+        pipelineInfo.pColorBlendState = &colorBlend;
+        pipelineInfo.layout = m_pipelineLayout;
+        pipelineInfo.renderPass = m_renderPass;
+        CHECK_VK(vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline));
+        vkDestroyShaderModule(m_device, vertexShader, nullptr);
+        vkDestroyShaderModule(m_device, fragmentShader, nullptr);
+    }
+
+    void CreateBuffer(Buffer* buffer, VkBufferUsageFlags usage, VkDeviceSize size, const void* data) {
+        VkBufferCreateInfo bufferInfo{VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO};
+        bufferInfo.usage = usage;
+        bufferInfo.size = size;
+        CHECK_VK(vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer->buffer));
+        VkMemoryRequirements requirements;
+        vkGetBufferMemoryRequirements(m_device, buffer->buffer, &requirements);
+        // Host coherent like the plugin's instance buffer, mapped for the lifetime of the bench.
+        buffer->memory = Allocate(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+        CHECK_VK(vkBindBufferMemory(m_device, buffer->buffer, buffer->memory, 0));
+        CHECK_VK(vkMapMemory(m_device, buffer->memory, 0, VK_WHOLE_SIZE, 0, &buffer->mapped));
+        if (data != nullptr) {
+            memcpy(buffer->mapped, data, (size_t)size);
+        }
+    }
+
+    void CreateBuffers() {
+        CreateBuffer(&m_vertices, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(Geometry::c_cubeVertices), Geometry::c_cubeVertices);
+        CreateBuffer(&m_indices, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, sizeof(Geometry::c_cubeIndices), Geometry::c_cubeIndices);
+        CreateBuffer(&m_instances, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, sizeof(XrMatrix4x4f) * MaxObjects, nullptr);
+    }
+
+    void CreateCommands() {
+        VkCommandPoolCreateInfo poolInfo{VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+        poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        poolInfo.queueFamilyIndex = m_queueFamily;
+        CHECK_VK(vkCreateCommandPool(m_device, &poolInfo, nullptr, &m_commandPool));
+        VkCommandBufferAllocateInfo allocInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        allocInfo.commandPool = m_commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        CHECK_VK(vkAllocateCommandBuffers(m_device, &allocInfo, &m_commandBuffer));
+
+        VkFenceCreateInfo fenceInfo{VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        CHECK_VK(vkCreateFence(m_device, &fenceInfo, nullptr, &m_fence));
+
+        VkQueryPoolCreateInfo queryInfo{VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+        queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryInfo.queryCount = 2;
+        CHECK_VK(vkCreateQueryPool(m_device, &queryInfo, nullptr, &m_queries));
+    }
+
+    // What RenderView records for one view: before the instanced path a push constant and a draw per cube, now the
+    // model matrices go to the instance buffer and one draw covers all cubes. Both write the same matrices, so the
+    // difference is the per-draw cost alone.
+    void Record(uint32_t objectCount, bool instanced, float time) {
+        CHECK_VK(vkResetCommandBuffer(m_commandBuffer, 0));
+        VkCommandBufferBeginInfo beginInfo{VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+        CHECK_VK(vkBeginCommandBuffer(m_commandBuffer, &beginInfo));
+        vkCmdResetQueryPool(m_commandBuffer, m_queries, 0, 2);
+        vkCmdWriteTimestamp(m_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queries, 0);
+
+        VkClearValue clearValues[2] = {};
+        clearValues[0].color = {{0.184313729f, 0.309803933f, 0.309803933f, 1.0f}};
+        clearValues[1].depthStencil = {1.0f, 0};
+        VkRenderPassBeginInfo passBegin{VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO};
+        passBegin.renderPass = m_renderPass;
+        passBegin.framebuffer = m_framebuffer;
+        passBegin.renderArea = {{0, 0}, {Width, Height}};
+        passBegin.clearValueCount = 2;
+        passBegin.pClearValues = clearValues;
+        vkCmdBeginRenderPass(m_commandBuffer, &passBegin, VK_SUBPASS_CONTENTS_INLINE);
+        vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipeline);
+        vkCmdBindIndexBuffer(m_commandBuffer, m_indices.buffer, 0, VK_INDEX_TYPE_UINT16);
+        const VkBuffer vertexBuffers[] = {m_vertices.buffer, m_instances.buffer};
+        const VkDeviceSize offsets[] = {0, 0};
+        vkCmdBindVertexBuffers(m_commandBuffer, 0, 2, vertexBuffers, offsets);
+
+        XrMatrix4x4f proj;
+        const XrFovf fov = {-0.8f, 0.8f, 0.8f, -0.8f};
+        XrMatrix4x4f_CreateProjectionFov(&proj, GRAPHICS_VULKAN, fov, 0.05f, 100.0f);
+        XrMatrix4x4f view;
+        XrMatrix4x4f_CreateIdentity(&view);
+        XrMatrix4x4f viewProj;
+        XrMatrix4x4f_Multiply(&viewProj, &proj, &view);
+
+        // A grid of small cubes two meters ahead, spinning so the matrices change every frame.
+        const uint32_t side = (uint32_t)std::ceil(std::sqrt((double)objectCount));
+        XrMatrix4x4f* models = static_cast<XrMatrix4x4f*>(m_instances.mapped);
+        const uint32_t indexCount = (uint32_t)(sizeof(Geometry::c_cubeIndices) / sizeof(Geometry::c_cubeIndices[0]));
+        if (instanced) {
+            vkCmdPushConstants(m_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(viewProj.m), &viewProj.m[0]);
+        }
+        for (uint32_t i = 0; i < objectCount; i++) {
+            const XrVector3f position = {((float)(i % side) / side - 0.5f) * 3.0f, ((float)(i / side) / side - 0.5f) * 3.0f, -2.0f};
+            const XrQuaternionf orientation = {0, std::sin(time + i * 0.1f), 0, std::cos(time + i * 0.1f)};
+            const float size = 1.5f / side;
+            const XrVector3f scale = {size, size, size};
+            XrMatrix4x4f_CreateTranslationRotationScale(&models[i], &position, &orientation, &scale);
+            if (!instanced) {
+                vkCmdPushConstants(m_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(viewProj.m), &viewProj.m[0]);
+                vkCmdDrawIndexed(m_commandBuffer, indexCount, 1, 0, 0, i);
+            }
+        }
+        if (instanced && objectCount > 0) {
+            vkCmdDrawIndexed(m_commandBuffer, indexCount, objectCount, 0, 0, 0);
+        }
+
+        vkCmdEndRenderPass(m_commandBuffer);
+        vkCmdWriteTimestamp(m_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queries, 1);
+        CHECK_VK(vkEndCommandBuffer(m_commandBuffer));
+    }
+
+    VkInstance m_instance{VK_NULL_HANDLE};
+    VkPhysicalDevice m_physicalDevice{VK_NULL_HANDLE};
+    VkPhysicalDeviceProperties m_properties{};
+    VkPhysicalDeviceMemoryProperties m_memoryProperties{};
+    uint32_t m_queueFamily{0};
+    VkDevice m_device{VK_NULL_HANDLE};
+    VkQueue m_queue{VK_NULL_HANDLE};
+    Image m_color;
+    Image m_depth;
+    VkRenderPass m_renderPass{VK_NULL_HANDLE};
+    VkFramebuffer m_framebuffer{VK_NULL_HANDLE};
+    VkPipelineLayout m_pipelineLayout{VK_NULL_HANDLE};
+    VkPipeline m_pipeline{VK_NULL_HANDLE};
+    Buffer m_vertices;
+    Buffer m_indices;
+    Buffer m_instances;
+    VkCommandPool m_commandPool{VK_NULL_HANDLE};
+    VkCommandBuffer m_commandBuffer{VK_NULL_HANDLE};
+    VkFence m_fence{VK_NULL_HANDLE};
+    VkQueryPool m_queries{VK_NULL_HANDLE};
+};
+
+}  // namespace
+
+int main() {
+    try {
+        DrawBench bench;
+        printf("%s, %ux%u, median of 200 views\n", bench.GetDeviceName(), Width, Height);
+        printf("%8s %12s %12s %12s %12s\n", "objects", "draws us", "draws gpu", "inst us", "inst gpu");
+        for (uint32_t objects : {10u, 100u, 1000u}) {
+            const Timing perObject = bench.Measure(objects, false, 200);
+            const Timing instanced = bench.Measure(objects, true, 200);
+            printf("%8u %12.1f %12.1f %12.1f %12.1f\n", objects, perObject.recordUs, perObject.gpuUs, instanced.recordUs, instanced.gpuUs);
+        }
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+/*
+    xr_linear.h compiled once per backend, for cross-checks and benchmarks
+*/
+
+#pragma once
+#include <openxr/openxr.h>
+#include <common/xr_linear.h>
+#include <vector>
+
+struct XrLinearBackend {
+    const char* name;
+    void (*multiply)(XrMatrix4x4f* result, const XrMatrix4x4f* a, const XrMatrix4x4f* b);
+    void (*invertRigidBody)(XrMatrix4x4f* result, const XrMatrix4x4f* src);
+    void (*createTranslationRotationScale)(XrMatrix4x4f* result, const XrVector3f* translation, const XrQuaternionf* rotation,
+                                           const XrVector3f* scale);
+    void (*transformVector3f)(XrVector3f* result, const XrMatrix4x4f* m, const XrVector3f* v);
+    void (*transformBounds)(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix, const XrVector3f* mins,
+                            const XrVector3f* maxs);
+    bool (*cullBounds)(const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs);
+    void (*transformBoundsArray)(XrVector3f* resultMins, XrVector3f* resultMaxs, const XrMatrix4x4f* matrix, const XrVector3f* mins,
+                                 const XrVector3f* maxs, const int count);
+    int (*cullBoundsArray)(bool* culled, const XrMatrix4x4f* mvp, const XrVector3f* mins, const XrVector3f* maxs, const int count);
+};
+
+#define XR_LINEAR_BACKEND_TABLE(name)                                                                                              \
+    {                                                                                                                              \
+        name, XrMatrix4x4f_Multiply, XrMatrix4x4f_InvertRigidBody, XrMatrix4x4f_CreateTranslationRotationScale,                   \
+            XrMatrix4x4f_TransformVector3f, XrMatrix4x4f_TransformBounds, XrMatrix4x4f_CullBounds,                                 \
+            XrMatrix4x4f_TransformBoundsArray, XrMatrix4x4f_CullBoundsArray                                                        \
+    }
+
+const XrLinearBackend& XrLinearScalarBackend();
+
+// NEON on arm64, SSE4.1 and, where the host has it, SSE4.1 with AVX on x86.
+std::vector<const XrLinearBackend*> XrLinearSimdBackends();
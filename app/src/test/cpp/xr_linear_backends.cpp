@@ -0,0 +1,19 @@
+/*
+    the SIMD backends this host can run
+*/
+#include "xr_linear_backend.h"
+
+const XrLinearBackend& XrLinearSimd4Backend();
+#if defined(XR_LINEAR_TEST_AVX)
+const XrLinearBackend& XrLinearAvxBackend();
+#endif
+
+std::vector<const XrLinearBackend*> XrLinearSimdBackends() {
+    std::vector<const XrLinearBackend*> backends{&XrLinearSimd4Backend()};
+#if defined(XR_LINEAR_TEST_AVX)
+    if (__builtin_cpu_supports("avx")) {
+        backends.push_back(&XrLinearAvxBackend());
+    }
+#endif
+    return backends;
+}
@@ -0,0 +1,106 @@
+/*
+    xr_linear.h scalar against SIMD timings, prints nanoseconds per call
+*/
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+#include "xr_linear_backend.h"
+
+namespace {
+
+template <typename F>
+double NsPerCall(int calls, int itemsPerCall, F&& body) {
+    body();  // warm up
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        body();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / calls / itemsPerCall;
+}
+
+// Keeps the optimizer from dropping the benchmarked work.
+volatile float g_sink;
+
+struct Inputs {
+    XrMatrix4x4f a, b, rigid, mvp;
+    XrVector3f translation{1, 2, 3};
+    XrQuaternionf rotation{0, 0.38268343f, 0, 0.92387953f};
+    XrVector3f scale{1, 1, 1};
+    std::vector<XrVector3f> mins, maxs;
+};
+
+void Run(const XrLinearBackend& backend, const Inputs& in) {
+    const int count = (int)in.mins.size();
+    std::vector<XrVector3f> outMins(count), outMaxs(count);
+    std::unique_ptr<bool[]> culled(new bool[count]);
+    XrMatrix4x4f result;
+
+    printf("%-12s", backend.name);
+    printf(" %8.2f", NsPerCall(1000000, 1, [&]() { backend.multiply(&result, &in.a, &in.b); g_sink = result.m[5]; }));
+    printf(" %8.2f", NsPerCall(1000000, 1, [&]() { backend.invertRigidBody(&result, &in.rigid); g_sink = result.m[5]; }));
+    printf(" %8.2f", NsPerCall(1000000, 1, [&]() {
+               backend.createTranslationRotationScale(&result, &in.translation, &in.rotation, &in.scale);
+               g_sink = result.m[5];
+           }));
+    printf(" %8.2f", NsPerCall(1000000, 1, [&]() {
+               XrVector3f v;
+               backend.transformVector3f(&v, &in.rigid, &in.translation);
+               g_sink = v.x;
+           }));
+    printf(" %8.2f", NsPerCall(1000, count, [&]() {
+               for (int i = 0; i < count; i++) {
+                   backend.transformBounds(&outMins[i], &outMaxs[i], &in.rigid, &in.mins[i], &in.maxs[i]);
+               }
+               g_sink = outMins[7].x;
+           }));
+    printf(" %8.2f", NsPerCall(1000, count, [&]() {
+               backend.transformBoundsArray(outMins.data(), outMaxs.data(), &in.rigid, in.mins.data(), in.maxs.data(), count);
+               g_sink = outMins[7].x;
+           }));
+    printf(" %8.2f", NsPerCall(1000, count, [&]() {
+               int culledCount = 0;
+               for (int i = 0; i < count; i++) {
+                   culledCount += backend.cullBounds(&in.mvp, &in.mins[i], &in.maxs[i]) ? 1 : 0;
+               }
+               g_sink = (float)culledCount;
+           }));
+    printf(" %8.2f", NsPerCall(1000, count, [&]() {
+               g_sink = (float)backend.cullBoundsArray(culled.get(), &in.mvp, in.mins.data(), in.maxs.data(), count);
+           }));
+    printf("\n");
+}
+
+}  // namespace
+
+int main() {
+    std::mt19937 engine(42);
+    std::uniform_real_distribution<float> uniform(-2.0f, 2.0f);
+
+    Inputs in;
+    for (int i = 0; i < 16; i++) {
+        in.a.m[i] = uniform(engine);
+        in.b.m[i] = uniform(engine);
+    }
+    XrMatrix4x4f_CreateTranslationRotationScale(&in.rigid, &in.translation, &in.rotation, &in.scale);
+    XrMatrix4x4f projection;
+    XrMatrix4x4f_CreateProjection(&projection, GRAPHICS_VULKAN, -1, 1, 1, -1, 0.05f, 100.0f);
+    XrMatrix4x4f_Multiply(&in.mvp, &projection, &in.rigid);
+
+    // Boxes around the camera, roughly half of them are culled.
+    for (int i = 0; i < 1024; i++) {
+        const XrVector3f center{uniform(engine) * 10, uniform(engine) * 10, uniform(engine) * 10};
+        in.mins.push_back({center.x - 0.5f, center.y - 0.5f, center.z - 0.5f});
+        in.maxs.push_back({center.x + 0.5f, center.y + 0.5f, center.z + 0.5f});
+    }
+
+    printf("ns per matrix or bounds, 1024 bounds per array call\n");
+    printf("%-12s %8s %8s %8s %8s %8s %8s %8s %8s\n", "backend", "mul", "invRigid", "trs", "xformV3", "xformBnd", "bndArray",
+           "cull", "cullArr");
+    Run(XrLinearScalarBackend(), in);
+    for (const XrLinearBackend* backend : XrLinearSimdBackends()) {
+        Run(*backend, in);
+    }
+    return 0;
+}
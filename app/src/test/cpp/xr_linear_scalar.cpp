@@ -0,0 +1,13 @@
+/*
+    xr_linear.h without the SIMD backend
+*/
+#include "xr_linear_backend.h"
+
+#if defined(XR_LINEAR_SIMD)
+#error "the scalar backend must not be compiled with XR_LINEAR_USE_SIMD"
+#endif
+
+const XrLinearBackend& XrLinearScalarBackend() {
+    static const XrLinearBackend backend = XR_LINEAR_BACKEND_TABLE("scalar");
+    return backend;
+}
@@ -0,0 +1,18 @@
+/*
+    xr_linear.h with the four lane SIMD backend, NEON or SSE4.1
+*/
+#define XR_LINEAR_USE_SIMD 1
+#include "xr_linear_backend.h"
+
+#if !defined(XR_LINEAR_SIMD)
+#error "no SIMD instruction set enabled for this translation unit"
+#endif
+
+const XrLinearBackend& XrLinearSimd4Backend() {
+#if defined(XR_LINEAR_SIMD_NEON)
+    static const XrLinearBackend backend = XR_LINEAR_BACKEND_TABLE("NEON");
+#else
+    static const XrLinearBackend backend = XR_LINEAR_BACKEND_TABLE("SSE4.1");
+#endif
+    return backend;
+}
@@ -0,0 +1,14 @@
+/*
+    xr_linear.h with the SIMD backend and the AVX eight corner culling, x86 only
+*/
+#define XR_LINEAR_USE_SIMD 1
+#include "xr_linear_backend.h"
+
+#if !defined(XR_LINEAR_SIMD_SSE) || !defined(__AVX__)
+#error "this translation unit needs SSE4.1 and AVX"
+#endif
+
+const XrLinearBackend& XrLinearAvxBackend() {
+    static const XrLinearBackend backend = XR_LINEAR_BACKEND_TABLE("SSE4.1+AVX");
+    return backend;
+}
@@ -0,0 +1,183 @@
+/*
+    xr_linear.h SIMD backend against the scalar code on random inputs
+*/
+#include <catch2/catch.hpp>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "xr_linear_backend.h"
+
+namespace {
+
+struct Random {
+    std::mt19937 engine{1234};
+
+    float Uniform(float lo, float hi) { return std::uniform_real_distribution<float>(lo, hi)(engine); }
+
+    XrVector3f Vector(float lo, float hi) { return {Uniform(lo, hi), Uniform(lo, hi), Uniform(lo, hi)}; }
+
+    XrQuaternionf Rotation() {
+        XrQuaternionf q{Uniform(-1, 1), Uniform(-1, 1), Uniform(-1, 1), Uniform(-1, 1)};
+        const float length = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+        return {q.x / length, q.y / length, q.z / length, q.w / length};
+    }
+
+    XrMatrix4x4f Rigid() {
+        const XrVector3f translation = Vector(-10, 10);
+        const XrQuaternionf rotation = Rotation();
+        const XrVector3f scale{1, 1, 1};
+        XrMatrix4x4f m;
+        XrMatrix4x4f_CreateTranslationRotationScale(&m, &translation, &rotation, &scale);
+        return m;
+    }
+
+    XrMatrix4x4f Matrix() {
+        XrMatrix4x4f m;
+        for (float& value : m.m) {
+            value = Uniform(-4, 4);
+        }
+        return m;
+    }
+};
+
+void RequireClose(const XrMatrix4x4f& a, const XrMatrix4x4f& b) {
+    for (int i = 0; i < 16; i++) {
+        REQUIRE(a.m[i] == Approx(b.m[i]).epsilon(1e-5).margin(1e-5));
+    }
+}
+
+void RequireClose(const XrVector3f& a, const XrVector3f& b) {
+    REQUIRE(a.x == Approx(b.x).epsilon(1e-5).margin(1e-5));
+    REQUIRE(a.y == Approx(b.y).epsilon(1e-5).margin(1e-5));
+    REQUIRE(a.z == Approx(b.z).epsilon(1e-5).margin(1e-5));
+}
+
+// A camera at a random pose looking at boxes scattered around it, so a good share is culled and a good share is not.
+XrMatrix4x4f RandomViewProjection(Random& random) {
+    XrMatrix4x4f projection;
+    XrMatrix4x4f_CreateProjection(&projection, GRAPHICS_VULKAN, -1, 1, 1, -1, 0.05f, 100.0f);
+    const XrMatrix4x4f camera = random.Rigid();
+    XrMatrix4x4f view;
+    XrMatrix4x4f_InvertRigidBody(&view, &camera);
+    XrMatrix4x4f viewProjection;
+    XrMatrix4x4f_Multiply(&viewProjection, &projection, &view);
+    return viewProjection;
+}
+
+void RandomBounds(Random& random, int count, std::vector<XrVector3f>* mins, std::vector<XrVector3f>* maxs) {
+    mins->resize(count);
+    maxs->resize(count);
+    for (int i = 0; i < count; i++) {
+        const XrVector3f center = random.Vector(-30, 30);
+        const XrVector3f extents = random.Vector(0.01f, 3);
+        (*mins)[i] = {center.x - extents.x, center.y - extents.y, center.z - extents.z};
+        (*maxs)[i] = {center.x + extents.x, center.y + extents.y, center.z + extents.z};
+    }
+}
+
+}  // namespace
+
+TEST_CASE("xr_linear SIMD backends are compiled in", "[xr_linear]") {
+    REQUIRE(std::string(XrLinearScalarBackend().name) == "scalar");
+    REQUIRE_FALSE(XrLinearSimdBackends().empty());
+}
+
+TEST_CASE("xr_linear SIMD matrix helpers match scalar", "[xr_linear]") {
+    const XrLinearBackend& scalarBackend = XrLinearScalarBackend();
+    for (const XrLinearBackend* simdBackend : XrLinearSimdBackends()) {
+        INFO("backend " << simdBackend->name);
+        Random random;
+        for (int i = 0; i < 1000; i++) {
+            const XrMatrix4x4f a = random.Matrix();
+            const XrMatrix4x4f b = random.Matrix();
+            XrMatrix4x4f scalar, simd;
+            scalarBackend.multiply(&scalar, &a, &b);
+            simdBackend->multiply(&simd, &a, &b);
+            RequireClose(simd, scalar);
+
+            const XrMatrix4x4f rigid = random.Rigid();
+            scalarBackend.invertRigidBody(&scalar, &rigid);
+            simdBackend->invertRigidBody(&simd, &rigid);
+            RequireClose(simd, scalar);
+
+            const XrVector3f translation = random.Vector(-10, 10);
+            const XrQuaternionf rotation = random.Rotation();
+            const XrVector3f scale = random.Vector(0.1f, 3);
+            scalarBackend.createTranslationRotationScale(&scalar, &translation, &rotation, &scale);
+            simdBackend->createTranslationRotationScale(&simd, &translation, &rotation, &scale);
+            RequireClose(simd, scalar);
+
+            const XrVector3f v = random.Vector(-5, 5);
+            XrVector3f scalarV, simdV;
+            scalarBackend.transformVector3f(&scalarV, &rigid, &v);
+            simdBackend->transformVector3f(&simdV, &rigid, &v);
+            RequireClose(simdV, scalarV);
+        }
+    }
+}
+
+TEST_CASE("xr_linear SIMD bounds transform matches scalar", "[xr_linear]") {
+    const XrLinearBackend& scalarBackend = XrLinearScalarBackend();
+    for (const XrLinearBackend* simdBackend : XrLinearSimdBackends()) {
+        INFO("backend " << simdBackend->name);
+        Random random;
+        std::vector<XrVector3f> mins, maxs;
+        RandomBounds(random, 257, &mins, &maxs);
+        const XrMatrix4x4f matrix = random.Rigid();
+
+        const size_t count = mins.size();
+        std::vector<XrVector3f> scalarMins(count), scalarMaxs(count), simdMins(count), simdMaxs(count);
+        scalarBackend.transformBoundsArray(scalarMins.data(), scalarMaxs.data(), &matrix, mins.data(), maxs.data(), (int)count);
+        simdBackend->transformBoundsArray(simdMins.data(), simdMaxs.data(), &matrix, mins.data(), maxs.data(), (int)count);
+        for (size_t i = 0; i < count; i++) {
+            RequireClose(simdMins[i], scalarMins[i]);
+            RequireClose(simdMaxs[i], scalarMaxs[i]);
+
+            XrVector3f single[2];
+            simdBackend->transformBounds(&single[0], &single[1], &matrix, &mins[i], &maxs[i]);
+            RequireClose(single[0], scalarMins[i]);
+            RequireClose(single[1], scalarMaxs[i]);
+        }
+    }
+}
+
+TEST_CASE("xr_linear SIMD culling matches scalar", "[xr_linear]") {
+    const XrLinearBackend& scalarBackend = XrLinearScalarBackend();
+    for (const XrLinearBackend* simdBackend : XrLinearSimdBackends()) {
+        INFO("backend " << simdBackend->name);
+        Random random;
+        int culledTotal = 0;
+        int keptTotal = 0;
+        for (int round = 0; round < 50; round++) {
+            const XrMatrix4x4f mvp = RandomViewProjection(random);
+            std::vector<XrVector3f> mins, maxs;
+            RandomBounds(random, 203, &mins, &maxs);
+            // An empty box is never culled.
+            maxs[5] = mins[5];
+
+            const size_t count = mins.size();
+            std::vector<char> scalar(count);
+            for (size_t i = 0; i < count; i++) {
+                scalar[i] = scalarBackend.cullBounds(&mvp, &mins[i], &maxs[i]);
+                REQUIRE(simdBackend->cullBounds(&mvp, &mins[i], &maxs[i]) == (scalar[i] != 0));
+            }
+            REQUIRE(scalar[5] == 0);
+
+            std::unique_ptr<bool[]> scalarArray(new bool[count]);
+            std::unique_ptr<bool[]> simdArray(new bool[count]);
+            const int scalarCount = scalarBackend.cullBoundsArray(scalarArray.get(), &mvp, mins.data(), maxs.data(), (int)count);
+            const int simdCount = simdBackend->cullBoundsArray(simdArray.get(), &mvp, mins.data(), maxs.data(), (int)count);
+            REQUIRE(simdCount == scalarCount);
+            for (size_t i = 0; i < count; i++) {
+                REQUIRE(scalarArray[i] == (scalar[i] != 0));
+                REQUIRE(simdArray[i] == scalarArray[i]);
+            }
+            culledTotal += scalarCount;
+            keptTotal += (int)count - scalarCount;
+        }
+        // Both outcomes have to be exercised for the comparison to mean anything.
+        REQUIRE(culledTotal > 1000);
+        REQUIRE(keptTotal > 1000);
+    }
+}